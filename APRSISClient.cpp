@@ -11,10 +11,17 @@ Q_DECLARE_LOGGING_CATEGORY(aprsisclient_js8)
 
 const int PACKET_TIMEOUT_SECONDS = 300;
 
+// positions of a station are sent no more often than this
+const int POSITION_TTL_SECONDS = 600;
+
+// frames are coalesced into writes of up to this many bytes
+const int MAX_WRITE_BYTES = 4096;
+
 APRSISClient::APRSISClient(QString const host,
                            quint16 const port,
                            QObject     * parent)
   : QTcpSocket{parent},
+    m_queue   {"APRS", {500, POSITION_TTL_SECONDS, PACKET_TIMEOUT_SECONDS, 128 * 1024}},
     m_timer   {this}
 {
     setServer(host, port);
@@ -225,7 +232,7 @@ void APRSISClient::enqueueSpot(QString by_call, QString from_call, QString grid,
     spotFrame = spotFrame.arg(geo.first);
     spotFrame = spotFrame.arg(geo.second);
     spotFrame = spotFrame.arg(comment.left(42));
-    enqueueRaw(spotFrame);
+    enqueueRaw(spotFrame, from_call);
 }
 
 void APRSISClient::enqueueThirdParty(QString by_call, QString from_call, QString text){
@@ -241,8 +248,8 @@ void APRSISClient::enqueueThirdParty(QString by_call, QString from_call, QString
     enqueueRaw(frame);
 }
 
-void APRSISClient::enqueueRaw(QString aprsFrame){
-    m_frameQueue.enqueue({ aprsFrame, DriftingDateTime::currentDateTimeUtc() });
+void APRSISClient::enqueueRaw(QString aprsFrame, QString key){
+    m_queue.push(aprsFrame.toLocal8Bit(), DriftingDateTime::currentSecsSinceEpoch(), key);
 }
 
 void APRSISClient::processQueue(bool disconnect){
@@ -250,18 +257,16 @@ void APRSISClient::processQueue(bool disconnect){
     if(m_localCall.isEmpty()) return;
 
     // don't process queue if there's nothing to process
-    if(m_frameQueue.isEmpty()) return;
+    if(m_queue.isEmpty()) return;
 
-    // don't process queue if there's no host
+    // don't process queue if there's no host; frames will age out
     if(m_host.isEmpty() || m_port == 0){
-        // no host, so let's clear the queue and exit
-        m_frameQueue.clear();
         return;
     }
 
     // 1. connect (and read)
     // 2. login (and read)
-    // 3. for each raw frame in queue, send
+    // 3. send the queued frames, as few writes as will hold them
     // 4. disconnect
 
     if(state() != QTcpSocket::ConnectedState){
@@ -269,6 +274,7 @@ void APRSISClient::processQueue(bool disconnect){
         connectToHost(m_host, m_port);
         if(!waitForConnected(5000)){
             qCDebug(aprsisclient_js8) << "APRSISClient Connection Error:" << errorString();
+            m_queue.setOnline(false, DriftingDateTime::currentSecsSinceEpoch());
             return;
         }
     }
@@ -296,52 +302,57 @@ void APRSISClient::processQueue(bool disconnect){
         return;
     }
 
-    QQueue<QPair<QString, QDateTime>> delayed;
+    auto const now = DriftingDateTime::currentSecsSinceEpoch();
 
-    while(!m_frameQueue.isEmpty()){
-        auto pair = m_frameQueue.head();
-        auto frame = pair.first;
-        auto timestamp = pair.second;
+    m_queue.setOnline(true, now);
 
-        // if the packet is older than the timeout, drop it.
-        if(timestamp.secsTo(DriftingDateTime::currentDateTimeUtc()) > PACKET_TIMEOUT_SECONDS){
-            qCDebug(aprsisclient_js8) << "APRSISClient Packet Timeout:" << frame;
-            m_frameQueue.dequeue();
-            continue;
-        }
+    SpotQueue::Records delayed;
+
+    for(auto records = m_queue.take(MAX_WRITE_BYTES, now); !records.isEmpty(); records = m_queue.take(MAX_WRITE_BYTES, now)){
+        SpotQueue::Records batch;
+        QByteArray data;
 
-        // random delay 25% of the time for throttling (a skip will add 60 seconds to the processing time)
-        if(m_skipPercent > 0 && QRandomGenerator::global()->generate() % 100 <= (m_skipPercent*100)){
-            qCDebug(aprsisclient_js8) << "APRSISClient Throttle: Skipping Frame";
-            delayed.enqueue(m_frameQueue.dequeue());
-            continue;
+        for(auto const &record : records){
+            // random delay 25% of the time for throttling (a skip will add 60 seconds to the processing time)
+            if(m_skipPercent > 0 && QRandomGenerator::global()->generate() % 100 <= (m_skipPercent*100)){
+                qCDebug(aprsisclient_js8) << "APRSISClient Throttle: Skipping Frame";
+                delayed.append(record);
+                continue;
+            }
+
+            batch.append(record);
+            data.append(record.data);
         }
 
-        QByteArray data = frame.toLocal8Bit();
+        if(data.isEmpty()) continue;
+
         if(write(data) == -1){
             qCDebug(aprsisclient_js8) << "APRSISClient Write Error:" << errorString();
+            m_queue.failed(batch);
+            m_queue.restore(delayed);
+            m_queue.setOnline(false, now);
             return;
         }
 
-        qCDebug(aprsisclient_js8) << "APRSISClient Write:" << data;
+        qCDebug(aprsisclient_js8) << "APRSISClient Write:" << batch.size() << "frames" << data.size() << "bytes";
         if(waitForReadyRead(5000)){
-            line = QString(readLine());
+            line = QString(readAll());
 
             qCDebug(aprsisclient_js8) << "APRSISClient Read:" << line;
 
             if(line.toLower().indexOf(re) >= 0){
                 qCDebug(aprsisclient_js8) << "APRSISClient Cannot Write Error:" << line;
+                m_queue.failed(batch);
+                m_queue.restore(delayed);
                 return;
             }
         }
 
-        m_frameQueue.dequeue();
+        m_queue.sent(batch.size());
     }
 
-    // enqueue the delayed frames for later processing
-    while(!delayed.isEmpty()){
-        m_frameQueue.enqueue(delayed.dequeue());
-    }
+    // requeue the delayed frames for later processing
+    m_queue.restore(delayed);
 
     if(disconnect){
         disconnectFromHost();
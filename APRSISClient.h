@@ -5,9 +5,11 @@
 #include <QtGlobal>
 #include <QDateTime>
 #include <QTcpSocket>
-#include <QQueue>
 #include <QPair>
 #include <QTimer>
+#include <QVariantMap>
+
+#include "SpotQueue.hpp"
 
 Q_DECLARE_LOGGING_CATEGORY(aprsisclient_js8)
 
@@ -25,9 +27,12 @@ public:
 
     bool isPasscodeValid(){ return m_localPasscode == QString::number(hashCallsign(m_localCall)); }
 
-    void enqueueRaw(QString aprsFrame);
+    void enqueueRaw(QString aprsFrame, QString key = {});
     void processQueue(bool disconnect=true);
 
+    // counters for the frame queue; callable from any thread
+    QVariantMap stats() const { return m_queue.stats(); }
+
 public slots:
 
     void setSkipPercent(float skipPercent){
@@ -67,7 +72,7 @@ private:
     QString m_localCall;
     QString m_localPasscode;
 
-    QQueue<QPair<QString, QDateTime>> m_frameQueue;
+    SpotQueue m_queue;
     QString m_host;
     quint16 m_port;
     QTimer m_timer;
@@ -38,6 +38,10 @@ public:
 
   bool isSequential () const override {return true;}
 
+  // Frame rate of the audio passed through us; by default, only the rate
+  // we've always run at is handled, and false is returned for any other.
+  virtual bool setFrameRate (int rate) {return 48000 == rate;}
+
   size_t bytesPerFrame () const {return sizeof (qint16) * (Mono == m_channel ? 1 : 2);}
 
   Channel channel () const {return m_channel;}
@@ -0,0 +1,264 @@
+#include "AudioHealth.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <QLoggingCategory>
+#include "DriftingDateTime.h"
+
+Q_DECLARE_LOGGING_CATEGORY(audiohealth_js8)
+
+/******************************************************************************/
+// Private Implementation
+/******************************************************************************/
+
+void
+AudioHealth::Stream::Window::clear()
+{
+  callbacks.store(0, std::memory_order_relaxed);
+  frames   .store(0, std::memory_order_relaxed);
+  dropped  .store(0, std::memory_order_relaxed);
+  discarded.store(0, std::memory_order_relaxed);
+  underruns.store(0, std::memory_order_relaxed);
+  interval .clear();
+  jitter   .clear();
+  buffered .clear();
+  deviation.clear();
+}
+
+QVariantMap
+AudioHealth::Stream::Window::stats() const
+{
+  return {
+    {"CALLBACKS", callbacks.load(std::memory_order_relaxed)},
+    {"FRAMES",    frames   .load(std::memory_order_relaxed)},
+    {"DROPPED",   dropped  .load(std::memory_order_relaxed)},
+    {"DISCARDED", discarded.load(std::memory_order_relaxed)},
+    {"UNDERRUNS", underruns.load(std::memory_order_relaxed)},
+    {"INTERVAL",  interval .stats()},
+    {"JITTER",    jitter   .stats()},
+    {"BUFFERED",  buffered .stats()},
+    {"DEVIATION", deviation.stats()}
+  };
+}
+
+/******************************************************************************/
+// Public Interface
+/******************************************************************************/
+
+void
+AudioHealth::Stream::restarted(qint64 const bufferMS)
+{
+  m_bufferMS.store(bufferMS, std::memory_order_relaxed);
+  resumed();
+}
+
+// Whatever happened while we were paused isn't the device's doing; start
+// timing callbacks and counting frames afresh.
+
+void
+AudioHealth::Stream::resumed()
+{
+  m_clock.invalidate();
+  m_period = -1;
+}
+
+// Record a callback moving the frames provided. The interval since the
+// last one should be the time those frames take to play; how far it was
+// from that is the jitter. At the first callback of each period, compare
+// the frames moved since the first callback of the one before with what
+// that time should have held, if we saw all of it; we'll not see it to
+// the frame, since callbacks come a buffer at a time, give or take, but
+// a shortfall of more than a couple of buffers is frames the device has
+// dropped.
+
+void
+AudioHealth::Stream::delivered(qint64 const frames,
+                               qint64 const frameRate,
+                               qint64 const periodMS)
+{
+  auto & window = current();
+
+  window.callbacks.fetch_add(1,      std::memory_order_relaxed);
+  window.frames   .fetch_add(frames, std::memory_order_relaxed);
+
+  if (m_clock.isValid())
+  {
+    auto const interval = m_clock.nsecsElapsed() / 1000;
+    auto const expected = frames * 1000000 / frameRate;
+
+    window.interval.record(interval);
+    window.jitter  .record(std::abs(interval - expected));
+  }
+
+  m_clock.start();
+
+  if (periodMS <= 0) return;
+
+  auto const now    = DriftingDateTime::currentMSecsSinceEpoch();
+  auto const period = now / periodMS;
+
+  m_periodFrames += frames;
+
+  if (period == m_period) return;
+
+  if (m_period >= 0 && period == m_period + 1)
+  {
+    auto const expected = m_periodClock.elapsed() * frameRate / 1000;
+    auto const slack    = 2 * bufferMS() * frameRate / 1000;
+
+    m_lastDelivered.store(m_periodFrames, std::memory_order_relaxed);
+    m_lastExpected .store(expected,       std::memory_order_relaxed);
+
+    window.deviation.record(std::abs(m_periodFrames - expected) * 1000000 / frameRate);
+
+    if (auto const lost = expected - m_periodFrames; lost > slack)
+    {
+      window.dropped.fetch_add(lost, std::memory_order_relaxed);
+      m_dropped     .fetch_add(lost, std::memory_order_relaxed);
+    }
+
+    qCDebug(audiohealth_js8) << "delivered" << m_periodFrames << "of" << expected << "frames expected";
+  }
+
+  m_period       = period;
+  m_periodFrames = 0;
+  m_periodClock.start();
+}
+
+void
+AudioHealth::Stream::discarded(qint64 const frames)
+{
+  current().discarded.fetch_add(frames, std::memory_order_relaxed);
+  m_discarded.fetch_add(frames, std::memory_order_relaxed);
+}
+
+void
+AudioHealth::Stream::underrun()
+{
+  current().underruns.fetch_add(1, std::memory_order_relaxed);
+  m_underruns.fetch_add(1, std::memory_order_relaxed);
+}
+
+void
+AudioHealth::Stream::buffered(qint64 const microseconds)
+{
+  current().buffered.record(microseconds);
+}
+
+// Clear the window before last and make it the current one; it's been a
+// window's length since anything was recorded into it.
+
+void
+AudioHealth::Stream::roll()
+{
+  auto const next = 1 - m_current.load(std::memory_order_relaxed);
+
+  m_windows[next].clear();
+  m_current.store(next, std::memory_order_release);
+}
+
+// Only what the device did counts here; frames discarded downstream of
+// it would be discarded just the same with any size of buffer.
+
+unsigned
+AudioHealth::Stream::tune(unsigned const bufferMS)
+{
+  auto const & window = previous();
+  auto const   jitter = window.jitter.stats().value("P99").toLongLong();
+
+  if (window.dropped.load(std::memory_order_relaxed)   ||
+      window.underruns.load(std::memory_order_relaxed) ||
+      jitter > static_cast<qint64>(bufferMS))
+  {
+    m_clean = 0;
+    m_floor = std::max(m_floor, bufferMS);
+
+    return std::clamp(bufferMS * 2, MIN_BUFFER_MS, MAX_BUFFER_MS);
+  }
+
+  // A window in which the stream didn't run tells us nothing.
+
+  if (!window.callbacks.load(std::memory_order_relaxed)) return bufferMS;
+
+  if (++m_clean < SHRINK_AFTER) return bufferMS;
+
+  m_clean = 0;
+
+  auto const smaller = std::max(bufferMS / 2, MIN_BUFFER_MS);
+
+  return smaller > m_floor ? smaller : bufferMS;
+}
+
+bool
+AudioHealth::Stream::troubled() const
+{
+  for (auto const & window : m_windows)
+  {
+    if (window.dropped.load(std::memory_order_relaxed)   ||
+        window.discarded.load(std::memory_order_relaxed) ||
+        window.underruns.load(std::memory_order_relaxed)) return true;
+  }
+
+  return false;
+}
+
+QString
+AudioHealth::Stream::summary() const
+{
+  quint64 dropped   = 0;
+  quint64 discarded = 0;
+  quint64 underruns = 0;
+
+  for (auto const & window : m_windows)
+  {
+    dropped   += window.dropped.load(std::memory_order_relaxed);
+    discarded += window.discarded.load(std::memory_order_relaxed);
+    underruns += window.underruns.load(std::memory_order_relaxed);
+  }
+
+  auto const jitter = previous().jitter.stats();
+
+  return QString("%1 ms buffer, %2 frames dropped, %3 discarded, %4 underruns, jitter P99 %5 ms")
+    .arg(bufferMS())
+    .arg(dropped)
+    .arg(discarded)
+    .arg(underruns)
+    .arg(jitter.value("P99").toLongLong());
+}
+
+QVariantMap
+AudioHealth::Stream::stats() const
+{
+  auto const index = m_current.load(std::memory_order_acquire);
+
+  return {
+    {"BUFFER_MS",      bufferMS()},
+    {"DROPPED",        m_dropped.load(std::memory_order_relaxed)},
+    {"DISCARDED",      m_discarded.load(std::memory_order_relaxed)},
+    {"UNDERRUNS",      m_underruns.load(std::memory_order_relaxed)},
+    {"LAST_DELIVERED", m_lastDelivered.load(std::memory_order_relaxed)},
+    {"LAST_EXPECTED",  m_lastExpected.load(std::memory_order_relaxed)},
+    {"CURRENT",        m_windows[index].stats()},
+    {"PREVIOUS",       m_windows[1 - index].stats()}
+  };
+}
+
+void
+AudioHealth::roll()
+{
+  m_input .roll();
+  m_output.roll();
+}
+
+QVariantMap
+AudioHealth::stats() const
+{
+  return {
+    {"WINDOW", WINDOW_SECONDS},
+    {"INPUT",  m_input.stats()},
+    {"OUTPUT", m_output.stats()}
+  };
+}
+
+/******************************************************************************/
+
+Q_LOGGING_CATEGORY(audiohealth_js8, "audiohealth.js8", QtWarningMsg)
@@ -0,0 +1,148 @@
+#ifndef AUDIO_HEALTH_HPP__
+#define AUDIO_HEALTH_HPP__
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QVariantMap>
+#include <QtGlobal>
+
+#include <array>
+#include <atomic>
+
+#include "LatencyHistogram.hpp"
+
+// How well the audio streams are keeping up, so that a decode missed for
+// want of audio can be told from one missed for want of signal.
+//
+// For each of input and output, we record how far apart the callbacks of
+// the audio device are, and how far that is from what the frames they
+// move should take; how many frames were delivered over each period, by
+// DriftingDateTime, against how many should have been; frames dropped,
+// underruns, and how much audio sat in the device's buffer, sampled now
+// and then.
+//
+// Frames are dropped by the device when a period falls short of what it
+// should have held by more than a couple of buffers; those are the ones
+// a larger buffer might have saved. Frames discarded by whoever they
+// were delivered to, e.g., a decoder with no room left, are counted on
+// their own; they're no fault of the device, and its buffer size has no
+// bearing on them.
+//
+// Counters are kept in windows of WINDOW_SECONDS; the GUI thread rolls
+// them over, so that we report the window under way, and the one before
+// it, rather than everything since we started. Totals of drops and
+// underruns are kept as well.
+//
+// Recording is lock-free, and is done from the audio thread; rolling and
+// tuning from the GUI thread, and stats() and summary() from any thread.
+
+class AudioHealth final
+{
+public:
+
+  static constexpr int WINDOW_SECONDS = 60;
+
+  class Stream final
+  {
+  public:
+
+    // Called from the audio thread; restarted() when the device starts,
+    // with the size of its buffer, resumed() when it carries on after a
+    // pause, and the others as things happen.
+
+    void restarted(qint64 bufferMS);
+    void resumed  ();
+    void delivered(qint64 frames,
+                   qint64 frameRate,
+                   qint64 periodMS);
+    void discarded(qint64 frames);
+    void underrun ();
+    void buffered (qint64 microseconds);
+
+    // Called from the GUI thread. When tuning, return the buffer size, in
+    // milliseconds, to use in place of the one provided, given how the
+    // window just rolled over went; larger at the first sign of trouble
+    // from the device, i.e., frames dropped, underruns, or callbacks late
+    // by more than the buffer holds, smaller after a run of windows
+    // without any, though never as small as a size that's given trouble
+    // before.
+
+    void     roll();
+    unsigned tune(unsigned bufferMS);
+
+    // Accessors
+
+    qint64      bufferMS() const { return m_bufferMS.load(std::memory_order_relaxed); }
+    bool        troubled() const;
+    QString     summary()  const;
+    QVariantMap stats()    const;
+
+  private:
+
+    static constexpr unsigned MIN_BUFFER_MS = 10;
+    static constexpr unsigned MAX_BUFFER_MS = 640;
+    static constexpr unsigned SHRINK_AFTER  = 10;
+
+    struct Window
+    {
+      std::atomic<quint64> callbacks {0};
+      std::atomic<quint64> frames    {0};
+      std::atomic<quint64> dropped   {0};
+      std::atomic<quint64> discarded {0};
+      std::atomic<quint64> underruns {0};
+      LatencyHistogram     interval;
+      LatencyHistogram     jitter;
+      LatencyHistogram     buffered;
+      LatencyHistogram     deviation;
+
+      void        clear();
+      QVariantMap stats() const;
+    };
+
+    Window       & current()       { return m_windows[m_current.load(std::memory_order_acquire)];     }
+    Window const & previous() const { return m_windows[1 - m_current.load(std::memory_order_acquire)]; }
+
+    std::array<Window, 2> m_windows;
+    std::atomic<int>      m_current       {0};
+    std::atomic<qint64>   m_bufferMS      {0};
+    std::atomic<quint64>  m_dropped       {0};
+    std::atomic<quint64>  m_discarded     {0};
+    std::atomic<quint64>  m_underruns     {0};
+    std::atomic<qint64>   m_lastDelivered {0};
+    std::atomic<qint64>   m_lastExpected  {0};
+
+    // Accessed only on the audio thread.
+
+    QElapsedTimer         m_clock;
+    QElapsedTimer         m_periodClock;
+    qint64                m_period       = -1;
+    qint64                m_periodFrames = 0;
+
+    // Accessed only on the GUI thread.
+
+    unsigned              m_clean        = 0;
+    unsigned              m_floor        = 0;
+  };
+
+  // Accessors
+
+  Stream       & input()        { return m_input;  }
+  Stream       & output()       { return m_output; }
+  Stream const & input()  const { return m_input;  }
+  Stream const & output() const { return m_output; }
+
+  // Roll both streams over to a new window; called from the GUI thread.
+
+  void roll();
+
+  // Counters, in the form the API reports them; times in milliseconds.
+
+  QVariantMap stats() const;
+
+private:
+
+  Stream m_input;
+  Stream m_output;
+};
+
+#endif
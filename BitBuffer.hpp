@@ -0,0 +1,231 @@
+#ifndef BIT_BUFFER_HPP__
+#define BIT_BUFFER_HPP__
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+// Fixed-capacity sequence of bits, packed most significant bit first
+// into 64-bit words; a stand-in for the QVector<bool> we'd otherwise
+// use to assemble frames and codewords, without the allocation and
+// without spending a byte on every bit.
+//
+// Operations that would take the size past the capacity are silently
+// truncated to it, and those reading past the size read zeros, so
+// callers are responsible for checking sizes where that matters, as
+// they'd have been with a QVector<bool>.
+
+template <std::size_t Capacity>
+class BitBuffer
+{
+  static_assert(Capacity > 0, "BitBuffer capacity must be non-zero");
+
+  static constexpr std::size_t Words = (Capacity + 63) / 64;
+
+  std::array<std::uint64_t, Words> m_words = {};
+  std::size_t                      m_size  = 0;
+
+public:
+
+  // Constructors
+
+  constexpr BitBuffer() = default;
+
+  constexpr BitBuffer(std::initializer_list<bool> bits)
+  {
+    for (auto const bit : bits) append(bit);
+  }
+
+  // Accessors
+
+  static constexpr std::size_t capacity() noexcept { return Capacity; }
+
+  constexpr int  size()    const noexcept { return static_cast<int>(m_size); }
+  constexpr int  length()  const noexcept { return size();                   }
+  constexpr bool isEmpty() const noexcept { return m_size == 0;              }
+
+  constexpr bool
+  at(int const i) const noexcept
+  {
+    if (i < 0 || static_cast<std::size_t>(i) >= m_size) return false;
+
+    return (m_words[i / 64] >> (63 - i % 64)) & 1;
+  }
+
+  // Return the n bits starting at pos, where n <= 64, as an integer
+  // with the first of them most significant.
+
+  constexpr std::uint64_t
+  extract(int const pos,
+          int const n) const noexcept
+  {
+    std::uint64_t value = 0;
+
+    if (n <= 0 || pos < 0) return value;
+
+    for (int i = pos, end = pos + std::min(n, 64); i < end;)
+    {
+      // Take as many bits as we can from the word holding bit i.
+
+      auto const offset = i % 64;
+      auto const take   = std::min(64 - offset, end - i);
+      auto const word   = static_cast<std::size_t>(i / 64) < Words ? m_words[i / 64] : 0;
+      auto const bits   = (word << offset) >> (64 - take);
+
+      value = (take == 64 ? 0 : value << take) | bits;
+      i    += take;
+    }
+
+    // Anything past the end reads as zero, but words are kept clear
+    // past the size, so there's nothing to mask off here.
+
+    return value;
+  }
+
+  // Index of the last bit having the value provided, or -1.
+
+  constexpr int
+  lastIndexOf(bool const bit) const noexcept
+  {
+    for (int i = size() - 1; i >= 0; --i)
+    {
+      if (at(i) == bit) return i;
+    }
+    return -1;
+  }
+
+  // Return n bits starting at pos, or all of those from pos onward if
+  // n is negative or runs past the end, as QVector::mid() would.
+
+  constexpr BitBuffer
+  mid(int const pos,
+      int       n = -1) const noexcept
+  {
+    BitBuffer out;
+
+    if (pos < 0 || pos >= size()) return out;
+    if (n < 0 || pos + n > size()) n = size() - pos;
+
+    for (int i = 0; i < n; i += 64)
+    {
+      auto const take = std::min(64, n - i);
+      out.append(extract(pos + i, take), take);
+    }
+
+    return out;
+  }
+
+  // Manipulators
+
+  constexpr void
+  clear() noexcept
+  {
+    m_words = {};
+    m_size  = 0;
+  }
+
+  // Drop all bits past the first n.
+
+  constexpr void
+  truncate(int const n) noexcept
+  {
+    if (n < 0 || static_cast<std::size_t>(n) >= m_size) return;
+
+    m_size = n;
+
+    for (std::size_t w = (m_size + 63) / 64; w < Words; ++w) m_words[w] = 0;
+
+    if (auto const tail = m_size % 64) m_words[m_size / 64] &= ~0ULL << (64 - tail);
+  }
+
+  constexpr void
+  append(bool const bit) noexcept
+  {
+    if (m_size >= Capacity) return;
+
+    if (bit) m_words[m_size / 64] |= 1ULL << (63 - m_size % 64);
+    ++m_size;
+  }
+
+  // Append the low n bits of value, where n <= 64, most significant
+  // first; the equivalent of appending intToBits(value, n).
+
+  constexpr void
+  append(std::uint64_t const value,
+         int                 n) noexcept
+  {
+    n = std::min(n, 64);
+
+    if (n <= 0) return;
+
+    auto bits = n == 64 ? value : value & ((1ULL << n) - 1);
+
+    // Keep only the leading bits that fit, as if we'd appended them one
+    // at a time until full.
+
+    if (auto const space = static_cast<int>(Capacity - m_size); n > space)
+    {
+      if (space <= 0) return;
+
+      bits >>= n - space;
+      n      = space;
+    }
+
+    // Fill the remainder of the current word, then spill into the next.
+
+    auto const offset = static_cast<int>(m_size % 64);
+    auto const room   = 64 - offset;
+    auto const word   = m_size / 64;
+
+    if (n <= room)
+    {
+      m_words[word] |= bits << (room - n);
+    }
+    else
+    {
+      m_words[word]     |= bits >> (n - room);
+      m_words[word + 1] |= bits << (64 - (n - room));
+    }
+
+    m_size += n;
+  }
+
+  template <std::size_t Other>
+  constexpr void
+  append(BitBuffer<Other> const & other) noexcept
+  {
+    for (int i = 0; i < other.size(); i += 64)
+    {
+      auto const take = std::min(64, other.size() - i);
+      append(other.extract(i, take), take);
+    }
+  }
+
+  template <std::size_t Other>
+  constexpr BitBuffer &
+  operator+=(BitBuffer<Other> const & other) noexcept
+  {
+    append(other);
+    return *this;
+  }
+
+  // Comparison
+
+  friend constexpr bool
+  operator==(BitBuffer const & lhs,
+             BitBuffer const & rhs) noexcept
+  {
+    return lhs.m_size == rhs.m_size && lhs.m_words == rhs.m_words;
+  }
+
+  friend constexpr bool
+  operator!=(BitBuffer const & lhs,
+             BitBuffer const & rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+};
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef CACHE_LEDGER_HPP__
+#define CACHE_LEDGER_HPP__
+
+#include <QHash>
+#include <QString>
+#include <QVariantMap>
+#include <QtGlobal>
+
+#include <map>
+#include <utility>
+
+// Recency bookkeeping for a cache whose entries live in an associative
+// container held elsewhere, typically a QMap that a good deal of code
+// already reads and writes directly. Writers call touch() for the keys
+// they write; every so often, trim() removes from the container those
+// entries not written within the time to live, and then the least
+// recently written of those remaining, until it's within capacity.
+//
+// Entries that make their way into the container without being touched,
+// e.g. by way of a restore, or the default values inserted by operator[],
+// are noticed by trim() and treated as having just been written. Those
+// removed from the container by other means are forgotten.
+//
+// Times are in milliseconds, on any clock the caller likes, so long as
+// it's the same one throughout; a time to live of zero means forever.
+
+template <typename Key>
+class CacheLedger
+{
+  using Order = std::multimap<qint64, Key>;
+
+  QString                                m_name;
+  qsizetype                              m_capacity;
+  qint64                                 m_ttl;
+  Order                                  m_order;
+  QHash<Key, typename Order::iterator>   m_where;
+
+  quint64   m_insertions  = 0;
+  quint64   m_evictions   = 0;
+  quint64   m_expirations = 0;
+  qsizetype m_size        = 0;
+  qsizetype m_bytes       = 0;
+
+public:
+
+  CacheLedger(QString   name,
+              qsizetype capacity,
+              qint64    ttl = 0)
+  : m_name    {std::move(name)}
+  , m_capacity{capacity}
+  , m_ttl     {ttl}
+  {}
+
+  // Accessors
+
+  QString const & name()     const { return m_name;     }
+  qsizetype       capacity() const { return m_capacity; }
+  qint64          ttl()      const { return m_ttl;      }
+
+  // Record a write of the key at the time provided.
+
+  void
+  touch(Key const & key,
+        qint64      now)
+  {
+    if (auto const it = m_where.find(key); it != m_where.end())
+    {
+      m_order.erase(it.value());
+      it.value() = m_order.emplace(now, key);
+    }
+    else
+    {
+      m_where.insert(key, m_order.emplace(now, key));
+      ++m_insertions;
+    }
+  }
+
+  void
+  forget(Key const & key)
+  {
+    if (auto const it = m_where.find(key); it != m_where.end())
+    {
+      m_order.erase(it.value());
+      m_where.erase(it);
+    }
+  }
+
+  void
+  clear()
+  {
+    m_order.clear();
+    m_where.clear();
+  }
+
+  // Bring the container within bounds, as of the time provided. The
+  // size function gives the approximate number of bytes used by a key
+  // and its value, for accounting purposes.
+
+  template <typename Map,
+            typename Size>
+  void
+  trim(Map  & map,
+       qint64 now,
+       Size && size)
+  {
+    // Reconcile with the container; anything we don't know about was
+    // written without our knowledge, and anything we know about that's
+    // not there has been removed.
+
+    for (auto it = map.keyBegin(); it != map.keyEnd(); ++it)
+    {
+      if (!m_where.contains(*it)) touch(*it, now);
+    }
+
+    for (auto it = m_where.begin(); it != m_where.end();)
+    {
+      if (map.contains(it.key()))
+      {
+        ++it;
+      }
+      else
+      {
+        m_order.erase(it.value());
+        it = m_where.erase(it);
+      }
+    }
+
+    // Drop the stale first, then the oldest of the rest.
+
+    auto const drop = [this, &map]()
+    {
+      auto const oldest = m_order.begin();
+      map.remove(oldest->second);
+      m_where.remove(oldest->second);
+      m_order.erase(oldest);
+    };
+
+    while (m_ttl > 0 && !m_order.empty() && now - m_order.begin()->first > m_ttl)
+    {
+      drop();
+      ++m_expirations;
+    }
+
+    while (m_capacity >= 0 && static_cast<qsizetype>(m_order.size()) > m_capacity)
+    {
+      drop();
+      ++m_evictions;
+    }
+
+    m_size  = map.size();
+    m_bytes = 0;
+
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it)
+    {
+      m_bytes += size(it.key(), it.value());
+    }
+  }
+
+  // Counters, as of the last trim, in the form the API reports them.
+
+  QVariantMap
+  stats() const
+  {
+    return {
+      {"SIZE",        m_size},
+      {"CAPACITY",    m_capacity},
+      {"TTL",         m_ttl / 1000},
+      {"BYTES",       m_bytes},
+      {"INSERTIONS",  m_insertions},
+      {"EVICTIONS",   m_evictions},
+      {"EXPIRATIONS", m_expirations}
+    };
+  }
+};
+
+#endif
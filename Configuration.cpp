@@ -620,6 +620,8 @@ private:
   QColor next_color_NewCall_;
   double txDelay_;
   bool write_logs_;
+  int log_rotation_size_;
+  bool compress_logs_;
   bool reset_activity_;
   bool check_for_updates_;
   bool tx_qsy_allowed_;
@@ -756,6 +758,8 @@ QFont Configuration::tx_text_font () const {return m_->tx_text_font_;}
 QFont Configuration::compose_text_font () const {return m_->compose_text_font_;}
 double Configuration::txDelay() const {return m_->txDelay_;}
 bool Configuration::write_logs() const { return m_->write_logs_;}
+int Configuration::log_rotation_size() const { return m_->log_rotation_size_;}
+bool Configuration::compress_logs() const { return m_->compress_logs_;}
 bool Configuration::reset_activity() const { return m_->reset_activity_;}
 bool Configuration::check_for_updates() const { return m_->check_for_updates_; }
 bool Configuration::tx_qsy_allowed () const {return m_->tx_qsy_allowed_;}
@@ -1552,6 +1556,8 @@ void Configuration::impl::initialize_models ()
   ui_->PTT_method_button_group->button (rig_params_.ptt_type)->setChecked (true);
   ui_->save_path_display_label->setText (save_directory_.absolutePath ());
   ui_->write_logs_check_box->setChecked (write_logs_);
+  ui_->log_rotation_spin_box->setValue (log_rotation_size_);
+  ui_->compress_logs_check_box->setChecked (compress_logs_);
   ui_->reset_activity_check_box->setChecked (reset_activity_);
   ui_->checkForUpdates_checkBox->setChecked (check_for_updates_);
   ui_->tx_qsy_check_box->setChecked (tx_qsy_allowed_);
@@ -1894,6 +1900,8 @@ void Configuration::impl::read_settings ()
   spot_to_reporting_networks_ = settings_->value ("PSKReporter", true).toBool ();
   spot_to_aprs_ = settings_->value("SpotToAPRS", true).toBool();
   write_logs_ = settings_->value("WriteLogs", true).toBool();
+  log_rotation_size_ = settings_->value("LogRotationSize", 32).toInt();
+  compress_logs_ = settings_->value("CompressLogs", false).toBool();
   reset_activity_ = settings_->value("ResetActivity", false).toBool();
   check_for_updates_ = settings_->value("CheckForUpdates", true).toBool();
   psk_reporter_tcpip_ = settings_->value ("PSKReporterTCPIP", false).toBool ();
@@ -2124,6 +2132,8 @@ void Configuration::impl::write_settings ()
   settings_->setValue ("PSKReporter", spot_to_reporting_networks_);
   settings_->setValue ("SpotToAPRS", spot_to_aprs_);
   settings_->setValue ("WriteLogs", write_logs_);
+  settings_->setValue ("LogRotationSize", log_rotation_size_);
+  settings_->setValue ("CompressLogs", compress_logs_);
   settings_->setValue ("ResetActivity", reset_activity_);
   settings_->setValue ("CheckForUpdates", check_for_updates_);
   settings_->setValue ("PSKReporterTCPIP", psk_reporter_tcpip_);
@@ -2705,6 +2715,8 @@ void Configuration::impl::accept ()
   psk_reporter_tcpip_ = ui_->psk_reporter_tcpip_check_box->isChecked ();
   txDelay_ = ui_->sbTxDelay->value ();
   write_logs_ = ui_->write_logs_check_box->isChecked();
+  log_rotation_size_ = ui_->log_rotation_spin_box->value();
+  compress_logs_ = ui_->compress_logs_check_box->isChecked();
   reset_activity_ = ui_->reset_activity_check_box->isChecked();
   check_for_updates_ = ui_->checkForUpdates_checkBox->isChecked();
   tx_qsy_allowed_ = ui_->tx_qsy_check_box->isChecked ();
@@ -125,6 +125,8 @@ public:
   QFont compose_text_font () const;
   double txDelay() const;
   bool write_logs() const;
+  int log_rotation_size() const;
+  bool compress_logs() const;
   bool reset_activity() const;
   bool check_for_updates() const;
   bool tx_qsy_allowed () const;
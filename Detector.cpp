@@ -9,37 +9,14 @@
 #include "DriftingDateTime.h"
 
 /******************************************************************************/
-// FIR Filter Coefficients
+// Constants
 /******************************************************************************/
 
 namespace
 {
-  // Filter coefficients for an FIR lowpass filter designed using ScopeFIR.
-  //
-  //   fsample     = 48000 Hz
-  //   Ntaps       = 49
-  //   fc          = 4500  Hz
-  //   fstop       = 6000  Hz
-  //   Ripple      = 1     dB
-  //   Stop Atten  = 40    dB
-  //   fout        = 12000 Hz
-
-  constexpr std::array LOWPASS
-  {
-     0.000861074040f,  0.010051920210f,  0.010161983649f,  0.011363155076f,
-     0.008706594219f,  0.002613872664f, -0.005202883094f, -0.011720748164f,
-    -0.013752163325f, -0.009431602741f,  0.000539063909f,  0.012636767098f,
-     0.021494659597f,  0.021951235065f,  0.011564169382f, -0.007656470131f,
-    -0.028965787341f, -0.042637874109f, -0.039203309748f, -0.013153301537f,
-     0.034320769178f,  0.094717832646f,  0.154224604789f,  0.197758325022f,
-     0.213715139513f,  0.197758325022f,  0.154224604789f,  0.094717832646f,
-     0.034320769178f, -0.013153301537f, -0.039203309748f, -0.042637874109f,
-    -0.028965787341f, -0.007656470131f,  0.011564169382f,  0.021951235065f,
-     0.021494659597f,  0.012636767098f,  0.000539063909f, -0.009431602741f,
-    -0.013752163325f, -0.011720748164f, -0.005202883094f,  0.002613872664f,
-     0.008706594219f,  0.011363155076f,  0.010161983649f,  0.010051920210f,
-     0.000861074040f
-  };
+  // Rate we take input at until told otherwise.
+
+  constexpr int DEFAULT_RATE = 48000;
 }
 
 /******************************************************************************/
@@ -56,11 +33,25 @@ Detector::Detector(unsigned  frameRate,
   : AudioDevice (parent)
   , m_frameRate (frameRate)
   , m_period    (periodLengthInSeconds)
-  , m_filter    (LOWPASS)
+  , m_resampler (DEFAULT_RATE)
 {
   clear();
 }
 
+bool
+Detector::setFrameRate(int const rate)
+{
+  if (!Resampler::supports(rate)) return false;
+
+  QMutexLocker mutex(&m_lock);
+
+  if (rate != m_resampler.inputRate()) m_resampler = Resampler(rate);
+
+  m_bufferPos = 0;
+
+  return true;
+}
+
 void
 Detector::setBlockSize (unsigned n)
 {
@@ -152,44 +143,55 @@ Detector::writeData(char const * const data,
 
   Q_ASSERT (!(maxSize % static_cast<qint64>(bytesPerFrame())));
 
-  // These are in terms of input frames (not down sampled).
+  // These are in terms of input frames (not resampled).
 
-  size_t const framesAcceptable = (sizeof(dec_data.d2) / sizeof(dec_data.d2[0]) - dec_data.params.kin) * Filter::NDOWN;
-  size_t const framesAccepted   = qMin(static_cast<size_t>(maxSize /bytesPerFrame()), framesAcceptable);
+  size_t const framesDelivered  = maxSize / bytesPerFrame();
+  size_t const framesAcceptable = m_resampler.inputFrames(sizeof(dec_data.d2) / sizeof(dec_data.d2[0]) - dec_data.params.kin);
+  size_t const framesAccepted   = qMin(framesDelivered, framesAcceptable);
 
-  if (framesAccepted < static_cast<size_t>(maxSize / bytesPerFrame()))
+  if (m_health)
   {
-    qCDebug(detector_js8) << "dropped " << maxSize / bytesPerFrame () - framesAccepted
+    m_health->delivered(framesDelivered, m_resampler.inputRate(), m_period * 1000);
+  }
+
+  if (framesAccepted < framesDelivered)
+  {
+    qCDebug(detector_js8) << "dropped " << framesDelivered - framesAccepted
               << " frames of data on the floor!"
               << dec_data.params.kin
               << ns;
-  }
 
-  for (auto remaining = framesAccepted;
-                remaining;)
-  {
-    size_t const numFramesProcessed = qMin(m_samplesPerFFT * Filter::NDOWN - m_bufferPos, remaining);
+    if (m_health) m_health->discarded(framesDelivered - framesAccepted);
+  }
 
-    store (&data[(framesAccepted - remaining) * bytesPerFrame()],
-           numFramesProcessed,
-           &m_buffer[m_bufferPos]);
+  // Resampled output is collected a block at a time, and each full block
+  // is added to the sample buffer.
 
-    m_bufferPos += numFramesProcessed;
+  auto const output = [this](short const sample)
+  {
+    m_buffer[m_bufferPos++] = sample;
 
-    if (m_bufferPos == m_samplesPerFFT * Filter::NDOWN)
+    if (m_bufferPos == m_samplesPerFFT)
     {
       if (dec_data.params.kin >= 0 &&
           dec_data.params.kin < static_cast<int>(JS8_NTMAX * 12000 - m_samplesPerFFT))
       {
-        for (std::size_t i = 0; i < m_samplesPerFFT; ++i)
-        {
-          dec_data.d2[dec_data.params.kin++] = m_filter.downSample(&m_buffer[i * Filter::NDOWN]);
-        }
+        std::copy_n(m_buffer.begin(), m_samplesPerFFT, &dec_data.d2[dec_data.params.kin]);
+        dec_data.params.kin += m_samplesPerFFT;
       }
       Q_EMIT framesWritten (dec_data.params.kin);
       m_bufferPos = 0;
     }
-    remaining -= numFramesProcessed;
+  };
+
+  for (size_t done = 0; done < framesAccepted;)
+  {
+    size_t const frames = qMin(Resampler::CHUNK, framesAccepted - done);
+
+    store (&data[done * bytesPerFrame()], frames, m_chunk.data());
+    m_resampler.process(m_chunk.data(), frames, output);
+
+    done += frames;
   }
 
   // We drop any data past the end of the buffer on the floor
@@ -913,65 +913,114 @@ void HamlibTransceiver::do_mode (MODE mode)
 
 void HamlibTransceiver::poll ()
 {
-  if(hamlibtransceiver_js8().isDebugEnabled())
-    rig_set_debug (RIG_DEBUG_WARN);
-  else
-    rig_set_debug (RIG_DEBUG_ERR);
+  for (unsigned step = 0; poll_step (step); ++step)
+    {
+    }
+}
+
+// Each step of a poll is at most a single query of the rig, in an order
+// such that later steps can rely on what earlier ones found: current
+// VFO, split, current VFO frequency, other VFO frequency, mode and
+// PTT. Steps that don't apply to this rig, or to its current state,
+// pass without a query.
+//
+// There's nothing to be had from coalescing these queries. No poll asks
+// for anything twice, and rig_get_vfo_info(), which looks like it would
+// combine them, asks for frequency, mode and split in turn on our
+// behalf, so it would only make for a longer step for a command to wait
+// behind. Nor do we let Hamlib's cache answer for the rig; the polls
+// after a command are there to see whether the rig has got there, and
+// the cache would tell us only what we asked for.
+bool HamlibTransceiver::poll_step (unsigned step)
+{
+  // polls are noisy, so quieten Hamlib's diagnostics while polling,
+  // restoring them for whatever comes between steps
+  struct quiet
+  {
+    quiet ()
+    {
+      if(hamlibtransceiver_js8().isDebugEnabled())
+        rig_set_debug (RIG_DEBUG_WARN);
+      else
+        rig_set_debug (RIG_DEBUG_ERR);
+    }
+
+    ~quiet ()
+    {
+      if (hamlibtransceiver_js8().isDebugEnabled())
+        rig_set_debug (RIG_DEBUG_TRACE);
+      else if (hamlibtransceiver_js8().isInfoEnabled())
+        rig_set_debug (RIG_DEBUG_VERBOSE);
+      else if (hamlibtransceiver_js8().isWarningEnabled())
+        rig_set_debug (RIG_DEBUG_WARN);
+      else
+        rig_set_debug (RIG_DEBUG_ERR);
+    }
+  } q;
 
   freq_t f;
   rmode_t m;
   pbwidth_t w;
   split_t s;
 
-  if (get_vfo_works_ && rig_->caps->get_vfo)
-    {
-      vfo_t v;
-      error_check (rig_get_vfo (rig_.data (), &v), tr ("getting current VFO")); // has side effect of establishing current VFO inside hamlib
-      TRACE_CAT_POLL ("HamlibTransceiver", "VFO =" << rig_strvfo (v));
-      reversed_ = RIG_VFO_B == v;
-    }
-
-  if ((WSJT_RIG_NONE_CAN_SPLIT || !is_dummy_)
-      && rig_->caps->get_split_vfo && split_query_works_)
+  switch (step)
     {
-      vfo_t v {RIG_VFO_NONE};		// so we can tell if it doesn't get updated :(
-      auto rc = rig_get_split_vfo (rig_.data (), RIG_VFO_CURR, &s, &v);
-      if (-RIG_OK == rc && RIG_SPLIT_ON == s)
-        {
-          TRACE_CAT_POLL ("HamlibTransceiver", "rig_get_split_vfo split = " << s << " VFO = " << rig_strvfo (v));
-          update_split (true);
-          // if (RIG_VFO_A == v)
-          // 	{
-          // 	  reversed_ = true;	// not sure if this helps us here
-          // 	}
-        }
-      else if (-RIG_OK == rc)	// not split
+    case 0:
+      if (get_vfo_works_ && rig_->caps->get_vfo)
         {
-          TRACE_CAT_POLL ("HamlibTransceiver", "rig_get_split_vfo split = " << s << " VFO = " << rig_strvfo (v));
-          update_split (false);
+          vfo_t v;
+          error_check (rig_get_vfo (rig_.data (), &v), tr ("getting current VFO")); // has side effect of establishing current VFO inside hamlib
+          TRACE_CAT_POLL ("HamlibTransceiver", "VFO =" << rig_strvfo (v));
+          reversed_ = RIG_VFO_B == v;
         }
-      else
+      return true;
+
+    case 1:
+      if ((WSJT_RIG_NONE_CAN_SPLIT || !is_dummy_)
+          && rig_->caps->get_split_vfo && split_query_works_)
         {
-          // Some rigs (Icom) don't have a way of reporting SPLIT
-          // mode
-          TRACE_CAT_POLL ("HamlibTransceiver", "rig_get_split_vfo can't do on this rig");
-          // just report how we see it based on prior commands
-          split_query_works_ = false;
+          vfo_t v {RIG_VFO_NONE};		// so we can tell if it doesn't get updated :(
+          auto rc = rig_get_split_vfo (rig_.data (), RIG_VFO_CURR, &s, &v);
+          if (-RIG_OK == rc && RIG_SPLIT_ON == s)
+            {
+              TRACE_CAT_POLL ("HamlibTransceiver", "rig_get_split_vfo split = " << s << " VFO = " << rig_strvfo (v));
+              update_split (true);
+              // if (RIG_VFO_A == v)
+              // 	{
+              // 	  reversed_ = true;	// not sure if this helps us here
+              // 	}
+            }
+          else if (-RIG_OK == rc)	// not split
+            {
+              TRACE_CAT_POLL ("HamlibTransceiver", "rig_get_split_vfo split = " << s << " VFO = " << rig_strvfo (v));
+              update_split (false);
+            }
+          else
+            {
+              // Some rigs (Icom) don't have a way of reporting SPLIT
+              // mode
+              TRACE_CAT_POLL ("HamlibTransceiver", "rig_get_split_vfo can't do on this rig");
+              // just report how we see it based on prior commands
+              split_query_works_ = false;
+            }
         }
-    }
+      return true;
 
-  if (freq_query_works_)
-    {
+    case 2:
       // only read if possible and when receiving or simplex
-      if (!state ().ptt () || !state ().split ())
+      if (freq_query_works_
+          && (!state ().ptt () || !state ().split ()))
         {
           error_check (rig_get_freq (rig_.data (), RIG_VFO_CURR, &f), tr ("getting current VFO frequency"));
           f = std::round (f);
           TRACE_CAT_POLL ("HamlibTransceiver", "rig_get_freq frequency =" << f);
           update_rx_frequency (f);
         }
+      return true;
 
-      if ((WSJT_RIG_NONE_CAN_SPLIT || !is_dummy_)
+    case 3:
+      if (freq_query_works_
+          && (WSJT_RIG_NONE_CAN_SPLIT || !is_dummy_)
           && state ().split ()
           && (rig_->caps->targetable_vfo & (RIG_TARGETABLE_FREQ | RIG_TARGETABLE_PURE))
           && !one_VFO_)
@@ -991,52 +1040,48 @@ void HamlibTransceiver::poll ()
           TRACE_CAT_POLL ("HamlibTransceiver", "rig_get_freq other VFO =" << f);
           update_other_frequency (f);
         }
-    }
+      return true;
 
-  // only read when receiving or simplex if direct VFO addressing unavailable
-  if ((!state ().ptt () || !state ().split ())
-      && mode_query_works_)
-    {
-      // We have to ignore errors here because Yaesu FTdx... rigs can
-      // report the wrong mode when transmitting split with different
-      // modes per VFO. This is unfortunate because that is exactly
-      // what you need to do to get 4kHz Rx b.w and modulation into
-      // the rig through the data socket or USB. I.e.  USB for Rx and
-      // DATA-USB for Tx.
-      auto rc = rig_get_mode (rig_.data (), RIG_VFO_CURR, &m, &w);
-      if (RIG_OK == rc)
-        {
-          TRACE_CAT_POLL ("HamlibTransceiver", "rig_get_mode mode =" << rig_strrmode (m) << "bw =" << w);
-          update_mode (map_mode (m));
-        }
-      else
+    case 4:
+      // only read when receiving or simplex if direct VFO addressing unavailable
+      if ((!state ().ptt () || !state ().split ())
+          && mode_query_works_)
         {
-          TRACE_CAT_POLL ("HamlibTransceiver", "rig_get_mode mode failed with rc:" << rc << "ignoring");
+          // We have to ignore errors here because Yaesu FTdx... rigs can
+          // report the wrong mode when transmitting split with different
+          // modes per VFO. This is unfortunate because that is exactly
+          // what you need to do to get 4kHz Rx b.w and modulation into
+          // the rig through the data socket or USB. I.e.  USB for Rx and
+          // DATA-USB for Tx.
+          auto rc = rig_get_mode (rig_.data (), RIG_VFO_CURR, &m, &w);
+          if (RIG_OK == rc)
+            {
+              TRACE_CAT_POLL ("HamlibTransceiver", "rig_get_mode mode =" << rig_strrmode (m) << "bw =" << w);
+              update_mode (map_mode (m));
+            }
+          else
+            {
+              TRACE_CAT_POLL ("HamlibTransceiver", "rig_get_mode mode failed with rc:" << rc << "ignoring");
+            }
         }
-    }
+      return true;
 
-  if (RIG_PTT_NONE != rig_->state.pttport.type.ptt && rig_->caps->get_ptt)
-    {
-      ptt_t p;
-      auto rc = rig_get_ptt (rig_.data (), RIG_VFO_CURR, &p);
-      if (-RIG_ENAVAIL != rc && -RIG_ENIMPL != rc) // may fail if
-        // Net rig ctl and target doesn't
-        // support command
+    default:
+      if (RIG_PTT_NONE != rig_->state.pttport.type.ptt && rig_->caps->get_ptt)
         {
-          error_check (rc, tr ("getting PTT state"));
-          TRACE_CAT_POLL ("HamlibTransceiver", "rig_get_ptt PTT =" << p);
-          update_PTT (!(RIG_PTT_OFF == p));
+          ptt_t p;
+          auto rc = rig_get_ptt (rig_.data (), RIG_VFO_CURR, &p);
+          if (-RIG_ENAVAIL != rc && -RIG_ENIMPL != rc) // may fail if
+            // Net rig ctl and target doesn't
+            // support command
+            {
+              error_check (rc, tr ("getting PTT state"));
+              TRACE_CAT_POLL ("HamlibTransceiver", "rig_get_ptt PTT =" << p);
+              update_PTT (!(RIG_PTT_OFF == p));
+            }
         }
+      return false;
     }
-
-  if (hamlibtransceiver_js8().isDebugEnabled())
-    rig_set_debug (RIG_DEBUG_TRACE);
-  else if (hamlibtransceiver_js8().isInfoEnabled())
-    rig_set_debug (RIG_DEBUG_VERBOSE);
-  else if (hamlibtransceiver_js8().isWarningEnabled())
-    rig_set_debug (RIG_DEBUG_WARN);
-  else
-    rig_set_debug (RIG_DEBUG_ERR);
 }
 
 void HamlibTransceiver::do_ptt (bool on)
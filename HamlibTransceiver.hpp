@@ -49,6 +49,7 @@ class HamlibTransceiver final
   void do_ptt (bool) override;
 
   void poll () override;
+  bool poll_step (unsigned) override;
 
   void error_check (int ret_code, QString const& doing) const;
   void set_conf (char const * item, char const * value);
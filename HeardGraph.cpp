@@ -0,0 +1,309 @@
+#include "HeardGraph.hpp"
+
+#include <algorithm>
+
+#include <QSet>
+
+/******************************************************************************/
+// Construction
+/******************************************************************************/
+
+HeardGraph::HeardGraph(qsizetype const capacity,
+                       qint64    const ttl)
+: m_capacity{capacity}
+, m_ttl     {ttl}
+{}
+
+/******************************************************************************/
+// Private Implementation
+/******************************************************************************/
+
+HeardGraph::Id
+HeardGraph::intern(QString const & call)
+{
+  if (auto const it = m_ids.constFind(call); it != m_ids.cend()) return it.value();
+
+  Id id;
+
+  if (m_free.empty())
+  {
+    id = static_cast<Id>(m_nodes.size());
+    m_nodes.emplace_back();
+  }
+  else
+  {
+    id = m_free.back();
+    m_free.pop_back();
+  }
+
+  m_nodes[id].call = call;
+  m_ids.insert(call, id);
+
+  return id;
+}
+
+bool
+HeardGraph::find(QString const & call,
+                 Id            & id) const
+{
+  auto const it = m_ids.constFind(call);
+  if (it == m_ids.cend()) return false;
+
+  id = it.value();
+  return true;
+}
+
+bool
+HeardGraph::band(QString const & name,
+                 quint16       & id) const
+{
+  auto const it = m_bands.constFind(name);
+  if (it == m_bands.cend()) return false;
+
+  id = it.value();
+  return true;
+}
+
+// Note that the edge has been seen, adding it if it's new; an edge and
+// its reverse are always updated together, so they'll always agree as
+// to when they were last seen.
+
+void
+HeardGraph::link(QVector<Edge> & edges,
+                 Id      const   peer,
+                 quint16 const   band,
+                 qint64  const   now)
+{
+  auto const it = std::find_if(edges.begin(), edges.end(), [=](Edge const & edge)
+  {
+    return edge.peer == peer && edge.band == band;
+  });
+
+  if (it != edges.end()) it->seen = now;
+  else                   edges.append({peer, band, now});
+}
+
+// Remove the edges that the function provided, given the band and time
+// last seen, says to, returning the number removed, and release those
+// stations left without any edges.
+
+template <typename Drop>
+qsizetype
+HeardGraph::prune(Drop && drop)
+{
+  auto const match = [&drop](Edge const & edge)
+  {
+    return drop(edge.band, edge.seen);
+  };
+
+  qsizetype dropped = 0;
+
+  for (Id id = 0; id < m_nodes.size(); ++id)
+  {
+    auto & node = m_nodes[id];
+
+    if (node.call.isEmpty()) continue;
+
+    dropped += node.out.removeIf(match);
+    node.in.removeIf(match);
+
+    if (node.out.isEmpty() && node.in.isEmpty())
+    {
+      m_ids.remove(node.call);
+      node = Node{};
+      m_free.push_back(id);
+    }
+  }
+
+  m_edges -= dropped;
+
+  return dropped;
+}
+
+QStringList
+HeardGraph::collect(QVector<Edge> const & edges,
+                    quint16       const   band) const
+{
+  QStringList calls;
+
+  for (auto const & edge : edges)
+  {
+    if (edge.band == band) calls.append(m_nodes[edge.peer].call);
+  }
+
+  calls.sort();
+  return calls;
+}
+
+/******************************************************************************/
+// Manipulators
+/******************************************************************************/
+
+void
+HeardGraph::add(QString const & hearer,
+                QString const & heard,
+                QString const & name,
+                qint64  const   now)
+{
+  if (hearer.isEmpty() || heard.isEmpty()) return;
+
+  quint16 b;
+
+  if (!band(name, b))
+  {
+    b = static_cast<quint16>(m_bands.size());
+    m_bands.insert(name, b);
+  }
+
+  // Intern both before taking any references; interning can grow the
+  // node array.
+
+  auto const from = intern(hearer);
+  auto const to   = intern(heard);
+  auto const size = m_nodes[from].out.size();
+
+  link(m_nodes[from].out, to,   b, now);
+  link(m_nodes[to].in,    from, b, now);
+
+  if (m_nodes[from].out.size() != size)
+  {
+    ++m_edges;
+    ++m_insertions;
+  }
+}
+
+void
+HeardGraph::clear(QString const & name)
+{
+  if (quint16 b; band(name, b))
+  {
+    prune([b](quint16 const band, qint64){ return band == b; });
+  }
+}
+
+void
+HeardGraph::clear()
+{
+  m_nodes.clear();
+  m_free.clear();
+  m_ids.clear();
+  m_edges = 0;
+}
+
+// Drop edges that have gone stale, and then, if we're still over
+// capacity, the oldest of the rest; ties with the last of the oldest
+// are dropped too, so we may end up a little under capacity.
+
+void
+HeardGraph::expire(qint64 const now)
+{
+  if (m_ttl > 0)
+  {
+    m_expirations += prune([cutoff = now - m_ttl](quint16, qint64 const seen)
+    {
+      return seen < cutoff;
+    });
+  }
+
+  if (m_capacity >= 0 && m_edges > m_capacity)
+  {
+    std::vector<qint64> seen;
+    seen.reserve(m_edges);
+
+    for (auto const & node : m_nodes)
+    {
+      for (auto const & edge : node.out) seen.push_back(edge.seen);
+    }
+
+    auto const nth = seen.begin() + (m_edges - m_capacity - 1);
+    std::nth_element(seen.begin(), nth, seen.end());
+
+    m_evictions += prune([cutoff = *nth](quint16, qint64 const seen)
+    {
+      return seen <= cutoff;
+    });
+  }
+}
+
+/******************************************************************************/
+// Queries
+/******************************************************************************/
+
+QStringList
+HeardGraph::hearing(QString const & call,
+                    QString const & name) const
+{
+  Id      id;
+  quint16 b;
+
+  if (!find(call, id) || !band(name, b)) return {};
+
+  return collect(m_nodes[id].out, b);
+}
+
+QStringList
+HeardGraph::heardBy(QString const & call,
+                    QString const & name) const
+{
+  Id      id;
+  quint16 b;
+
+  if (!find(call, id) || !band(name, b)) return {};
+
+  return collect(m_nodes[id].in, b);
+}
+
+QStringList
+HeardGraph::relays(QString const & from,
+                   QString const & to,
+                   QString const & name) const
+{
+  Id      src;
+  Id      dst;
+  quint16 b;
+
+  if (!find(from, src) || !find(to, dst) || !band(name, b)) return {};
+
+  QSet<Id> heardFrom;
+
+  for (auto const & edge : m_nodes[src].in)
+  {
+    if (edge.band == b) heardFrom.insert(edge.peer);
+  }
+
+  QStringList calls;
+
+  for (auto const & edge : m_nodes[dst].out)
+  {
+    if (edge.band == b && edge.peer != src && heardFrom.contains(edge.peer))
+    {
+      calls.append(m_nodes[edge.peer].call);
+    }
+  }
+
+  calls.sort();
+  return calls;
+}
+
+QVariantMap
+HeardGraph::stats() const
+{
+  qsizetype bytes = m_nodes.capacity() * sizeof(Node);
+
+  for (auto const & node : m_nodes)
+  {
+    bytes += node.call.capacity() * sizeof(QChar)
+          + (node.out.capacity() + node.in.capacity()) * sizeof(Edge);
+  }
+
+  return {
+    {"SIZE",        m_edges},
+    {"NODES",       m_ids.size()},
+    {"CAPACITY",    m_capacity},
+    {"TTL",         m_ttl / 1000},
+    {"BYTES",       bytes},
+    {"INSERTIONS",  m_insertions},
+    {"EVICTIONS",   m_evictions},
+    {"EXPIRATIONS", m_expirations}
+  };
+}
@@ -0,0 +1,108 @@
+#ifndef HEARD_GRAPH_HPP__
+#define HEARD_GRAPH_HPP__
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+#include <QtGlobal>
+
+#include <vector>
+
+// Record of which stations have heard which, on which band, and when.
+// An edge from A to B means that A has heard B.
+//
+// Callsigns are interned to integer IDs, and each station keeps compact
+// arrays of its edges in both directions, so queries are a walk over a
+// station's neighbours rather than over the whole graph. Edges carry the
+// band they were heard on, so that each band has its own view of the
+// graph without keeping a copy per band, and the time they were last
+// seen, so that they can be expired.
+//
+// The footprint is bounded: edges not seen within the time to live are
+// dropped by expire(), as are the oldest edges beyond capacity, and the
+// IDs of stations left with no edges are reused.
+//
+// Times are in milliseconds, on any clock the caller likes, so long as
+// it's the same one throughout; a time to live of zero means forever.
+
+class HeardGraph
+{
+public:
+
+  HeardGraph(qsizetype capacity,
+             qint64    ttl = 0);
+
+  // Manipulators
+
+  void add(QString const & hearer,
+           QString const & heard,
+           QString const & band,
+           qint64          now);
+
+  void clear(QString const & band);
+  void clear();
+  void expire(qint64 now);
+
+  // Queries, on the band provided; results are sorted.
+
+  QStringList hearing(QString const & call,
+                      QString const & band) const;
+
+  QStringList heardBy(QString const & call,
+                      QString const & band) const;
+
+  // Stations that could relay from one station to another: those that
+  // have heard the first, and that have been heard by the second.
+
+  QStringList relays(QString const & from,
+                     QString const & to,
+                     QString const & band) const;
+
+  // Counters, in the form the API reports them.
+
+  QVariantMap stats() const;
+
+private:
+
+  using Id = quint32;
+
+  struct Edge
+  {
+    Id      peer;
+    quint16 band;
+    qint64  seen;
+  };
+
+  struct Node
+  {
+    QString       call;
+    QVector<Edge> out; // stations this one has heard
+    QVector<Edge> in;  // stations that have heard this one
+  };
+
+  Id   intern(QString const & call);
+  bool find  (QString const & call, Id & id) const;
+  bool band  (QString const & name, quint16 & id) const;
+
+  void link  (QVector<Edge> & edges, Id peer, quint16 band, qint64 now);
+
+  template <typename Drop>
+  qsizetype prune(Drop && drop);
+
+  QStringList collect(QVector<Edge> const & edges, quint16 band) const;
+
+  qsizetype               m_capacity;
+  qint64                  m_ttl;
+  std::vector<Node>       m_nodes;
+  std::vector<Id>         m_free;
+  QHash<QString, Id>      m_ids;
+  QHash<QString, quint16> m_bands;
+  qsizetype               m_edges       = 0;
+  quint64                 m_insertions  = 0;
+  quint64                 m_evictions   = 0;
+  quint64                 m_expirations = 0;
+};
+
+#endif
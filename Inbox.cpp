@@ -26,16 +26,12 @@ Q_DECLARE_LOGGING_CATEGORY(inbox_js8)
 
 namespace
 {
-    constexpr char SCHEMA[] = "CREATE TABLE IF NOT EXISTS inbox_v1 ("
+    constexpr char SCHEMA[] = "PRAGMA journal_mode = WAL;"
+                              "PRAGMA synchronous = NORMAL;"
+                              "CREATE TABLE IF NOT EXISTS inbox_v1 ("
                               "  id INTEGER PRIMARY KEY AUTOINCREMENT, "
                               "  blob TEXT"
                               ");"
-                              "CREATE INDEX IF NOT EXISTS idx_inbox_v1__type ON"
-                              "  inbox_v1(json_extract(blob, '$.type'));"
-                              "CREATE INDEX IF NOT EXISTS idx_inbox_v1__params_from ON"
-                              "  inbox_v1(json_extract(blob, '$.params.FROM'));"
-                              "CREATE INDEX IF NOT EXISTS idx_inbox_v1__params_to ON"
-                              "  inbox_v1(json_extract(blob, '$.params.TO'));"
 							  "CREATE TABLE IF NOT EXISTS inbox_group_recip_v1 ("
 							  "  id INTEGER PRIMARY KEY AUTOINCREMENT, "
 							  "  msg_id INTEGER, "
@@ -45,6 +41,120 @@ namespace
 							  "CREATE INDEX IF NOT EXISTS idx_inbox_group_recip_v1__callsign ON"
 							  "  inbox_group_recip_v1(callsign);";
 
+    // Schema migrations, applied in order to bring a database from the
+    // user_version at which we find it up to the current version. Each
+    // runs inside a transaction along with its user_version update.
+    //
+    //   1: Replace the json_extract() expression indexes with real type,
+    //      FROM, TO, and UTC columns, set from the blob on insert and
+    //      update, and by BACKFILL below for rows we already have. FROM
+    //      and TO are NOCASE so that LIKE can use the indexes.
+
+    constexpr char const * MIGRATIONS[] = {
+        "ALTER TABLE inbox_v1 ADD COLUMN type TEXT;"
+        "ALTER TABLE inbox_v1 ADD COLUMN params_from TEXT COLLATE NOCASE;"
+        "ALTER TABLE inbox_v1 ADD COLUMN params_to TEXT COLLATE NOCASE;"
+        "ALTER TABLE inbox_v1 ADD COLUMN params_utc TEXT;"
+        "DROP INDEX IF EXISTS idx_inbox_v1__type;"
+        "DROP INDEX IF EXISTS idx_inbox_v1__params_from;"
+        "DROP INDEX IF EXISTS idx_inbox_v1__params_to;"
+        "CREATE INDEX idx_inbox_v1__type_from ON inbox_v1(type, params_from);"
+        "CREATE INDEX idx_inbox_v1__type_to ON inbox_v1(type, params_to);"
+    };
+
+    constexpr int SCHEMA_VERSION = sizeof(MIGRATIONS) / sizeof(MIGRATIONS[0]);
+
+    // Bring the typed columns into line with the blob wherever they're
+    // not. Versions before the columns existed write only the blob, so
+    // if one of them has had the database since we last did, e.g., on a
+    // downgrade and upgrade again, rows it inserted have them NULL, and
+    // rows it updated, say from UNREAD to READ, have them stale; either
+    // way, queries on the columns would miss them. The user_version is
+    // no help, since those versions leave it alone, so we run this on
+    // every open, after any migrations.
+
+    constexpr char BACKFILL[] = "UPDATE inbox_v1 SET"
+                                "  type        = json_extract(blob, '$.type'),"
+                                "  params_from = json_extract(blob, '$.params.FROM'),"
+                                "  params_to   = json_extract(blob, '$.params.TO'),"
+                                "  params_utc  = json_extract(blob, '$.params.UTC')"
+                                "  WHERE json_valid(blob) AND ("
+                                "    type        IS NOT json_extract(blob, '$.type')        OR"
+                                "    params_from IS NOT json_extract(blob, '$.params.FROM') OR"
+                                "    params_to   IS NOT json_extract(blob, '$.params.TO')   OR"
+                                "    params_utc  IS NOT json_extract(blob, '$.params.UTC'));";
+
+    // Statements are cached for the life of the connection, so rather
+    // than finalizing them when we're done, we reset them and drop any
+    // bindings, leaving them ready for the next caller.
+
+    struct StatementReset
+    {
+        sqlite3_stmt * const stmt;
+
+        ~StatementReset()
+        {
+            if (stmt)
+            {
+                sqlite3_reset(stmt);
+                sqlite3_clear_bindings(stmt);
+            }
+        }
+    };
+
+    // Map a JSON path used as a query onto the column that holds its
+    // value, or, if it's not one we've got a column for, onto a
+    // json_extract() of the path, which will be bound as parameter 2.
+
+    QByteArray
+    column_for(QString const & query)
+    {
+        if (query == "$.type")        return "type";
+        if (query == "$.params.FROM") return "params_from";
+        if (query == "$.params.TO")   return "params_to";
+        if (query == "$.params.UTC")  return "params_utc";
+
+        return "json_extract(blob, ?2)";
+    }
+
+    // Bind the specified parameter of the message, if present, as text,
+    // or as null if the message doesn't have it.
+
+    void
+    bind_param(sqlite3_stmt      * const stmt,
+               int                 const index,
+               QVariantMap const &       params,
+               QString     const &       key)
+    {
+        if (auto const it  = params.constFind(key);
+                       it != params.constEnd())
+        {
+            sqlite3_bind_text(stmt, index, it->toString().toUtf8().constData(), -1, SQLITE_TRANSIENT);
+        }
+        else
+        {
+            sqlite3_bind_null(stmt, index);
+        }
+    }
+
+    // Bind the blob and the typed columns for a message, starting with
+    // the specified parameter index, in the order blob, type, FROM, TO,
+    // UTC.
+
+    void
+    bind_message(sqlite3_stmt  * const stmt,
+                 int             const index,
+                 Message const &       value)
+    {
+        auto const params = value.params();
+
+        sqlite3_bind_text(stmt, index,     value.toJson().constData(),      -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, index + 1, value.type().toUtf8().constData(), -1, SQLITE_TRANSIENT);
+        bind_param(stmt, index + 2, params, "FROM");
+        bind_param(stmt, index + 3, params, "TO");
+        bind_param(stmt, index + 4, params, "UTC");
+    }
+
     // Attempt to retrieve a Message object previously serialized as a
     // JSON object to the specified column; will throw on failure to
     // deserialize the object.
@@ -56,6 +166,32 @@ namespace
         return Message::fromJson(QByteArray((const char *)sqlite3_column_text (stmt, iCol),
                                                           sqlite3_column_bytes(stmt, iCol)));
     }
+
+    // Return the first row of a lookahead query that has non-empty text,
+    // or -1 if there isn't one.
+
+    int
+    first_with_text(sqlite3_stmt * const stmt)
+    {
+        while (sqlite3_step(stmt) == SQLITE_ROW)
+        {
+            auto const text = get_column_message(stmt, 1).params().value("TEXT").toString().trimmed();
+
+            if (!text.isEmpty()) return sqlite3_column_int(stmt, 0);
+        }
+
+        return -1;
+    }
+
+    // Floor for group message retrieval, 48 hours back from now.
+    // TODO: date formatting with the "yyyy-MM-dd HH:mm:ss" string happens elsewhere as well, centralize
+    // TODO: possibly make the date floor configurable
+
+    QByteArray
+    group_date_floor()
+    {
+        return DriftingDateTime::currentDateTimeUtc().addDays(-2).toString("yyyy-MM-dd HH:mm:ss").toLocal8Bit();
+    }
 }
 
 Inbox::Inbox(QString path) :
@@ -78,14 +214,32 @@ bool Inbox::isOpen(){
 }
 
 bool Inbox::open(){
+    if(isOpen()){
+        return true;
+    }
+
+    // Anything that goes wrong from here on closes the connection, and
+    // with it the message that would say why, so we keep a copy of that
+    // for error() to report.
+
+    error_.clear();
+
     int rc = sqlite3_open(path_.toLocal8Bit().data(), &db_);
     if(rc != SQLITE_OK){
+        error_ = db_ ? error() : QString::fromLocal8Bit(sqlite3_errstr(rc));
         close();
         return false;
     }
 
+    sqlite3_busy_timeout(db_, 5000);
+
     rc = sqlite3_exec(db_, SCHEMA, nullptr, nullptr, nullptr);
     if(rc != SQLITE_OK){
+        error_ = error();
+    }
+    if(rc != SQLITE_OK || !migrate()){
+        qCWarning(inbox_js8) << "unable to prepare inbox" << path_ << error_;
+        close();
         return false;
     }
 
@@ -93,6 +247,11 @@ bool Inbox::open(){
 }
 
 void Inbox::close(){
+    for(auto stmt : std::as_const(stmts_)){
+        sqlite3_finalize(stmt);
+    }
+    stmts_.clear();
+
     if(db_){
         sqlite3_close(db_);
         db_ = nullptr;
@@ -103,43 +262,94 @@ QString Inbox::error(){
     if(db_){
         return QString::fromLocal8Bit(sqlite3_errmsg(db_));
     }
-    return "";
+    return error_;
 }
 
-int Inbox::count(QString type, QString query, QString match){
-    if(!isOpen()){
-        return -1;
+bool Inbox::migrate(){
+    sqlite3_stmt *stmt;
+    if(sqlite3_prepare_v2(db_, "PRAGMA user_version;", -1, &stmt, nullptr) != SQLITE_OK){
+        error_ = error();
+        return false;
+    }
+
+    int version = 0;
+    if(sqlite3_step(stmt) == SQLITE_ROW){
+        version = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    for(; version < SCHEMA_VERSION; ++version){
+        qCDebug(inbox_js8) << "migrating inbox to version" << version + 1;
+
+        auto const sql = QByteArray("BEGIN;")
+                       + MIGRATIONS[version]
+                       + "PRAGMA user_version = " + QByteArray::number(version + 1) + ";"
+                       + "COMMIT;";
+
+        if(sqlite3_exec(db_, sql.constData(), nullptr, nullptr, nullptr) != SQLITE_OK){
+            error_ = error();
+            qCWarning(inbox_js8) << "inbox migration to version" << version + 1 << "failed:" << error_;
+            sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return false;
+        }
+    }
+
+    if(sqlite3_exec(db_, BACKFILL, nullptr, nullptr, nullptr) != SQLITE_OK){
+        error_ = error();
+        qCWarning(inbox_js8) << "inbox backfill failed:" << error_;
+        return false;
+    }
+
+    if(auto const changed = sqlite3_changes(db_)){
+        qCDebug(inbox_js8) << "backfilled typed columns of" << changed << "inbox rows";
     }
 
-    const char* sql = "SELECT COUNT(*) FROM inbox_v1 "
-                      "WHERE json_extract(blob, '$.type') = ? "
-                      "AND json_extract(blob, ?) LIKE ?;";
+    return true;
+}
+
+sqlite3_stmt * Inbox::prepare(QByteArray const & sql){
+    if(auto const it = stmts_.constFind(sql); it != stmts_.constEnd()){
+        return *it;
+    }
 
     sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
+    int rc = sqlite3_prepare_v3(db_, sql.constData(), sql.size(), SQLITE_PREPARE_PERSISTENT, &stmt, nullptr);
     if(rc != SQLITE_OK){
+        return nullptr;
+    }
+
+    stmts_.insert(sql, stmt);
+    return stmt;
+}
+
+int Inbox::count(QString type, QString query, QString match){
+    if(!isOpen()){
         return -1;
     }
 
-    auto t8 = type.toLocal8Bit();
-    auto q8 = query.toLocal8Bit();
-    auto m8 = match.toLocal8Bit();
-    rc = sqlite3_bind_text(stmt, 1, t8.data(),  -1, nullptr);
-    rc = sqlite3_bind_text(stmt, 2, q8.data(), -1, nullptr);
-    rc = sqlite3_bind_text(stmt, 3, m8.data(), -1, nullptr);
+    auto const sql = "SELECT COUNT(*) FROM inbox_v1 "
+                     "WHERE type = ?1 "
+                     "AND " + column_for(query) + " LIKE ?3;";
 
-    int count = 0;
-    rc = sqlite3_step(stmt);
-    if(rc == SQLITE_ROW) {
-        count = sqlite3_column_int(stmt, 0);
+    auto stmt = prepare(sql);
+    if(!stmt){
+        return -1;
     }
 
-    rc = sqlite3_finalize(stmt);
-    if(rc != SQLITE_OK){
+    StatementReset reset{ stmt };
+
+    auto t8 = type.toUtf8();
+    auto q8 = query.toUtf8();
+    auto m8 = match.toUtf8();
+    sqlite3_bind_text(stmt, 1, t8.data(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, q8.data(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, m8.data(), -1, SQLITE_STATIC);
+
+    if(sqlite3_step(stmt) != SQLITE_ROW){
         return -1;
     }
 
-    return count;
+    return sqlite3_column_int(stmt, 0);
 }
 
 QList<QPair<int, Message> > Inbox::values(QString type, QString query, QString match, int offset, int limit){
@@ -147,31 +357,33 @@ QList<QPair<int, Message> > Inbox::values(QString type, QString query, QString m
         return {};
     }
 
-    const char* sql = "SELECT id, blob FROM inbox_v1 "
-                      "WHERE json_extract(blob, '$.type') = ? "
-                      "AND json_extract(blob, ?) LIKE ? "
-                      "ORDER BY id ASC "
-                      "LIMIT ? OFFSET ?;";
+    auto const sql = "SELECT id, blob FROM inbox_v1 "
+                     "WHERE type = ?1 "
+                     "AND " + column_for(query) + " LIKE ?3 "
+                     "ORDER BY id ASC "
+                     "LIMIT ?4 OFFSET ?5;";
 
-    sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if(rc != SQLITE_OK){
+    auto stmt = prepare(sql);
+    if(!stmt){
         return {};
     }
 
-    auto t8 = type.toLocal8Bit();
-    auto q8 = query.toLocal8Bit();
-    auto m8 = match.toLocal8Bit();
-    rc = sqlite3_bind_text(stmt, 1, t8.data(),  -1, nullptr);
-    rc = sqlite3_bind_text(stmt, 2, q8.data(), -1, nullptr);
-    rc = sqlite3_bind_text(stmt, 3, m8.data(), -1, nullptr);
-    rc = sqlite3_bind_int(stmt, 4, limit);
-    rc = sqlite3_bind_int(stmt, 5, offset);
+    StatementReset reset{ stmt };
+
+    auto t8 = type.toUtf8();
+    auto q8 = query.toUtf8();
+    auto m8 = match.toUtf8();
+    sqlite3_bind_text(stmt, 1, t8.data(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, q8.data(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, m8.data(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 4, limit);
+    sqlite3_bind_int(stmt, 5, offset);
 
     //qCDebug(inbox_js8) << "exec" << sqlite3_expanded_sql(stmt);
 
     QList<QPair<int, Message>> v;
 
+    int rc;
     while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
     {
         try
@@ -187,8 +399,7 @@ QList<QPair<int, Message> > Inbox::values(QString type, QString query, QString m
         }
     }
 
-    rc = sqlite3_finalize(stmt);
-    if(rc != SQLITE_OK){
+    if(rc != SQLITE_DONE){
         return {};
     }
 
@@ -200,18 +411,17 @@ Message Inbox::value(int key){
         return {};
     }
 
-    const char* sql = "SELECT blob FROM inbox_v1 WHERE id = ? LIMIT 1;";
-
-    sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if(rc != SQLITE_OK){
+    auto stmt = prepare("SELECT blob FROM inbox_v1 WHERE id = ? LIMIT 1;");
+    if(!stmt){
         return {};
     }
 
-    rc = sqlite3_bind_int(stmt, 1, key);
+    StatementReset reset{ stmt };
+
+    sqlite3_bind_int(stmt, 1, key);
 
     Message m;
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    if(sqlite3_step(stmt) == SQLITE_ROW)
     {
         try
         {
@@ -219,15 +429,9 @@ Message Inbox::value(int key){
         }
         catch (...)
         {
-            continue;
         }
     }
 
-    rc = sqlite3_finalize(stmt);
-    if(rc != SQLITE_OK){
-        return {};
-    }
-
     return m;
 }
 
@@ -236,20 +440,17 @@ int Inbox::append(Message value){
         return -1;
     }
 
-    const char* sql = "INSERT INTO inbox_v1 (blob) VALUES (?);";
-
-    sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if(rc != SQLITE_OK){
+    auto stmt = prepare("INSERT INTO inbox_v1 (blob, type, params_from, params_to, params_utc) "
+                        "VALUES (?, ?, ?, ?, ?);");
+    if(!stmt){
         return -2;
     }
 
-    auto j8 = value.toJson();
-    rc = sqlite3_bind_text(stmt, 1, j8.data(), -1, nullptr);
-    rc = sqlite3_step(stmt);
+    StatementReset reset{ stmt };
 
-    rc = sqlite3_finalize(stmt);
-    if(rc != SQLITE_OK){
+    bind_message(stmt, 1, value);
+
+    if(sqlite3_step(stmt) != SQLITE_DONE){
         return -1;
     }
 
@@ -261,26 +462,18 @@ bool Inbox::set(int key, Message value){
         return false;
     }
 
-    const char* sql = "UPDATE inbox_v1 SET blob = ? WHERE id = ?;";
-
-    sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if(rc != SQLITE_OK){
+    auto stmt = prepare("UPDATE inbox_v1 SET blob = ?, type = ?, params_from = ?, params_to = ?, params_utc = ? "
+                        "WHERE id = ?;");
+    if(!stmt){
         return false;
     }
 
-    auto j8 = value.toJson();
-    rc = sqlite3_bind_text(stmt, 1, j8.data(), -1, nullptr);
-    rc = sqlite3_bind_int(stmt, 2, key);
-
-    rc = sqlite3_step(stmt);
+    StatementReset reset{ stmt };
 
-    rc = sqlite3_finalize(stmt);
-    if(rc != SQLITE_OK){
-        return false;
-    }
+    bind_message(stmt, 1, value);
+    sqlite3_bind_int(stmt, 6, key);
 
-    return true;
+    return sqlite3_step(stmt) == SQLITE_DONE;
 }
 
 bool Inbox::del(int key){
@@ -288,23 +481,38 @@ bool Inbox::del(int key){
         return false;
     }
 
-    const char* sql = "DELETE FROM inbox_v1 WHERE id = ?;";
+    auto stmt = prepare("DELETE FROM inbox_v1 WHERE id = ?;");
+    if(!stmt){
+        return false;
+    }
 
-    sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-    if(rc != SQLITE_OK){
+    StatementReset reset{ stmt };
+
+    sqlite3_bind_int(stmt, 1, key);
+
+    return sqlite3_step(stmt) == SQLITE_DONE;
+}
+
+bool Inbox::begin(){
+    if(!isOpen()){
         return false;
     }
 
-    rc = sqlite3_bind_int(stmt, 1, key);
-    rc = sqlite3_step(stmt);
+    return sqlite3_exec(db_, "BEGIN;", nullptr, nullptr, nullptr) == SQLITE_OK;
+}
 
-    rc = sqlite3_finalize(stmt);
-    if(rc != SQLITE_OK){
+bool Inbox::commit(){
+    if(!isOpen()){
         return false;
     }
 
-    return true;
+    return sqlite3_exec(db_, "COMMIT;", nullptr, nullptr, nullptr) == SQLITE_OK;
+}
+
+void Inbox::rollback(){
+    if(isOpen() && !sqlite3_get_autocommit(db_)){
+        sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+    }
 }
 
 int Inbox::getLookaheadMessageIdForCallsign(const QString &callsign, int afterMsgId){
@@ -312,52 +520,26 @@ int Inbox::getLookaheadMessageIdForCallsign(const QString &callsign, int afterMs
 		return -1;
 	}
 
-	const char* sql = "SELECT inbox_v1.id, inbox_v1.blob FROM inbox_v1 "
-					  "WHERE inbox_v1.id > ? "
-					  "AND json_extract(blob, '$.type') = 'STORE' "
-					  "AND json_extract(blob, '$.params.TO') LIKE ? "
-					  "ORDER BY inbox_v1.id ASC "
-					  "LIMIT ? OFFSET ?;";
-
-	sqlite3_stmt *stmt;
-	int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-	if(rc != SQLITE_OK){
+	auto stmt = prepare("SELECT id, blob FROM inbox_v1 "
+						"WHERE id > ? "
+						"AND type = 'STORE' "
+						"AND params_to LIKE ? "
+						"ORDER BY id ASC "
+						"LIMIT 10;");
+	if(!stmt){
 		return -1;
 	}
 
-	auto c8 = callsign.toLocal8Bit();
+	StatementReset reset{ stmt };
 
-	rc = sqlite3_bind_int(stmt, 1, afterMsgId);
-	rc = sqlite3_bind_text(stmt, 2, c8.data(), -1, nullptr);
-	rc = sqlite3_bind_int(stmt, 3, 10);
-	rc = sqlite3_bind_int(stmt, 4, 0);
-
-	//qCDebug(inbox_js8) << "exec " << sqlite3_expanded_sql(stmt);
+	auto c8 = callsign.toUtf8();
 
-	int next_id = -1;
-	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-		Message m;
+	sqlite3_bind_int(stmt, 1, afterMsgId);
+	sqlite3_bind_text(stmt, 2, c8.data(), -1, SQLITE_STATIC);
 
-		int i = sqlite3_column_int(stmt, 0);
-
-		auto msg = QByteArray((const char*)sqlite3_column_text(stmt, 1), sqlite3_column_bytes(stmt, 1));
-
-		m = Message::fromJson(msg);
-
-		auto params = m.params();
-		auto text = params.value("TEXT").toString().trimmed();
-		if(!text.isEmpty()){
-			next_id = i;
-			break;
-		}
-	}
-
-	rc = sqlite3_finalize(stmt);
-	if(rc != SQLITE_OK){
-		return -1;
-	}
+	//qCDebug(inbox_js8) << "exec " << sqlite3_expanded_sql(stmt);
 
-	return next_id;
+	return first_with_text(stmt);
 }
 
 /**
@@ -384,38 +566,33 @@ QMap<QString, int> Inbox::getGroupMessageCounts()
 
 	QMap<QString, int> messageCounts;
 
-	const char* sql = "SELECT count(id) as msg_count, json_extract(blob, '$.params.TO') as group_name FROM inbox_v1 "
-					  "WHERE json_extract(blob, '$.type') = 'STORE' "
-					  "AND group_name LIKE '@%' "
-					  "AND json_extract(blob, '$.params.UTC') > ? "
-					  "GROUP BY group_name";
+	// TO is NOCASE for the sake of LIKE; group on it as it was written,
+	// so that groups differing only in case are counted apart.
 
-	sqlite3_stmt *stmt;
-	int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-	if(rc != SQLITE_OK){
+	auto stmt = prepare("SELECT count(id) as msg_count, params_to as group_name FROM inbox_v1 "
+						"WHERE type = 'STORE' "
+						"AND params_to LIKE '@%' "
+						"AND params_utc > ? "
+						"GROUP BY params_to COLLATE BINARY");
+	if(!stmt){
 		return messageCounts;
 	}
 
-	// Set a floor or 48 hours for group message retrieval
-	// TODO: date formatting with the "yyyy-MM-dd HH:mm:ss" string happens elsewhere as well, centralize
-	// TODO: possibly make the date floor configurable
-	auto d8 = DriftingDateTime::currentDateTimeUtc().addDays(-2).toString("yyyy-MM-dd HH:mm:ss").toLocal8Bit();
+	StatementReset reset{ stmt };
 
-	rc = sqlite3_bind_text(stmt, 1, d8.data(), -1, nullptr);
+	auto d8 = group_date_floor();
 
-	//qCDebug(inbox_js8) << "exec " << sqlite3_expanded_sql(stmt);
+	sqlite3_bind_text(stmt, 1, d8.data(), -1, SQLITE_STATIC);
 
-	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-		Message m;
+	//qCDebug(inbox_js8) << "exec " << sqlite3_expanded_sql(stmt);
 
+	while (sqlite3_step(stmt) == SQLITE_ROW) {
 		int count = sqlite3_column_int(stmt, 0);
 		auto group = sqlite3_column_text(stmt, 1);
 
-		messageCounts.insert(QString::fromLocal8Bit(reinterpret_cast<const char *>(group)), count);
+		messageCounts.insert(QString::fromUtf8(reinterpret_cast<const char *>(group)), count);
 	}
 
-	rc = sqlite3_finalize(stmt);
-
 	return messageCounts;
 }
 
@@ -425,44 +602,39 @@ bool Inbox::markGroupMsgDeliveredForCallsign(int msgId, QString callsign)
 		return false;
 	}
 
-	const char* sql = "SELECT count(id) as msg_count FROM inbox_group_recip_v1 WHERE msg_id = ? AND callsign = ? LIMIT 1;";
-
-	sqlite3_stmt *exists_stmt;
-	int rc = sqlite3_prepare_v2(db_, sql, -1, &exists_stmt, nullptr);
-	if(rc != SQLITE_OK){
+	auto exists_stmt = prepare("SELECT count(id) as msg_count FROM inbox_group_recip_v1 WHERE msg_id = ? AND callsign = ? LIMIT 1;");
+	if(!exists_stmt){
 		return false;
 	}
 
-	auto cs8 = callsign.toLocal8Bit();
-
-	rc = sqlite3_bind_int(exists_stmt, 1, msgId);
-	rc = sqlite3_bind_text(exists_stmt, 2, cs8.data(), -1, nullptr);
+	auto cs8 = callsign.toUtf8();
 
 	bool recordExists = false;
-	rc = sqlite3_step(exists_stmt);
-	int count = sqlite3_column_int(exists_stmt, 0);
-	recordExists = (count > 0);
+	{
+		StatementReset reset{ exists_stmt };
 
-	rc = sqlite3_finalize(exists_stmt);
+		sqlite3_bind_int(exists_stmt, 1, msgId);
+		sqlite3_bind_text(exists_stmt, 2, cs8.data(), -1, SQLITE_STATIC);
+
+		if(sqlite3_step(exists_stmt) == SQLITE_ROW){
+			recordExists = sqlite3_column_int(exists_stmt, 0) > 0;
+		}
+	}
 
 	if(!recordExists)
 	{
-		sql = "INSERT INTO inbox_group_recip_v1 (msg_id, callsign) VALUES (?,?);";
-
-		sqlite3_stmt *insert_stmt;
-		rc = sqlite3_prepare_v2(db_, sql, -1, &insert_stmt, nullptr);
-		if (rc != SQLITE_OK)
+		auto insert_stmt = prepare("INSERT INTO inbox_group_recip_v1 (msg_id, callsign) VALUES (?,?);");
+		if (!insert_stmt)
 		{
 			return false;
 		}
 
-		rc = sqlite3_bind_int(insert_stmt, 1, msgId);
-		rc = sqlite3_bind_text(insert_stmt, 2, cs8.data(), -1, nullptr);
+		StatementReset reset{ insert_stmt };
 
-		rc = sqlite3_step(insert_stmt);
+		sqlite3_bind_int(insert_stmt, 1, msgId);
+		sqlite3_bind_text(insert_stmt, 2, cs8.data(), -1, SQLITE_STATIC);
 
-		rc = sqlite3_finalize(insert_stmt);
-		if (rc != SQLITE_OK)
+		if (sqlite3_step(insert_stmt) != SQLITE_DONE)
 		{
 			return false;
 		}
@@ -476,61 +648,31 @@ int Inbox::getNextGroupMessageIdForCallsign(const QString &group_name, const QSt
 		return -1;
 	}
 
-	const char* sql = "SELECT inbox_v1.id, inbox_v1.blob FROM inbox_v1 "
-					  "LEFT JOIN inbox_group_recip_v1 ON (inbox_group_recip_v1.msg_id=inbox_v1.id AND inbox_group_recip_v1.callsign = ?) "
-					  "WHERE json_extract(blob, '$.type') = 'STORE' "
-					  "AND json_extract(blob, '$.params.TO') LIKE ? "
-					  "AND json_extract(blob, '$.params.UTC') > ? "
-					  "AND inbox_group_recip_v1.id IS NULL "
-					  "ORDER BY inbox_v1.id ASC "
-					  "LIMIT ? OFFSET ?;";
-
-	sqlite3_stmt *stmt;
-	int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-	if(rc != SQLITE_OK){
+	auto stmt = prepare("SELECT inbox_v1.id, inbox_v1.blob FROM inbox_v1 "
+						"LEFT JOIN inbox_group_recip_v1 ON (inbox_group_recip_v1.msg_id=inbox_v1.id AND inbox_group_recip_v1.callsign = ?) "
+						"WHERE inbox_v1.type = 'STORE' "
+						"AND inbox_v1.params_to LIKE ? "
+						"AND inbox_v1.params_utc > ? "
+						"AND inbox_group_recip_v1.id IS NULL "
+						"ORDER BY inbox_v1.id ASC "
+						"LIMIT 10;");
+	if(!stmt){
 		return -1;
 	}
 
-	auto c8 = callsign.toLocal8Bit();
-	auto g8 = group_name.toLocal8Bit();
+	StatementReset reset{ stmt };
 
-	// Set a floor or 48 hours for group message retrieval
-	// TODO: date formatting with the "yyyy-MM-dd HH:mm:ss" string happens elsewhere as well, centralize
-	// TODO: possibly make the date floor configurable
-	auto d8 = DriftingDateTime::currentDateTimeUtc().addDays(-2).toString("yyyy-MM-dd HH:mm:ss").toLocal8Bit();
+	auto c8 = callsign.toUtf8();
+	auto g8 = group_name.toUtf8();
+	auto d8 = group_date_floor();
 
-	rc = sqlite3_bind_text(stmt, 1, c8.data(), -1, nullptr);
-	rc = sqlite3_bind_text(stmt, 2, g8.data(), -1, nullptr);
-	rc = sqlite3_bind_text(stmt, 3, d8.data(), -1, nullptr);
-	rc = sqlite3_bind_int(stmt, 4, 10);
-	rc = sqlite3_bind_int(stmt, 5, 0);
+	sqlite3_bind_text(stmt, 1, c8.data(), -1, SQLITE_STATIC);
+	sqlite3_bind_text(stmt, 2, g8.data(), -1, SQLITE_STATIC);
+	sqlite3_bind_text(stmt, 3, d8.data(), -1, SQLITE_STATIC);
 
 	//qCDebug(inbox_js8) << "exec " << sqlite3_expanded_sql(stmt);
 
-	int next_id = -1;
-	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-		Message m;
-
-		int i = sqlite3_column_int(stmt, 0);
-
-		auto msg = QByteArray((const char*)sqlite3_column_text(stmt, 1), sqlite3_column_bytes(stmt, 1));
-
-		m = Message::fromJson(msg);
-
-		auto params = m.params();
-		auto text = params.value("TEXT").toString().trimmed();
-		if(!text.isEmpty()){
-			next_id = i;
-			break;
-		}
-	}
-
-	rc = sqlite3_finalize(stmt);
-	if(rc != SQLITE_OK){
-		return -1;
-	}
-
-	return next_id;
+	return first_with_text(stmt);
 }
 
 int Inbox::getLookaheadGroupMessageIdForCallsign(const QString &group_name, const QString &callsign, int afterMsgId){
@@ -538,64 +680,33 @@ int Inbox::getLookaheadGroupMessageIdForCallsign(const QString &group_name, cons
 		return -1;
 	}
 
-	const char* sql = "SELECT inbox_v1.id, inbox_v1.blob FROM inbox_v1 "
-					  "LEFT JOIN inbox_group_recip_v1 ON (inbox_group_recip_v1.msg_id=inbox_v1.id AND inbox_group_recip_v1.callsign = ?) "
-					  "WHERE inbox_v1.id > ? "
-					  "AND json_extract(blob, '$.type') = 'STORE' "
-					  "AND json_extract(blob, '$.params.TO') LIKE ? "
-					  "AND json_extract(blob, '$.params.UTC') > ? "
-					  "AND inbox_group_recip_v1.id IS NULL "
-					  "ORDER BY inbox_v1.id ASC "
-					  "LIMIT ? OFFSET ?;";
-
-	sqlite3_stmt *stmt;
-	int rc = sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr);
-	if(rc != SQLITE_OK){
+	auto stmt = prepare("SELECT inbox_v1.id, inbox_v1.blob FROM inbox_v1 "
+						"LEFT JOIN inbox_group_recip_v1 ON (inbox_group_recip_v1.msg_id=inbox_v1.id AND inbox_group_recip_v1.callsign = ?) "
+						"WHERE inbox_v1.id > ? "
+						"AND inbox_v1.type = 'STORE' "
+						"AND inbox_v1.params_to LIKE ? "
+						"AND inbox_v1.params_utc > ? "
+						"AND inbox_group_recip_v1.id IS NULL "
+						"ORDER BY inbox_v1.id ASC "
+						"LIMIT 10;");
+	if(!stmt){
 		return -1;
 	}
 
-	auto c8 = callsign.toLocal8Bit();
-	auto g8 = group_name.toLocal8Bit();
+	StatementReset reset{ stmt };
 
-	// Set a floor or 48 hours for group message retrieval
-	// TODO: date formatting with the "yyyy-MM-dd HH:mm:ss" string happens elsewhere as well, centralize
-	// TODO: possibly make the date floor configurable
-	auto d8 = DriftingDateTime::currentDateTimeUtc().addDays(-2).toString("yyyy-MM-dd HH:mm:ss").toLocal8Bit();
+	auto c8 = callsign.toUtf8();
+	auto g8 = group_name.toUtf8();
+	auto d8 = group_date_floor();
 
-	rc = sqlite3_bind_text(stmt, 1, c8.data(), -1, nullptr);
-	rc = sqlite3_bind_int(stmt, 2, afterMsgId);
-	rc = sqlite3_bind_text(stmt, 3, g8.data(), -1, nullptr);
-	rc = sqlite3_bind_text(stmt, 4, d8.data(), -1, nullptr);
-	rc = sqlite3_bind_int(stmt, 5, 10);
-	rc = sqlite3_bind_int(stmt, 6, 0);
+	sqlite3_bind_text(stmt, 1, c8.data(), -1, SQLITE_STATIC);
+	sqlite3_bind_int(stmt, 2, afterMsgId);
+	sqlite3_bind_text(stmt, 3, g8.data(), -1, SQLITE_STATIC);
+	sqlite3_bind_text(stmt, 4, d8.data(), -1, SQLITE_STATIC);
 
 	qCDebug(inbox_js8) << "exec " << sqlite3_expanded_sql(stmt);
 
-	int next_id = -1;
-	while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-		Message m;
-
-		int i = sqlite3_column_int(stmt, 0);
-
-		auto msg = QByteArray((const char*)sqlite3_column_text(stmt, 1), sqlite3_column_bytes(stmt, 1));
-
-		m = Message::fromJson(msg);
-
-		auto params = m.params();
-		auto text = params.value("TEXT").toString().trimmed();
-		if(!text.isEmpty()){
-			next_id = i;
-			break;
-		}
-	}
-
-	rc = sqlite3_finalize(stmt);
-	if(rc != SQLITE_OK){
-		return -1;
-	}
-
-	return next_id;
+	return first_with_text(stmt);
 }
 
 Q_LOGGING_CATEGORY(inbox_js8, "inbox.js8", QtWarningMsg)
-
@@ -5,6 +5,8 @@
  * (C) 2018 Jordan Sherer <kn4crd@gmail.com> - All Rights Reserved
  **/
 
+#include <QByteArray>
+#include <QHash>
 #include <QObject>
 #include <QString>
 #include <QPair>
@@ -32,6 +34,9 @@ public:
     int append(Message value);
     bool set(int key, Message value);
     bool del(int key);
+    bool begin();
+    bool commit();
+    void rollback();
 
     // High-Level Interface
     int countUnreadFrom(QString from);
@@ -48,8 +53,18 @@ signals:
 public slots:
 
 private:
+    bool migrate();
+    sqlite3_stmt * prepare(QByteArray const & sql);
+
     QString path_;
     sqlite3 * db_;
+
+    // Why the last open() failed; error() reports it once closed.
+    QString error_;
+
+    // Prepared statements, keyed by their SQL text; these live as long
+    // as the connection does and are finalized when it's closed.
+    QHash<QByteArray, sqlite3_stmt *> stmts_;
 };
 
 #endif // INBOX_H
@@ -0,0 +1,223 @@
+/**
+ * This file is part of JS8Call.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ **/
+
+#include "InboxService.h"
+
+#include <QLoggingCategory>
+#include <QMetaObject>
+
+Q_DECLARE_LOGGING_CATEGORY(inbox_js8)
+
+InboxService::InboxService(QString const & path,
+                           QObject       * parent)
+  : QObject        {parent}
+  , inbox_         {path}
+  , flushScheduled_{false}
+  , openFailed_    {false}
+{
+    thread_.setObjectName("InboxService");
+    context_.moveToThread(&thread_);
+    thread_.start(QThread::LowPriority);
+}
+
+// Drain anything still queued, close the connection on the thread that
+// has been using it, and then shut the thread down.
+
+InboxService::~InboxService()
+{
+    QMetaObject::invokeMethod(&context_, [this]()
+    {
+        flush();
+        inbox_.close();
+    }, Qt::BlockingQueuedConnection);
+
+    thread_.quit();
+    thread_.wait();
+}
+
+/**
+ * Low-Level Interface
+ **/
+
+QFuture<int>
+InboxService::count(QString const & type,
+                    QString const & query,
+                    QString const & match)
+{
+    return read([=](Inbox & inbox){ return inbox.count(type, query, match); });
+}
+
+QFuture<QList<QPair<int, Message>>>
+InboxService::values(QString const & type,
+                     QString const & query,
+                     QString const & match,
+                     int             offset,
+                     int             limit)
+{
+    return read([=](Inbox & inbox){ return inbox.values(type, query, match, offset, limit); });
+}
+
+QFuture<Message>
+InboxService::value(int key)
+{
+    return read([=](Inbox & inbox){ return inbox.value(key); });
+}
+
+QFuture<int>
+InboxService::append(Message const & value)
+{
+    return write([=](Inbox & inbox){ return inbox.append(value); });
+}
+
+QFuture<bool>
+InboxService::set(int             key,
+                  Message const & value)
+{
+    return write([=](Inbox & inbox){ return inbox.set(key, value); });
+}
+
+QFuture<bool>
+InboxService::del(int key)
+{
+    return write([=](Inbox & inbox){ return inbox.del(key); });
+}
+
+/**
+ * High-Level Interface
+ **/
+
+QFuture<QMap<QString, int>>
+InboxService::getGroupMessageCounts()
+{
+    return read([](Inbox & inbox){ return inbox.getGroupMessageCounts(); });
+}
+
+QFuture<int>
+InboxService::getLookaheadMessageIdForCallsign(QString const & callsign,
+                                               int             afterMsgId)
+{
+    return read([=](Inbox & inbox){ return inbox.getLookaheadMessageIdForCallsign(callsign, afterMsgId); });
+}
+
+QFuture<int>
+InboxService::getNextGroupMessageIdForCallsign(QString const & group_name,
+                                               QString const & callsign)
+{
+    return read([=](Inbox & inbox){ return inbox.getNextGroupMessageIdForCallsign(group_name, callsign); });
+}
+
+QFuture<int>
+InboxService::getLookaheadGroupMessageIdForCallsign(QString const & group_name,
+                                                    QString const & callsign,
+                                                    int             afterMsgId)
+{
+    return read([=](Inbox & inbox){ return inbox.getLookaheadGroupMessageIdForCallsign(group_name, callsign, afterMsgId); });
+}
+
+QFuture<bool>
+InboxService::markGroupMsgDeliveredForCallsign(int             msgId,
+                                               QString const & callsign)
+{
+    return write([=](Inbox & inbox){ return inbox.markGroupMsgDeliveredForCallsign(msgId, callsign); });
+}
+
+/**
+ * Service Thread
+ **/
+
+// Hand a job off to the service thread. Reads run immediately, after
+// committing any writes ahead of them; writes are held until the next
+// pass through the event loop, so that a burst of them will share one
+// transaction.
+
+void
+InboxService::schedule(Job  job,
+                       bool isWrite)
+{
+    QMetaObject::invokeMethod(&context_, [this, job = std::move(job), isWrite]()
+    {
+        if (isWrite)
+        {
+            pending_.append(job);
+
+            if (!flushScheduled_)
+            {
+                flushScheduled_ = true;
+                QMetaObject::invokeMethod(&context_, [this](){ flush(); }, Qt::QueuedConnection);
+            }
+        }
+        else
+        {
+            flush();
+            ensureOpen();
+            job(inbox_)(true);
+        }
+    }, Qt::QueuedConnection);
+}
+
+// Open the inbox if it's not already; we complain once if we can't, and
+// otherwise let the jobs run against the closed inbox, which will give
+// them the same failure results they'd have seen from a failed open().
+
+bool
+InboxService::ensureOpen()
+{
+    if (inbox_.open())
+    {
+        openFailed_ = false;
+        return true;
+    }
+
+    if (!openFailed_)
+    {
+        openFailed_ = true;
+        qCWarning(inbox_js8) << "unable to open inbox:" << inbox_.error();
+        Q_EMIT error(inbox_.error());
+    }
+
+    return false;
+}
+
+void
+InboxService::flush()
+{
+    flushScheduled_ = false;
+
+    if (pending_.isEmpty()) return;
+
+    auto const jobs    = std::exchange(pending_, {});
+    auto const batched = ensureOpen() && inbox_.begin();
+
+    QList<Completion> completions;
+
+    for (auto const & job : jobs) completions.append(job(inbox_));
+
+    // Only now do we know whether the writes stuck; without a transaction,
+    // each stood or fell on its own, and its result says which.
+
+    auto committed = true;
+
+    if (batched && !inbox_.commit())
+    {
+        qCWarning(inbox_js8) << "unable to commit inbox writes:" << inbox_.error();
+        inbox_.rollback();
+        committed = false;
+    }
+
+    for (auto const & complete : completions) complete(committed);
+}
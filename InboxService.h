@@ -0,0 +1,152 @@
+#ifndef INBOXSERVICE_H
+#define INBOXSERVICE_H
+
+#include <QFuture>
+#include <QList>
+#include <QMap>
+#include <QObject>
+#include <QPair>
+#include <QPromise>
+#include <QString>
+#include <QThread>
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Inbox.h"
+#include "Message.hpp"
+
+/**
+ * Owns the inbox database connection and performs all work against it
+ * on a dedicated thread, handing results back as futures. Writes that
+ * arrive together are committed together in a single transaction; any
+ * read waits for the writes queued ahead of it. The future of a write
+ * completes once its transaction has committed; if the transaction is
+ * rolled back, it fails, with an exception, rather than report a result
+ * that was never stored.
+ *
+ * Futures complete on the service thread, so continuations that touch
+ * the GUI must supply a context object, e.g.
+ *
+ *   inbox->count(...).then(this, [this](int n){ ... });
+ *
+ * Callers that need an answer right away can still block on result(),
+ * which is what the synchronous facades in MainWindow do.
+ **/
+
+class InboxService final : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit InboxService(QString const & path,
+                          QObject       * parent = nullptr);
+    ~InboxService();
+
+    // Low-Level Interface
+    QFuture<int> count(QString const & type, QString const & query, QString const & match);
+    QFuture<QList<QPair<int, Message>>> values(QString const & type, QString const & query, QString const & match, int offset, int limit);
+    QFuture<Message> value(int key);
+    QFuture<int> append(Message const & value);
+    QFuture<bool> set(int key, Message const & value);
+    QFuture<bool> del(int key);
+
+    // High-Level Interface
+    QFuture<QMap<QString, int>> getGroupMessageCounts();
+    QFuture<int> getLookaheadMessageIdForCallsign(QString const & callsign, int afterMsgId);
+    QFuture<int> getNextGroupMessageIdForCallsign(QString const & group_name, QString const & callsign);
+    QFuture<int> getLookaheadGroupMessageIdForCallsign(QString const & group_name, QString const & callsign, int afterMsgId);
+    QFuture<bool> markGroupMsgDeliveredForCallsign(int msgId, QString const & callsign);
+
+    // Run a function against the inbox on the service thread, returning
+    // its result; use read() for queries and write() for anything that
+    // modifies the inbox, so that it'll be batched into a transaction.
+    template<typename Function> auto read (Function && function);
+    template<typename Function> auto write(Function && function);
+
+    Q_SIGNAL void error(QString const &) const;
+
+private:
+    // A job runs against the inbox and returns how to complete its future;
+    // for writes, that's done once the transaction has been committed, or
+    // rolled back, and the completion is told which.
+    using Completion = std::function<void (bool committed)>;
+    using Job        = std::function<Completion (Inbox &)>;
+
+    template<typename Function> auto submit(Function && function, bool isWrite);
+
+    void schedule(Job job, bool isWrite);
+    bool ensureOpen();
+    void flush();
+
+    QThread thread_;
+    QObject context_;
+
+    // Accessed only on the service thread.
+    Inbox inbox_;
+    QList<Job> pending_;
+    bool flushScheduled_;
+    bool openFailed_;
+};
+
+template<typename Function>
+auto
+InboxService::submit(Function && function,
+                     bool       isWrite)
+{
+    using Result = std::invoke_result_t<Function, Inbox &>;
+
+    auto promise = std::make_shared<QPromise<Result>>();
+    auto future  = promise->future();
+
+    promise->start();
+
+    schedule([promise, function = std::forward<Function>(function)](Inbox & inbox) mutable -> Completion
+    {
+        try
+        {
+            return [promise, result = function(inbox)](bool const committed)
+            {
+                if (committed)
+                {
+                    promise->addResult(result);
+                }
+                else
+                {
+                    promise->setException(std::make_exception_ptr(std::runtime_error("inbox transaction rolled back")));
+                }
+                promise->finish();
+            };
+        }
+        catch (...)
+        {
+            return [promise, exception = std::current_exception()](bool)
+            {
+                promise->setException(exception);
+                promise->finish();
+            };
+        }
+    }, isWrite);
+
+    return future;
+}
+
+template<typename Function>
+auto
+InboxService::read(Function && function)
+{
+    return submit(std::forward<Function>(function), false);
+}
+
+template<typename Function>
+auto
+InboxService::write(Function && function)
+{
+    return submit(std::forward<Function>(function), true);
+}
+
+#endif // INBOXSERVICE_H
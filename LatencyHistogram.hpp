@@ -0,0 +1,104 @@
+#ifndef LATENCY_HISTOGRAM_HPP__
+#define LATENCY_HISTOGRAM_HPP__
+
+#include <QVariantList>
+#include <QVariantMap>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+
+// Histogram of latencies, in buckets of powers of two milliseconds; the
+// first bucket holds those under a millisecond, bucket n those of 2^(n-1)
+// up to 2^n milliseconds, and the last everything beyond. Percentiles are
+// reported as the upper bound of the bucket they fall in, which is as
+// much as a log scale can tell us, and as much as we need to know.
+//
+// Recording is lock-free, and may be done from any thread, as may asking
+// for the counters; a snapshot taken while recording is under way might
+// be out by the latencies being recorded, which is fine for diagnostics.
+
+class LatencyHistogram
+{
+public:
+
+  static constexpr int BUCKETS = 16;
+
+  void
+  record(qint64 const microseconds)
+  {
+    auto const us     = static_cast<quint64>(std::max(qint64{0}, microseconds));
+    auto const bucket = std::min(BUCKETS - 1, static_cast<int>(std::bit_width(us / 1000)));
+
+    m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    m_total.fetch_add(us, std::memory_order_relaxed);
+
+    for (auto max = m_max.load(std::memory_order_relaxed);
+         us > max && !m_max.compare_exchange_weak(max, us, std::memory_order_relaxed);)
+    {}
+  }
+
+  // Start over; as with a snapshot, latencies being recorded while this
+  // is under way might land either side of it.
+
+  void
+  clear()
+  {
+    for (auto & bucket : m_buckets) bucket.store(0, std::memory_order_relaxed);
+
+    m_total.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+  }
+
+  // Counters, in the form the API reports them; times in milliseconds.
+
+  QVariantMap
+  stats() const
+  {
+    std::array<quint64, BUCKETS> buckets;
+    QVariantList                 counts;
+    quint64                      count = 0;
+
+    for (int i = 0; i < BUCKETS; ++i)
+    {
+      buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+      count     += buckets[i];
+      counts.append(buckets[i]);
+    }
+
+    auto const percentile = [&](quint64 const p) -> qint64
+    {
+      if (!count) return 0;
+
+      auto const rank = (count * p + 99) / 100;
+      quint64    seen = 0;
+
+      for (int i = 0; i < BUCKETS - 1; ++i)
+      {
+        if ((seen += buckets[i]) >= rank) return qint64{1} << i;
+      }
+
+      return static_cast<qint64>(m_max.load(std::memory_order_relaxed) / 1000);
+    };
+
+    return {
+      {"COUNT",   count},
+      {"MEAN",    count ? m_total.load(std::memory_order_relaxed) / 1000.0 / count : 0.0},
+      {"MAX",     m_max.load(std::memory_order_relaxed) / 1000.0},
+      {"P50",     percentile(50)},
+      {"P90",     percentile(90)},
+      {"P99",     percentile(99)},
+      {"BUCKETS", counts}
+    };
+  }
+
+private:
+
+  std::array<std::atomic<quint64>, BUCKETS> m_buckets {};
+  std::atomic<quint64>                      m_total   {0};
+  std::atomic<quint64>                      m_max     {0};
+};
+
+#endif
@@ -0,0 +1,416 @@
+#include "LogJournal.hpp"
+#include <utility>
+#include <QDate>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLoggingCategory>
+#include <QMetaObject>
+#include <QTimer>
+#include <zlib.h>
+
+#if defined (Q_OS_WIN)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+Q_DECLARE_LOGGING_CATEGORY(logjournal_js8)
+
+/******************************************************************************/
+// Constants
+/******************************************************************************/
+
+namespace
+{
+  // How long we'll hold on to lines before writing them, and how long
+  // we'll let written data sit in the system's buffers before forcing
+  // it out to the disk, in milliseconds.
+
+  constexpr int FLUSH_INTERVAL = 500;
+  constexpr int SYNC_INTERVAL  = 10000;
+
+  // Bytes we'll allow to be queued and not yet written before we start
+  // dropping lines; many minutes of even the busiest band.
+
+  constexpr qint64 QUEUE_LIMIT = 4 * 1024 * 1024;
+
+  // Bytes of a rotated file we'll read, and of what it compresses to
+  // we'll write, at a time.
+
+  constexpr qsizetype COMPRESS_CHUNK = 64 * 1024;
+}
+
+/******************************************************************************/
+// Local Routines
+/******************************************************************************/
+
+namespace
+{
+  // Force anything written to the file out to the disk.
+
+  bool
+  syncFile(QFile & file)
+  {
+    if (!file.flush()) return false;
+
+#if defined (Q_OS_WIN)
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+  }
+
+  // Compress the file provided into a gzip file, a chunk at a time, so
+  // that however large the log has grown, we never hold more than a
+  // chunk of it, or of what it compresses to, in memory.
+
+  bool
+  gzip(QFile & in,
+       QFile & out)
+  {
+    z_stream stream {};
+
+    // Window bits past 15 ask for a gzip header and trailer, rather than
+    // those of zlib.
+
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) return false;
+
+    QByteArray input (COMPRESS_CHUNK, Qt::Uninitialized);
+    QByteArray output(COMPRESS_CHUNK, Qt::Uninitialized);
+    int        status = Z_OK;
+    bool       ok     = true;
+
+    while (ok && status != Z_STREAM_END)
+    {
+      auto const read = in.read(input.data(), input.size());
+
+      if (read < 0)
+      {
+        ok = false;
+        break;
+      }
+
+      auto const flush = in.atEnd() ? Z_FINISH : Z_NO_FLUSH;
+
+      stream.next_in  = reinterpret_cast<Bytef *>(input.data());
+      stream.avail_in = static_cast<uInt>(read);
+
+      // Take all the output this chunk of input makes; when finishing,
+      // that's all there is left.
+
+      do
+      {
+        stream.next_out  = reinterpret_cast<Bytef *>(output.data());
+        stream.avail_out = static_cast<uInt>(output.size());
+
+        status = deflate(&stream, flush);
+
+        auto const have = static_cast<qint64>(output.size() - stream.avail_out);
+
+        if (status == Z_STREAM_ERROR || out.write(output.constData(), have) != have)
+        {
+          ok = false;
+          break;
+        }
+      }
+      while (stream.avail_out == 0);
+    }
+
+    deflateEnd(&stream);
+
+    return ok;
+  }
+}
+
+/******************************************************************************/
+// Private Implementation
+/******************************************************************************/
+
+struct LogJournal::File
+{
+  QFile      file;
+  QByteArray pending;          // Queued, and not yet written.
+  QDate      date;             // UTC date of the last write.
+  bool       unsynced = false; // Written since last forced to disk.
+  bool       failed   = false; // Last open or write failed; reported.
+  bool       stuck    = false; // Last rotation failed; reported.
+};
+
+void
+LogJournal::write(QString    const & path,
+                  QByteArray const & bytes)
+{
+  auto & file = m_files[path];
+
+  if (!file) file = std::make_unique<File>();
+
+  file->pending.append(bytes);
+
+  if (!m_flushScheduled)
+  {
+    m_flushScheduled = true;
+    QTimer::singleShot(FLUSH_INTERVAL, &m_context, [this](){ flush(); });
+  }
+}
+
+void
+LogJournal::flush()
+{
+  m_flushScheduled = false;
+
+  for (auto & [path, file] : m_files) flush(path, *file);
+
+  if (auto const dropped = m_dropped.exchange(0))
+  {
+    qCWarning(logjournal_js8) << "dropped" << dropped << "lines while behind";
+  }
+
+  if (!m_syncScheduled)
+  {
+    m_syncScheduled = true;
+    QTimer::singleShot(SYNC_INTERVAL, &m_context, [this](){ sync(); });
+  }
+}
+
+void
+LogJournal::flush(QString const & path,
+                  File          & file)
+{
+  if (file.pending.isEmpty()) return;
+
+  auto const bytes = std::exchange(file.pending, {});
+  auto const today = QDateTime::currentDateTimeUtc().date();
+
+  m_queued -= bytes.size();
+
+  if (!file.file.isOpen() && !open(path, file)) return;
+
+  if (auto const size = file.file.size(); size > 0 &&
+      ((m_rotation.maxBytes > 0 && size + bytes.size() > m_rotation.maxBytes) ||
+       (m_rotation.daily && file.date.isValid() && file.date != today)))
+  {
+    rotate(path, file);
+
+    if (!file.file.isOpen()) return;
+  }
+
+  if (file.file.write(bytes) == bytes.size())
+  {
+    file.date     = today;
+    file.unsynced = true;
+    file.failed   = false;
+  }
+  else
+  {
+    if (!file.failed)
+    {
+      file.failed = true;
+      Q_EMIT error(tr("Cannot write to \"%1\": %2").arg(path, file.file.errorString()));
+    }
+
+    // Start afresh on the next write; whatever went wrong may well
+    // have been fixed by then.
+
+    file.file.close();
+  }
+}
+
+void
+LogJournal::sync()
+{
+  m_syncScheduled = false;
+
+  for (auto & [path, file] : m_files)
+  {
+    if (file->unsynced && file->file.isOpen())
+    {
+      if (!syncFile(file->file))
+      {
+        qCWarning(logjournal_js8) << "unable to sync" << path << file->file.errorString();
+      }
+      file->unsynced = false;
+    }
+  }
+}
+
+bool
+LogJournal::open(QString const & path,
+                 File          & file)
+{
+  file.file.setFileName(path);
+
+  if (!file.file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Append))
+  {
+    if (!file.failed)
+    {
+      file.failed = true;
+      Q_EMIT error(tr("Cannot open \"%1\" for append: %2").arg(path, file.file.errorString()));
+    }
+    return false;
+  }
+
+  // An existing file was last written on the day it was last modified;
+  // a new one is as of now.
+
+  QFileInfo const info(path);
+
+  file.date = info.size() > 0 ? info.lastModified().toUTC().date()
+                              : QDateTime::currentDateTimeUtc().date();
+  return true;
+}
+
+// Move the file aside, under a name marked with the time we did so, e.g.,
+// ALL.TXT to ALL-20240101-000000.TXT, compress it if asked, and open a
+// fresh one in its place.
+
+void
+LogJournal::rotate(QString const & path,
+                   File          & file)
+{
+  file.file.close();
+
+  QFileInfo const info(path);
+
+  auto const suffix  = info.suffix().isEmpty() ? QString() : "." + info.suffix();
+  auto const stamp   = QDateTime::currentDateTimeUtc().toString("yyyyMMdd-hhmmss");
+  auto const rotated = info.dir().absoluteFilePath(info.completeBaseName() + "-" + stamp + suffix);
+
+  // We'll be asked to try again on every flush until a rotation works,
+  // and writes carry on to the file as it is in the meantime; complain
+  // about the first failure of a run, not all of them.
+
+  QFile      current(path);
+  auto const renamed = current.rename(rotated);
+
+  if (!renamed)
+  {
+    if (!file.stuck)
+    {
+      Q_EMIT error(tr("Cannot rotate \"%1\": %2").arg(path, current.errorString()));
+    }
+  }
+  else if (m_rotation.compress)
+  {
+    QFile in(rotated);
+    QFile out(rotated + ".gz");
+
+    if (!in.open(QIODevice::ReadOnly))
+    {
+      qCWarning(logjournal_js8) << "unable to read" << rotated << in.errorString();
+    }
+    else if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+             !gzip(in, out) || !syncFile(out))
+    {
+      // Leave the rotated file as it is; it's no worse off for not
+      // having been compressed.
+
+      qCWarning(logjournal_js8) << "unable to compress" << rotated << out.errorString();
+      out.remove();
+    }
+    else
+    {
+      in.remove();
+    }
+  }
+
+  file.stuck = !renamed;
+
+  open(path, file);
+}
+
+void
+LogJournal::close()
+{
+  flush();
+
+  for (auto & [path, file] : m_files)
+  {
+    if (file->file.isOpen())
+    {
+      syncFile(file->file);
+      file->file.close();
+    }
+  }
+}
+
+/******************************************************************************/
+// Public Interface
+/******************************************************************************/
+
+LogJournal::LogJournal(Rotation  const rotation,
+                       QObject * const parent)
+: QObject   {parent}
+, m_rotation{rotation}
+{
+  m_thread.setObjectName("LogJournal");
+  m_context.moveToThread(&m_thread);
+  m_thread.start(QThread::LowPriority);
+}
+
+// Write out anything still queued, and close the files on the thread
+// that has been using them before shutting it down.
+
+LogJournal::~LogJournal()
+{
+  QMetaObject::invokeMethod(&m_context, [this](){ close(); }, Qt::BlockingQueuedConnection);
+
+  m_thread.quit();
+  m_thread.wait();
+}
+
+void
+LogJournal::append(QString const & path,
+                   QString const & line)
+{
+  auto bytes = line.toUtf8();
+  bytes.append('\n');
+
+  auto const size = static_cast<qint64>(bytes.size());
+
+  if (m_queued.fetch_add(size) + size > QUEUE_LIMIT)
+  {
+    m_queued.fetch_sub(size);
+
+    if (m_dropped.fetch_add(1) == 0)
+    {
+      Q_EMIT error(tr("Log files are falling behind; some lines will not be written"));
+    }
+    return;
+  }
+
+  QMetaObject::invokeMethod(&m_context, [this, path, bytes = std::move(bytes)]()
+  {
+    write(path, bytes);
+  }, Qt::QueuedConnection);
+}
+
+void
+LogJournal::setRotation(Rotation const rotation)
+{
+  QMetaObject::invokeMethod(&m_context, [this, rotation]()
+  {
+    m_rotation = rotation;
+  }, Qt::QueuedConnection);
+}
+
+void
+LogJournal::remove(QString const & path)
+{
+  QMetaObject::invokeMethod(&m_context, [this, path]()
+  {
+    if (auto const it = m_files.find(path); it != m_files.end())
+    {
+      flush(path, *it->second);
+      it->second->file.close();
+      m_files.erase(it);
+    }
+
+    QFile::remove(path);
+  }, Qt::QueuedConnection);
+}
+
+/******************************************************************************/
+
+Q_LOGGING_CATEGORY(logjournal_js8, "logjournal.js8", QtWarningMsg)
@@ -0,0 +1,89 @@
+#ifndef LOG_JOURNAL_HPP__
+#define LOG_JOURNAL_HPP__
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QtGlobal>
+
+#include <atomic>
+#include <map>
+#include <memory>
+
+// Appends lines to text log files, e.g., ALL.TXT and DIRECTED.TXT, on a
+// thread of its own, so that a slow disk never holds up the caller.
+//
+// Lines are queued as they arrive, and written out in batches, each file
+// kept open between them, with the data forced out to the disk every so
+// often. The queue is bounded; should the disk fall far enough behind
+// that it fills, further lines are dropped until it catches up. Files
+// can be rotated when they'd grow past a size, or when the UTC date
+// changes, with rotated files optionally compressed with gzip.
+//
+// Problems are reported through the error() signal, once for each run
+// of failures on a file, rather than on every line.
+
+class LogJournal final : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  struct Rotation
+  {
+    qint64 maxBytes = 0;     // Rotate before passing this size; zero for never.
+    bool   daily    = false; // Rotate when the UTC date changes.
+    bool   compress = false; // Compress rotated files with gzip.
+  };
+
+  explicit LogJournal(Rotation  rotation,
+                      QObject * parent = nullptr);
+  ~LogJournal();
+
+  // Queue a line, to which a newline will be added, for appending to the
+  // file at the path provided; callable from any thread.
+
+  void append(QString const & path,
+              QString const & line);
+
+  // Rotate files as provided from now on; callable from any thread.
+
+  void setRotation(Rotation rotation);
+
+  // Write out anything queued for the file, close it, and remove it.
+
+  void remove(QString const & path);
+
+  Q_SIGNAL void error(QString const & message) const;
+
+private:
+
+  struct File;
+
+  using Files = std::map<QString, std::unique_ptr<File>>;
+
+  // Accessed only on the journal thread.
+
+  void   write (QString const & path, QByteArray const & bytes);
+  void   flush ();
+  void   flush (QString const & path, File & file);
+  void   sync  ();
+  bool   open  (QString const & path, File & file);
+  void   rotate(QString const & path, File & file);
+  void   close ();
+
+  QThread              m_thread;
+  QObject              m_context;
+  Rotation             m_rotation;
+  Files                m_files;
+  bool                 m_flushScheduled = false;
+  bool                 m_syncScheduled  = false;
+
+  // Shared between threads.
+
+  std::atomic<qint64>  m_queued  {0};
+  std::atomic<qint64>  m_dropped {0};
+};
+
+#endif
@@ -21,6 +21,7 @@
 #include "Message.hpp"
 #include "MessageError.hpp"
 #include "DriftingDateTime.h"
+#include <QCborValue>
 
 /******************************************************************************/
 // Constants
@@ -182,6 +183,56 @@ Message::setValue(QString const & value)
 // Deserialization
 /******************************************************************************/
 
+// CBOR is the compact alternative to JSON offered to API clients; the
+// map has the same shape as the JSON object, with the params converted
+// directly from their variants rather than by way of a JSON document.
+
+Message
+Message::fromCbor(QByteArray const & cbor)
+{
+  QCborParserError parse;
+  QCborValue       value = QCborValue::fromCbor(cbor, &parse);
+
+  if (parse.error != QCborError::NoError) throw std::system_error
+  {
+    MessageError::Code::cbor_parsing_error,
+    parse.errorString().toStdString()
+  };
+
+  if (!value.isMap()) throw std::system_error
+  {
+    MessageError::Code::cbor_not_a_map
+  };
+
+  return fromCbor(value.toMap());
+}
+
+Message
+Message::fromCbor(QCborMap const & cbor)
+{
+  Message message;
+
+  if (auto const it  = cbor.constFind(QLatin1String("type"));
+                 it != cbor.constEnd() && it->isString())
+  {
+    message.d_->type_ = it->toString();
+  }
+
+  if (auto const it  = cbor.constFind(QLatin1String("value"));
+                 it != cbor.constEnd() && it->isString())
+  {
+    message.d_->value_ = it->toString();
+  }
+
+  if (auto const it  = cbor.constFind(QLatin1String("params"));
+                 it != cbor.constEnd() && it->isMap())
+  {
+    message.d_->params_ = it->toMap().toVariantMap();
+  }
+
+  return message;
+}
+
 Message
 Message::fromJson(QByteArray const & json)
 {
@@ -238,6 +289,22 @@ Message::fromJson(QJsonObject const & json)
 // Conversions
 /******************************************************************************/
 
+QByteArray
+Message::toCbor() const
+{
+  return QCborValue(toCborMap()).toCbor();
+}
+
+QCborMap
+Message::toCborMap() const
+{
+  return {
+    { QLatin1String("type"),                            d_->type_    },
+    { QLatin1String("value"),                           d_->value_   },
+    { QLatin1String("params"), QCborMap::fromVariantMap(d_->params_) }
+  };
+}
+
 QByteArray
 Message::toJson() const
 {
@@ -6,6 +6,7 @@
  **/
 
 #include <QByteArray>
+#include <QCborMap>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QMap>
@@ -49,6 +50,8 @@ public:
 
     // Conversions
 
+    QByteArray    toCbor()         const;
+    QCborMap      toCborMap()      const;
     QByteArray    toJson()         const;
     QJsonDocument toJsonDocument() const;
     QJsonObject   toJsonObject()   const;
@@ -56,6 +59,8 @@ public:
 
     // Deserialization
 
+    static Message fromCbor(QByteArray    const &);
+    static Message fromCbor(QCborMap      const &);
     static Message fromJson(QByteArray    const &);
     static Message fromJson(QJsonDocument const &);
     static Message fromJson(QJsonObject   const &);
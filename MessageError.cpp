@@ -23,6 +23,8 @@ namespace
             {
                 case Code::json_parsing_error: return "json parsing error";
                 case Code::json_not_an_object: return "json not an object";
+                case Code::cbor_parsing_error: return "cbor parsing error";
+                case Code::cbor_not_a_map:     return "cbor not a map";
 
                 default: return "message error";
             }
@@ -8,7 +8,9 @@ namespace MessageError
     enum class Code
     {
         json_parsing_error = -1001,
-        json_not_an_object = -1002
+        json_not_an_object = -1002,
+        cbor_parsing_error = -1003,
+        cbor_not_a_map     = -1004
     };
 
     std::error_category const & category() noexcept;
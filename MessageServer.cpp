@@ -1,6 +1,11 @@
 #include "MessageServer.h"
+#include <algorithm>
+#include <array>
 #include <stdexcept>
 #include <QLoggingCategory>
+#include <QMetaObject>
+#include <QtEndian>
+#include <QThread>
 Q_DECLARE_LOGGING_CATEGORY(messageserver_js8)
 
 MessageServer::MessageServer(QObject *parent) :
@@ -41,6 +46,7 @@ void MessageServer::stop()
     // disconnect all clients
     foreach(auto client, m_clients){
         client->close();
+        removeClient(client);
     }
 
     // then close the server
@@ -90,36 +96,76 @@ int MessageServer::activeConnections(){
 
 void MessageServer::pruneConnections(){
     // keep only the n most recent connections (fifo)
-    if(m_maxConnections && m_maxConnections < activeConnections()){
-        for(int i = m_maxConnections; i < activeConnections(); i++){
-            auto client = m_clients.first();
-            client->close();
-            m_clients.removeFirst();
-        }
+    while(m_maxConnections && m_maxConnections < activeConnections()){
+        auto client = m_clients.first();
+        client->close();
+        removeClient(client);
+    }
+}
+
+void MessageServer::removeClient(Client *client){
+    if(m_clients.removeOne(client)){
+        client->deleteLater();
     }
 }
 
+// Messages are serialized once per encoding in use, here on the server's
+// thread, and the same frame is then handed to each client that should
+// receive it. If we're called from any other thread, we hand the message
+// off to ours.
+
 void MessageServer::send(const Message &message){
+    if(QThread::currentThread() != thread()){
+        QMetaObject::invokeMethod(this, [this, message](){ send(message); }, Qt::QueuedConnection);
+        return;
+    }
+
+    if(m_clients.isEmpty()){
+        return;
+    }
+
+    auto const id = message.id();
+    std::array<QByteArray, 2> frames;
+
     foreach(auto client, m_clients){
-        if(!client->awaitingResponse(message.id())){
+        if(!client->awaitingResponse(id)){
+            continue;
+        }
+
+        if(id <= 0 && !client->isSubscribed(message)){
             continue;
         }
-        client->send(message);
+
+        auto &frame = frames[static_cast<int>(client->encoding())];
+        if(frame.isEmpty()){
+            frame = Client::frame(message, client->encoding());
+        }
+
+        client->send(frame, id);
     }
 }
 
+QVariantList MessageServer::statistics() const {
+    QVariantList l;
+    foreach(auto client, m_clients){
+        l << client->statistics();
+    }
+    return l;
+}
+
 void MessageServer::incomingConnection(qintptr handle)
 {
     qCDebug(messageserver_js8) << "MessageServer incomingConnection" << handle;
 
     auto client = new Client(this, this);
+    connect(client, &Client::disconnected, this, &MessageServer::removeClient);
     client->setSocket(handle);
 
 #if JS8_MESSAGESERVER_IS_SINGLE_CLIENT
     while(!m_clients.isEmpty()){
         auto client = m_clients.first();
         client->close();
-        m_clients.removeFirst();
+        removeClient(client);
     }
 #endif
 
@@ -127,6 +173,7 @@ void MessageServer::incomingConnection(qintptr handle)
         qCDebug(messageserver_js8) << "MessageServer connections full, dropping incoming connection";
         client->send(Message("API.ERROR", "Connections Full"));
         client->close();
+        client->deleteLater();
         return;
     }
 
@@ -135,7 +182,13 @@ void MessageServer::incomingConnection(qintptr handle)
 
 Client::Client(MessageServer * server, QObject *parent):
     QObject(parent),
-    m_server {server}
+    m_encoding {Encoding::Json},
+    m_server {server},
+    m_socket {nullptr},
+    m_bytesSent {0},
+    m_messagesSent {0},
+    m_messagesDropped {0},
+    m_maxQueuedBytes {0}
 {
     setConnected(true);
 }
@@ -145,8 +198,13 @@ void Client::setSocket(qintptr handle){
 
     connect(m_socket, &QTcpSocket::disconnected, this, &Client::onDisconnected);
     connect(m_socket, &QTcpSocket::readyRead, this, &Client::readyRead);
+    connect(m_socket, &QTcpSocket::bytesWritten, this, [this](qint64 bytes){
+        m_bytesSent += bytes;
+    });
 
     m_socket->setSocketDescriptor(handle);
+
+    m_peer = QString("%1:%2").arg(m_socket->peerAddress().toString()).arg(m_socket->peerPort());
 }
 
 void Client::setConnected(bool connected){
@@ -162,7 +220,27 @@ void Client::close(){
     m_socket = nullptr;
 }
 
+QByteArray Client::frame(Message const &message, Encoding encoding){
+    if(encoding == Encoding::Cbor){
+        auto const cbor = message.toCbor();
+        QByteArray frame(sizeof(quint32), Qt::Uninitialized);
+        qToBigEndian<quint32>(cbor.size(), frame.data());
+        return frame + cbor;
+    }
+
+    return message.toJson() + '\n';
+}
+
 void Client::send(const Message &message){
+    send(frame(message, m_encoding), message.id());
+}
+
+// Frames are appended to the socket's write buffer, which is drained as
+// the socket becomes writable; we don't flush, so that frames written
+// in quick succession go out together. A client that lets its buffer
+// grow past the limit misses messages until it catches up.
+
+void Client::send(QByteArray const &frame, qint64 id){
     if(!isConnected()){
         return;
     }
@@ -176,36 +254,210 @@ void Client::send(const Message &message){
         return;
     }
 
-    qCDebug(messageserver_js8) << "client writing" << message.toJson();
-    m_socket->write(message.toJson());
-    m_socket->write("\n");
-    m_socket->flush();
-
     // remove if needed
-    if(m_requests.contains(message.id())){
-        m_requests.remove(message.id());
+    m_requests.remove(id);
+
+    if(m_socket->bytesToWrite() + frame.size() > MAX_QUEUED_BYTES){
+        qCDebug(messageserver_js8) << "client" << m_peer << "is backed up, dropping message";
+        m_messagesDropped++;
+        return;
+    }
+
+    qCDebug(messageserver_js8) << "client writing" << frame;
+    m_socket->write(frame);
+    m_messagesSent++;
+    m_maxQueuedBytes = qMax(m_maxQueuedBytes, m_socket->bytesToWrite());
+}
+
+qint64 Client::queuedBytes() const {
+    return m_socket ? m_socket->bytesToWrite() : 0;
+}
+
+QVariantMap Client::statistics() const {
+    return {
+        {"PEER", m_peer},
+        {"ENCODING", m_encoding == Encoding::Cbor ? "CBOR" : "JSON"},
+        {"SUBSCRIPTION", m_subscription.toVariantMap()},
+        {"QUEUED_BYTES", queuedBytes()},
+        {"MAX_QUEUED_BYTES", m_maxQueuedBytes},
+        {"BYTES_SENT", m_bytesSent},
+        {"MESSAGES_SENT", m_messagesSent},
+        {"MESSAGES_DROPPED", m_messagesDropped},
+    };
+}
+
+// Type filters apply to every unsolicited message; callsign and offset
+// filters apply only to messages that carry a callsign (FROM, TO, or
+// CALL) or an OFFSET, so status messages without them still pass.
+
+bool Client::Subscription::accepts(Message const &message) const {
+    if(!types.isEmpty()){
+        auto const type = message.type();
+        auto const matches = std::any_of(types.begin(), types.end(), [&type](QString const &t){
+            return t.endsWith('*') ? type.startsWith(QStringView{t}.chopped(1)) : type == t;
+        });
+        if(!matches){
+            return false;
+        }
+    }
+
+    if(callsigns.isEmpty() && offsetMin < 0 && offsetMax < 0){
+        return true;
+    }
+
+    auto const params = message.params();
+
+    if(!callsigns.isEmpty()){
+        bool hasCall = false;
+        for(auto const key : {"FROM", "TO", "CALL"}){
+            auto const it = params.constFind(key);
+            if(it == params.constEnd()){
+                continue;
+            }
+            if(callsigns.contains(it->toString().toUpper())){
+                return true;
+            }
+            hasCall = true;
+        }
+        if(hasCall){
+            return false;
+        }
+    }
+
+    if(auto const it = params.constFind("OFFSET"); it != params.constEnd()){
+        auto const offset = it->toInt();
+        if(offsetMin >= 0 && offset < offsetMin){
+            return false;
+        }
+        if(offsetMax >= 0 && offset > offsetMax){
+            return false;
+        }
+    }
+
+    return true;
+}
+
+QVariantMap Client::Subscription::toVariantMap() const {
+    return {
+        {"TYPES", types},
+        {"CALLSIGNS", QStringList(callsigns.begin(), callsigns.end())},
+        {"OFFSET_MIN", offsetMin},
+        {"OFFSET_MAX", offsetMax},
+    };
+}
+
+Client::Subscription Client::Subscription::fromVariantMap(QVariantMap const &params){
+    Subscription s;
+    s.types = params.value("TYPES").toStringList();
+    for(auto const &call : params.value("CALLSIGNS").toStringList()){
+        s.callsigns.insert(call.trimmed().toUpper());
     }
+    s.offsetMin = params.value("OFFSET_MIN", -1).toInt();
+    s.offsetMax = params.value("OFFSET_MAX", -1).toInt();
+    return s;
 }
 
 void Client::onDisconnected(){
     qCDebug(messageserver_js8) << "MessageServer client disconnected";
     setConnected(false);
+    emit disconnected(this);
+}
+
+// Take the next complete frame off the socket, if there is one. A CBOR
+// client announcing a frame larger than we're willing to buffer is out
+// of sync with us, or worse; either way there's no recovering, so we
+// tell it so and hang up.
+
+bool Client::readFrame(QByteArray &frame){
+    if(!m_socket){
+        return false;
+    }
+
+    if(m_encoding == Encoding::Json){
+        if(!m_socket->canReadLine()){
+            return false;
+        }
+
+        frame = m_socket->readLine().trimmed();
+        return true;
+    }
+
+    char header[sizeof(quint32)];
+    if(m_socket->peek(header, sizeof(header)) < qint64(sizeof(header))){
+        return false;
+    }
+
+    auto const size = qFromBigEndian<quint32>(header);
+    if(size > MAX_FRAME_BYTES){
+        qCDebug(messageserver_js8) << "client" << m_peer << "sent oversized frame" << size;
+        send({"API.ERROR", "Frame Too Large"});
+        close();
+        return false;
+    }
+
+    if(m_socket->bytesAvailable() < qint64(sizeof(header) + size)){
+        return false;
+    }
+
+    m_socket->skip(sizeof(header));
+    frame = m_socket->read(size);
+    return true;
 }
 
 void Client::readyRead(){
     qCDebug(messageserver_js8) << "MessageServer client readyRead";
 
-    while(m_socket->canReadLine())
+    QByteArray msg;
+    while(readFrame(msg))
     {
-        auto const msg = m_socket->readLine().trimmed();
         qCDebug(messageserver_js8) << "-> Client" << m_socket->socketDescriptor() << msg;
 
         if (msg.isEmpty()) return;
 
         try
         {
-            auto m = Message::fromJson(msg);
-            m_requests[m.ensureId()] = m;
+            auto m = m_encoding == Encoding::Cbor ? Message::fromCbor(msg)
+                                                  : Message::fromJson(msg);
+            auto id = m.ensureId();
+
+            // API.GET_CLIENTS is about the server itself, so we'll
+            // answer it here rather than passing it along.
+            if(m.type() == "API.GET_CLIENTS"){
+                send(Message("API.CLIENTS", "", {
+                    {"_ID", id},
+                    {"CLIENTS", m_server->statistics()},
+                }));
+                continue;
+            }
+
+            // Likewise subscriptions, which are per client; replace the
+            // subscription, or drop it to go back to receiving it all.
+            if(m.type() == "API.SUBSCRIBE" || m.type() == "API.UNSUBSCRIBE"){
+                m_subscription = m.type() == "API.SUBSCRIBE" ? Subscription::fromVariantMap(m.params())
+                                                             : Subscription{};
+
+                auto params = m_subscription.toVariantMap();
+                params["_ID"] = id;
+                send(Message("API.SUBSCRIPTION", "", params));
+                continue;
+            }
+
+            // And the encoding. The acknowledgement is the last frame
+            // we send in the old encoding; everything after it, in both
+            // directions, uses the new one.
+            if(m.type() == "API.SET_ENCODING"){
+                auto const value = m.value().trimmed().toUpper();
+                if(value != "JSON" && value != "CBOR"){
+                    send(Message("API.ERROR", "Unknown Encoding", {{"_ID", id}}));
+                    continue;
+                }
+
+                send(Message("API.ENCODING", value, {{"_ID", id}}));
+                m_encoding = value == "CBOR" ? Encoding::Cbor : Encoding::Json;
+                continue;
+            }
+
+            m_requests[id] = m;
             emit m_server->message(m);
         }
         catch (std::exception const & e)
@@ -6,6 +6,9 @@
 #include <QAbstractSocket>
 #include <QScopedPointer>
 #include <QList>
+#include <QSet>
+#include <QStringList>
+#include <QVariant>
 
 #include "Message.hpp"
 
@@ -37,7 +40,12 @@ public slots:
     void setServerPort(quint16 port){ setServer(m_host, port); }
     void send(Message const &message);
 
+public:
+    QVariantList statistics() const;
+
 private:
+    void removeClient(Client *client);
+
     bool m_paused;
     QString m_host;
     quint16 m_port;
@@ -50,16 +58,36 @@ class Client : public QObject
 {
     Q_OBJECT
 public:
+    // Outbound data we'll let queue up for a client that isn't keeping
+    // up with us; past this, messages to the client are dropped.
+    static constexpr qint64 MAX_QUEUED_BYTES = 1024 * 1024;
+
+    // Largest length-prefixed frame we'll accept from a client.
+    static constexpr quint32 MAX_FRAME_BYTES = 1024 * 1024;
+
+    // Wire encodings a client can select with API.SET_ENCODING; JSON is
+    // newline-delimited, CBOR frames carry a 32-bit big-endian length.
+    enum class Encoding { Json, Cbor };
+
+    static QByteArray frame(Message const &message, Encoding encoding);
+
     explicit Client(MessageServer *server, QObject *parent = 0);
 
     bool isConnected() const { return m_connected; }
     void setSocket(qintptr handle);
     void send(const Message &message);
+    void send(QByteArray const &frame, qint64 id);
     void close();
     bool awaitingResponse(qint64 id){
         return id <= 0 || m_requests.contains(id);
     }
+    bool isSubscribed(Message const &message) const { return m_subscription.accepts(message); }
+    Encoding encoding() const { return m_encoding; }
+    qint64 queuedBytes() const;
+    QVariantMap statistics() const;
+
 signals:
+    void disconnected(Client *client);
 
 public slots:
     void setConnected(bool connected);
@@ -67,10 +95,33 @@ public slots:
     void readyRead();
 
 private:
+    // Unsolicited messages the client has asked to receive; an empty
+    // list or set matches anything, as does an offset range of -1.
+    struct Subscription
+    {
+        QStringList types;      // exact types, or prefixes ending in '*'
+        QSet<QString> callsigns;
+        int offsetMin = -1;
+        int offsetMax = -1;
+
+        bool accepts(Message const &message) const;
+        QVariantMap toVariantMap() const;
+        static Subscription fromVariantMap(QVariantMap const &params);
+    };
+
+    bool readFrame(QByteArray &frame);
+
     QMap<qint64, Message> m_requests;
+    Subscription m_subscription;
+    Encoding m_encoding;
     MessageServer * m_server;
     QTcpSocket * m_socket;
     bool m_connected;
+    QString m_peer;
+    qint64 m_bytesSent;
+    qint64 m_messagesSent;
+    qint64 m_messagesDropped;
+    qint64 m_maxQueuedBytes;
 };
 
 
@@ -1,14 +1,18 @@
 #include "Modulator.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
 #include <limits>
 #include <numbers>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QLoggingCategory>
 #include <QtMath>
-#include "commons.h"
 #include "DriftingDateTime.h"
 #include "JS8Submode.hpp"
-#include "mainwindow.h"
 #include "soundout.h"
+#include "TxFrameQueue.hpp"
 
 #include "moc_Modulator.cpp"
 
@@ -16,18 +20,202 @@ Q_DECLARE_LOGGING_CATEGORY(modulator_js8)
 
 namespace
 {
-  constexpr double TAU        = 2 * std::numbers::pi;
   constexpr auto   FRAME_RATE = 48000;
   constexpr auto   MS_PER_DAY = 86400000;
   constexpr auto   MS_PER_SEC = 1000;
+  constexpr double AMPLITUDE  = std::numeric_limits<qint16>::max();
+
+  // Fraction of a symbol over which the transmission fades out at its
+  // end, and, with shaping, over which the frequency moves from one tone
+  // to the next, half either side of the boundary between them.
+
+  constexpr double FADE_SYMBOLS  = 0.017;
+  constexpr double SHAPE_SYMBOLS = 0.25;
+
+  // Phase is a 32 bit accumulator, i.e., a full turn is 2^32; its top
+  // SINE_BITS index a table of sines, and the rest interpolate between
+  // adjacent entries, which is good to better than 16 bits.
+
+  constexpr int    SINE_BITS  = 10;
+  constexpr int    FRAC_BITS  = 32 - SINE_BITS;
+  constexpr double TURN       = 4294967296.0;
+
+  auto const SINE = []()
+  {
+    std::array<float, (1 << SINE_BITS) + 1> table;
+
+    for (std::size_t i = 0; i < table.size(); ++i)
+    {
+      table[i] = static_cast<float>(std::sin(2 * std::numbers::pi * i / (1 << SINE_BITS)));
+    }
+
+    return table;
+  }();
+
+  float
+  sine(quint32 const phase)
+  {
+    auto const index = phase >> FRAC_BITS;
+    auto const frac  = static_cast<float>(phase & ((1u << FRAC_BITS) - 1)) / (1u << FRAC_BITS);
+
+    return SINE[index] + (SINE[index + 1] - SINE[index]) * frac;
+  }
+
+  // Phase increment per frame for a frequency, in Hz.
+
+  qint64
+  step(double const frequency)
+  {
+    return std::llround(frequency / FRAME_RATE * TURN);
+  }
+
+  // Raised cosine, rising from 0 to 1 as x goes from 0 to 1, i.e., the
+  // square of the sine of a quarter turn's worth of x.
+
+  float
+  raised(double const x)
+  {
+    auto const s = sine(static_cast<quint32>(std::clamp(x, 0.0, 1.0) * (TURN / 4)));
+
+    return s * s;
+  }
+}
+
+namespace
+{
+  // Run the phase accumulator of a transmission over frames [from, to),
+  // at the audio frequency provided, starting from the phase reached at
+  // from, and return the phase reached at to. Given a frame buffer, the
+  // transmission is sized to fit, and the samples written to it. The
+  // audio frequency is a constant added to each tone, so the phase steps
+  // are those of the tones alone, plus that of the audio frequency.
+
+  quint32
+  synthesizeFrame(std::vector<qint16>       * frame,
+                  QList<int>          const & symbols,
+                  qint64              const   symbolFrames,
+                  double              const   toneSpacing,
+                  double              const   frequency,
+                  bool                const   shaping,
+                  qint64              const   from,
+                  qint64              const   to,
+                  quint32                     phase)
+  {
+    auto const count  = static_cast<qint64>(symbols.size());
+    auto const frames = count * symbolFrames;
+    auto const fade   = std::max(qint64{1}, std::llround(FADE_SYMBOLS  * symbolFrames));
+    auto const shape  = shaping ? std::llround(SHAPE_SYMBOLS * symbolFrames) : 0;
+    auto const offset = step(frequency);
+    auto const end    = std::min(to, frames);
+
+    std::vector<qint64> tones(count);
+
+    for (qint64 k = 0; k < count; ++k) tones[k] = step(symbols[k] * toneSpacing);
+
+    if (frame) frame->resize(frames);
+
+    for (qint64 i = from; i < end; ++i)
+    {
+      auto const k    = i / symbolFrames;
+      auto const j    = i % symbolFrames;
+      auto       tone = tones[k];
+
+      if (shape)
+      {
+        if (k > 0 && j < shape / 2)
+        {
+          tone = tones[k - 1] + std::llround((tones[k] - tones[k - 1]) * raised((j + shape / 2.0) / shape));
+        }
+        else if (k < count - 1 && j >= symbolFrames - shape / 2)
+        {
+          tone = tones[k] + std::llround((tones[k + 1] - tones[k]) * raised((j - (symbolFrames - shape / 2.0)) / shape));
+        }
+      }
+
+      phase += static_cast<quint32>(offset + tone);
+
+      if (!frame) continue;
+
+      auto const amplitude = i < frames - fade ? AMPLITUDE : AMPLITUDE * raised(static_cast<double>(frames - i) / fade);
+
+      (*frame)[i] = static_cast<qint16>(std::lround(amplitude * sine(phase)));
+    }
+
+    return phase;
+  }
+}
+
+std::vector<qint16>
+Modulator::synthesize(QList<int> const & tones,
+                      int        const   submode,
+                      double     const   frequency,
+                      bool       const   shaping)
+{
+  std::vector<qint16> frame;
+
+  synthesizeFrame(&frame,
+                  tones,
+                  4 * JS8::Submode::samplesForOneSymbol(submode),
+                  JS8::Submode::toneSpacing(submode),
+                  frequency,
+                  shaping,
+                  0,
+                  std::numeric_limits<qint64>::max(),
+                  0);
+  return frame;
+}
+
+// Re-synthesize the transmission from the frame index provided on, at the
+// audio frequency now in play. The frames from the last render point up
+// to it were made at the audio frequency in play then; run the phase on
+// over them, from where it stood at the last render point, to find where
+// to carry on from.
+
+void
+Modulator::render(qint64 const from)
+{
+  auto const phase = synthesizeFrame(nullptr,
+                                     m_tones,
+                                     m_symbolFrames,
+                                     m_toneSpacing,
+                                     m_frameFrequency,
+                                     m_frameShaping,
+                                     m_renderFrom,
+                                     from,
+                                     m_renderPhase);
+
+  synthesizeFrame(&m_frame,
+                  m_tones,
+                  m_symbolFrames,
+                  m_toneSpacing,
+                  m_audioFrequency,
+                  m_frameShaping,
+                  from,
+                  std::numeric_limits<qint64>::max(),
+                  phase);
+
+  m_renderFrom     = from;
+  m_renderPhase    = phase;
+  m_frameFrequency = m_audioFrequency;
+}
+
+void
+Modulator::setAudioFrequency(double const audioFrequency)
+{
+  m_audioFrequency = audioFrequency;
+
+  if (m_tuning || isIdle() || m_frame.empty() || m_audioFrequency == m_frameFrequency) return;
+
+  render(m_ic);
 }
 
 void
-Modulator::start(double        const frequency,
-                 int           const submode,
-                 double        const txDelay,
-                 SoundOutput * const stream,
-                 Channel       const channel)
+Modulator::start(double             const   frequency,
+                 int                const   submode,
+                 double             const   txDelay,
+                 QList<int>         const & tones,
+                 SoundOutput      * const   stream,
+                 Channel            const   channel)
 {
   Q_ASSERT (stream);
 
@@ -41,16 +229,45 @@ Modulator::start(double        const frequency,
       stop();
   }
 
-  m_quickClose      = false;
-  m_audioFrequency  = frequency;
-  m_nsps            = JS8::Submode::samplesForOneSymbol(submode);
-  m_toneSpacing     = JS8::Submode::toneSpacing(submode);
-  m_isym0           = std::numeric_limits<unsigned>::max();
-  m_amp             = std::numeric_limits<qint16>::max();
-  m_audioFrequency0 = 0.0;
-  m_phi             = 0.0;
-  m_silentFrames    = 0;
-  m_ic              = 0;
+  m_quickClose     = false;
+  m_audioFrequency = frequency;
+  m_frameFrequency = frequency;
+  m_symbolFrames   = 4 * JS8::Submode::samplesForOneSymbol(submode);
+  m_toneSpacing    = JS8::Submode::toneSpacing(submode);
+  m_tones          = tones;
+  m_frameShaping   = m_shaping.load();
+  m_periodMS       = JS8::Submode::period(submode) * MS_PER_SEC;
+  m_phase          = 0;
+  m_renderPhase    = 0;
+  m_renderFrom     = 0;
+  m_silentFrames   = 0;
+  m_ic             = 0;
+
+  // Take the transmission as synthesized ahead of time, if it was, or
+  // synthesize it now, so that there's nothing left to do while audio is
+  // being pulled from us but to copy it out. Either way, it's done before
+  // working out where in the period we are.
+
+  bool   ready    = false;
+  qint64 renderUS = 0;
+
+  if (m_tuning)
+  {
+    m_frame.clear();
+  }
+  else if (auto frame = m_frames ? m_frames->take({tones, submode, frequency, m_frameShaping})
+                                 : std::nullopt)
+  {
+    m_frame = std::move(*frame);
+    ready   = true;
+  }
+  else
+  {
+    QElapsedTimer timer;
+    timer.start();
+    render(0);
+    renderUS = timer.nsecsElapsed() / 1000;
+  }
 
   // If we're not tuning, then we'll need to figure out exactly when we
   // should start transmitting; this will depend on the submode in play.
@@ -89,6 +306,14 @@ Modulator::start(double        const frequency,
                                  << "ms late into transmission, cutting away initial symbol(s).";
         m_ic = (periodOffsetMS - startDelayMS) * FRAME_RATE / MS_PER_SEC;
     }
+
+    if (m_frames)
+    {
+      m_frames->started(inTxDelayBeforePeriodStart ? qint64{periodOffsetMS} - periodMS : qint64{periodOffsetMS},
+                        startDelayMS <= periodOffsetMS && !inTxDelayBeforePeriodStart,
+                        ready,
+                        renderUS);
+    }
   } else {
       qCDebug(modulator_js8) << "Modulator finds it is tuning.";
   }
@@ -149,6 +374,8 @@ Modulator::readData(char * const data,
   qint16       *       samples         = reinterpret_cast<qint16 *>(data);
   qint16 const * const samplesEnd      = samples + maxFrames * (bytesPerFrame() / sizeof(qint16));
 
+  if (m_health && !isIdle()) m_health->delivered(maxFrames, FRAME_RATE, m_periodMS);
+
   switch (m_state.load())
   {
     case State::Synchronizing:
@@ -175,47 +402,40 @@ Modulator::readData(char * const data,
 
     case State::Active:
     {
-      // Fade out parameters; no fade out during tuning.
-
-      unsigned int const i0 = (m_tuning ? 9999 : (JS8_NUM_SYMBOLS - 0.017) * 4.0) * m_nsps;
-      unsigned int const i1 = (m_tuning ? 9999 :  JS8_NUM_SYMBOLS          * 4.0) * m_nsps;
-
-      while (samples != samplesEnd && m_ic < i1)
+      if (m_tuning)
       {
-        unsigned int const isym = m_tuning ? 0 : m_ic / (4.0 * m_nsps);
+        auto const increment = static_cast<quint32>(step(m_audioFrequency));
 
-        if (isym != m_isym0 || m_audioFrequency != m_audioFrequency0)
+        while (samples != samplesEnd)
         {
-          double const toneFrequency = m_audioFrequency + itone[isym] * m_toneSpacing;
-
-          m_dphi       = TAU * toneFrequency / FRAME_RATE;
-          m_isym0      = isym;
-          m_audioFrequency0 = m_audioFrequency;
+          m_phase += increment;
+          samples  = load(qRound(AMPLITUDE * sine(m_phase)), samples);
+          ++framesGenerated;
         }
 
-        m_phi += m_dphi;
+        return framesGenerated * bytesPerFrame();
+      }
 
-        if (m_phi > TAU) m_phi -= TAU;
-        if (m_ic  > i0)  m_amp  = 0.98 * m_amp;
-        if (m_ic  > i1)  m_amp  = 0.0;
+      // Copy out as much of the transmission as is left and will fit.
 
-        samples = load(qRound(m_amp * qSin(m_phi)), samples);
+      auto const size   = static_cast<qint64>(m_frame.size());
+      auto const frames = std::clamp(size - m_ic, qint64{0}, maxFrames - framesGenerated);
+      auto const source = m_frame.data() + std::min(m_ic, size);
 
-        ++framesGenerated;
-        ++m_ic;
+      if (channel() == Mono)
+      {
+        std::memcpy(samples, source, frames * sizeof(qint16));
+        samples += frames;
       }
-
-      if (m_amp == 0.0)
+      else
       {
-        m_state.store(State::Idle);
-        return framesGenerated * bytesPerFrame();
-        m_phi = 0.0;
+        for (qint64 i = 0; i < frames; ++i) samples = load(source[i], samples);
       }
 
-      m_audioFrequency0 = m_audioFrequency;
+      framesGenerated += frames;
+      m_ic            += frames;
 
-      // Done for this chunk; continue on the next call. Pad the
-      // block with silence.
+      // Once it's all been sent, pad with silence until we're stopped.
 
       while (samples != samplesEnd)
       {
@@ -2,16 +2,32 @@
 #define MODULATOR_HPP__
 
 #include <QAudio>
+#include <QList>
 #include <QPointer>
+#include <atomic>
+#include <vector>
 #include "AudioDevice.hpp"
+#include "AudioHealth.hpp"
 
 class SoundOutput;
+class TxFrameQueue;
 
 /**
  * Audio device that generates PCM audio frames that encode a message.
  *
- * Output can be muted while underway, preserving waveform timing when
- * transmission is resumed.
+ * The whole transmission is synthesized into a buffer when it's started,
+ * from the tones provided, by a phase accumulator and a sine table, so
+ * that reading audio is a matter of copying samples out of the buffer.
+ * Tones are phase-continuous; optionally, the change of frequency from
+ * one symbol to the next is shaped as a raised cosine, rather than made
+ * at once. A change of audio frequency while underway re-synthesizes
+ * whatever is left to send, carrying on from the phase already reached.
+ *
+ * Tuning sends a single tone at the audio frequency, from the same sine
+ * table, for as long as it lasts.
+ *
+ * Given a frame queue, a transmission synthesized ahead of time by it is
+ * used if it matches what's to be sent, and each start is reported to it.
  *
  * This is intended to run in a thread different from the GUI thread.
  * It is **not** generally thread-safe, see remarks below.
@@ -45,28 +61,63 @@ public:
    */
   bool isIdle() const { return m_state.load() == State::Idle; }
 
+  /**
+   * Whether the change of frequency between symbols is shaped.
+   *
+   * This method is thread-safe, i.e., can be called from a different thread.
+   */
+  bool symbolShaping() const { return m_shaping.load(); }
+
+  /**
+   * Synthesizes a transmission of the tones provided, as start() would;
+   * this is a pure function, and so thread-safe.
+   */
+  static std::vector<qint16> synthesize(QList<int> const & tones,
+                                        int                submode,
+                                        double             frequency,
+                                        bool               shaping);
+
   // Manipulators
 
   void close() override;
 
+  /**
+   * Sets the queue of transmissions synthesized ahead of time; this must
+   * be done before the device is moved to its thread, and the queue must
+   * outlive it.
+   */
+  void setFrameQueue(TxFrameQueue * const frames) { m_frames = frames; }
+
+  /**
+   * Sets where to record how audio is being pulled from us; as with the
+   * frame queue, before the device is moved to its thread.
+   */
+  void setHealth(AudioHealth::Stream * const health) { m_health = health; }
+
+  /**
+   * Whether to shape the change of frequency between symbols; takes
+   * effect with the next transmission started.
+   *
+   * This method is thread-safe, i.e., can be called from a different thread.
+   */
+  void setSymbolShaping(bool const shaping) { m_shaping.store(shaping); }
+
   /**
    * Sets the audio frequency.
    *
    * This is **not** by itself thread-safe, but ok if fed
    * via the Qt signalling mechanism.
    */
-  Q_SLOT void setAudioFrequency(double const audioFrequency)
-  {
-    m_audioFrequency = audioFrequency;
-  }
+  Q_SLOT void setAudioFrequency(double audioFrequency);
 
   // Slots
 
-  Q_SLOT void start(double        audioFrequency,
-                    int           submode,
-                    double        tx_delay,
-                    SoundOutput * stream,
-                    Channel       channel);
+  Q_SLOT void start(double             audioFrequency,
+                    int                submode,
+                    double             tx_delay,
+                    QList<int> const & tones,
+                    SoundOutput      * stream,
+                    Channel            channel);
   Q_SLOT void stop(bool quick = false);
   Q_SLOT void tune(bool state = true);
 
@@ -95,22 +146,32 @@ protected:
 
 private:
 
+  // Synthesize the transmission from the frame index provided on.
+
+  void render(qint64 from);
+
   // Data members
 
   QPointer<SoundOutput> m_stream;
-  std::atomic<State>    m_state      = State::Idle;
-  bool                  m_quickClose = false;
-  bool                  m_tuning     = false;
+  TxFrameQueue        * m_frames       = nullptr;
+  AudioHealth::Stream * m_health       = nullptr;
+  std::atomic<State>    m_state        = State::Idle;
+  std::atomic<bool>     m_shaping      = false;
+  bool                  m_quickClose   = false;
+  bool                  m_tuning       = false;
+  bool                  m_frameShaping = false;
+  qint64                m_periodMS     = 0;
   double                m_audioFrequency;
-  double                m_audioFrequency0;
+  double                m_frameFrequency;
   double                m_toneSpacing;
-  double                m_phi;
-  double                m_dphi;
-  double                m_amp;
-  double                m_nsps;
+  QList<int>            m_tones;
+  std::vector<qint16>   m_frame;
+  qint64                m_symbolFrames;
   qint64                m_silentFrames;
-  unsigned              m_ic;
-  unsigned              m_isym0;
+  qint64                m_ic;
+  qint64                m_renderFrom;
+  quint32               m_renderPhase;
+  quint32               m_phase;
 };
 
 #endif
@@ -9,17 +9,14 @@
 // Reports will be sent in batch mode every 5 minutes.
 
 #include <algorithm>
-#include <ctime>
 #include <cstddef>
 #include <QByteArray>
 #include <QDataStream>
 #include <QDateTime>
 #include <QDir>
 #include <QFile>
-#include <QHash>
 #include <QLoggingCategory>
 #include <QObject>
-#include <QQueue>
 #include <QRandomGenerator>
 #include <QSharedPointer>
 #include <QString>
@@ -30,6 +27,7 @@
 #include "Bands.hpp"
 #include "Configuration.hpp"
 #include "DriftingDateTime.h"
+#include "SpotQueue.hpp"
 #include "pimpl_impl.hpp"
 
 #include "moc_PSKReporter.cpp"
@@ -50,9 +48,20 @@ namespace
   constexpr int              JITTER_MAX  		= 5;    // in seconds
   constexpr int              FLUSH_INTERVAL     = 125;  // in send intervals
   constexpr qsizetype        MAX_STRING_LENGTH  = 254;  // PSK reporter spec
-  constexpr std::time_t      CACHE_TIMEOUT      = 3600; // in seconds
+  constexpr qint64           CACHE_TIMEOUT      = 3600; // in seconds
   constexpr int              MIN_PAYLOAD_LENGTH = 508;
   constexpr int              MAX_PAYLOAD_LENGTH = 10000;
+
+  // Spots carry the time they were heard, so they're good for a while
+  // yet should we be unable to send them for a time.
+
+  constexpr SpotQueue::Limits QUEUE_LIMITS
+  {
+    2000,           // capacity, records
+    CACHE_TIMEOUT,  // ttl, seconds
+    6 * 3600,       // age, seconds
+    1024 * 1024     // spill, bytes
+  };
 }
 
 /******************************************************************************/
@@ -176,6 +185,38 @@ namespace
     out.device()->seek(pos);
   }
 
+  // Encode a spot as a record of the sender information set described
+  // by the descriptor below, unpadded; records are padded as a set.
+
+  QByteArray
+  encodeSpot(QString          const & call,
+             QString          const & grid,
+             int              const   snr,
+             Radio::Frequency const   freq,
+             QString          const & mode,
+             QDateTime        const & time)
+  {
+    QByteArray  record;
+    QDataStream out {&record, QIODevice::WriteOnly};
+
+    // Sender information
+    writeUtfString(out, call);
+    out // BigEndian
+      << static_cast<quint8>(freq >> 32)
+      << static_cast<quint8>(freq >> 24)
+      << static_cast<quint8>(freq >> 16)
+      << static_cast<quint8>(freq >>  8)
+      << static_cast<quint8>(freq)
+      << static_cast<qint8> (snr);
+    writeUtfString(out, mode);
+    writeUtfString(out, grid);
+    out
+      << quint8 (1u)          // REPORTER_SOURCE_AUTOMATIC
+      << static_cast<quint32>(time.toSecsSinceEpoch());
+
+    return record;
+  }
+
   // Append a Sender Information Descriptor to the provided message.
 
   void
@@ -256,18 +297,6 @@ class PSKReporter::impl final : public QObject
 
 public:
 
-  // POD describing a spot; we queue these for later delivery.
-
-  struct Spot
-  {
-    QString          call_;
-    QString          grid_;
-    int              snr_;
-    Radio::Frequency freq_;
-    QString          mode_;
-    QDateTime        time_;
-  };
-
   // Data members
 
   PSKReporter                   * self_;
@@ -280,11 +309,7 @@ public:
   QString                         rx_call_;
   QString                         rx_grid_;
   QString                         rx_ant_;
-  QByteArray                      tx_data_;
-  QByteArray                      tx_residue_;
-  QByteArray                      payload_;
-  QQueue<Spot>                    spots_;
-  QHash<QString, std::time_t>     calls_;
+  SpotQueue                       spots_;
   quint32                         observation_id_   = QRandomGenerator::global()->generate();
   quint32                         sequence_number_  = 0u;
   unsigned                        send_descriptors_ = 0u;
@@ -302,6 +327,7 @@ public:
     , prog_id_          {program_info}
     , report_timer_     {this}
     , descriptor_timer_ {this}
+    , spots_            {"PSK", QUEUE_LIMITS}
   {
     // Attempt to load up the eclipse dates. Not a big deal if this fails;
     // just means that we won't bypass the spot cache during eclipse periods.
@@ -399,7 +425,7 @@ public:
         break;
 
       default:
-        spots_.clear();
+        spots_.setOnline(false, DriftingDateTime::currentSecsSinceEpoch());
         Q_EMIT self_->errorOccurred(socket_->errorString ());
         break;
     }
@@ -518,104 +544,73 @@ public:
   {
     if (QAbstractSocket::ConnectedState != socket_->state()) return;
 
-    QDataStream message {&payload_, QIODevice::WriteOnly | QIODevice::Append};
-    QDataStream tx_out  {&tx_data_, QIODevice::WriteOnly | QIODevice::Append};
+    auto const now = DriftingDateTime::currentSecsSinceEpoch();
+
+    spots_.setOnline(true, now);
+
+    // Unless we're flushing, hold on to spots until we've enough of them
+    // to be worth a datagram; anything still spilled is waiting on those
+    // in memory, and they've waited long enough.
+
+    auto const flush = flushing() || send_residue;
+
+    if (!flush && !spots_.spilled() && spots_.bytes() <= MIN_PAYLOAD_LENGTH) return;
+
+    // Each datagram holds the header, descriptors if they're due, and the
+    // receiver information, followed by a sender information set of as
+    // many spots as will fit; when flushing, we'll send one even if we've
+    // no spots to put in it.
 
-    if (!payload_.size())
+    do
     {
+      QByteArray  payload;
+      QDataStream message {&payload, QIODevice::WriteOnly};
+
       // Build header, optional descriptors, and receiver information
       build_preamble(message);
-    }
 
-    auto flush = flushing() || send_residue;
-    while (spots_.size() || flush)
-    {
-      if (!payload_.size())
-      {
-        // Build header, optional descriptors, and receiver information
-        build_preamble (message);
-      }
+      // Leave room for the set header, and for padding the set out.
 
-      if (!tx_data_.size () && (spots_.size () || tx_residue_.size ()))
+      auto const room    = MAX_PAYLOAD_LENGTH - payload.size() - 2 * qsizetype(sizeof(quint16)) - 3;
+      auto const records = spots_.take(room, now);
+
+      if (!records.isEmpty())
       {
+        QByteArray  tx;
+        QDataStream tx_out {&tx, QIODevice::WriteOnly};
+
         // Set Header
         tx_out
           << quint16 (0x50e3)     // Template ID
           << quint16 (0u);        // Length (place-holder)
-      }
-
-      // insert any residue
-      if (tx_residue_.size())
-      {
-        tx_out.writeRawData(tx_residue_, tx_residue_.size());
-        tx_residue_.clear();
-      }
 
-      qCDebug(pskreporter_js8) << "[PSK]pending spots:" << spots_.size();
-      while (spots_.size() || flush)
-      {
-        auto tx_data_size = tx_data_.size();
-        if (spots_.size())
+        for (auto const & record : records)
         {
-          auto const& spot = spots_.dequeue();
-
-          // Sender information
-          writeUtfString(tx_out, spot.call_);
-          tx_out // BigEndian
-            << static_cast<quint8>(spot.freq_ >> 32)
-            << static_cast<quint8>(spot.freq_ >> 24)
-            << static_cast<quint8>(spot.freq_ >> 16)
-            << static_cast<quint8>(spot.freq_ >>  8)
-            << static_cast<quint8>(spot.freq_)
-            << static_cast<qint8> (spot.snr_);
-          writeUtfString(tx_out, spot.mode_);
-          writeUtfString(tx_out, spot.grid_);
-          tx_out
-            << quint8 (1u)          // REPORTER_SOURCE_AUTOMATIC
-            << static_cast<quint32>(spot.time_.toSecsSinceEpoch());
+          tx_out.writeRawData(record.data, record.data.size());
         }
 
-        auto len = payload_.size() + tx_data_.size();
-        len     += num_pad_bytes(tx_data_.size());
-        len     += num_pad_bytes(len);
+        // insert Length
+        set_length(tx_out, tx);
+        message.writeRawData(tx, tx.size());
+      }
 
-        if (len > MAX_PAYLOAD_LENGTH // our upper datagram size limit
-            || (!spots_.size() && len > MIN_PAYLOAD_LENGTH) // spots drained and above lower datagram size limit
-            || (flush && !spots_.size())) // send what we have, possibly no spots
-        {
-          if (tx_data_.size())
-          {
-            if (len <= MAX_PAYLOAD_LENGTH)
-            {
-              tx_data_size = tx_data_.size();
-            }
-            QByteArray tx {tx_data_.left (tx_data_size)};
-            QDataStream out {&tx, QIODevice::WriteOnly | QIODevice::Append};
-            // insert Length
-            set_length(out, tx);
-            message.writeRawData(tx, tx.size());
-          }
+      // insert Length and Export Time
+      set_length(message, payload);
+      message.device()->seek(2 * sizeof(quint16));
+      message << static_cast<quint32>(DriftingDateTime::currentSecsSinceEpoch());
 
-          // insert Length and Export Time
-          set_length(message, payload_);
-          message.device()->seek(2 * sizeof(quint16));
-          message << static_cast<quint32>(DriftingDateTime::currentSecsSinceEpoch());
-
-          // Send data to PSK Reporter site
-          socket_->write (payload_); // TODO: handle errors
-          qCDebug(pskreporter_js8) << "[PSK]sent spots";
-          flush = false;    // break loop
-          message.device()->seek(0u);
-          payload_.clear();  // Fresh message
-          // Save unsent spots
-          tx_residue_ = tx_data_.right(tx_data_.size() - tx_data_size);
-          tx_out.device()->seek(0u);
-          tx_data_.clear();
-          break;
-        }
+      // Send data to PSK Reporter site
+      if (socket_->write(payload) == -1)
+      {
+        qCWarning(pskreporter_js8) << "[PSK]send failed:" << socket_->errorString();
+        spots_.failed(records);
+        break;
       }
-      qCDebug(pskreporter_js8) << "[PSK]remaining spots:" << spots_.size();
+
+      spots_.sent(records.size());
+      qCDebug(pskreporter_js8) << "[PSK]sent spots:" << records.size();
     }
+    while (!spots_.isEmpty());
   }
 
   bool
@@ -665,6 +660,12 @@ PSKReporter::start()
   }
 }
 
+QVariantMap
+PSKReporter::stats() const
+{
+  return m_->spots_.stats();
+}
+
 void
 PSKReporter::reconnect()
 {
@@ -705,57 +706,17 @@ PSKReporter::addRemoteStation(QString           const & call,
       reconnect();
     }
 
-    // If this call+band combination is not already in the cache, or it's there but expired, or an eclipse is active,
-    // (we allow all spots through +/- 6 hours around an eclipse for the HamSCI group) then we're going to send
-    // the spot; cache the fact that we've done so, either by adding a new cache
-    // entry or updating an existing one with an updated time value.
-
-	// Get the frequency band name and concatenate it with the callsign to create the cache key
-	// so we can spot cached calls if they switch bands
-	auto const band = m_->config_->bands()->find(freq);
-	auto const cache_key = call + "_" + band;
-
-    const std::time_t now = std::time(nullptr);
-
-	// Determine cache expiration time by subtracting CACHE_TIMEOUT from the current time
-	const std::time_t cache_expiration_time = now - CACHE_TIMEOUT;
-
-	auto const it = m_->calls_.find(cache_key);
-
-	bool notFound     = (it == m_->calls_.end());
-	bool expired      = (!notFound && it.value() < cache_expiration_time);
-	bool eclipse      = m_->eclipse_active(utcTimestamp);
-
-	if (notFound || expired || eclipse)
-	{
-	  m_->spots_.enqueue({call, grid, snr, freq, mode, utcTimestamp});
-	  m_->calls_.insert(cache_key, now);
-	}
-	else // cache exists AND not expired AND no eclipse active
-	{
-	  // Iterate through the queued spots from last to first, if we find one with a matching call and band (we should), replace it with
-	  // a new spot with updated details and bump the cache time
-	  for (qsizetype i = m_->spots_.size(); i-- > 0;)
-	  {
-		auto const& cachedSpot		= m_->spots_[i];
-		auto const cachedSpotBand	= m_->config_->bands()->find(cachedSpot.freq_);
-
-		if (cachedSpot.call_ == call && cachedSpotBand == band)
-		{
-		  m_->spots_[i] = {call, grid, snr, freq, mode, utcTimestamp};
-		  m_->calls_.insert(cache_key, now);
-		  break;
-		}
-	  }
-	}
-
-    // Perform cache cleanup; anything that's been around for more than twice the cache
-    // timeout period can go.
-
-    m_->calls_.removeIf([now](auto const it)
-    {
-      return now - it.value() > (CACHE_TIMEOUT * 2);
-    });
+    // Spots of a call on a band are sent once in the cache timeout period;
+    // the queue brings a spot that's still waiting to go up to date, and
+    // drops one that's already gone, unless an eclipse is active, around
+    // which we allow all spots through, +/- 6 hours, for the HamSCI group.
+
+    auto const band = m_->config_->bands()->find(freq);
+    auto const key  = m_->eclipse_active(utcTimestamp) ? QString() : call + "_" + band;
+
+    m_->spots_.push(encodeSpot(call, grid, snr, freq, mode, utcTimestamp),
+                    DriftingDateTime::currentSecsSinceEpoch(),
+                    key);
   }
 }
 
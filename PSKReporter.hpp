@@ -2,6 +2,7 @@
 #define PSK_REPORTER_HPP_
 
 #include <QObject>
+#include <QVariantMap>
 #include "Radio.hpp"
 #include "pimpl_h.hpp"
 
@@ -40,6 +41,12 @@ public:
   //
   void sendReport(bool last = false);
 
+  //
+  // Counters for the queue of spots waiting to be sent; callable from
+  // any thread
+  //
+  QVariantMap stats() const;
+
   Q_SIGNAL void errorOccurred (QString const& reason);
 
 private:
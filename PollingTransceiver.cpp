@@ -1,5 +1,6 @@
 #include "PollingTransceiver.hpp"
 
+#include <algorithm>
 #include <exception>
 
 #include <QObject>
@@ -11,16 +12,36 @@
 namespace
 {
   unsigned const polls_to_stabilize {3};
+
+  // polls without change before the interval is backed off, and how
+  // far it can be backed off, as a multiple of the poll interval
+  unsigned const polls_to_back_off {5};
+  int const max_back_off {4};
+
+  // poll interval while waiting for a change to stabilise, if it's
+  // shorter than the poll interval, in milliseconds
+  int const stabilizing_interval {500};
 }
 
 PollingTransceiver::PollingTransceiver (int poll_interval, QObject * parent)
   : TransceiverBase {parent}
   , interval_ {poll_interval * 1000}
+  , current_ {interval_}
   , poll_timer_ {nullptr}
+  , step_ {0}
+  , generation_ {0}
+  , polling_ {false}
+  , stable_polls_ {0}
   , retries_ {0}
 {
 }
 
+bool PollingTransceiver::poll_step (unsigned)
+{
+  poll ();
+  return false;
+}
+
 void PollingTransceiver::start_timer ()
 {
   if (interval_)
@@ -30,11 +51,14 @@ void PollingTransceiver::start_timer ()
           poll_timer_ = new QTimer {this}; // pass ownership to
                                            // QObject which handles
                                            // destruction for us
+          poll_timer_->setSingleShot (true);
 
           connect (poll_timer_, &QTimer::timeout, this,
                    &PollingTransceiver::handle_timeout);
         }
-      poll_timer_->start (interval_);
+      current_ = interval_;
+      stable_polls_ = 0;
+      schedule ();
     }
   else
     {
@@ -44,12 +68,56 @@ void PollingTransceiver::start_timer ()
 
 void PollingTransceiver::stop_timer ()
 {
+  ++generation_;                // abandon any poll under way
+  polling_ = false;
   if (poll_timer_)
     {
       poll_timer_->stop ();
     }
 }
 
+// Arm the timer for the next poll; if one is under way, it'll do this
+// when it's done.
+void PollingTransceiver::schedule ()
+{
+  if (poll_timer_ && !polling_)
+    {
+      poll_timer_->start (retries_ ? std::min (interval_, stabilizing_interval) : current_);
+    }
+}
+
+// A command has been sent to the rig, so any poll under way is likely
+// to be of a state that no longer holds; abandon it, and poll again at
+// the full rate until things settle down.
+void PollingTransceiver::tighten ()
+{
+  current_ = interval_;
+  stable_polls_ = 0;
+  if (poll_timer_ && (poll_timer_->isActive () || polling_))
+    {
+      ++generation_;
+      polling_ = false;
+      schedule ();
+    }
+}
+
+// Back off the poll interval while nothing is changing, other than
+// while transmitting, and return to the full rate as soon as something
+// does change.
+void PollingTransceiver::adapt (bool changed)
+{
+  if (changed || state ().ptt ())
+    {
+      current_ = interval_;
+      stable_polls_ = 0;
+    }
+  else if (++stable_polls_ >= polls_to_back_off)
+    {
+      current_ = std::min (current_ * 2, interval_ * max_back_off);
+      stable_polls_ = 0;
+    }
+}
+
 void PollingTransceiver::do_post_start ()
 {
   start_timer ();
@@ -82,6 +150,7 @@ void PollingTransceiver::do_post_frequency (Frequency f, MODE m)
           next_state_.mode (m);
         }
       retries_ = polls_to_stabilize;
+      tighten ();
     }
 }
 
@@ -94,6 +163,7 @@ void PollingTransceiver::do_post_tx_frequency (Frequency f, MODE)
       next_state_.tx_frequency (f);
       next_state_.split (f); // setting non-zero TX frequency means split
       retries_ = polls_to_stabilize;
+      tighten ();
     }
 }
 
@@ -105,6 +175,7 @@ void PollingTransceiver::do_post_mode (MODE m)
       // update expected state with new mode and set poll count
       next_state_.mode (m);
       retries_ = polls_to_stabilize;
+      tighten ();
     }
 }
 
@@ -116,6 +187,7 @@ void PollingTransceiver::do_post_ptt (bool p)
       next_state_.ptt (p);
       retries_ = polls_to_stabilize;
       //retries_ = 0;             // fast feedback on PTT
+      tighten ();
     }
 }
 
@@ -168,13 +240,45 @@ void PollingTransceiver::do_sync (bool force_signal, bool no_poll)
 
 void PollingTransceiver::handle_timeout ()
 {
+  polling_ = true;
+  step_ = 0;
+  continue_poll (++generation_);
+}
+
+// Perform the next step of the poll under way, unless it has been
+// abandoned, returning to the event loop between steps so that any
+// commands that have arrived in the meantime go first. When the last
+// step is done, signal any change, as do_sync() would, and schedule
+// the next poll.
+void PollingTransceiver::continue_poll (unsigned generation)
+{
+  if (!polling_ || generation != generation_)
+    {
+      return;
+    }
+
   QString message;
 
   // we must catch all exceptions here since we are called by Qt and
   // inform our parent of the failure via the offline() message
   try
     {
-      do_sync ();
+      bool more;
+      {
+        timed t {Operation::POLL};
+        more = poll_step (step_++);
+      }
+      if (more)
+        {
+          QTimer::singleShot (0, this, [this, generation] {continue_poll (generation);});
+          return;
+        }
+
+      polling_ = false;
+      bool changed {retries_ || state () != last_signalled_state_};
+      do_sync (false, true);    // we've just polled
+      adapt (changed);
+      schedule ();
     }
   catch (std::exception const& e)
     {
@@ -186,6 +290,7 @@ void PollingTransceiver::handle_timeout ()
     }
   if (!message.isEmpty ())
     {
+      polling_ = false;
       offline (message);
     }
 }
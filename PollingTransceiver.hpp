@@ -17,7 +17,15 @@ class QTimer;
 //
 //  Implements the TransceiverBase post  action interface and provides
 //  the abstract  poll() operation  for sub-classes to  implement. The
-//  poll operation is invoked every poll_interval seconds.
+//  poll operation is invoked every poll_interval seconds while things
+//  are changing, backing off to  a few times that while the rig state
+//  is stable, and tightening up again on QSY or PTT changes.
+//
+//  Sub-classes may  break a poll  into steps of  one rig query  each,
+//  with poll_step(); between  steps we return to the  event loop, so
+//  commands  waiting to  be sent,  PTT in  particular, go  ahead of the
+//  rest of the poll rather than waiting behind all of it. A command
+//  abandons any poll under way, and one is started afresh after it.
 //
 // Responsibilities
 //
@@ -45,6 +53,11 @@ protected:
   // in a non-intrusive manner.
   virtual void poll () = 0;
 
+  // Sub-classes that can break poll() into steps implement this to
+  // perform the step provided, counting from zero, returning true if
+  // there are more steps to come. By default, a poll is one step.
+  virtual bool poll_step (unsigned step);
+
   void do_post_start () override final;
   void do_post_stop () override final;
   void do_post_frequency (Frequency, MODE) override final;
@@ -56,12 +69,22 @@ protected:
 private:
   void start_timer ();
   void stop_timer ();
+  void schedule ();
+  void tighten ();
+  void adapt (bool changed);
 
   Q_SLOT void handle_timeout ();
+  void continue_poll (unsigned generation);
 
   int interval_;    // polling interval in milliseconds
+  int current_;     // current interval, backed off from the above
   QTimer * poll_timer_;
 
+  unsigned step_;               // next step of the poll under way
+  unsigned generation_;         // poll under way, bumped to abandon it
+  bool polling_;                // a poll is under way
+  unsigned stable_polls_;       // polls without change at this interval
+
   // keep a record of the last state signalled so we can elide
   // duplicate updates
   Transceiver::TransceiverState last_signalled_state_;
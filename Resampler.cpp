@@ -0,0 +1,159 @@
+#include "Resampler.hpp"
+#include <numbers>
+#include <numeric>
+#include <QHash>
+#include <QLoggingCategory>
+#include <QMutex>
+#include <QMutexLocker>
+
+Q_DECLARE_LOGGING_CATEGORY(resampler_js8)
+
+/******************************************************************************/
+// Constants
+/******************************************************************************/
+
+namespace
+{
+  // Lowpass filter specification for resampling; edges of the passband
+  // and stopband, in Hz, and attenuation in the stopband, in dB. Edges
+  // are as they were for the fixed 48kHz filter we used to have, which
+  // attenuated by only 40dB.
+
+  constexpr double PASSBAND_HZ    = 4500.0;
+  constexpr double STOPBAND_HZ    = 6000.0;
+  constexpr double ATTENUATION_DB = 60.0;
+
+  // Most phases we'll put in a filter bank; enough for 44.1kHz and its
+  // multiples, which need 40.
+
+  constexpr int MAX_PHASES = 160;
+
+  // Highest rate we'll accept.
+
+  constexpr int MAX_RATE = 384000;
+}
+
+/******************************************************************************/
+// Local Routines
+/******************************************************************************/
+
+namespace
+{
+  // Modified Bessel function of the first kind, of order zero, from its
+  // power series, which converges quickly over the range a Kaiser window
+  // needs.
+
+  double
+  besselI0(double const x)
+  {
+    double sum  = 1.0;
+    double term = 1.0;
+
+    for (int k = 1; term > sum * 1e-12; ++k)
+    {
+      auto const factor = x / (2.0 * k);
+
+      term *= factor * factor;
+      sum  += term;
+    }
+
+    return sum;
+  }
+
+  // Design a Kaiser-windowed sinc lowpass, to run at the input rate times
+  // the number of phases provided, and split it into that many phases, of
+  // the taps of each in reverse, one phase to a column. Scaled so that
+  // each phase has, near enough, unity gain at DC.
+
+  Eigen::MatrixXf
+  lowpass(int const phases,
+          int const inputRate)
+  {
+    auto const rate   = static_cast<double>(phases) * inputRate;
+    auto const cutoff = (PASSBAND_HZ + STOPBAND_HZ) / 2.0 / rate;
+    auto const beta   = 0.1102 * (ATTENUATION_DB - 8.7);
+    auto const taps   = static_cast<int>(std::ceil((ATTENUATION_DB - 7.95) * inputRate /
+                                                   (14.357 * (STOPBAND_HZ - PASSBAND_HZ))));
+    auto const length = taps * phases;
+    auto const centre = (length - 1) / 2.0;
+
+    std::vector<double> h(length);
+
+    for (int n = 0; n < length; ++n)
+    {
+      auto const t = n - centre;
+      auto const r = 2.0 * n / (length - 1) - 1.0;
+      auto const x = 2.0 * cutoff * t;
+      auto const w = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / besselI0(beta);
+
+      h[n] = 2.0 * cutoff * (x == 0.0 ? 1.0 : std::sin(std::numbers::pi * x) / (std::numbers::pi * x)) * w;
+    }
+
+    auto const scale = phases / std::accumulate(h.begin(), h.end(), 0.0);
+
+    Eigen::MatrixXf bank(taps, phases);
+
+    for (int p = 0; p < phases; ++p)
+    {
+      for (int j = 0; j < taps; ++j)
+      {
+        bank(j, p) = static_cast<float>(h[p + (taps - 1 - j) * phases] * scale);
+      }
+    }
+
+    return bank;
+  }
+}
+
+/******************************************************************************/
+// Public Interface
+/******************************************************************************/
+
+bool
+Resampler::supports(int const inputRate)
+{
+  return inputRate >= OUTPUT_RATE &&
+         inputRate <= MAX_RATE    &&
+         OUTPUT_RATE / std::gcd(OUTPUT_RATE, inputRate) <= MAX_PHASES;
+}
+
+// Filter banks are designed on first use of a rate, and kept; there are
+// only so many rates a sound card will offer.
+
+std::shared_ptr<Resampler::Bank const>
+Resampler::bank(int const inputRate)
+{
+  static QMutex                                   mutex;
+  static QHash<int, std::shared_ptr<Bank const>> banks;
+
+  QMutexLocker lock(&mutex);
+
+  auto & bank = banks[inputRate];
+
+  if (!bank)
+  {
+    auto const divisor = std::gcd(OUTPUT_RATE, inputRate);
+    auto const up      = OUTPUT_RATE / divisor;
+    auto const down    = inputRate   / divisor;
+
+    bank = std::make_shared<Bank const>(Bank{up, down, lowpass(up, inputRate)});
+
+    qCDebug(resampler_js8) << "filter bank for" << inputRate << "Hz:"
+                           << up << "/" << down << "with"
+                           << bank->taps.rows() << "taps per phase";
+  }
+
+  return bank;
+}
+
+Resampler::Resampler(int const inputRate)
+  : m_inputRate (inputRate)
+  , m_bank      (bank(inputRate))
+  , m_history   (m_bank->taps.rows() - 1 + CHUNK, 0.0f)
+  , m_size      (m_bank->taps.rows() - 1)
+  , m_index     (m_size)
+{}
+
+/******************************************************************************/
+
+Q_LOGGING_CATEGORY(resampler_js8, "resampler.js8", QtWarningMsg)
@@ -0,0 +1,121 @@
+#ifndef RESAMPLER_HPP__
+#define RESAMPLER_HPP__
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <vendor/Eigen/Dense>
+
+// Resamples audio, at whatever rate the sound card gives it to us, to
+// 12kHz, for the Detector, through a polyphase rational resampler; i.e.,
+// conceptually, we upsample by L, lowpass, and downsample by M, where
+// L / M is 12kHz over the input rate, reduced, but in practice we only
+// compute the outputs we keep, each as the dot product of the latest
+// input samples with one phase of the lowpass filter.
+//
+// Needs nothing of Qt beyond QtCore, so that the benchmark in tests can
+// build it on its own.
+//
+// Filter banks are designed for each input rate the first time it's
+// seen, and shared thereafter; a bank is a matrix, with a column of
+// taps, reversed, for each phase, so that each dot product is over
+// contiguous memory, and vectorizes.
+
+class Resampler final
+{
+public:
+
+  // Rate we resample to, and the bank for an input rate.
+
+  static constexpr int OUTPUT_RATE = 12000;
+
+  struct Bank
+  {
+    int             up;
+    int             down;
+    Eigen::MatrixXf taps;
+  };
+
+  // Whether we can resample from the rate provided; we handle rates
+  // from the output rate up, whose ratio to it reduces to something
+  // of a sensible number of phases.
+
+  static bool supports(int inputRate);
+
+  // Constructor; we require a supported input rate.
+
+  explicit Resampler(int inputRate);
+
+  // Inline accessors
+
+  int inputRate() const { return m_inputRate; }
+
+  // Input frames it takes to produce the output samples provided.
+
+  std::size_t
+  inputFrames(std::size_t const outputSamples) const
+  {
+    return outputSamples * m_bank->down / m_bank->up;
+  }
+
+  // Resample the input provided, handing each output sample produced
+  // to the function provided.
+
+  template <typename Output>
+  void
+  process(short  const * const data,
+          std::size_t    const size,
+          Output             && output)
+  {
+    auto const taps = static_cast<std::size_t>(m_bank->taps.rows());
+
+    std::transform(data, data + size, m_history.begin() + m_size, [](auto const sample)
+    {
+      return static_cast<float>(sample);
+    });
+
+    m_size += size;
+
+    while (m_index < m_size)
+    {
+      auto const window = Eigen::Map<Eigen::VectorXf const>(m_history.data() + m_index + 1 - taps, taps);
+      auto const sample = m_bank->taps.col(m_phase).dot(window);
+
+      output(static_cast<short>(std::clamp(std::round(sample), -32768.0f, 32767.0f)));
+
+      m_phase += m_bank->down;
+      m_index += m_phase / m_bank->up;
+      m_phase %= m_bank->up;
+    }
+
+    // Keep the samples the next outputs will need.
+
+    auto const drop = m_size - (taps - 1);
+
+    std::copy(m_history.begin() + drop, m_history.begin() + m_size, m_history.begin());
+
+    m_size  -= drop;
+    m_index -= drop;
+  }
+
+  // Largest number of input frames process() takes at a time.
+
+  static constexpr std::size_t CHUNK = 4096;
+
+private:
+
+  static std::shared_ptr<Bank const> bank(int inputRate);
+
+  // Data members
+
+  int                         m_inputRate;
+  std::shared_ptr<Bank const> m_bank;
+  std::vector<float>          m_history;
+  std::size_t                 m_size;
+  std::size_t                 m_index;
+  int                         m_phase = 0;
+};
+
+#endif
@@ -2,10 +2,11 @@
 #include <QHostInfo>
 #include <QLoggingCategory>
 #include <QNetworkDatagram>
-#include <QQueue>
 #include <QTimer>
 #include <QUdpSocket>
+#include "DriftingDateTime.h"
 #include "Message.hpp"
+#include "SpotQueue.hpp"
 #include "pimpl_impl.hpp"
 #include "moc_SpotClient.cpp"
 
@@ -18,6 +19,18 @@ Q_DECLARE_LOGGING_CATEGORY(spotclient_js8)
 namespace
 {
   constexpr auto SEND_INTERVAL = std::chrono::seconds(60);
+
+  // Spots of a station on a dial frequency within the time to live are
+  // folded into one; since spots carry no time of their own, they're no
+  // use to anyone once they've waited longer than the age limit.
+
+  constexpr SpotQueue::Limits QUEUE_LIMITS
+  {
+    1000,       // capacity, records
+    120,        // ttl, seconds
+    300,        // age, seconds
+    256 * 1024  // spill, bytes
+  };
 }
 
 /******************************************************************************/
@@ -58,6 +71,7 @@ public:
     , port_      {port}
     , version_   {version}
     , send_      {new QTimer {this}}
+    , queue_     {"JS8", QUEUE_LIMITS}
   {}
 
   // Intended to be called on the thread that starts us, which can be
@@ -82,10 +96,52 @@ public:
       }
     });
 
-    // Start a host lookup for the name we were provided. If it succeeds, use
-    // the first address in the list. If it fails, then we've missed what was
-    // our one and only shot at this.
+    lookup();
+
+    // Empty the queue every time our timer goes off, one datagram to a
+    // message, which is what the server expects. Until we've a host to
+    // send to, or while sends are failing, messages wait in the queue,
+    // and retrying the lookup takes the place of sending.
+
+    connect(send_, &QTimer::timeout, this, [this]()
+    {
+      sent_++;
+
+      if (host_.isNull())
+      {
+        lookup();
+        return;
+      }
 
+      auto const now = DriftingDateTime::currentSecsSinceEpoch();
+
+      queue_.setOnline(true, now);
+
+      for (auto records = queue_.take(0, now);
+               !records.isEmpty();
+                records = queue_.take(0, now))
+      {
+        if (writeDatagram(records.first().data, host_, port_) == -1)
+        {
+          qCDebug(spotclient_js8) << "SpotClient Send Failed:" << errorString();
+          queue_.failed(records);
+          queue_.setOnline(false, now);
+          break;
+        }
+        queue_.sent(records.size());
+      }
+    });
+
+    send_->start(SEND_INTERVAL);
+  }
+
+  // Start a host lookup for the name we were provided. If it succeeds, use
+  // the first address in the list. If it fails, we'll try again when the
+  // timer next goes off, holding on to what's queued in the meantime.
+
+  void
+  lookup()
+  {
     QHostInfo::lookupHost(name_,
                           this,
                           [this](QHostInfo const & info)
@@ -99,27 +155,20 @@ public:
 
         bind(host_.protocol() == IPv6Protocol ? QHostAddress::AnyIPv6
                                               : QHostAddress::AnyIPv4);
-
-        send_->start(SEND_INTERVAL);
       }
-      else
+      else if (queue_.online())
       {
         Q_EMIT self_->error (QString {"Host lookup failed: %1"}.arg(info.errorString()));
-        valid_ = false;
-        queue_.clear();
+        queue_.setOnline(false, DriftingDateTime::currentSecsSinceEpoch());
       }
     });
+  }
 
-    // Empty the queue every time our timer goes off.
-
-    connect(send_, &QTimer::timeout, this, [this]()
-    {
-      while (!queue_.isEmpty())
-      {
-        writeDatagram(queue_.dequeue().toJson(), host_, port_);
-      }
-      sent_++;
-    });
+  void
+  enqueue(Message const & message,
+          QString const & key = {})
+  {
+    queue_.push(message.toJson(), DriftingDateTime::currentSecsSinceEpoch(), key);
   }
 
   // Sent as the "BY" value on command and spot sends; contains the call
@@ -142,8 +191,7 @@ public:
   QString         version_;
   QTimer        * send_;
   QHostAddress    host_;
-  QQueue<Message> queue_;
-  bool            valid_ =  true;
+  SpotQueue       queue_;
   bool            once_  =  false;
   int             sent_  =  0;
   QString         call_;
@@ -177,6 +225,12 @@ SpotClient::start()
   }
 }
 
+QVariantMap
+SpotClient::stats() const
+{
+  return m_->queue_.stats();
+}
+
 void
 SpotClient::setLocalStation(QString const & callsign,
                             QString const & grid,
@@ -192,9 +246,9 @@ SpotClient::setLocalStation(QString const & callsign,
 
   // Send local information to network on change, or once every 15 minutes.
 
-  if (m_->valid_ && (changed || m_->sent_ % 15 == 0))
+  if (changed || m_->sent_ % 15 == 0)
   {
-    m_->queue_.enqueue({"RX.LOCAL", "", {
+    m_->enqueue({"RX.LOCAL", "", {
       {"CALLSIGN", QVariant(callsign)    },
       {"GRID",     QVariant(grid)        },
       {"INFO",     QVariant(info)        },
@@ -216,24 +270,21 @@ SpotClient::enqueueCmd(QString const & cmd,
                        int     const   offset,
                        int     const   snr)
 {
-  if (m_->valid_)
-  {
-    m_->queue_.enqueue({"RX.DIRECTED", "", {
-      {"BY",     QVariant(m_->by())     },
-      {"CMD",    QVariant(cmd)          },
-      {"FROM",   QVariant(from)         },
-      {"TO",     QVariant(to)           },
-      {"PATH",   QVariant(relayPath)    },
-      {"TEXT",   QVariant(text)         },
-      {"GRID",   QVariant(grid)         },
-      {"EXTRA",  QVariant(extra)        },
-      {"FREQ",   QVariant(dial + offset)},
-      {"DIAL",   QVariant(dial)         },
-      {"OFFSET", QVariant(offset)       },
-      {"SNR",    QVariant(snr)          },
-      {"SPEED",  QVariant(submode)      }
-    }});
-  }
+  m_->enqueue({"RX.DIRECTED", "", {
+    {"BY",     QVariant(m_->by())     },
+    {"CMD",    QVariant(cmd)          },
+    {"FROM",   QVariant(from)         },
+    {"TO",     QVariant(to)           },
+    {"PATH",   QVariant(relayPath)    },
+    {"TEXT",   QVariant(text)         },
+    {"GRID",   QVariant(grid)         },
+    {"EXTRA",  QVariant(extra)        },
+    {"FREQ",   QVariant(dial + offset)},
+    {"DIAL",   QVariant(dial)         },
+    {"OFFSET", QVariant(offset)       },
+    {"SNR",    QVariant(snr)          },
+    {"SPEED",  QVariant(submode)      }
+  }});
 }
 
 void
@@ -244,19 +295,16 @@ SpotClient::enqueueSpot(QString const & callsign,
                         int     const   offset,
                         int     const   snr)
 {
-  if (m_->valid_)
-  {
-    m_->queue_.enqueue({"RX.SPOT", "", {
-      {"BY",       QVariant(m_->by())     },
-      {"CALLSIGN", QVariant(callsign)     },
-      {"GRID",     QVariant(grid)         },
-      {"FREQ",     QVariant(dial + offset)},
-      {"DIAL",     QVariant(dial)         },
-      {"OFFSET",   QVariant(offset)       },
-      {"SNR",      QVariant(snr)          },
-      {"SPEED",    QVariant(submode)      }
-    }});
-  }
+  m_->enqueue({"RX.SPOT", "", {
+    {"BY",       QVariant(m_->by())     },
+    {"CALLSIGN", QVariant(callsign)     },
+    {"GRID",     QVariant(grid)         },
+    {"FREQ",     QVariant(dial + offset)},
+    {"DIAL",     QVariant(dial)         },
+    {"OFFSET",   QVariant(offset)       },
+    {"SNR",      QVariant(snr)          },
+    {"SPEED",    QVariant(submode)      }
+  }}, QString("%1 %2").arg(callsign).arg(dial));
 }
 
 /******************************************************************************/
@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QString>
+#include <QVariantMap>
 #include "pimpl_h.hpp"
 
 class SpotClient final : public QObject
@@ -41,6 +42,11 @@ public:
                    int             offset,
                    int             snr);
 
+  // Counters for the queue of messages waiting to be sent; callable
+  // from any thread.
+
+  QVariantMap stats() const;
+
   Q_SIGNAL void error (QString const &) const;
 
 private:
@@ -0,0 +1,402 @@
+#include "SpotQueue.hpp"
+#include <algorithm>
+#include <iterator>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QStandardPaths>
+
+Q_DECLARE_LOGGING_CATEGORY(spotqueue_js8)
+
+/******************************************************************************/
+// Constants
+/******************************************************************************/
+
+namespace
+{
+  // Spill files start with a magic number and version; records follow,
+  // each as a time, key, and the record data, appended as they're spilled.
+
+  constexpr quint32 SPILL_MAGIC   = 0x4a533853; // "JS8S"
+  constexpr quint32 SPILL_VERSION = 2;
+}
+
+/******************************************************************************/
+// Private Implementation
+/******************************************************************************/
+
+// A record with a key is going to be dropped rather than sent; unless a
+// later record has been pushed with the key since, which would have seen
+// it last, a record pushed with it again is no duplicate.
+
+void
+SpotQueue::forget(Record const & record)
+{
+  if (record.key.isEmpty()) return;
+
+  if (auto const it = m_seen.constFind(record.key); it != m_seen.cend() &&
+                                                    it.value() == record.time)
+  {
+    m_seen.erase(it);
+  }
+}
+
+// Drop records that have grown too old to be worth sending; a replaced
+// record takes the time of its replacement, so these needn't all be at
+// the head of the queue.
+
+void
+SpotQueue::expire(qint64 const now)
+{
+  if (m_limits.age <= 0) return;
+
+  qsizetype bytes = 0;
+
+  auto const it = std::remove_if(m_records.begin(), m_records.end(),
+                                 [this, now, &bytes](Record const & record)
+  {
+    if (now - record.time <= m_limits.age) return false;
+
+    bytes += record.data.size();
+    forget(record);
+    return true;
+  });
+
+  m_bytes -= bytes;
+  m_stale += static_cast<quint64>(std::distance(it, m_records.end()));
+  m_records.erase(it, m_records.end());
+}
+
+// Make room for what's just been pushed, if we've run out. Offline, with
+// somewhere to spill to, the lot goes to disk in one go; otherwise, it's
+// the oldest that have to go.
+
+void
+SpotQueue::evict()
+{
+  if (static_cast<qsizetype>(m_records.size()) <= m_limits.capacity) return;
+
+  if (!m_online && m_limits.spill > 0)
+  {
+    spill();
+  }
+  else while (static_cast<qsizetype>(m_records.size()) > m_limits.capacity)
+  {
+    m_bytes -= m_records.front().data.size();
+    forget(m_records.front());
+    m_records.pop_front();
+    ++m_dropped;
+  }
+}
+
+void
+SpotQueue::spill()
+{
+  if (m_limits.spill <= 0 || m_records.empty()) return;
+
+  auto const written = write(m_records);
+
+  std::for_each(m_records.begin() + written, m_records.end(),
+                [this](Record const & record) { forget(record); });
+
+  m_spills  += static_cast<quint64>(written);
+  m_dropped += static_cast<quint64>(m_records.size() - written);
+
+  m_records.clear();
+  m_bytes = 0;
+}
+
+// Append records to the spill file, for as long as there's room in it,
+// returning the number written.
+
+qsizetype
+SpotQueue::write(std::deque<Record> const & records)
+{
+  QFile file(m_path);
+
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+  {
+    qCWarning(spotqueue_js8) << m_name << "unable to spill to" << m_path << file.errorString();
+    return 0;
+  }
+
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_6_5);
+
+  if (file.size() == 0) out << SPILL_MAGIC << SPILL_VERSION;
+
+  qsizetype written = 0;
+
+  for (auto const & record : records)
+  {
+    // Time, and the lengths of the key and data, take 16 bytes; the key
+    // takes 2 bytes a character.
+
+    if (file.pos() + 2 * record.key.size() + record.data.size() + 16 > m_limits.spill) break;
+
+    out << record.time << record.key << record.data;
+
+    if (out.status() != QDataStream::Ok) break;
+
+    ++written;
+  }
+
+  m_spilled = m_spilled || written > 0;
+
+  return written;
+}
+
+// Bring spilled records back, ahead of any in memory, since they're the
+// older ones, for as many as there's room for; anything that won't fit
+// is written back to wait its turn.
+
+void
+SpotQueue::unspill(qint64 const now)
+{
+  if (!m_spilled) return;
+
+  m_spilled = false;
+
+  std::deque<Record> records;
+
+  if (QFile file(m_path); file.open(QIODevice::ReadOnly))
+  {
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_5);
+
+    quint32 magic   = 0;
+    quint32 version = 0;
+
+    in >> magic >> version;
+
+    if (magic == SPILL_MAGIC && version == SPILL_VERSION)
+    {
+      while (!in.atEnd())
+      {
+        Record record;
+
+        in >> record.time >> record.key >> record.data;
+
+        if (in.status() != QDataStream::Ok) break;
+
+        if (m_limits.age > 0 && now - record.time > m_limits.age)
+        {
+          forget(record);
+          ++m_stale;
+        }
+        else
+        {
+          records.push_back(std::move(record));
+        }
+      }
+    }
+  }
+
+  QFile::remove(m_path);
+
+  auto const room = std::max(qsizetype{0}, m_limits.capacity - static_cast<qsizetype>(m_records.size()));
+  auto const keep = std::min(room, static_cast<qsizetype>(records.size()));
+
+  if (keep < static_cast<qsizetype>(records.size()))
+  {
+    auto const rest    = std::deque<Record>(records.begin() + keep, records.end());
+    auto const written = write(rest);
+
+    std::for_each(rest.begin() + written, rest.end(),
+                  [this](Record const & record) { forget(record); });
+
+    m_dropped += static_cast<quint64>(rest.size() - written);
+    records.resize(keep);
+  }
+
+  for (auto const & record : records) m_bytes += record.data.size();
+
+  m_restores += static_cast<quint64>(records.size());
+  m_records.insert(m_records.begin(),
+                   std::make_move_iterator(records.begin()),
+                   std::make_move_iterator(records.end()));
+}
+
+void
+SpotQueue::update()
+{
+  m_pending = static_cast<qsizetype>(m_records.size());
+}
+
+/******************************************************************************/
+// Public Interface
+/******************************************************************************/
+
+SpotQueue::SpotQueue(QString const & name,
+                     Limits  const   limits)
+: m_name  {name}
+, m_path  {QDir{QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)}
+             .absoluteFilePath(QString("spots-%1.dat").arg(name.toLower()))}
+, m_limits{limits}
+{
+  m_spilled = m_limits.spill > 0 && QFile::exists(m_path);
+}
+
+// Whatever we've not managed to send by now waits for the next run.
+
+SpotQueue::~SpotQueue()
+{
+  spill();
+}
+
+bool
+SpotQueue::push(QByteArray const & data,
+                qint64     const   now,
+                QString    const & key)
+{
+  if (m_limits.ttl > 0 && !key.isEmpty())
+  {
+    // Forget about keys that have lived out their time, every so often,
+    // rather than on every push.
+
+    if (now - m_swept > m_limits.ttl)
+    {
+      m_swept = now;
+      m_seen.removeIf([this, now](auto const it)
+      {
+        return now - it.value() > m_limits.ttl;
+      });
+    }
+
+    if (auto const it = m_seen.find(key); it != m_seen.end() &&
+                                          now - it.value() <= m_limits.ttl)
+    {
+      // Seen within the time to live; if it's still waiting to go out,
+      // bring it up to date, otherwise it's a duplicate. Most likely, a
+      // record we'd replace was pushed recently, so look from the back.
+
+      auto const record = std::find_if(m_records.rbegin(), m_records.rend(),
+                                       [&key](auto const & r) { return r.key == key; });
+
+      if (record == m_records.rend())
+      {
+        ++m_duplicates;
+        return false;
+      }
+
+      m_bytes += data.size() - record->data.size();
+      record->data = data;
+      record->time = now;
+      it.value()   = now;
+      ++m_replaced;
+      return true;
+    }
+
+    m_seen.insert(key, now);
+  }
+
+  m_records.push_back({data, now, key});
+  m_bytes += data.size();
+  ++m_queued;
+
+  evict();
+  update();
+
+  return true;
+}
+
+SpotQueue::Records
+SpotQueue::take(qsizetype const maxBytes,
+                qint64    const now,
+                qsizetype const overhead)
+{
+  if (m_online) unspill(now);
+
+  expire(now);
+
+  Records   records;
+  qsizetype size = 0;
+
+  while (!m_records.empty())
+  {
+    auto const bytes = m_records.front().data.size() + overhead;
+
+    if (!records.isEmpty() && size + bytes > maxBytes) break;
+
+    size    += bytes;
+    m_bytes -= m_records.front().data.size();
+    records.append(std::move(m_records.front()));
+    m_records.pop_front();
+  }
+
+  update();
+
+  return records;
+}
+
+void
+SpotQueue::sent(qsizetype const count)
+{
+  m_sent += static_cast<quint64>(count);
+}
+
+void
+SpotQueue::failed(Records const & records)
+{
+  m_failed += static_cast<quint64>(records.size());
+  restore(records);
+}
+
+void
+SpotQueue::restore(Records const & records)
+{
+  for (auto it = records.crbegin(); it != records.crend(); ++it)
+  {
+    m_records.push_front(*it);
+    m_bytes += it->data.size();
+  }
+
+  evict();
+  update();
+}
+
+// Spilled records may be waiting while we're online, having been spilled
+// by the last run, or not all having fit when last brought back; bring
+// them back every time we're told, not only on coming back online, so the
+// client sees them before deciding whether it has enough to send.
+
+void
+SpotQueue::setOnline(bool   const online,
+                     qint64 const now)
+{
+  if (m_online.exchange(online) != online)
+  {
+    qCDebug(spotqueue_js8) << m_name << (online ? "online" : "offline");
+
+    if (!online) spill();
+  }
+
+  if (online) unspill(now);
+
+  update();
+}
+
+QVariantMap
+SpotQueue::stats() const
+{
+  return {
+    {"PENDING",    m_pending.load()},
+    {"ONLINE",     m_online.load()},
+    {"CAPACITY",   m_limits.capacity},
+    {"TTL",        m_limits.ttl},
+    {"QUEUED",     m_queued.load()},
+    {"REPLACED",   m_replaced.load()},
+    {"DUPLICATES", m_duplicates.load()},
+    {"DROPPED",    m_dropped.load()},
+    {"STALE",      m_stale.load()},
+    {"SPILLED",    m_spills.load()},
+    {"RESTORED",   m_restores.load()},
+    {"SENT",       m_sent.load()},
+    {"FAILED",     m_failed.load()}
+  };
+}
+
+/******************************************************************************/
+
+Q_LOGGING_CATEGORY(spotqueue_js8, "spotqueue.js8", QtWarningMsg)
@@ -0,0 +1,137 @@
+#ifndef SPOT_QUEUE_HPP__
+#define SPOT_QUEUE_HPP__
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+#include <QtGlobal>
+
+#include <atomic>
+#include <deque>
+
+// Outbound queue of spot records, shared by the clients that upload spots
+// to the JS8 spot server, PSK Reporter and APRS-IS; each of them keeps one
+// per destination. Records are opaque bytes, already in the form they'll
+// be sent in, so that the client can coalesce as many of them as will fit
+// into each datagram or write it makes.
+//
+// A record may be pushed with a key, e.g., callsign and band, to which a
+// time to live applies; a record pushed while another with the same key
+// is still queued replaces it, and one pushed after the key's record was
+// sent, but within the time to live, is dropped as a duplicate. A record
+// that's dropped rather than sent doesn't make its key a duplicate.
+//
+// The number of records held in memory is bounded, and the oldest will
+// be dropped to make room, as will those older than the age limit. While
+// the client tells us that the destination can't be reached, records go
+// to a spill file on disk rather than being dropped, up to a byte limit,
+// and come back from it once the destination can be reached again; the
+// spill file also carries whatever is left over at exit into the next
+// run.
+//
+// Times are in seconds since the epoch. A queue is used on a single
+// thread; stats() may be called from any thread.
+
+class SpotQueue
+{
+public:
+
+  struct Limits
+  {
+    qsizetype capacity;  // Records held in memory.
+    qint64    ttl   = 0; // Seconds in which a key is a duplicate; zero for none.
+    qint64    age   = 0; // Seconds after which a record is stale; zero for never.
+    qint64    spill = 0; // Bytes of spill file; zero for no spilling.
+  };
+
+  struct Record
+  {
+    QByteArray data;
+    qint64     time;
+    QString    key;
+  };
+
+  using Records = QList<Record>;
+
+  SpotQueue(QString const & name,
+            Limits          limits);
+  ~SpotQueue();
+
+  // Queue a record; false if it was dropped as a duplicate.
+
+  bool push(QByteArray const & data,
+            qint64             now,
+            QString    const & key = {});
+
+  // Remove and return the oldest records, as many as will fit within the
+  // number of bytes provided, counting each record's size plus overhead
+  // bytes; at least one record, if there are any, even if it won't fit.
+
+  Records take(qsizetype maxBytes,
+               qint64    now,
+               qsizetype overhead = 0);
+
+  // Report the fate of records taken. Those that couldn't be sent, and
+  // those held back, e.g., by throttling, go back to the head of the queue
+  // in order; only the former count as failures.
+
+  void sent   (qsizetype       count);
+  void failed (Records const & records);
+  void restore(Records const & records);
+
+  // Whether the destination can be reached. Going offline spills what's
+  // in memory; being online brings back what's been spilled, dropping
+  // any that's gone stale by now.
+
+  void setOnline(bool   online,
+                 qint64 now);
+
+  // Accessors
+
+  bool      online()  const { return m_online; }
+  bool      isEmpty() const { return m_records.empty() && !m_spilled; }
+  bool      spilled() const { return m_spilled; }
+  qsizetype bytes()   const { return m_bytes;  }
+  QString   name()    const { return m_name;   }
+
+  // Counters, in the form the API reports them.
+
+  QVariantMap stats() const;
+
+private:
+
+  void      forget (Record const & record);
+  void      expire (qint64 now);
+  void      evict  ();
+  void      spill  ();
+  qsizetype write  (std::deque<Record> const & records);
+  void      unspill(qint64 now);
+  void      update ();
+
+  QString                 m_name;
+  QString                 m_path;
+  Limits                  m_limits;
+  std::deque<Record>      m_records;
+  QHash<QString, qint64>  m_seen;
+  qsizetype               m_bytes   = 0;
+  qint64                  m_swept   = 0;
+  bool                    m_spilled = false;
+
+  // Read from any thread by stats().
+
+  std::atomic<bool>       m_online     {true};
+  std::atomic<qsizetype>  m_pending    {0};
+  std::atomic<quint64>    m_queued     {0};
+  std::atomic<quint64>    m_replaced   {0};
+  std::atomic<quint64>    m_duplicates {0};
+  std::atomic<quint64>    m_dropped    {0};
+  std::atomic<quint64>    m_stale      {0};
+  std::atomic<quint64>    m_spills     {0};
+  std::atomic<quint64>    m_restores   {0};
+  std::atomic<quint64>    m_sent       {0};
+  std::atomic<quint64>    m_failed     {0};
+};
+
+#endif
@@ -0,0 +1,243 @@
+#include "Symbols.hpp"
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <QHash>
+#include <QReadLocker>
+#include <QReadWriteLock>
+#include <QWriteLocker>
+#include "Radio.hpp"
+
+/******************************************************************************/
+// Private Implementation
+/******************************************************************************/
+
+namespace
+{
+  // Interning table for a type of symbol, given a function to make one
+  // from its handle and string. Symbols live in slots in a deque, which
+  // doesn't move its elements as it grows; each slot notes the generation
+  // in which its symbol was last interned, and trim() frees those that
+  // weren't interned in the generation just ending, for reuse. A slot
+  // counts its uses, and the count goes into the handle of each symbol
+  // it holds. The lock protects the index, the free list, and the deque's
+  // own bookkeeping; a slot's generation is atomic, since it's marked
+  // under the read lock.
+
+  template <typename Symbol,
+            auto     Make>
+  class Table
+  {
+    struct Slot
+    {
+      Slot(QString const & key,
+           Symbol  const & symbol,
+           quint32 const   seen)
+      : key    (key)
+      , symbol (symbol)
+      , seen   (seen)
+      {}
+
+      QString              key;
+      Symbol               symbol;
+      std::atomic<quint32> seen;
+      Symbols::Handle      uses = 0;
+    };
+
+    mutable QReadWriteLock          m_lock;
+    std::deque<Slot>                m_slots;
+    std::vector<Symbols::Handle>    m_free;
+    QHash<QString, Symbols::Handle> m_index;
+    quint32                         m_generation = 0;
+
+    Symbol
+    mark(Symbols::Handle const index)
+    {
+      auto & slot = m_slots[index];
+
+      slot.seen.store(m_generation, std::memory_order_relaxed);
+      return slot.symbol;
+    }
+
+  public:
+
+    Table()
+    {
+      m_slots.emplace_back(QString(), Make(Symbols::NONE, QString()), 0);
+      m_index.insert(QString(), Symbols::NONE);
+    }
+
+    Symbol
+    intern(QString const & string)
+    {
+      {
+        QReadLocker lock(&m_lock);
+
+        if (auto const it = m_index.constFind(string); it != m_index.cend())
+        {
+          return mark(it.value());
+        }
+      }
+
+      // Not seen before, most likely; we'll have to check again now that
+      // we've got the write lock, since we might have raced someone else
+      // who was after the same string.
+
+      QWriteLocker lock(&m_lock);
+
+      if (auto const it = m_index.constFind(string); it != m_index.cend())
+      {
+        return mark(it.value());
+      }
+
+      Symbols::Handle index;
+
+      if (m_free.empty())
+      {
+        index = static_cast<Symbols::Handle>(m_slots.size());
+
+        if (index > Symbols::SLOT_MASK) return Make(Symbols::NONE, string);
+
+        m_slots.emplace_back(string, Make(index, string), m_generation);
+      }
+      else
+      {
+        index = m_free.back();
+        m_free.pop_back();
+
+        auto & slot = m_slots[index];
+
+        slot.uses   = (slot.uses + 1) & (Symbols::Handle(-1) >> Symbols::SLOT_BITS);
+        slot.key    = string;
+        slot.symbol = Make(slot.uses << Symbols::SLOT_BITS | index, string);
+        slot.seen.store(m_generation, std::memory_order_relaxed);
+      }
+
+      m_index.insert(string, index);
+      return m_slots[index].symbol;
+    }
+
+    Symbol
+    find(QString const & string) const
+    {
+      {
+        QReadLocker lock(&m_lock);
+
+        if (auto const it = m_index.constFind(string); it != m_index.cend())
+        {
+          return m_slots[it.value()].symbol;
+        }
+      }
+
+      return Make(Symbols::NONE, string);
+    }
+
+    Symbol
+    lookup(Symbols::Handle const handle) const
+    {
+      QReadLocker lock(&m_lock);
+
+      if (auto const index = Symbols::slot(handle); index < m_slots.size())
+      {
+        if (auto const & slot = m_slots[index]; slot.symbol.handle == handle) return slot.symbol;
+      }
+
+      return m_slots.front().symbol;
+    }
+
+    // Free the slots of symbols not interned in the generation ending;
+    // a freed slot holds the symbol for the empty string until reused,
+    // so that lookups of its old handle answer as for unknown handles.
+    // The empty string itself is never forgotten.
+
+    qsizetype
+    trim()
+    {
+      QWriteLocker lock(&m_lock);
+
+      qsizetype forgotten = 0;
+
+      for (Symbols::Handle index = 1; index < m_slots.size(); ++index)
+      {
+        auto & slot = m_slots[index];
+
+        if (slot.symbol.handle == Symbols::NONE ||
+            slot.seen.load(std::memory_order_relaxed) == m_generation) continue;
+
+        m_index.remove(slot.key);
+        m_free.push_back(index);
+
+        slot.key    = QString();
+        slot.symbol = m_slots.front().symbol;
+
+        ++forgotten;
+      }
+
+      ++m_generation;
+
+      return forgotten;
+    }
+
+    qsizetype
+    size() const
+    {
+      QReadLocker lock(&m_lock);
+
+      return m_index.size();
+    }
+  };
+
+  Symbols::Call
+  makeCall(Symbols::Handle const   handle,
+           QString         const & call)
+  {
+    return {
+      handle,
+      call,
+      Radio::base_callsign(call),
+      Radio::effective_prefix(call),
+      Radio::is_compound_callsign(call)
+    };
+  }
+
+  Symbols::Grid
+  makeGrid(Symbols::Handle const   handle,
+           QString         const & grid)
+  {
+    auto const trimmed = grid.trimmed();
+
+    return {
+      handle,
+      trimmed,
+      trimmed.left(4)
+    };
+  }
+
+  using CallTable = Table<Symbols::Call, makeCall>;
+  using GridTable = Table<Symbols::Grid, makeGrid>;
+
+  // Function-local statics, so that they're constructed on first use,
+  // whenever and on whichever thread that happens to be.
+
+  CallTable & callTable() { static CallTable table; return table; }
+  GridTable & gridTable() { static GridTable table; return table; }
+}
+
+/******************************************************************************/
+// Public Interface
+/******************************************************************************/
+
+namespace Symbols
+{
+  Call call(QString const & call)   { return callTable().intern(call);   }
+  Grid grid(QString const & grid)   { return gridTable().intern(grid);   }
+  Call findCall(QString const & call) { return callTable().find(call); }
+  Grid findGrid(QString const & grid) { return gridTable().find(grid); }
+  Call call(Handle  const   handle) { return callTable().lookup(handle); }
+  Grid grid(Handle  const   handle) { return gridTable().lookup(handle); }
+
+  qsizetype trim() { return callTable().trim() + gridTable().trim(); }
+
+  qsizetype calls() { return callTable().size(); }
+  qsizetype grids() { return gridTable().size(); }
+}
@@ -0,0 +1,88 @@
+#ifndef SYMBOLS_HPP__
+#define SYMBOLS_HPP__
+
+#include <QString>
+#include <QtGlobal>
+
+// Process-wide interning of the callsigns and grids that we see over and
+// over again in decodes, activity and spots. The first time a string is
+// seen, it's given a small integer handle, and whatever we'd otherwise
+// derive from it on every use is derived once and kept alongside; from
+// then on, looking it up costs one hash lookup, and the handle alone is
+// an array index.
+//
+// Symbols are returned by value; their strings are implicitly shared, so
+// that's cheap. A symbol that hasn't been interned since the last call to
+// trim() is forgotten by the next one, and its slot in the table given to
+// whatever comes along next, so the table holds what's been heard lately,
+// rather than everything heard since we started. A handle names both the
+// slot and which use of it the symbol had, so the handle of a forgotten
+// symbol isn't taken to mean the one that replaced it; use slot() of the
+// handle to index an array, and compare handles to see that the entry is
+// still for the same symbol. Safe for use from any thread.
+//
+// Handle zero is always the empty string.
+
+namespace Symbols
+{
+  using Handle = quint32;
+
+  constexpr Handle NONE = 0;
+
+  // The low bits of a handle are its slot, the high bits count the uses
+  // of the slot before it, modulo what they can hold.
+
+  constexpr int    SLOT_BITS = 20;
+  constexpr Handle SLOT_MASK = (Handle(1) << SLOT_BITS) - 1;
+
+  constexpr Handle slot(Handle const handle) { return handle & SLOT_MASK; }
+
+  struct Call
+  {
+    Handle  handle;
+    QString call;     // as interned
+    QString base;     // Radio::base_callsign()
+    QString prefix;   // Radio::effective_prefix()
+    bool    compound; // Radio::is_compound_callsign()
+  };
+
+  struct Grid
+  {
+    Handle  handle;
+    QString grid;     // trimmed, as used for display and distance
+    QString square;   // first four characters, i.e., the square
+  };
+
+  // Intern, returning the symbol for the string provided. Should the
+  // table be full, the symbol is made, but not held, and its handle is
+  // NONE.
+
+  Call call(QString const &);
+  Grid grid(QString const &);
+
+  // Return the symbol for the string provided, without interning it; if
+  // it's not held, it's made on the spot, and its handle is NONE. For
+  // strings that needn't be kept on our account, or looked up again.
+
+  Call findCall(QString const &);
+  Grid findGrid(QString const &);
+
+  // Return the symbol for a handle previously obtained; unknown handles,
+  // and handles of symbols since forgotten, return the symbol for the
+  // empty string.
+
+  Call call(Handle);
+  Grid grid(Handle);
+
+  // Forget symbols that haven't been interned since the last trim, and
+  // return the number forgotten.
+
+  qsizetype trim();
+
+  // Number of symbols held at present, for diagnostics.
+
+  qsizetype calls();
+  qsizetype grids();
+}
+
+#endif
@@ -0,0 +1,418 @@
+#include "TimerWheel.hpp"
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <utility>
+#include <QLoggingCategory>
+#include <QStringList>
+#include "DriftingDateTime.h"
+
+Q_DECLARE_LOGGING_CATEGORY(timerwheel_js8)
+
+/******************************************************************************/
+// Constants
+/******************************************************************************/
+
+namespace
+{
+  // Longest we'll let the timer run before waking to check on things; a
+  // task due further out than this just sees one or two extra wakeups on
+  // its way.
+
+  constexpr qint64 MAX_DELAY = 60 * 60 * 1000;
+
+  constexpr qint64 NEVER = std::numeric_limits<qint64>::max();
+}
+
+/******************************************************************************/
+// Local Routines
+/******************************************************************************/
+
+namespace
+{
+  // The first time after the one provided that's a whole number of
+  // periods past the phase.
+
+  qint64
+  nextBoundary(qint64 const now,
+               qint64 const period,
+               qint64 const phase)
+  {
+    auto const since = now - phase;
+    auto       count = since / period;
+
+    if (since % period < 0) --count;
+
+    return phase + (count + 1) * period;
+  }
+}
+
+/******************************************************************************/
+// Private Implementation
+/******************************************************************************/
+
+void
+TimerWheel::schedule(QString const & name,
+                     qint64  const   deadline,
+                     qint64  const   period,
+                     qint64  const   phase,
+                     Task            task)
+{
+  cancel(name);
+
+  auto const id = ++m_next;
+  auto     & entry = m_entries[id];
+
+  entry = {name, deadline, period, phase, std::move(task), -1, -1};
+  m_names.insert(name, id);
+  if (!m_timings.contains(name)) m_timings.insert(name, {});
+
+  insert(id, entry);
+
+  qCDebug(timerwheel_js8) << name << "due at" << deadline << "at level" << entry.level;
+
+  if (!m_expiring && (!m_timer.isActive() || deadline < m_armed)) arm();
+}
+
+// File the entry in the finest level whose slots reach out as far as its
+// deadline, as of the time the wheel was last turned; from there on, the
+// slots of each level, taken from the current one, are in the order of
+// their deadlines. Anything beyond the reach of the coarsest level waits
+// in its furthest slot, and is filed again when that comes round.
+
+void
+TimerWheel::insert(quint64 const id,
+                   Entry       & entry)
+{
+  auto const delta = std::max(qint64{0}, entry.deadline - m_now);
+  int        level = 0;
+
+  while (level < LEVELS - 1 && delta >= (qint64{SLOTS - 1} << (level * SLOT_BITS))) ++level;
+
+  auto const shift = level * SLOT_BITS;
+  auto const when  = m_now + std::min(delta, (qint64{SLOTS - 1} << shift) - 1);
+  auto const slot  = static_cast<int>((when >> shift) & (SLOTS - 1));
+
+  entry.level = level;
+  entry.slot  = slot;
+
+  m_slots[level][slot].append(id);
+  m_occupied[level] |= quint64{1} << slot;
+}
+
+void
+TimerWheel::remove(quint64 const   id,
+                   Entry   const & entry)
+{
+  if (entry.level < 0) return;
+
+  auto & slot = m_slots[entry.level][entry.slot];
+
+  slot.removeOne(id);
+
+  if (slot.isEmpty()) m_occupied[entry.level] &= ~(quint64{1} << entry.slot);
+}
+
+// File everything afresh, as of now; done when the time has moved in a
+// way that might have upset the order of the slots, i.e., backwards.
+
+void
+TimerWheel::rebuild()
+{
+  for (auto & level : m_slots) for (auto & slot : level) slot.clear();
+
+  m_occupied.fill(0);
+  m_now = now();
+
+  for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+  {
+    if (it->level >= 0) insert(it.key(), *it);
+  }
+}
+
+// Turn the wheel up to the present, taking out whatever's come due, and
+// run it in order of deadline. Entries are taken out of their slots before
+// any of them run, but stay in the table until their turn comes, so that
+// a task can cancel or replace one that's due in the same turn.
+
+void
+TimerWheel::expire()
+{
+  auto const time = now();
+
+  ++m_wakeups;
+
+  if (time < m_armed) ++m_early;
+
+  if (time < m_now)
+  {
+    rebuild();
+    arm();
+    return;
+  }
+
+  QList<quint64> due;
+  QList<quint64> refile;
+
+  for (int level = 0; level < LEVELS; ++level)
+  {
+    if (!m_occupied[level]) continue;
+
+    auto const shift = level * SLOT_BITS;
+    auto const last  = time >> shift;
+
+    for (auto index = std::max(m_now >> shift, last - (SLOTS - 1)); index <= last; ++index)
+    {
+      auto const slot = static_cast<int>(index & (SLOTS - 1));
+
+      if (!(m_occupied[level] & (quint64{1} << slot))) continue;
+
+      for (auto const id : std::as_const(m_slots[level][slot]))
+      {
+        if      (m_entries[id].deadline <= time) due.append(id);
+        else if (index != last)                  refile.append(id);
+      }
+    }
+  }
+
+  for (auto const id : std::as_const(due))
+  {
+    auto & entry = m_entries[id];
+    remove(id, entry);
+    entry.level = -1;
+  }
+
+  m_now = time;
+
+  for (auto const id : std::as_const(refile))
+  {
+    auto & entry = m_entries[id];
+    remove(id, entry);
+    insert(id, entry);
+  }
+
+  std::stable_sort(due.begin(), due.end(), [this](auto const a, auto const b)
+  {
+    return m_entries[a].deadline < m_entries[b].deadline;
+  });
+
+  m_expiring = true;
+
+  for (auto const id : std::as_const(due))
+  {
+    auto const it = m_entries.find(id);
+
+    if (it == m_entries.end()) continue;
+
+    auto const ran    = now();
+    auto const late   = std::max(qint64{0}, ran - it->deadline);
+    auto     & timing = m_timings[it->name];
+
+    timing.runs  += 1;
+    timing.last   = late;
+    timing.max    = std::max(timing.max, late);
+    timing.total += late;
+
+    auto task = it->task;
+
+    if (it->period > 0)
+    {
+      auto const next = nextBoundary(ran, it->period, it->phase);
+
+      timing.missed += static_cast<quint64>((next - it->deadline) / it->period - 1);
+      it->deadline   = next;
+      insert(id, *it);
+    }
+    else
+    {
+      m_names.remove(it->name);
+      m_entries.erase(it);
+    }
+
+    task();
+  }
+
+  m_expiring = false;
+
+  arm();
+}
+
+// Set the timer for the earliest deadline there is, if any.
+
+void
+TimerWheel::arm()
+{
+  if (m_expiring) return;
+
+  auto const deadline = earliest();
+
+  if (deadline == NEVER)
+  {
+    m_timer.stop();
+    m_armed = 0;
+    return;
+  }
+
+  m_armed = deadline;
+  m_timer.start(static_cast<int>(std::clamp(deadline - now(), qint64{0}, MAX_DELAY)));
+}
+
+// In each level, the first occupied slot from the current one holds that
+// level's earliest entries; the earliest of them all is our deadline.
+
+qint64
+TimerWheel::earliest() const
+{
+  auto deadline = NEVER;
+
+  for (int level = 0; level < LEVELS; ++level)
+  {
+    if (!m_occupied[level]) continue;
+
+    auto const current = static_cast<int>((m_now >> (level * SLOT_BITS)) & (SLOTS - 1));
+    auto const offset  = std::countr_zero(std::rotr(m_occupied[level], current));
+    auto const slot    = (current + offset) & (SLOTS - 1);
+
+    for (auto const id : m_slots[level][slot])
+    {
+      deadline = std::min(deadline, m_entries.constFind(id)->deadline);
+    }
+  }
+
+  return deadline;
+}
+
+/******************************************************************************/
+// Public Interface
+/******************************************************************************/
+
+TimerWheel::TimerWheel(QObject * const parent)
+: QObject{parent}
+, m_now  {now()}
+{
+  m_timer.setTimerType(Qt::PreciseTimer);
+  m_timer.setSingleShot(true);
+
+  connect(&m_timer, &QTimer::timeout, this, &TimerWheel::expire);
+
+  // Deadlines are in drifting time; when the drift changes, the real time
+  // at which they fall changes with it.
+
+  connect(&DriftingDateTimeSingleton::getSingleton(), &DriftingDateTimeSingleton::driftChanged,
+          this, [this]()
+  {
+    rebuild();
+    arm();
+  });
+}
+
+void
+TimerWheel::at(QString const & name,
+               qint64  const   deadline,
+               Task            task)
+{
+  schedule(name, deadline, 0, 0, std::move(task));
+}
+
+void
+TimerWheel::after(QString const & name,
+                  qint64  const   delay,
+                  Task            task)
+{
+  schedule(name, now() + delay, 0, 0, std::move(task));
+}
+
+void
+TimerWheel::every(QString const & name,
+                  qint64  const   period,
+                  qint64  const   phase,
+                  Task            task)
+{
+  if (period <= 0) return;
+
+  schedule(name, nextBoundary(now(), period, phase), period, phase, std::move(task));
+}
+
+bool
+TimerWheel::cancel(QString const & name)
+{
+  auto const id = m_names.take(name);
+
+  if (!id) return false;
+
+  if (auto const it = m_entries.find(id); it != m_entries.end())
+  {
+    remove(id, *it);
+    m_entries.erase(it);
+  }
+
+  // Leave the timer as it is; should it have been set for this one, it'll
+  // wake to find nothing due, and set itself for whatever's next.
+
+  if (m_entries.isEmpty()) m_timer.stop();
+
+  return true;
+}
+
+qint64
+TimerWheel::deadline(QString const & name) const
+{
+  auto const it = m_entries.constFind(m_names.value(name));
+
+  return it != m_entries.cend() ? it->deadline : 0;
+}
+
+qint64
+TimerWheel::now()
+{
+  return DriftingDateTime::currentMSecsSinceEpoch();
+}
+
+QVariantMap
+TimerWheel::stats() const
+{
+  auto const time  = now();
+  auto       names = m_timings.keys();
+
+  names.sort();
+
+  QVariantList tasks;
+
+  for (auto const & name : std::as_const(names))
+  {
+    auto const & timing = *m_timings.constFind(name);
+    auto const   id     = m_names.value(name);
+
+    QVariantMap task = {
+      {"NAME",    name},
+      {"PENDING", id != 0},
+      {"RUNS",    timing.runs},
+      {"MISSED",  timing.missed},
+      {"LAST",    timing.last},
+      {"MAX",     timing.max},
+      {"MEAN",    timing.runs ? static_cast<double>(timing.total) / timing.runs : 0.0}
+    };
+
+    if (id)
+    {
+      auto const & entry = *m_entries.constFind(id);
+
+      task["DEADLINE"] = entry.deadline;
+      task["IN"]       = entry.deadline - time;
+      task["PERIOD"]   = entry.period;
+    }
+
+    tasks.append(task);
+  }
+
+  return {
+    {"NOW",     time},
+    {"WAKEUPS", m_wakeups},
+    {"EARLY",   m_early},
+    {"TASKS",   tasks}
+  };
+}
+
+/******************************************************************************/
+
+Q_LOGGING_CATEGORY(timerwheel_js8, "timerwheel.js8", QtWarningMsg)
@@ -0,0 +1,123 @@
+#ifndef TIMER_WHEEL_HPP__
+#define TIMER_WHEEL_HPP__
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QVariantMap>
+#include <QtGlobal>
+
+#include <array>
+#include <functional>
+
+// Runs named tasks at deadlines given in the time DriftingDateTime keeps,
+// i.e., milliseconds since the epoch, with the drift applied; once, or
+// repeatedly, on boundaries of a period, e.g., every second, or at the
+// start of every period of a submode.
+//
+// Tasks are kept in a hierarchical timer wheel, of levels of 64 slots, the
+// first of a millisecond apiece, each level thereafter 64 times coarser
+// than the one before. A single precise timer is armed for the earliest
+// deadline in the wheel, so that we wake only when there's work to do, and
+// at the millisecond it's due; a slot holds the exact deadline of each of
+// its tasks, so coarser levels lose nothing in precision. Should the drift
+// change, the wheel is rebuilt and the timer re-armed to the new time.
+//
+// Scheduling a task under the name of one that's pending replaces it. A
+// repeating task that runs late by more than its period skips the runs it
+// missed, rather than running them back to back.
+//
+// How late each task ran, relative to its deadline, is recorded by name;
+// stats() reports it, with the tasks pending, for the API's debug view.
+//
+// A wheel is used on the thread that created it.
+
+class TimerWheel final : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  using Task = std::function<void()>;
+
+  explicit TimerWheel(QObject * parent = nullptr);
+
+  // Run a task once, at a deadline, or after a delay, in milliseconds.
+
+  void at   (QString const & name, qint64 deadline, Task task);
+  void after(QString const & name, qint64 delay,    Task task);
+
+  // Run a task every period milliseconds, at times which are a multiple
+  // of the period past the phase, starting with the next one to come.
+
+  void every(QString const & name, qint64 period, qint64 phase, Task task);
+
+  // Remove a pending task; false if there was none of that name.
+
+  bool cancel(QString const & name);
+
+  // Accessors
+
+  bool   isPending(QString const & name) const { return m_names.contains(name); }
+  qint64 deadline (QString const & name) const;
+
+  static qint64 now();
+
+  // Tasks, pending or run, with their timing, in the form the API reports
+  // them; times in milliseconds.
+
+  QVariantMap stats() const;
+
+private:
+
+  static constexpr int LEVELS    = 5;
+  static constexpr int SLOT_BITS = 6;
+  static constexpr int SLOTS     = 1 << SLOT_BITS;
+
+  struct Entry
+  {
+    QString name;
+    qint64  deadline;
+    qint64  period;
+    qint64  phase;
+    Task    task;
+    int     level;
+    int     slot;
+  };
+
+  struct Timing
+  {
+    quint64 runs   = 0;
+    quint64 missed = 0;
+    qint64  last   = 0;
+    qint64  max    = 0;
+    qint64  total  = 0;
+  };
+
+  using Slot = QList<quint64>;
+
+  void   schedule(QString const & name, qint64 deadline, qint64 period, qint64 phase, Task task);
+  void   insert  (quint64 id, Entry & entry);
+  void   remove  (quint64 id, Entry const & entry);
+  void   rebuild ();
+  void   expire  ();
+  void   arm     ();
+  qint64 earliest() const;
+
+  QTimer                                      m_timer;
+  QHash<quint64, Entry>                       m_entries;
+  QHash<QString, quint64>                     m_names;
+  QHash<QString, Timing>                      m_timings;
+  std::array<std::array<Slot, SLOTS>, LEVELS> m_slots;
+  std::array<quint64, LEVELS>                 m_occupied {};
+  qint64                                      m_now;
+  qint64                                      m_armed    = 0;
+  quint64                                     m_next     = 0;
+  quint64                                     m_wakeups  = 0;
+  quint64                                     m_early    = 0;
+  bool                                        m_expiring = false;
+};
+
+#endif
@@ -1,5 +1,6 @@
 #include "TransceiverBase.hpp"
 
+#include <array>
 #include <exception>
 
 #include <QString>
@@ -7,11 +8,32 @@
 #include <QThread>
 #include <QDebug>
 
+#include "LatencyHistogram.hpp"
 #include "moc_TransceiverBase.cpp"
 
 namespace
 {
   auto const unexpected = TransceiverBase::tr ("Unexpected rig error");
+
+  // one histogram per TransceiverBase::Operation, in order
+  std::array<LatencyHistogram, 4> latencies;
+
+  char const * const latency_names[] {"PTT", "FREQUENCY", "TX_FREQUENCY", "POLL"};
+}
+
+QVariantMap TransceiverBase::latency ()
+{
+  QVariantMap result;
+  for (std::size_t i = 0; i < latencies.size (); ++i)
+    {
+      result[latency_names[i]] = latencies[i].stats ();
+    }
+  return result;
+}
+
+void TransceiverBase::record_latency (Operation operation, QElapsedTimer const& timer)
+{
+  latencies[static_cast<std::size_t> (operation)].record (timer.nsecsElapsed () / 1000);
 }
 
 void TransceiverBase::start (unsigned sequence_number) noexcept
@@ -68,7 +90,10 @@ void TransceiverBase::set (TransceiverState const& s,
             }
           if (ptt_off)
             {
-              do_ptt (false);
+              {
+                timed t {Operation::PTT};
+                do_ptt (false);
+              }
               do_post_ptt (false);
               QThread::msleep (100); // some rigs cannot process CAT
                                      // commands while switching from
@@ -79,7 +104,10 @@ void TransceiverBase::set (TransceiverState const& s,
                    || (s.mode () != UNK && s.mode () != requested_.mode ())) // or mode change
                   || ptt_off))       // or just returned to rx
             {
-              do_frequency (s.frequency (), s.mode (), ptt_off);
+              {
+                timed t {Operation::FREQUENCY};
+                do_frequency (s.frequency (), s.mode (), ptt_off);
+              }
               do_post_frequency (s.frequency (), s.mode ());
 
               // record what actually changed
@@ -95,7 +123,10 @@ void TransceiverBase::set (TransceiverState const& s,
                   // || s.split () != requested_.split ())) // or split change
                   || (s.tx_frequency () && ptt_on)) // or about to tx split
                 {
-                  do_tx_frequency (s.tx_frequency (), s.mode (), ptt_on);
+                  {
+                    timed t {Operation::TX_FREQUENCY};
+                    do_tx_frequency (s.tx_frequency (), s.mode (), ptt_on);
+                  }
                   do_post_tx_frequency (s.tx_frequency (), s.mode ());
 
                   // record what actually changed
@@ -105,7 +136,10 @@ void TransceiverBase::set (TransceiverState const& s,
             }
           if (ptt_on)
             {
-              do_ptt (true);
+              {
+                timed t {Operation::PTT};
+                do_ptt (true);
+              }
               do_post_ptt (true);
               QThread::msleep (100); // some rigs cannot process CAT
                                      // commands while switching from
@@ -3,8 +3,10 @@
 
 #include <stdexcept>
 
+#include <QElapsedTimer>
 #include <QString>
 #include <QLoggingCategory>
+#include <QVariantMap>
 #include "Transceiver.hpp"
 
 //
@@ -80,6 +82,16 @@ public:
   //
   TransceiverState const& state () const {return actual_;}
 
+  //
+  // Rig operations whose latency we keep histograms of, across all
+  // instances, since there's only ever one rig in use at a time
+  //
+  enum class Operation {PTT, FREQUENCY, TX_FREQUENCY, POLL};
+
+  // latency histograms, in the form the API reports them; callable
+  // from any thread
+  static QVariantMap latency ();
+
 protected:
   //
   // Error exception which is thrown to signal unexpected errors.
@@ -129,6 +141,25 @@ protected:
   // sub class may asynchronously take the rig offline by calling this
   void offline (QString const& reason);
 
+  // record the time taken by a rig operation, from when the timer
+  // was started; whether it succeeded or not, it took this long
+  static void record_latency (Operation, QElapsedTimer const&);
+
+  // use this convenience class to time an operation in a scope
+  class timed
+  {
+  public:
+    explicit timed (Operation operation)
+      : operation_ {operation}
+    {
+      timer_.start ();
+    }
+    ~timed () {record_latency (operation_, timer_);}
+  private:
+    Operation operation_;
+    QElapsedTimer timer_;
+  };
+
 private:
   void startup ();
   void shutdown ();
@@ -0,0 +1,180 @@
+#include "TxFrameQueue.hpp"
+#include <algorithm>
+#include <exception>
+#include <utility>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QMetaObject>
+#include "commons.h"
+#include "JS8.hpp"
+#include "JS8Submode.hpp"
+#include "Modulator.hpp"
+
+Q_DECLARE_LOGGING_CATEGORY(txframequeue_js8)
+
+/******************************************************************************/
+// Private Implementation
+/******************************************************************************/
+
+// Encode and synthesize a frame, and queue it for the Modulator, unless
+// it's in the ring already, i.e., queued and not yet taken. The keys of
+// the slots are ours alone; the Modulator owns the slots from tail up to
+// head, but never touches their keys, so we can look at them while it
+// takes frames from the ring. A frame sent over and over, e.g., a
+// heartbeat, is made again as soon as the one before it is taken.
+
+void
+TxFrameQueue::render(Request const & request,
+                     int     const   submode,
+                     double  const   frequency,
+                     bool    const   shaping)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  Key key {QList<int>(JS8_NUM_SYMBOLS, 0), submode, frequency, shaping};
+
+  try
+  {
+    JS8::encode(request.bits,
+                JS8::Costas::array(JS8::Submode::costas(submode)),
+                request.message.constData(),
+                key.tones.data());
+  }
+  catch (std::exception const & e)
+  {
+    qCDebug(txframequeue_js8) << "unable to encode" << request.message << e.what();
+    return;
+  }
+
+  auto const head = m_head.load(std::memory_order_relaxed);
+  auto const tail = m_tail.load(std::memory_order_acquire);
+
+  for (auto i = tail; i != head; ++i)
+  {
+    if (m_keys[i % CAPACITY] == key) return;
+  }
+
+  if (head - tail >= CAPACITY)
+  {
+    ++m_dropped;
+    return;
+  }
+
+  m_slots[head % CAPACITY] = std::make_unique<Frame>(Frame{key, Modulator::synthesize(key.tones,
+                                                                                     submode,
+                                                                                     frequency,
+                                                                                     shaping)});
+  m_keys [head % CAPACITY] = std::move(key);
+  m_head.store(head + 1, std::memory_order_release);
+
+  m_renderAhead.record(timer.nsecsElapsed() / 1000);
+  ++m_renders;
+
+  qCDebug(txframequeue_js8) << "ready" << request.message.trimmed() << "in" << timer.elapsed() << "ms";
+}
+
+/******************************************************************************/
+// Public Interface
+/******************************************************************************/
+
+TxFrameQueue::TxFrameQueue(QObject * const parent)
+: QObject{parent}
+{
+  m_thread.setObjectName("TxFrameQueue");
+  m_context.moveToThread(&m_thread);
+  m_thread.start(QThread::LowPriority);
+}
+
+TxFrameQueue::~TxFrameQueue()
+{
+  m_thread.quit();
+  m_thread.wait();
+}
+
+void
+TxFrameQueue::prepare(QList<Request> const & requests,
+                      int            const   submode,
+                      double         const   frequency,
+                      bool           const   shaping)
+{
+  if (requests.isEmpty()) return;
+
+  QMetaObject::invokeMethod(&m_context, [this, requests, submode, frequency, shaping]()
+  {
+    for (auto const & request : requests) render(request, submode, frequency, shaping);
+  }, Qt::QueuedConnection);
+}
+
+std::optional<std::vector<qint16>>
+TxFrameQueue::take(Key const & key)
+{
+  auto const tail = m_tail.load(std::memory_order_relaxed);
+  auto const head = m_head.load(std::memory_order_acquire);
+  auto       last = head;
+
+  for (auto i = tail; i != head; ++i)
+  {
+    if (m_slots[i % CAPACITY]->key == key)
+    {
+      last = i;
+      break;
+    }
+  }
+
+  std::optional<std::vector<qint16>> pcm;
+
+  if (last != head) pcm = std::move(m_slots[last % CAPACITY]->pcm);
+
+  auto const end = last != head ? last + 1 : head;
+
+  for (auto i = tail; i != end; ++i) m_slots[i % CAPACITY].reset();
+
+  m_tail.store(end, std::memory_order_release);
+
+  if (pcm) ++m_hits;
+  else     ++m_misses;
+
+  return pcm;
+}
+
+void
+TxFrameQueue::started(qint64 const offset,
+                      bool   const cut,
+                      bool   const ready,
+                      qint64 const renderUS)
+{
+  if (offset < 0)
+  {
+    ++m_early;
+  }
+  else
+  {
+    ++m_late;
+    m_lateness.record(offset * 1000);
+  }
+
+  if (cut)    ++m_cut;
+  if (!ready) m_renderInline.record(renderUS);
+}
+
+QVariantMap
+TxFrameQueue::stats() const
+{
+  return {
+    {"RENDERED",      m_renders.load()},
+    {"DROPPED",       m_dropped.load()},
+    {"HITS",          m_hits.load()},
+    {"MISSES",        m_misses.load()},
+    {"EARLY",         m_early.load()},
+    {"LATE",          m_late.load()},
+    {"CUT",           m_cut.load()},
+    {"LATENESS",      m_lateness.stats()},
+    {"RENDER_AHEAD",  m_renderAhead.stats()},
+    {"RENDER_INLINE", m_renderInline.stats()}
+  };
+}
+
+/******************************************************************************/
+
+Q_LOGGING_CATEGORY(txframequeue_js8, "txframequeue.js8", QtWarningMsg)
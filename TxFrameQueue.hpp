@@ -0,0 +1,136 @@
+#ifndef TX_FRAME_QUEUE_HPP__
+#define TX_FRAME_QUEUE_HPP__
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QThread>
+#include <QVariantMap>
+#include <QtGlobal>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "LatencyHistogram.hpp"
+
+// Transmissions encoded and synthesized ahead of time, so that when the
+// time comes to send one, the Modulator has only to take it, rather than
+// synthesize it while the period boundary passes.
+//
+// The GUI thread tells us which frames it expects to send next; we encode
+// and synthesize them on a thread of our own, and hand them over to the
+// Modulator's thread through a single producer, single consumer ring of
+// a few entries, without locking. A transmission is used only if what's
+// to be sent matches it in full; anything else, e.g., a frame changed by
+// typeahead, or a change of offset, is synthesized by the Modulator as it
+// would have been without us, so that a wrong guess costs us nothing but
+// the work of having made it.
+//
+// The Modulator reports each start of transmission to us, with how far
+// from the period boundary it was, and whether the frame was ready; the
+// counters are read from any thread by stats().
+
+class TxFrameQueue final : public QObject
+{
+  Q_OBJECT
+
+public:
+
+  // What a transmission is synthesized from.
+
+  struct Key
+  {
+    QList<int> tones;
+    int        submode;
+    double     frequency;
+    bool       shaping;
+
+    bool operator==(Key const &) const = default;
+  };
+
+  // A frame to be sent, as message text and frame type bits.
+
+  struct Request
+  {
+    QByteArray message;
+    int        bits;
+  };
+
+  explicit TxFrameQueue(QObject * parent = nullptr);
+  ~TxFrameQueue();
+
+  // Encode and synthesize the frames provided, in order, unless that's
+  // been done already; called from the GUI thread.
+
+  void prepare(QList<Request> const & requests,
+               int                    submode,
+               double                 frequency,
+               bool                   shaping);
+
+  // Take the transmission for the key provided, if it's ready, dropping
+  // any queued ahead of it. If it's not, drop everything queued; we're
+  // not sending what we expected to, so nothing there is of any use.
+  // Called from the Modulator's thread.
+
+  std::optional<std::vector<qint16>> take(Key const & key);
+
+  // Record a start of transmission, the milliseconds after the period
+  // boundary it was at, negative if before, whether it was late enough
+  // to lose symbols, and whether its frame was ready or took so many
+  // microseconds to synthesize. Called from the Modulator's thread.
+
+  void started(qint64 offset,
+               bool   cut,
+               bool   ready,
+               qint64 renderUS);
+
+  // Counters, in the form the API reports them.
+
+  QVariantMap stats() const;
+
+private:
+
+  static constexpr quint32 CAPACITY = 4;
+
+  struct Frame
+  {
+    Key                 key;
+    std::vector<qint16> pcm;
+  };
+
+  // Accessed only on the worker thread.
+
+  void render(Request const & request,
+              int             submode,
+              double          frequency,
+              bool            shaping);
+
+  QThread                                      m_thread;
+  QObject                                      m_context;
+  std::array<Key, CAPACITY>                    m_keys;
+
+  // The ring; slots from tail up to head are owned by the consumer, the
+  // rest by the producer.
+
+  std::array<std::unique_ptr<Frame>, CAPACITY> m_slots;
+  std::atomic<quint32>                         m_head    {0};
+  std::atomic<quint32>                         m_tail    {0};
+
+  // Read from any thread by stats().
+
+  std::atomic<quint64>                         m_renders {0};
+  std::atomic<quint64>                         m_dropped {0};
+  std::atomic<quint64>                         m_hits    {0};
+  std::atomic<quint64>                         m_misses  {0};
+  std::atomic<quint64>                         m_early   {0};
+  std::atomic<quint64>                         m_late    {0};
+  std::atomic<quint64>                         m_cut     {0};
+  LatencyHistogram                             m_lateness;
+  LatencyHistogram                             m_renderAhead;
+  LatencyHistogram                             m_renderInline;
+};
+
+#endif
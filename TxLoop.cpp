@@ -8,17 +8,16 @@
 
 Q_DECLARE_LOGGING_CATEGORY(txloop_js8)
 
-TxLoop::TxLoop(const QString & name) :
+TxLoop::TxLoop(const QString & name, TimerWheel & wheel) :
     m_name{name},
     m_next_activity{DriftingDateTime::currentDateTimeUtc()},
     m_tx_delay_ms{100}, // arbitrary
+    m_wheel{wheel},
+    m_task{"txloop." + name},
     m_submode{Varicode::JS8CallSlow},
     m_active{false},
     m_loop_period_ms{600000} // arbitrary
 {
-    m_next_activity_timer.setTimerType(Qt::PreciseTimer);
-    m_next_activity_timer.setSingleShot(true);
-    connect(&m_next_activity_timer, &QTimer::timeout, this, &TxLoop::onTimer);
 }
 
 TxLoop::~TxLoop() {
@@ -26,8 +25,13 @@ TxLoop::~TxLoop() {
     qCDebug(txloop_js8) << m_name << "Destruction of TX loop";
 }
 
+// The wheel keeps DriftingDateTime's time, so the trigger is given as
+// an absolute time, in milliseconds, and stays put when the drift changes.
+void TxLoop::scheduleTrigger(qint64 trigger_ms) {
+    m_wheel.at(m_task, trigger_ms, [this](){ onTimer(); });
+}
+
 void TxLoop::onTimer() {
-    m_next_activity_timer.stop();
     if(m_active) {
         // Calculate the next start point.
         // Doing it as milliseconds is fast and straightforward.
@@ -62,7 +66,7 @@ void TxLoop::onTimer() {
         qCDebug(txloop_js8)
             << m_name << "triggers TX, and also plans future signal to happen at" << m_next_activity
             << ". Taking into account TX delay" << m_tx_delay_ms << "ms, the timer is to wake us in" << wait_for_next_trigger << "ms";
-        m_next_activity_timer.start(wait_for_next_trigger);
+        scheduleTrigger(next_activity_ms - m_tx_delay_ms);
         emit nextActivityChanged(m_next_activity);
         emit triggerTxNow();
     } else {
@@ -86,15 +90,13 @@ void TxLoop::onPlumbingCompleted() const {
 
 void TxLoop::onDriftChange(qint64 /* new_drift */) {
     if (m_active) {
-        m_next_activity_timer.stop();
         QDateTime now = DriftingDateTime::currentDateTimeUtc();
         QDateTime need_to_push_ptt = m_next_activity.addMSecs(-m_tx_delay_ms);
         if (now < need_to_push_ptt && need_to_push_ptt < now.addMSecs(m_loop_period_ms)) {
             // Small drift change which does not affect when the next event is to happen.
-            // Just adjust the timer (slightly).
+            // The timer wheel has already moved our task along with the drift.
             qint64 fire_in_ms = now.msecsTo(need_to_push_ptt);
             qCDebug(txloop_js8) << m_name << "Small drift change, pushing PTT in" << fire_in_ms << "ms";
-            m_next_activity_timer.start(fire_in_ms);
         } else {
             qCDebug(txloop_js8) << m_name << "After big drift change, need to restart transmission schedule from square one.";
             onTxLoopPeriodChangeStart(m_loop_period_ms);
@@ -144,7 +146,7 @@ void TxLoop::onTxDelayChange(qint64 tx_delay_ms) {
 void TxLoop::onLoopCancel() {
     if(m_active) {
         m_active = false;
-        m_next_activity_timer.stop();
+        m_wheel.cancel(m_task);
         qCDebug(txloop_js8) << m_name << "Canceling scheduled TX activity (and telling all who want to know).";
         emit canceled();
     } else {
@@ -154,21 +156,20 @@ void TxLoop::onLoopCancel() {
 
 void TxLoop::onTxLoopPeriodChangeStart(qint64 loop_period_ms) {
     // This is also sometimes used to adjust the timer when tx delay changed.
-    m_next_activity_timer.stop(); // Probably redundant.
     m_loop_period_ms = loop_period_ms;
     QDateTime now = DriftingDateTime::currentDateTimeUtc();
-    qint64 now_ms = now.currentMSecsSinceEpoch();
+    qint64 now_ms = now.toMSecsSinceEpoch();
     qint64 earliest = now_ms + m_loop_period_ms;
     qint64 mode_period_ms = ((qint64)1000) * JS8::Submode::period(m_submode);
     qint64 remainder = earliest % mode_period_ms;
     qint64 next_start =
         0 == remainder ? earliest : earliest + mode_period_ms - remainder;
     bool need_to_send_signal =
-        !m_active || next_start != m_next_activity.currentMSecsSinceEpoch();
+        !m_active || next_start != m_next_activity.toMSecsSinceEpoch();
     qint64 need_to_wait = next_start-now_ms-m_tx_delay_ms;
     m_active = true;
     m_next_activity.setMSecsSinceEpoch(next_start);
-    m_next_activity_timer.start(need_to_wait);
+    scheduleTrigger(next_start - m_tx_delay_ms);
     qCDebug(txloop_js8)
         << m_name
         << "Active tx loop, transmission to start at" << m_next_activity
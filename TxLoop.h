@@ -2,8 +2,8 @@
 #define TXLOOP_H
 
 #include <QDateTime>
-#include <QTimer>
 
+#include "TimerWheel.hpp"
 #include "TwoPhaseSignal.h"
 #include "varicode.h"
 
@@ -25,9 +25,11 @@ private:
     QDateTime m_next_activity;
     // How much tx_delay, in milliseconds, we need to be early.
     qint64 m_tx_delay_ms;
-    // A timer that is supposed to wake us up when it is time.
+    // The timer wheel that is supposed to wake us up when it is time,
+    // and the name of our task on it.
     // This will be m_tx_delay_ms earlier than m_next_activity.
-    QTimer m_next_activity_timer;
+    TimerWheel & m_wheel;
+    const QString m_task;
     // The currently active JS8 m_submode.
     Varicode::SubmodeType m_submode;
     // Whether this loop is active (or else does nothing).
@@ -36,8 +38,9 @@ private:
     qint64 m_loop_period_ms;
 
 public:
-    // Provide a "name" argument that can be used for logging.
-    TxLoop(const QString& name);
+    // Provide a "name" argument that can be used for logging,
+    // and the timer wheel to schedule our activity on.
+    TxLoop(const QString& name, TimerWheel & wheel);
 
     ~TxLoop();
 
@@ -124,8 +127,9 @@ public slots:
      */
     void onLoopCancel();
 
-private slots:
+private:
     void onTimer();
+    void scheduleTrigger(qint64 trigger_ms);
 };
 
 #endif
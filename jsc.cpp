@@ -21,35 +21,229 @@
 #include "jsc.h"
 #include "varicode.h"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <limits>
+#include <string_view>
+#include <vector>
 
 #include <QDebug>
-#include <QCache>
 
-QMap<QString, quint32> LOOKUP_CACHE;
+namespace {
+    // Compact trie over the word list, built once on first use. Nodes are
+    // stored in one flat vector with each node's children contiguous and
+    // sorted by byte, so that a lookup is a binary search per character
+    // rather than a scan over every word sharing the first letter.
+    //
+    // The answer is the same as the linear scan it replaces: of all words
+    // in the first letter's range of the list that are a prefix of the
+    // input, the one that appears first in the list.
+    class Trie {
+    public:
+        static constexpr quint32 NONE = std::numeric_limits<quint32>::max();
+
+        static Trie const & instance(){
+            static Trie const trie;
+            return trie;
+        }
 
-Codeword JSC::codeword(quint32 index, bool separate, quint32 bytesize, quint32 s, quint32 c){
-    QList<Codeword> out;
+        // Index into JSC::prefix for each possible first byte, or NONE.
+        quint32 group(unsigned char byte) const {
+            return groups_[byte];
+        }
 
-    quint32 v = ((index % s) << 1) + (quint32)separate;
-    out.prepend(Varicode::intToBits(v, bytesize + 1));
+        // Position in JSC::list of the best match for the input, where
+        // at(i) yields the i'th byte of the input, or zero past its end.
+        template<typename At>
+        quint32 find(At && at) const {
+            quint32 best = NONE;
+            quint32 node = 0;
+
+            for(int i = 0; ; i++){
+                auto const byte = at(i);
+                if(!byte){
+                    break;
+                }
+
+                node = child(node, byte);
+                if(node == NONE){
+                    break;
+                }
+
+                best = std::min(best, nodes_[node].rank);
+            }
+
+            return best;
+        }
+
+    private:
+        struct Node {
+            quint32 first;         // index of the first child
+            quint32 rank;          // list position of the word ending here, or NONE
+            quint16 count;         // number of children
+            unsigned char byte;    // byte on the edge leading here
+        };
+
+        Trie(){
+            groups_.fill(NONE);
+            for(quint32 i = 0; i < JSC::prefixSize; i++){
+                auto const byte = static_cast<unsigned char>(JSC::prefix[i].str[0]);
+                if(groups_[byte] == NONE){
+                    groups_[byte] = i;
+                }
+            }
+
+            // Only words that the scan would have reached are inserted,
+            // i.e. those inside the range of their first letter's group;
+            // single word groups are answered without looking at the trie.
+            auto const word = [](quint32 i){
+                return std::string_view(JSC::list[i].str, JSC::list[i].size);
+            };
+
+            std::vector<quint32> entries;
+            entries.reserve(JSC::size);
+
+            for(quint32 i = 0; i < JSC::size; i++){
+                if(JSC::list[i].size <= 0){
+                    continue;
+                }
+
+                auto const g = groups_[static_cast<unsigned char>(JSC::list[i].str[0])];
+                if(g == NONE || JSC::prefix[g].size == 1){
+                    continue;
+                }
+
+                auto const start = static_cast<quint32>(JSC::prefix[g].index);
+                if(i < start || i >= start + JSC::prefix[g].size){
+                    continue;
+                }
+
+                entries.push_back(i);
+            }
+
+            std::sort(entries.begin(), entries.end(), [&word](quint32 a, quint32 b){
+                auto const wa = word(a);
+                auto const wb = word(b);
+                return wa == wb ? a < b : wa < wb;
+            });
+
+            // Breadth first, so that each node's children are appended
+            // together; every pending range shares a prefix of the given
+            // depth, with the words ending exactly there sorted first.
+            struct Range {
+                quint32 node;
+                size_t  lo;
+                size_t  hi;
+                size_t  depth;
+            };
+
+            nodes_.push_back({0, NONE, 0, 0});
+
+            std::vector<Range> pending{{0, 0, entries.size(), 0}};
+            for(size_t p = 0; p < pending.size(); p++){
+                auto const r = pending[p];
+
+                auto lo = r.lo;
+                while(lo < r.hi && word(entries[lo]).size() == r.depth){
+                    lo++;
+                }
+
+                nodes_[r.node].first = nodes_.size();
+
+                while(lo < r.hi){
+                    auto const byte = static_cast<unsigned char>(word(entries[lo])[r.depth]);
+
+                    auto hi = lo;
+                    while(hi < r.hi && static_cast<unsigned char>(word(entries[hi])[r.depth]) == byte){
+                        hi++;
+                    }
+
+                    auto const rank = word(entries[lo]).size() == r.depth + 1 ? entries[lo] : NONE;
+
+                    pending.push_back({static_cast<quint32>(nodes_.size()), lo, hi, r.depth + 1});
+                    nodes_.push_back({0, rank, 0, byte});
+                    nodes_[r.node].count++;
+
+                    lo = hi;
+                }
+            }
+
+            nodes_.shrink_to_fit();
+        }
+
+        quint32 child(quint32 node, unsigned char byte) const {
+            auto const begin = nodes_.begin() + nodes_[node].first;
+            auto const end   = begin + nodes_[node].count;
+            auto const it    = std::lower_bound(begin, end, byte, [](Node const & n, unsigned char b){
+                return n.byte < b;
+            });
+
+            return it != end && it->byte == byte ? static_cast<quint32>(it - nodes_.begin()) : NONE;
+        }
+
+        std::array<quint32, 256> groups_;
+        std::vector<Node> nodes_;
+    };
+
+    // Shared by both lookup() overloads; at(i) yields the i'th byte of
+    // the word being looked up, or zero once past its end.
+    template<typename At>
+    quint32 lookupBytes(At && at, bool *ok){
+        auto const & trie = Trie::instance();
+
+        auto const g = trie.group(at(0));
+        if(g == Trie::NONE){
+            if(ok) *ok = false;
+            return 0;
+        }
+
+        // a group with a single word needs no further comparison
+        if(JSC::prefix[g].size == 1){
+            if(ok) *ok = true;
+            return JSC::list[JSC::prefix[g].index].index;
+        }
+
+        auto const position = trie.find(at);
+        if(position == Trie::NONE){
+            if(ok) *ok = false;
+            return 0;
+        }
+
+        if(ok) *ok = true;
+        return JSC::list[position].index;
+    }
+}
+
+Codeword JSC::codeword(quint32 index, bool separate, quint32 bytesize, quint32 s, quint32 c){
+    // the continuation bytes come out last to first; there are at most
+    // a handful of them for an index within the dictionary.
+    quint32 bytes[8];
+    int count = 0;
 
     quint32 x = index / s;
-    while(x > 0){
+    while(x > 0 && count < 8){
         x -= 1;
-        out.prepend(Varicode::intToBits((x % c) + s, bytesize));
+        bytes[count++] = (x % c) + s;
         x /= c;
     }
 
     Codeword word;
-    foreach(auto w, out){
-        word.append(w);
+    while(count > 0){
+        word.append(bytes[--count], bytesize);
     }
 
+    quint32 v = ((index % s) << 1) + (quint32)separate;
+    word.append(v, bytesize + 1);
+
     return word;
 }
 
-QList<CodewordPair> JSC::compress(QString text){
+// If pStarts is provided, it receives the position in the text at which
+// each codeword begins; that's the sum of the character counts before
+// it, unless part of a word couldn't be found in the dictionary.
+
+QList<CodewordPair> JSC::compress(QString text, QList<int> *pStarts){
     QList<CodewordPair> out;
 
     const quint32 b = 4;
@@ -60,9 +254,14 @@ QList<CodewordPair> JSC::compress(QString text){
 
     QStringList words = text.split(" ", Qt::KeepEmptyParts);
 
+    int start = 0;
+
     for(int i = 0, len = words.length(); i < len; i++){
         QString w = words[i];
 
+        int wordStart = start;
+        start += w.length() + 1;
+
         bool isLastWord = (i == len - 1);
         bool ok = false;
         bool isSpaceCharacter = false;
@@ -73,6 +272,8 @@ QList<CodewordPair> JSC::compress(QString text){
             isSpaceCharacter = true;
         }
 
+        int consumed = 0;
+
         while(!w.isEmpty()){
             // this does both prefix and full match lookup
             auto index = lookup(w, &ok);
@@ -88,13 +289,16 @@ QList<CodewordPair> JSC::compress(QString text){
             bool shouldAppendSpace = isLast && !isSpaceCharacter && !isLastWord;
 
             out.append({ codeword(index, shouldAppendSpace, b, s, c), (quint32)t.size + (shouldAppendSpace ? 1 : 0) /* for the space that follows */});
+            if(pStarts) pStarts->append(wordStart + consumed);
+
+            consumed += t.size;
         }
     }
 
     return out;
 }
 
-QString JSC::decompress(Codeword const& bitvec){
+QString JSC::decompress(BitBuffer<72> const& bitvec){
     const quint32 b = 4;
     const quint32 s = 7;
     const quint32 c = pow(2, b) - s;
@@ -117,11 +321,10 @@ QString JSC::decompress(Codeword const& bitvec){
     int i = 0;
     int count = bitvec.count();
     while(i < count){
-        auto b = bitvec.mid(i, 4);
-        if(b.length() != 4){
+        if(i + 4 > count){
             break;
         }
-        quint64 byte = Varicode::bitsToInt(b);
+        quint64 byte = bitvec.extract(i, 4);
         bytes.append(byte);
         i += 4;
 
@@ -177,62 +380,23 @@ bool JSC::exists(QString w, quint32 *pIndex){
     return found && JSC::map[index].size == w.length();
 }
 
-quint32 JSC::lookup(QString w, bool * ok){
-    if(LOOKUP_CACHE.contains(w)){
-        if(ok) *ok = true;
-        return LOOKUP_CACHE[w];
-    }
+// Characters outside of Latin-1 become '?', as they would in a call to
+// toLatin1(), and an embedded null ends the word, as it would in a C
+// string; we just don't make a copy to get there.
 
-    bool found = false;
-    quint32 result = lookup(w.toLatin1().data(), &found);
-    if(found){
-        LOOKUP_CACHE[w] = result;
-    }
-
-    if(ok) *ok = found;
-    return result;
+quint32 JSC::lookup(QString w, bool * ok){
+    return lookupBytes([&w](int i) -> unsigned char {
+        if(i >= w.size()){
+            return 0;
+        }
+        auto const u = w.at(i).unicode();
+        return u > 0xff ? '?' : static_cast<unsigned char>(u);
+    }, ok);
 }
 
 quint32 JSC::lookup(char const* b, bool *ok){
-    quint32 index = 0;
-    quint32 count = 0;
-    bool found = false;
-
-    // first find prefix match to jump into the list faster
-    for(quint32 i = 0; i < JSC::prefixSize; i++){
-        // skip obvious non-prefixes...
-        if(b[0] != JSC::prefix[i].str[0]){
-            continue;
-        }
-
-        // ok, we found one... let's end early for single char strings.
-        if(JSC::prefix[i].size == 1){
-            if(ok) *ok = true;
-            return JSC::list[JSC::prefix[i].index].index;
-        }
-
-        // otherwise, keep track of the first index in the list and the number of elements
-        index = JSC::prefix[i].index;
-        count = JSC::prefix[i].size;
-        found = true;
-        break;
-    }
-
-    // no prefix found... no lookup
-    if(!found){
-        if(ok) *ok = false;
-        return 0;
-    }
-
-    // now that we have the first index in the list, let's just iterate through the list, comparing words along the way
-    for(quint32 i = index; i < index + count; i++){
-        quint32 len = JSC::list[i].size;
-        if(strncmp(b, JSC::list[i].str, len) == 0){
-            if(ok) *ok = true;
-            return JSC::list[i].index;
-        }
-    }
-
-    if(ok) *ok = false;
-    return 0;
+    // the input is null terminated, so we never read past its end
+    return lookupBytes([b](int i){
+        return static_cast<unsigned char>(b[i]);
+    }, ok);
 }
@@ -12,8 +12,10 @@
 #include <QPair>
 #include <QVector>
 
-typedef QPair<QVector<bool>, quint32> CodewordPair;        // Tuple(Codeword, N) where N = number of characters
-typedef QVector<bool> Codeword;                        // Codeword bit vector
+#include "BitBuffer.hpp"
+
+typedef BitBuffer<64> Codeword;                        // Codeword bit vector
+typedef QPair<Codeword, quint32> CodewordPair;         // Tuple(Codeword, N) where N = number of characters
 
 typedef struct Tuple{
     char const * str;
@@ -29,8 +31,8 @@ public:
     static CompressionTable loadCompressionTable(QTextStream &stream);
 #endif
     static Codeword codeword(quint32 index, bool separate, quint32 bytesize, quint32 s, quint32 c);
-    static QList<CodewordPair> compress(QString text);
-    static QString decompress(Codeword const& bits);
+    static QList<CodewordPair> compress(QString text, QList<int> *pStarts = nullptr);
+    static QString decompress(BitBuffer<72> const& bits);
 
     static bool exists(QString w, quint32 *pIndex);
     static quint32 lookup(QString w, bool *ok);
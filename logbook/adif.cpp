@@ -1,11 +1,35 @@
 #include "adif.h"
 
+#include <algorithm>
+#include <cstring>
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
 #include <QTextStream>
 #include <QDateTime>
 #include <QLoggingCategory>
 Q_DECLARE_LOGGING_CATEGORY(adif_js8)
 
+namespace
+{
+  // Index cache; lives alongside the log, and is good for as long as the
+  // log is as it was when we wrote it, or has only been appended to. We
+  // check the latter by way of a digest of the tail of what we indexed.
+  auto const INDEX_SUFFIX = ".idx";
+  constexpr quint32 INDEX_MAGIC = 0x4a533849; // JS8I
+  constexpr quint32 INDEX_VERSION = 2;
+  constexpr qint64 INDEX_TAIL = 4096;
+
+  QByteArray tailDigest(QFile &file, qint64 size)
+  {
+    auto const from = std::max<qint64>(0, size - INDEX_TAIL);
+    if (!file.seek(from)) return {};
+    return QCryptographicHash::hash(file.read(size - from), QCryptographicHash::Md5);
+  }
+}
+
 const QStringList ADIF_FIELDS = {
     // ADIF 3.1.0 - pulled from http://www.adif.org/310/adx310.xsd on 2019-06-04
     "APP",
@@ -172,101 +196,290 @@ const QStringList ADIF_FIELDS = {
 void ADIF::init(QString const& filename)
 {
     _filename = filename;
-    _data.clear();
+    _clear();
+}
+
+
+void ADIF::_clear()
+{
+    _index.clear();
+    _bandNames.clear();
+    _modeNames.clear();
+    _bandBits.clear();
+    _modeBits.clear();
+    _count = 0;
 }
 
 
-QString ADIF::extractField(QString const& record, QString const& fieldName) const
+// Bit for the name provided, interning it if it's new, and returning the
+// overflow bit if there's no room left to do so.
+ADIF::Bits ADIF::_intern(QString const& name, QStringList &names, QHash<QString, Bits> &bits, int limit, Bits overflow)
 {
-    qsizetype fieldNameIndex = record.indexOf ('<' + fieldName + ':', 0, Qt::CaseInsensitive);
-    if (fieldNameIndex >=0)
+    if (auto const it = bits.constFind(name); it != bits.cend())
     {
-        qsizetype closingBracketIndex = record.indexOf('>',fieldNameIndex);
-        qsizetype fieldLengthIndex    = record.indexOf(':',fieldNameIndex);  // find the size delimiter
-        qsizetype dataTypeIndex       = -1;
-        if (fieldLengthIndex >= 0)
-        {
-          dataTypeIndex = record.indexOf(':',fieldLengthIndex+1);  // check for a second : indicating there is a data type
-          if (dataTypeIndex > closingBracketIndex)
-            dataTypeIndex = -1; // second : was found but it was beyond the closing >
-        }
+        return it.value();
+    }
 
-        if ((closingBracketIndex > fieldNameIndex) && (fieldLengthIndex > fieldNameIndex) && (fieldLengthIndex< closingBracketIndex))
-        {
-            qsizetype fieldLengthCharCount = closingBracketIndex - fieldLengthIndex -1;
-            if (dataTypeIndex >= 0)
-              fieldLengthCharCount -= 2; // data type indicator is always a colon followed by a single character
-            QString fieldLengthString = record.mid(fieldLengthIndex+1,fieldLengthCharCount);
-            int fieldLength = fieldLengthString.toInt();
-            if (fieldLength > 0)
-            {
-              QString field = record.mid(closingBracketIndex+1,fieldLength);
-              return field;
-            }
-       }
+    if (names.size() >= limit)
+    {
+        return overflow;
     }
-    return "";
-}
 
+    auto const bit = Bits {1} << names.size();
+    names.append(name);
+    bits.insert(name, bit);
+    return bit;
+}
 
 
-void ADIF::load()
+// Single pass over the log, by way of the lengths given in each field's
+// tag, so that a value is never searched for anything, and a stray '<'
+// in one doesn't trip us up. The first of each field in a record wins.
+// Header, if asked to look for one, is whatever precedes <EOH>, and
+// there is one if the data doesn't start with a tag.
+void ADIF::_parse(QByteArrayView data, bool header)
 {
-    _data.clear();
-    QFile inputFile(_filename);
-    if (inputFile.open(QIODevice::ReadOnly))
-    {
-      QTextStream in(&inputFile);
-      QString buffer;
-      bool pre_read {false};
-      qsizetype end_position {-1};
+    auto const begin = data.data();
+    auto const end = begin + data.size();
+    auto at = begin;
 
-      // skip optional header record
-      do
+    if (header && data.size() && *at != '<')
+    {
+        at = end;
+        for (auto lt = begin; (lt = static_cast<char const *>(std::memchr(lt, '<', end - lt))); ++lt)
         {
-          buffer += in.readLine () + '\n';
-          if (buffer.startsWith (QChar {'<'})) // denotes no header
+            if (end - lt >= 5 && QByteArrayView(lt, 5).compare("<EOH>", Qt::CaseInsensitive) == 0)
             {
-              pre_read = true;
+                at = lt + 5;
+                break;
             }
-          else
+        }
+    }
+
+    QSO qso;
+    bool pending = false;
+
+    while (at < end)
+    {
+        auto const lt = static_cast<char const *>(std::memchr(at, '<', end - at));
+        if (!lt) break;
+        auto const gt = static_cast<char const *>(std::memchr(lt, '>', end - lt));
+        if (!gt) break;
+
+        QByteArrayView const tag(lt + 1, gt - lt - 1);
+        at = gt + 1;
+
+        auto const colon = tag.indexOf(':');
+        if (colon < 0)
+        {
+            if (tag.compare("EOR", Qt::CaseInsensitive) == 0)
             {
-              end_position = buffer.indexOf ("<EOH>", 0, Qt::CaseInsensitive);
+                _add(qso);
+                qso = QSO {};
+                pending = false;
             }
+            continue;
         }
-      while (!in.atEnd () && !pre_read && end_position < 0);
-      if (!pre_read)            // found header
+
+        auto const name = tag.first(colon);
+        auto length = tag.sliced(colon + 1);
+        if (auto const type = length.indexOf(':'); type >= 0)
         {
-          buffer.remove (0, end_position + 5);
+            length = length.first(type);
         }
-      while (buffer.size () || !in.atEnd ())
+
+        bool ok = false;
+        auto const size = length.toLongLong(&ok);
+        if (!ok || size <= 0) continue;
+
+        QByteArrayView const value(at, std::min<qint64>(size, end - at));
+        at += value.size();
+
+        auto const take = [&](QString &field)
         {
-          do
-            {
-              end_position = buffer.indexOf ("<EOR>", 0, Qt::CaseInsensitive);
-              if (!in.atEnd () && end_position < 0)
-                {
-                  buffer += in.readLine () + '\n';
-                }
-            }
-          while (!in.atEnd () && end_position < 0);
-          qsizetype record_length {end_position >= 0 ? end_position + 5 : -1};
-          auto record = buffer.left (record_length).trimmed ();
-          auto next_record = buffer.indexOf (QChar {'<'}, record_length);
-          buffer.remove (0, next_record >=0 ? next_record : buffer.size ());
-          record = record.mid (record.indexOf (QChar {'<'}));
-          add (extractField (record, "CALL")
-               , extractField (record, "BAND")
-               , extractField (record, "MODE")
-               , extractField (record, "SUBMODE")
-               , extractField (record, "GRIDSQUARE")
-               , extractField (record, "QSO_DATE")
-               , extractField (record, "NAME")
-               , extractField (record, "COMMENT")
-               );
-        }
-        inputFile.close ();
+            if (field.isEmpty()) field = QString::fromUtf8(value);
+            pending = true;
+        };
+
+        if      (name.compare("CALL",       Qt::CaseInsensitive) == 0) take(qso.call);
+        else if (name.compare("BAND",       Qt::CaseInsensitive) == 0) take(qso.band);
+        else if (name.compare("MODE",       Qt::CaseInsensitive) == 0) take(qso.mode);
+        else if (name.compare("SUBMODE",    Qt::CaseInsensitive) == 0) take(qso.submode);
+        else if (name.compare("GRIDSQUARE", Qt::CaseInsensitive) == 0) take(qso.grid);
+        else if (name.compare("QSO_DATE",   Qt::CaseInsensitive) == 0) take(qso.date);
+        else if (name.compare("NAME",       Qt::CaseInsensitive) == 0) take(qso.name);
+        else if (name.compare("COMMENT",    Qt::CaseInsensitive) == 0) take(qso.comment);
+    }
+
+    // a final record that's missing its <EOR> still counts
+    if (pending)
+    {
+        _add(qso);
+    }
+}
+
+
+bool ADIF::_loadIndex(QFile &file, qint64 &from)
+{
+    QFile cache(_filename + INDEX_SUFFIX);
+    if (!cache.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QDataStream in(&cache);
+    in.setVersion(QDataStream::Qt_6_5);
+
+    quint32 magic, version;
+    qint64 size, modified;
+    QByteArray tail;
+    QStringList bandNames, modeNames;
+    in >> magic >> version >> size >> modified >> tail;
+
+    if (in.status() != QDataStream::Ok || magic != INDEX_MAGIC || version != INDEX_VERSION
+        || size > file.size()
+        || (size == file.size() && modified != QFileInfo(file.fileName()).lastModified().toMSecsSinceEpoch())
+        || tail != tailDigest(file, size))
+    {
+        return false;
+    }
+
+    qint64 count;
+    quint32 entries;
+    in >> count >> bandNames >> modeNames >> entries;
+
+    if (bandNames.size() > 63 || modeNames.size() > 64)
+    {
+        return false;
+    }
+
+    QHash<QString, Entry> index;
+    index.reserve(entries);
+    for (quint32 i = 0; i < entries && in.status() == QDataStream::Ok; ++i)
+    {
+        QString call;
+        Entry entry;
+        in >> call >> entry.bands >> entry.modes >> entry.grid >> entry.date >> entry.name >> entry.comment;
+        index.insert(call, entry);
+    }
+
+    if (in.status() != QDataStream::Ok)
+    {
+        return false;
+    }
+
+    _clear();
+    _index = std::move(index);
+    _count = count;
+    for (auto const &band : bandNames) _intern(band, _bandNames, _bandBits, 63, ANY_BAND);
+    for (auto const &mode : modeNames) _intern(mode, _modeNames, _modeBits, 64, 0);
+    from = size;
+    return true;
+}
+
+
+void ADIF::_saveIndex(QFile &file) const
+{
+    QSaveFile cache(_filename + INDEX_SUFFIX);
+    if (!cache.open(QIODevice::WriteOnly))
+    {
+        qCWarning(adif_js8) << "unable to write log index:" << cache.errorString();
+        return;
+    }
+
+    QDataStream out(&cache);
+    out.setVersion(QDataStream::Qt_6_5);
+
+    out << INDEX_MAGIC << INDEX_VERSION
+        << static_cast<qint64>(file.size())
+        << static_cast<qint64>(QFileInfo(file.fileName()).lastModified().toMSecsSinceEpoch())
+        << tailDigest(file, file.size())
+        << static_cast<qint64>(_count)
+        << _bandNames
+        << _modeNames
+        << static_cast<quint32>(_index.size());
+
+    for (auto it = _index.cbegin(); it != _index.cend(); ++it)
+    {
+        auto const &entry = it.value();
+        out << it.key() << entry.bands << entry.modes << entry.grid << entry.date << entry.name << entry.comment;
+    }
+
+    if (!cache.commit())
+    {
+        qCWarning(adif_js8) << "unable to write log index:" << cache.errorString();
+    }
+}
+
+
+void ADIF::load()
+{
+    _clear();
+
+    QFile inputFile(_filename);
+    if (!inputFile.open(QIODevice::ReadOnly))
+    {
+        return;
+    }
+
+    // start from the index if it's good, parsing whatever's been appended
+    // since; failing that, parse the lot
+    qint64 from = 0;
+    if (!_loadIndex(inputFile, from))
+    {
+        _clear();
+        from = 0;
+    }
+
+    auto const size = inputFile.size();
+    if (from == size)
+    {
+        return;
+    }
+
+    if (auto const mapped = inputFile.map(from, size - from))
+    {
+        _parse(QByteArrayView(reinterpret_cast<char const *>(mapped), size - from), from == 0);
+        inputFile.unmap(mapped);
+    }
+    else
+    {
+        inputFile.seek(from);
+        _parse(inputFile.readAll(), from == 0);
     }
+
+    qCDebug(adif_js8) << "indexed" << _count << "QSOs with" << _index.size() << "calls from offset" << from;
+
+    _saveIndex(inputFile);
+    inputFile.close();
+}
+
+
+void ADIF::_add(QSO const& qso)
+{
+    if (qso.call.isEmpty())
+      {
+        return;
+      }
+
+    auto &entry = _index[qso.call];
+    entry.bands |= qso.band.isEmpty() ? ANY_BAND : _intern(qso.band.toLower(), _bandNames, _bandBits, 63, ANY_BAND);
+
+    // modes beyond what we've bits for just aren't recorded; they're of
+    // interest, but nothing depends on them
+    auto const mode = qso.submode.isEmpty() ? qso.mode : qso.submode;
+    if (!mode.isEmpty())
+      {
+        entry.modes |= _intern(mode.toUpper(), _modeNames, _modeBits, 64, 0);
+      }
+
+    // later records are more recent, and so take precedence
+    if (!qso.grid.isEmpty()) entry.grid = qso.grid;
+    if (!qso.date.isEmpty()) entry.date = qso.date;
+    if (!qso.name.isEmpty()) entry.name = qso.name;
+    if (!qso.comment.isEmpty()) entry.comment = qso.comment;
+
+    ++_count;
 }
 
 
@@ -282,53 +495,68 @@ void ADIF::add(QString const& call, QString const& band, QString const& mode, QS
     q.name = name;
     q.comment = comment;
 
-    if (q.call.size ())
-      {
-        _data.insert(q.call,q);
-        // qCDebug(adif_js8) << "Added as worked:" << call << band << mode << date;
-      }
+    _add(q);
+    // qCDebug(adif_js8) << "Added as worked:" << call << band << mode << date;
 }
 
 // return true if in the log same band
 bool ADIF::match(QString const& call, QString const& band) const
 {
-    QList<QSO> qsos = _data.values(call);
-    if (qsos.size()>0)
+    auto const it = _index.constFind(call);
+    if (it == _index.cend())
     {
-        QSO q;
-        foreach(q,qsos)
-        {
-            if (     (band.compare(q.band,Qt::CaseInsensitive) == 0)
-                  || (band=="")
-                  || (q.band==""))
-            {
-                return true;
-            }
-        }
+        return false;
     }
-    return false;
+
+    return band == "" || (it.value().bands & (ANY_BAND | bandBit(band)));
 }
 
-QList<ADIF::QSO> ADIF::find(QString const& call) const
+ADIF::Bits ADIF::bandBit(QString const& band) const
 {
-    return _data.values(call);
+    return _bandBits.value(band.toLower(), 0);
+}
+
+ADIF::Bits ADIF::modeBit(QString const& mode) const
+{
+    return _modeBits.value(mode.toUpper(), 0);
+}
+
+ADIF::Bits ADIF::bands(QString const& call) const
+{
+    return _index.value(call).bands;
+}
+
+ADIF::Bits ADIF::modes(QString const& call) const
+{
+    return _index.value(call).modes;
+}
+
+// the most recent of each of the details logged for the call
+bool ADIF::find(QString const& call, ADIF::QSO &details) const
+{
+    auto const it = _index.constFind(call);
+    if (it == _index.cend())
+    {
+        return false;
+    }
+
+    auto const &entry = it.value();
+    details.call = call;
+    details.grid = entry.grid;
+    details.date = entry.date;
+    details.name = entry.name;
+    details.comment = entry.comment;
+    return true;
 }
 
 QList<QString> ADIF::getCallList() const
 {
-    QList<QString> p;
-    QMultiHash<QString,QSO>::const_iterator i = _data.constBegin();
-     while (i != _data.constEnd())
-     {
-         p << i.key();
-         ++i;
-     }
-    return p;
+    return _index.keys();
 }
 
 qsizetype ADIF::getCount() const
 {
-    return _data.size();
+    return _count;
 }
 
 QByteArray ADIF::QSOToADIF(QString const& hisCall, QString const& hisGrid, QString const& mode, QString const& submode
@@ -18,6 +18,9 @@
 #include <QtGui>
 #endif
 
+#include <QByteArrayView>
+#include <QHash>
+
 #include "fileutils.h"
 
 class QDateTime;
@@ -34,7 +37,20 @@ class ADIF
 	void load();
     void add(QString const& call, QString const& band, QString const& mode, const QString &submode, QString const& grid, QString const& date, const QString &name, const QString &comment);
     bool match(QString const& call, QString const& band) const;
-    QList<ADIF::QSO> find(QString const& call) const;
+    bool find(QString const& call, ADIF::QSO &details) const;
+
+    // Bands and modes are interned, each given a bit, so that the bands
+    // or modes a call has been worked on are a bit set, and a question of
+    // whether it's been worked on one is a mask. A QSO logged without a
+    // band counts as worked on any, and is recorded as ANY_BAND; should
+    // a log hold more bands than we have bits for, the extras do too.
+    using Bits = quint64;
+    static constexpr Bits ANY_BAND = Bits {1} << 63;
+
+    Bits bandBit(QString const& band) const; // 0 if none logged
+    Bits modeBit(QString const& mode) const; // 0 if none logged
+    Bits bands(QString const& call) const;   // 0 if not worked
+    Bits modes(QString const& call) const;
 	QList<QString> getCallList() const;
 	qsizetype getCount() const;
 
@@ -54,10 +70,32 @@ class ADIF
     };
 
     private:
-		QMultiHash<QString, QSO> _data;
+		// What we keep for each call worked: the bands and modes worked on,
+		// and the most recent of each of the details that the log has for it.
+		// This is also what's kept in the index cache alongside the log,
+		// from which we can load without parsing the log, or by parsing
+		// only what's been appended to it since.
+		struct Entry
+		{
+		  Bits bands {0};
+		  Bits modes {0};
+		  QString grid,date,name,comment;
+		};
+
+		QHash<QString, Entry> _index;
+		QStringList _bandNames;           // by bit, lower case
+		QStringList _modeNames;           // by bit, upper case
+		QHash<QString, Bits> _bandBits;
+		QHash<QString, Bits> _modeBits;
+		qsizetype _count {0};
 		QString _filename;
 
-		QString extractField(QString const& line, QString const& fieldName) const;
+		void _add(QSO const& qso);
+		Bits _intern(QString const& name, QStringList &names, QHash<QString, Bits> &bits, int limit, Bits overflow);
+		void _clear();
+		void _parse(QByteArrayView data, bool header);
+		bool _loadIndex(QFile &file, qint64 &from);
+		void _saveIndex(QFile &file) const;
 };
 
 
@@ -19,12 +19,18 @@
 #include <QFile>
 #include <QTextStream>
 #include <QDebug>
+#include <algorithm>
+#include <map>
+#include <vector>
 #include "Radio.hpp"
+#include "Symbols.hpp"
 
 void CountryDat::init(const QString filename)
 {
     _filename = filename;
-    _data.clear();
+    _exact.clear();
+    _nodes.clear();
+    _edges.clear();
 }
 
 QString CountryDat::_extractName(const QString line) const
@@ -75,9 +81,11 @@ QStringList CountryDat::_extractPrefix(QString &line, bool &more) const
 
 void CountryDat::load()
 {
-    _data.clear();
+    _exact.clear();
     _countryNames.clear(); //used by countriesWorked
 
+    QHash<QString, int> prefixes;
+
     QFile inputFile(_filename);
     if (inputFile.open(QIODevice::ReadOnly))
     {
@@ -97,6 +105,7 @@ void CountryDat::load()
               int i1=principalPrefix.indexOf(":");
               if(i1>0) principalPrefix=principalPrefix.mid(0,i1);
               name += "; " + principalPrefix + "; " + continent;
+                int entity = _countryNames.size();
                 _countryNames << name;
                 bool more = true;
                 QStringList prefixs;
@@ -111,50 +120,172 @@ void CountryDat::load()
                 QString p;
                 foreach(p,prefixs)
                 {
-                    if (p.length() > 0)
-                        _data.insert(p,name);
+                    if (p.startsWith('='))
+                        _exact.insert(p.mid(1),entity);
+                    else if (p.length() > 0)
+                        prefixes.insert(p,entity);
                 }
             }
           }
        }
     inputFile.close();
     }
+
+    _gitmo = _countryNames.indexOf("Guantanamo Bay; KG4; NA");
+    _unitedStates = _countryNames.indexOf("United States; K; NA");
+
+    _compile(prefixes);
+}
+
+// Build the trie from the prefixes provided, first as a tree of ordered
+// maps, and then flattened breadth first into the node and edge arrays.
+void CountryDat::_compile(QHash<QString, int> const &prefixes)
+{
+    struct Building
+    {
+        std::map<char16_t, int> children;
+        int entity = -1;
+    };
+
+    std::vector<Building> tree(1);
+
+    for (auto it = prefixes.constBegin(); it != prefixes.constEnd(); ++it)
+    {
+        int at = 0;
+        for (QChar const c : it.key())
+        {
+            auto const key = c.unicode();
+            auto const found = tree[at].children.find(key);
+            if (found != tree[at].children.end())
+            {
+                at = found->second;
+            }
+            else
+            {
+                int const next = tree.size();
+                tree[at].children.emplace(key, next);
+                tree.emplace_back();
+                at = next;
+            }
+        }
+        tree[at].entity = it.value();
+    }
+
+    _nodes.clear();
+    _edges.clear();
+    _nodes.reserve(tree.size());
+    _edges.reserve(tree.size() - 1);
+
+    // Walking the tree breadth first numbers the nodes in the order we
+    // visit them, so a node's children, queued together, land together.
+    std::vector<int> order {0};
+    std::vector<int> number(tree.size());
+
+    for (std::size_t i = 0; i < order.size(); ++i)
+    {
+        for (auto const &[key, child] : tree[order[i]].children)
+        {
+            number[child] = order.size();
+            order.push_back(child);
+        }
+    }
+
+    for (int const at : order)
+    {
+        auto const &building = tree[at];
+        Node node;
+        node.firstEdge = _edges.size();
+        node.edgeCount = building.children.size();
+        node.entity = building.entity;
+        _nodes.append(node);
+
+        for (auto const &[key, child] : building.children)
+        {
+            _edges.append({key, number[child]});
+        }
+    }
+}
+
+// Entity of the longest prefix in the trie matching the start of the
+// prefix provided, else -1; case is ignored.
+int CountryDat::_longestPrefix(QStringView prefix) const
+{
+    if (_nodes.isEmpty())
+    {
+        return -1;
+    }
+
+    int at = 0;
+    int entity = -1;
+
+    for (QChar const c : prefix)
+    {
+        auto const key = c.toUpper().unicode();
+        auto const first = _edges.cbegin() + _nodes[at].firstEdge;
+        auto const last = first + _nodes[at].edgeCount;
+        auto const edge = std::lower_bound(first, last, key, [](Edge const &e, char16_t k)
+        {
+            return e.key < k;
+        });
+
+        if (edge == last || edge->key != key)
+        {
+            break;
+        }
+
+        at = edge->node;
+        if (_nodes[at].entity >= 0)
+        {
+            entity = _nodes[at].entity;
+        }
+    }
+
+    return entity;
 }
 
 // return country name else ""
 QString CountryDat::find(QString call) const
 {
-  call = call.toUpper ();
+  return _countryNames.value (entity (call));
+}
+
+int CountryDat::entity(QString call) const
+{
+  // nearly every call we see is already upper case, so we can look it
+  // up as it is
+  if (std::any_of (call.cbegin (), call.cend (), [] (QChar c) { return c.isLower (); }))
+    {
+      call = call.toUpper ();
+    }
 
   // check for exact match first
-  if (_data.contains ("=" + call))
+  if (auto const exact = _exact.constFind (call); exact != _exact.cend ())
     {
-      return fixup (_data.value ("=" + call), call);
+      return fixup (exact.value (), call);
     }
 
-  auto prefix = Radio::effective_prefix (call);
-  auto match_candidate = prefix;
-  while (match_candidate.size () >= 1)
+  // the effective prefix of a call we've seen before is already known;
+  // one we haven't needn't be kept just because we looked it up
+  auto const prefix = Symbols::findCall (call).prefix;
+  auto const entity = _longestPrefix (prefix);
+  if (entity >= 0)
     {
-      if (_data.contains (match_candidate))
-        {
-          return fixup (_data.value (match_candidate), prefix);
-        }
-      match_candidate = match_candidate.left (match_candidate.size () - 1);
+      return fixup (entity, prefix);
     }
-  return QString {};
+  return -1;
 }
 
-QString CountryDat::fixup (QString country, QString const& call) const
+int CountryDat::fixup (int entity, QStringView call) const
 {
   //
   // deal with special rules that cty.dat does not cope with
   //
 
   // KG4 2x1 and 2x3 calls that map to Gitmo are mainland US not Gitmo
-  if (call.startsWith ("KG4") && call.size () != 5 && call.size () != 3)
+  if (entity == _gitmo && _unitedStates >= 0
+      && call.startsWith (u"KG4") && call.size () != 5 && call.size () != 3)
     {
-      country.replace ("Guantanamo Bay; KG4; NA", "United States; K; NA");
+      return _unitedStates;
     }
-  return country;
+  return entity;
 }
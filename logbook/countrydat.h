@@ -11,7 +11,9 @@
 
 #include <QString>
 #include <QStringList>
+#include <QStringView>
 #include <QHash>
+#include <QVector>
 
 
 class CountryDat
@@ -20,17 +22,42 @@ public:
   void init(const QString filename);
   void load();
   QString find(QString prefix) const; // return country name or ""
+  int entity(QString call) const;     // return entity, i.e., index into country names, or -1
   QStringList  getCountryNames() const { return _countryNames; };
 
 private:
+  // Prefixes are compiled at load into a trie, its nodes stored in
+  // breadth-first order so that each node's children are contiguous,
+  // and an entity is the index of its name in _countryNames; a lookup
+  // walks the prefix a character at a time, remembering the deepest
+  // entity seen, without building any strings along the way.
+  struct Node
+  {
+    int firstEdge = 0;
+    int edgeCount = 0;
+    int entity    = -1;
+  };
+
+  struct Edge
+  {
+    char16_t key;
+    int      node;
+  };
+
   QString _extractName(const QString line) const;
   void _removeBrackets(QString &line, const QString a, const QString b) const;
   QStringList _extractPrefix(QString &line, bool &more) const;
-  QString fixup (QString country, QString const& call) const;
+  void _compile(QHash<QString, int> const &prefixes);
+  int _longestPrefix(QStringView prefix) const;
+  int fixup (int entity, QStringView call) const;
 
   QString _filename;
   QStringList _countryNames;
-  QHash<QString, QString> _data;
+  QHash<QString, int> _exact;   // exact calls, i.e., =CALL entries
+  QVector<Node> _nodes;
+  QVector<Edge> _edges;
+  int _gitmo = -1;              // entities for fixup()
+  int _unitedStates = -1;
 };
 
 #endif
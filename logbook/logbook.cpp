@@ -24,11 +24,11 @@ void LogBook::init()
       countryDataFilename = QString {":/"} + countryFileName;
     }
 
+  _entities.clear();
+
   _countries.init(countryDataFilename);
   _countries.load();
 
-  _worked.init(_countries.getCountryNames());
-
   _log.init(dataPath.absoluteFilePath (logFileName));
   _log.load();
 
@@ -38,18 +38,90 @@ void LogBook::init()
 
 void LogBook::_setAlreadyWorkedFromLog()
 {
-  QList<QString> calls = _log.getCallList();
-  QString c;
-  foreach(c,calls)
+  _entityBands.assign(_countries.getCountryNames().size(), 0);
+
+  foreach(auto const &call, _log.getCallList())
     {
-      QString countryName = _countries.find(c);
-      if (countryName.length() > 0)
+      auto const entity = _entity(call);
+      if (entity >= 0)
         {
-          _worked.setAsWorked(countryName);
+          _entityBands[entity] |= _log.bands(call);
         }
     }
 }
 
+int LogBook::_entity(const QString &call) const
+{
+  auto const symbol = Symbols::call(call);
+  if (symbol.handle == Symbols::NONE)
+    {
+      return _countries.entity(call);
+    }
+
+  auto const slot = Symbols::slot(symbol.handle);
+  if (slot >= _entities.size())
+    {
+      _entities.resize(slot + 1);
+    }
+
+  auto &entity = _entities[slot];
+  if (entity.id == -2 || entity.handle != symbol.handle)
+    {
+      entity.handle = symbol.handle;
+      entity.id = _countries.entity(call);
+    }
+  return entity.id;
+}
+
+// Answer all the questions at once; each is a bit test, given the bits
+// for the band and mode asked about.
+LogBook::Worked LogBook::_worked(const QString &call, ADIF::Bits band, ADIF::Bits mode) const
+{
+  Worked worked;
+  if (call.isEmpty())
+    {
+      return worked;
+    }
+
+  auto const callBands = _log.bands(call);
+  worked.call = callBands != 0;
+  worked.callOnBand = callBands & band;
+  worked.callInMode = _log.modes(call) & mode;
+
+  worked.entityId = _entity(call);
+  if (worked.entityId >= 0)
+    {
+      auto const entityBands = _entityBands[worked.entityId];
+      worked.entity = entityBands != 0;
+      worked.entityOnBand = entityBands & band;
+      worked.country = _countries.getCountryNames().value(worked.entityId);
+    }
+  return worked;
+}
+
+LogBook::Worked LogBook::worked(const QString &call, const QString &band, const QString &mode) const
+{
+  return _worked(call,
+                 band.isEmpty() ? ~ADIF::Bits {0} : ADIF::ANY_BAND | _log.bandBit(band),
+                 mode.isEmpty() ? ~ADIF::Bits {0} : _log.modeBit(mode));
+}
+
+// Batch form, for the activity views; the band and mode are looked up
+// once, rather than once per call.
+QVector<LogBook::Worked> LogBook::worked(const QStringList &calls, const QString &band, const QString &mode) const
+{
+  auto const bandBits = band.isEmpty() ? ~ADIF::Bits {0} : ADIF::ANY_BAND | _log.bandBit(band);
+  auto const modeBits = mode.isEmpty() ? ~ADIF::Bits {0} : _log.modeBit(mode);
+
+  QVector<Worked> results;
+  results.reserve(calls.size());
+  for (auto const &call : calls)
+    {
+      results.append(_worked(call, bandBits, modeBits));
+    }
+  return results;
+}
+
 bool LogBook::hasWorkedBefore(const QString &call, const QString &band){
     return _log.match(call, band);
 }
@@ -63,12 +135,12 @@ void LogBook::match(/*in*/const QString call,
         return;
     }
 
-    QString currentBand = "";  // match any band
-    callWorkedBefore = _log.match(call, currentBand);
-    countryName = _countries.find(call);
+    auto const result = worked(call);
+    callWorkedBefore = result.call;
 
-    if (countryName.length() > 0){  //  country was found
-        countryWorkedBefore = _worked.getHasWorked(countryName);
+    if (result.entityId >= 0){  //  country was found
+        countryName = result.country;
+        countryWorkedBefore = result.entity;
     } else {
         countryName = "where?"; //error: prefix not found
         countryWorkedBefore = false;
@@ -88,17 +160,15 @@ bool LogBook::findCallDetails(
         return false;
     }
 
-    auto qsos = _log.find(call);
-    if(qsos.isEmpty()){
+    ADIF::QSO qso;
+    if(!_log.find(call, qso)){
         return false;
     }
 
-    foreach(auto qso, qsos){
-        if(grid.isEmpty() && !qso.grid.isEmpty()) grid = qso.grid;
-        if(date.isEmpty() && !qso.date.isEmpty()) date = qso.date;
-        if(name.isEmpty() && !qso.name.isEmpty()) name = qso.name;
-        if(comment.isEmpty() && !qso.comment.isEmpty()) comment = qso.comment;
-    }
+    if(grid.isEmpty() && !qso.grid.isEmpty()) grid = qso.grid;
+    if(date.isEmpty() && !qso.date.isEmpty()) date = qso.date;
+    if(name.isEmpty() && !qso.name.isEmpty()) name = qso.name;
+    if(comment.isEmpty() && !qso.comment.isEmpty()) comment = qso.comment;
 
     return true;
 }
@@ -106,10 +176,10 @@ bool LogBook::findCallDetails(
 void LogBook::addAsWorked(const QString call, const QString band, const QString mode, const QString submode, const QString grid, const QString date, const QString name, const QString comment)
 {
   _log.add(call,band,mode,submode,grid,date,name,comment);
-  QString countryName = _countries.find(call);
-  if (countryName.length() > 0)
-    _worked.setAsWorked(countryName);
-}
-
-
 
+  auto const entity = _entity(call);
+  if (entity >= 0)
+    {
+      _entityBands[entity] |= _log.bands(call);
+    }
+}
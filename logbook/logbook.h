@@ -8,20 +8,39 @@
 
 
 #include <QString>
+#include <QStringList>
 #include <QFont>
+#include <QVector>
+
+#include <vector>
 
 #include "countrydat.h"
-#include "countriesworked.h"
 #include "adif.h"
 #include "n3fjp.h"
+#include "Symbols.hpp"
 
 class QDir;
 
 class LogBook
 {
 public:
+    // Everything we know about having worked a call, and its entity, on
+    // any band and on the band asked about, and in the mode asked about.
+    struct Worked
+    {
+        bool call = false;
+        bool callOnBand = false;
+        bool callInMode = false;
+        bool entity = false;
+        bool entityOnBand = false;
+        int entityId = -1;
+        QString country;
+    };
+
     void init();
     bool hasWorkedBefore(const QString &call, const QString &band);
+    Worked worked(const QString &call, const QString &band = {}, const QString &mode = {}) const;
+    QVector<Worked> worked(const QStringList &calls, const QString &band = {}, const QString &mode = {}) const;
     void match(/*in*/ const QString call,
               /*out*/ QString &countryName,
                       bool &callWorkedBefore,
@@ -37,9 +56,26 @@ public:
 
 private:
    CountryDat _countries;
-   CountriesWorked _worked;
    ADIF _log;
 
+   // Bands worked for each entity, indexed by entity, in the same terms
+   // as the log's bands worked for each call.
+   std::vector<ADIF::Bits> _entityBands;
+
+   // Entities of calls we've been asked about, indexed by the slot of
+   // their symbol's handle, so that asking again costs nothing; -2 if not
+   // yet known. Slots are reused once a symbol's been forgotten, so the
+   // handle is kept as well, and an entry for some other handle is as
+   // good as unknown. Reset whenever cty.dat is reloaded.
+   struct Entity
+   {
+       Symbols::Handle handle = Symbols::NONE;
+       int id = -2;
+   };
+   mutable std::vector<Entity> _entities;
+
+   int _entity(const QString &call) const;
+   Worked _worked(const QString &call, ADIF::Bits band, ADIF::Bits mode) const;
    void _setAlreadyWorkedFromLog();
 
 };
@@ -60,6 +60,7 @@
 #include "decodedtext.h"
 #include "Radio.hpp"
 #include "Bands.hpp"
+#include "TransceiverBase.hpp"
 #include "TransceiverFactory.hpp"
 #include "StationList.hpp"
 #include "MessageClient.hpp"
@@ -71,11 +72,14 @@
 #include "DriftingDateTime.h"
 #include "jsc_checker.h"
 #include "Inbox.h"
+#include "InboxService.h"
+#include "LogJournal.hpp"
 #include "messagewindow.h"
 #include "NotificationAudio.h"
 #include "JS8Submode.hpp"
 #include "EventFilter.hpp"
 #include "Geodesic.hpp"
+#include "Symbols.hpp"
 
 #include "ui_mainwindow.h"
 #include "moc_mainwindow.cpp"
@@ -88,14 +92,20 @@ static char   msgsent[29];
 static int    msgibits;
 
 
-// How often to poll the UI, in MS.
+// How often to step the TX sequence while transmitting, or about to, in MS.
 // Some things may depend on this being a divisor of 1000.
 constexpr quint32 UI_POLL_INTERVAL_MS = 100;
 
 // How many milliseconds to wait before releasing PTT at end of transmission.
 constexpr int TX_SWITCHOFF_DELAY = 200;
 
-int volatile    itone[JS8_NUM_SYMBOLS];  // Audio tones for all Tx symbols
+// How many queued frames, past the next one to be sent, to synthesize ahead.
+constexpr qsizetype TX_FRAMES_AHEAD = 2;
+
+// How many milliseconds past a period boundary, beyond the length of the
+// input buffer, to wait before restarting input to resize the buffer.
+constexpr qint64 AUDIO_RETUNE_MARGIN_MS = 50;
+
 struct dec_data dec_data;                // for sharing with Fortran
 struct specData specData;                // Used by plotter
 std::mutex      fftw_mutex;
@@ -115,13 +125,24 @@ namespace
     constexpr auto TX = 2;
   }
 
-  int ms_minute_error ()
+  // Bounds on the activity we hold on to; plenty for a busy band over a
+  // good few days, but fixed, however long we're left running. Times are
+  // in milliseconds.
+  namespace Cache
   {
-    auto const now    = DriftingDateTime::currentDateTimeLocal();
-    auto const time   = now.time();
-    auto const second = time.second();
+    constexpr qsizetype CALL_ACTIVITY = 5000;
+    constexpr qsizetype HEARD_GRAPH   = 20000; // edges, over all bands
+    constexpr qsizetype INBOX_COUNTS  = 2000;
+    constexpr qsizetype BANDS         = 32;
+    constexpr qint64    TTL           = 7 * 24 * 60 * 60 * 1000LL;
+    constexpr qint64    TRIM_INTERVAL = 60 * 1000;
+  }
 
-    return now.msecsTo (now.addSecs (second > 30 ? 60 - second : -second)) - time.msec ();
+  // Approximate memory used by a string, for cache accounting.
+  qsizetype
+  stringBytes(QString const & s)
+  {
+    return sizeof(QString) + s.capacity() * sizeof(QChar);
   }
 
   QString
@@ -136,6 +157,33 @@ namespace
       else                            return QString("now");
   }
 
+  // API representations of the most recent band activity at an offset
+  // and of a call's activity; shared by the RX.GET_*_ACTIVITY snapshots
+  // and the RX.*_ACTIVITY.DELTA streams.
+
+  QVariantMap
+  bandActivityDetail(auto const & d)
+  {
+      return {
+        { "FREQ",   QVariant(d.dial + d.offset)                  },
+        { "DIAL",   QVariant(d.dial)                             },
+        { "OFFSET", QVariant(d.offset)                           },
+        { "TEXT",   QVariant(d.text)                             },
+        { "SNR",    QVariant(d.snr)                              },
+        { "UTC",    QVariant(d.utcTimestamp.toMSecsSinceEpoch()) }
+      };
+  }
+
+  QVariantMap
+  callActivityDetail(auto const & cd)
+  {
+      return {
+        { "SNR",  QVariant(cd.snr)                              },
+        { "GRID", QVariant(cd.grid)                             },
+        { "UTC",  QVariant(cd.utcTimestamp.toMSecsSinceEpoch()) }
+      };
+  }
+
   namespace State
   {
     constexpr QStringView Ready   = u"Ready";
@@ -307,6 +355,65 @@ namespace
     for (int i = 0;         i < nh;   ++i) b[i] = 0.0f; // Zero out leading edge
     for (int i = npts - nh; i < npts; ++i) b[i] = 0.0f; // Zero out trailing edge
   }
+
+  // Unpack a decoded frame on the global thread pool; the varicode
+  // unpacking that DecodedText performs is safe to run concurrently.
+  // Should it throw, the future finishes without a result.
+
+  QFuture<DecodedText>
+  unpackDecoded(JS8::Event::Decoded const & decoded)
+  {
+    return QtConcurrent::run([decoded](){ return DecodedText(decoded); });
+  }
+
+  // Inbox lookups by callsign, run on the inbox service thread, so that
+  // an autoreply needing more than one of them makes a single trip. All
+  // of them fall back to the base callsign when the full one has nothing.
+
+  int
+  nextMessageIdForCallsign(Inbox         & inbox,
+                           QString const & callsign)
+  {
+    for (auto const & call : {callsign, Symbols::call(callsign).base})
+    {
+      for (auto const & [id, message] : inbox.values("STORE", "$.params.TO", call, 0, 10))
+      {
+        if (!message.params().value("TEXT").toString().trimmed().isEmpty()) return id;
+      }
+    }
+
+    return -1;
+  }
+
+  int
+  lookaheadMessageIdForCallsign(Inbox         & inbox,
+                                QString const & callsign,
+                                int     const   afterMsgId)
+  {
+    if (auto const mid = inbox.getLookaheadMessageIdForCallsign(callsign, afterMsgId); mid != -1) return mid;
+
+    return inbox.getLookaheadMessageIdForCallsign(Symbols::call(callsign).base, afterMsgId);
+  }
+
+  int
+  lookaheadGroupMessageIdForCallsign(Inbox         & inbox,
+                                     QString const & group_name,
+                                     QString const & callsign,
+                                     int     const   afterMsgId)
+  {
+    if (auto const mid = inbox.getLookaheadGroupMessageIdForCallsign(group_name, callsign, afterMsgId); mid != -1) return mid;
+
+    return inbox.getLookaheadGroupMessageIdForCallsign(group_name, Symbols::call(callsign).base, afterMsgId);
+  }
+
+  // How the log files are to be rotated, as configured; the size is in
+  // megabytes there.
+
+  LogJournal::Rotation
+  journalRotation(Configuration const & config)
+  {
+    return {config.log_rotation_size() * 1024LL * 1024LL, false, config.compress_logs()};
+  }
 }
 
 //--------------------------------------------------- MainWindow constructor
@@ -340,8 +447,8 @@ MainWindow::MainWindow(QString  const & program_info,
   m_modulator {new Modulator},
   m_soundOutput {new SoundOutput},
   m_notification {new NotificationAudio},
-  m_cq_loop {new TxLoop {"CQ calls"}},
-  m_hb_loop {new TxLoop {"HB calls"}},
+  m_cq_loop {new TxLoop {"CQ calls", m_wheel}},
+  m_hb_loop {new TxLoop {"HB calls", m_wheel}},
   m_decoder {this},
   m_secBandChanged {0},
   m_freqNominal {0},
@@ -378,12 +485,18 @@ MainWindow::MainWindow(QString  const & program_info,
   m_txTextDirty {false},
   m_driftMsMMA { 0 },
   m_driftMsMMA_N { 0 },
+  m_heardGraph {Cache::HEARD_GRAPH, Cache::TTL},
+  m_callActivityLedger {"CALL_ACTIVITY", Cache::CALL_ACTIVITY, Cache::TTL},
+  m_rxInboxCountLedger {"INBOX_COUNTS", Cache::INBOX_COUNTS, Cache::TTL},
+  m_bandCacheLedger {"BAND_ACTIVITY", Cache::BANDS},
+  m_lastActivityCacheTrim {0},
   m_previousFreq {0},
   m_hbInterval {0},
   m_cqInterval {0},
   m_hbPaused { false },
   m_msAudioOutputBuffered (0u),
   m_framesAudioInputBuffered (JS8_RX_SAMPLE_RATE / 10),
+  m_audioAutoTune (false),
   m_audioThreadPriority (QThread::HighPriority),
   m_notificationAudioThreadPriority (QThread::LowPriority),
   m_decoderThreadPriority (QThread::HighPriority),
@@ -419,9 +532,24 @@ MainWindow::MainWindow(QString  const & program_info,
   m_rigErrorMessageBox.setInformativeText (tr ("Do you want to reconfigure the radio interface?"));
   m_rigErrorMessageBox.setDefaultButton (MessageBox::Ok);
 
+  // the inbox database is owned by the inbox service, which runs all of
+  // its queries and updates on a thread of its own
+  m_inbox.reset(new InboxService(inboxPath()));
+
+  // ALL.TXT and DIRECTED.TXT are written by the journal, on a thread of
+  // its own; they're rotated, and the old ones compressed if asked, as
+  // they get larger than configured
+  m_journal.reset(new LogJournal(journalRotation(m_config)));
+  connect (m_journal.data(), &LogJournal::error, this, &MainWindow::journalError);
+
   // start audio thread and hook up slots & signals for shutdown management
   // these objects need to be in the audio thread so that invoking
   // their slots is done in a thread safe way
+  m_detector->setHealth (&m_audioHealth.input ());
+  m_soundInput->setHealth (&m_audioHealth.input ());
+  m_modulator->setFrameQueue (&m_txFrames);
+  m_modulator->setHealth (&m_audioHealth.output ());
+  m_soundOutput->setHealth (&m_audioHealth.output ());
   m_soundOutput->moveToThread (&m_audioThread);
   m_modulator->moveToThread (&m_audioThread);
   m_soundInput->moveToThread (&m_audioThread);
@@ -637,14 +765,9 @@ MainWindow::MainWindow(QString  const & program_info,
     currentTextChanged();
   });
 
-  m_guiTimer.setTimerType(Qt::PreciseTimer);
-  m_guiTimer.setSingleShot(true);
-  connect(&m_guiTimer, &QTimer::timeout, this, &MainWindow::guiUpdate);
-  m_guiTimer.start(UI_POLL_INTERVAL_MS);
-
-  pttReleaseTimer.setTimerType(Qt::PreciseTimer);
-  pttReleaseTimer.setSingleShot(true);
-  connect(&pttReleaseTimer, &QTimer::timeout, this, &MainWindow::stopTx2);
+  // Once a second, on the second, bring the UI up to date. The TX sequence
+  // runs more often than this, but only while it has something to do.
+  m_wheel.every("ui.second", 1000, 0, [this](){ guiUpdate(); });
 
   logQSOTimer.setSingleShot(true);
   connect(&logQSOTimer, &QTimer::timeout, this, &MainWindow::on_logQSOButton_clicked);
@@ -655,9 +778,6 @@ MainWindow::MainWindow(QString  const & program_info,
   tuneATU_Timer.setSingleShot(true);
   connect(&tuneATU_Timer, &QTimer::timeout, this, &MainWindow::stopTuneATU);
 
-  TxAgainTimer.setSingleShot(true);
-  connect(&TxAgainTimer, &QTimer::timeout, this, &MainWindow::TxAgain);
-
   connect(m_wideGraph.data(), &WideGraph::changeFreq, this, &MainWindow::changeFreq);
   connect(m_wideGraph.data(), &WideGraph::qsy,        this, &MainWindow::qsy);
 
@@ -687,6 +807,11 @@ MainWindow::MainWindow(QString  const & program_info,
   connect(this, &MainWindow::submodeChanged, this->m_hb_loop, &TxLoop::onModeChange);
   connect(this, &MainWindow::submodeChanged, this->m_cq_loop, &TxLoop::onModeChange);
 
+  // Likewise to the start of our own transmissions, if one is pending:
+  connect(this, &MainWindow::submodeChanged, this, [this](){
+      if (m_wheel.isPending("tx.start")) scheduleTxStart();
+  });
+
   // When the loops are switched off, tell the UI:
   connect(m_hb_loop, &TxLoop::canceled, ui->hbMacroButton, [this](){this->ui->hbMacroButton->setChecked(false);});
   connect(m_cq_loop, &TxLoop::canceled, ui->cqMacroButton, [this](){this->ui->cqMacroButton->setChecked(false);});
@@ -737,9 +862,13 @@ MainWindow::MainWindow(QString  const & program_info,
 
   statusChanged();
 
-  connect (&minuteTimer, &QTimer::timeout, this, &MainWindow::on_the_minute);
-  minuteTimer.setSingleShot (true);
-  minuteTimer.start (ms_minute_error () + 60 * 1000);
+  m_wheel.every ("minute", 60 * 1000, 0, [this](){ on_the_minute (); });
+
+  // Show how the audio streams are keeping up every second, and roll the
+  // counters over to a new window, tuning the buffers if asked to, every
+  // window.
+  m_wheel.every ("audio.status", 1000, 0, [this](){ updateAudioHealth (); });
+  m_wheel.every ("audio.roll", AudioHealth::WINDOW_SECONDS * 1000, 0, [this](){ rollAudioHealth (); });
 
   QTimer::singleShot (0, this, &MainWindow::checkStartupWarnings);
 
@@ -1112,6 +1241,7 @@ MainWindow::MainWindow(QString  const & program_info,
               CallDetail cd = {};
               cd.call = callsign;
               m_callActivity[callsign] = cd;
+              m_callActivityLedger.touch(callsign, QDateTime::currentMSecsSinceEpoch());
           } else {
               MessageBox::critical_message (this, QString("%1 is not a valid callsign or group").arg(callsign));
           }
@@ -1146,53 +1276,47 @@ MainWindow::MainWindow(QString  const & program_info,
           selectedCall = "%";
       }
 
-      Inbox inbox(inboxPath());
-      if(!inbox.open()){
-          return;
-      }
-
-      QList<QPair<int, Message> > msgs;
-
-      msgs.append(inbox.values("STORE", "$.params.TO", selectedCall, 0, 1000));
-
-      msgs.append(inbox.values("READ", "$.params.FROM", selectedCall, 0, 1000));
+      m_inbox->write([selectedCall](Inbox & inbox){
+          QList<QPair<int, Message> > msgs;
 
-      foreach(auto pair, inbox.values("UNREAD", "$.params.FROM", selectedCall, 0, 1000)){
-          msgs.append(pair);
+          msgs.append(inbox.values("STORE", "$.params.TO", selectedCall, 0, 1000));
 
-          // mark as read
-          auto msg = pair.second;
-          msg.setType("READ");
-          inbox.set(pair.first, msg);
-      }
+          msgs.append(inbox.values("READ", "$.params.FROM", selectedCall, 0, 1000));
 
-      std::stable_sort(msgs.begin(), msgs.end(), [](QPair<int, Message> const &a, QPair<int, Message> const &b){
-          return QVariant::compare(a.second.params().value("UTC"),
-                                   b.second.params().value("UTC")) == QPartialOrdering::Greater;
-      });
+          foreach(auto pair, inbox.values("UNREAD", "$.params.FROM", selectedCall, 0, 1000)){
+              msgs.append(pair);
 
-      auto mw = new MessageWindow(this);
-      connect(mw, &MessageWindow::finished, this, [this](int){
-          refreshInboxCounts();
-          displayCallActivity();
-      });
-      connect(mw, &MessageWindow::deleteMessage, this, [this](int id){
-          Inbox inbox(inboxPath());
-          if(!inbox.open()){
-              return;
+              // mark as read
+              auto msg = pair.second;
+              msg.setType("READ");
+              inbox.set(pair.first, msg);
           }
 
-          inbox.del(id);
-      });
-      connect(mw, &MessageWindow::replyMessage, this, [this, mw](const QString &text){
-          addMessageText(text, true, true);
-          refreshInboxCounts();
-          displayCallActivity();
-          mw->close();
+          return msgs;
+      }).then(this, [this, selectedCall](QList<QPair<int, Message> > msgs){
+          std::stable_sort(msgs.begin(), msgs.end(), [](QPair<int, Message> const &a, QPair<int, Message> const &b){
+              return QVariant::compare(a.second.params().value("UTC"),
+                                       b.second.params().value("UTC")) == QPartialOrdering::Greater;
+          });
+
+          auto mw = new MessageWindow(this);
+          connect(mw, &MessageWindow::finished, this, [this](int){
+              refreshInboxCounts();
+              displayCallActivity();
+          });
+          connect(mw, &MessageWindow::deleteMessage, this, [this](int id){
+              m_inbox->del(id);
+          });
+          connect(mw, &MessageWindow::replyMessage, this, [this, mw](const QString &text){
+              addMessageText(text, true, true);
+              refreshInboxCounts();
+              displayCallActivity();
+              mw->close();
+          });
+          mw->setCall(selectedCall);
+          mw->populateMessages(msgs);
+          mw->show();
       });
-      mw->setCall(selectedCall);
-      mw->populateMessages(msgs);
-      mw->show();
   });
 
   auto historyAction = new QAction(QString("Show Message Inbox..."), ui->tableWidgetCalls);
@@ -1294,8 +1418,19 @@ MainWindow::MainWindow(QString  const & program_info,
     menu->addAction(logAction);
     logAction->setDisabled(missingCallsign || isAllCall);
 
+    // Whether there's any history to show comes from the inbox thread;
+    // until it does, or if the selection has moved on by then, leave the
+    // action disabled.
+
     menu->addAction(historyAction);
-    historyAction->setDisabled(missingCallsign || isAllCall || !hasMessageHistory(selectedCall));
+    historyAction->setDisabled(true);
+    if(!missingCallsign && !isAllCall){
+        hasMessageHistory(selectedCall).then(menu, [this, historyAction, selectedCall](bool hasHistory){
+            if(callsignSelected() == selectedCall){
+                historyAction->setDisabled(!hasHistory);
+            }
+        });
+    }
 
     menu->addAction(localMessageAction);
     localMessageAction->setDisabled(missingCallsign || isAllCall);
@@ -1822,7 +1957,9 @@ void MainWindow::initializeGroupMessageDummyData()
 
 	processCommandActivity();
 
-	int mid = getNextGroupMessageIdForCallsign("@GROUP42", "W1AW");
+	// This is only dummy data for testing, and each step needs the message
+	// id the one before it stored, so here we wait on the inbox.
+	int mid = getNextGroupMessageIdForCallsign("@GROUP42", "W1AW").result();
 
 	qCDebug(mainwindow_js8) << "Testing group messaging";
 	qCDebug(mainwindow_js8) << "Test message ID: " << mid;
@@ -1883,7 +2020,7 @@ void MainWindow::initializeGroupMessageDummyData()
 
 	processCommandActivity();
 
-	mid = getNextMessageIdForCallsign("W1AW");
+	mid = getNextMessageIdForCallsign("W1AW").result();
 
 	qCDebug(mainwindow_js8) << "Testing group messaging";
 	qCDebug(mainwindow_js8) << "Test message ID: " << mid;
@@ -1920,21 +2057,6 @@ void MainWindow::initialize_fonts ()
 
 void MainWindow::on_the_minute ()
 {
-  if (minuteTimer.isSingleShot ())
-    {
-      minuteTimer.setSingleShot (false);
-      minuteTimer.start (60 * 1000); // run free
-    }
-  else
-    {
-        auto const& ms_error = ms_minute_error ();
-        if (qAbs (ms_error) > 1000) // keep drift within +-1s
-        {
-          minuteTimer.setSingleShot (true);
-          minuteTimer.start (ms_error + 60 * 1000);
-        }
-    }
-
   if (m_config.watchdog ())
     {
       incrementIdleTimer();
@@ -2084,6 +2206,8 @@ MainWindow::~MainWindow()
     fftwf_export_wisdom_to_filename(wisdomFileName());
   }
 
+  m_inbox.reset();
+
   m_networkThread.quit();
   m_networkThread.wait();
 
@@ -2124,6 +2248,7 @@ void MainWindow::writeSettings()
   m_settings->setValue("SubModeHB", ui->actionModeJS8HB->isChecked());
   m_settings->setValue("SubModeHBAck", ui->actionHeartbeatAcknowledgements->isChecked());
   m_settings->setValue("SubModeMultiDecode", ui->actionModeMultiDecoder->isChecked());
+  m_settings->setValue("TxSymbolShaping", m_modulator->symbolShaping());
   m_settings->setValue("DialFreq", QVariant::fromValue(m_lastMonitoredFrequency));
   m_settings->setValue("OutAttenuation", ui->outAttenuation->value ());
   m_settings->setValue("pwrBandTxMemory",m_pwrBandTxMemory);
@@ -2229,6 +2354,7 @@ void MainWindow::readSettings()
   ui->actionModeJS8HB->setChecked(m_settings->value("SubModeHB", false).toBool());
   ui->actionHeartbeatAcknowledgements->setChecked(m_settings->value("SubModeHBAck", false).toBool());
   ui->actionModeMultiDecoder->setChecked(m_settings->value("SubModeMultiDecode", true).toBool());
+  m_modulator->setSymbolShaping(m_settings->value("TxSymbolShaping", false).toBool());
 
   m_lastMonitoredFrequency = m_settings->value ("DialFreq",
     QVariant::fromValue<Frequency> (Default::DIAL_FREQUENCY)).value<Frequency> ();
@@ -2266,6 +2392,7 @@ void MainWindow::readSettings()
   m_settings->beginGroup ("Tune");
   m_msAudioOutputBuffered = m_settings->value ("Audio/OutputBufferMs").toInt ();
   m_framesAudioInputBuffered = m_settings->value ("Audio/InputBufferFrames", JS8_RX_SAMPLE_RATE / 10).toInt ();
+  m_audioAutoTune = m_settings->value ("Audio/AutoTune", false).toBool ();
   m_audioThreadPriority = static_cast<QThread::Priority> (m_settings->value ("Audio/ThreadPriority", QThread::TimeCriticalPriority).toInt () % 8);
   m_notificationAudioThreadPriority = static_cast<QThread::Priority> (m_settings->value ("Audio/NotificationThreadPriority", QThread::LowPriority).toInt () % 8);
   m_decoderThreadPriority = static_cast<QThread::Priority> (m_settings->value ("Audio/DecoderThreadPriority", QThread::HighPriority).toInt () % 8);
@@ -2870,6 +2997,8 @@ void MainWindow::openSettings(int tab){
         prepareApi();
         prepareSpotting();
 
+        m_journal->setRotation(journalRotation(m_config));
+
         // this will close the connection to PSKReporter if it has been
         // disabled
         if (spot_on && !m_config.spot_to_reporting_networks ())
@@ -3015,6 +3144,7 @@ void MainWindow::auto_tx_mode (bool state)
   m_auto = state;
   statusUpdate();
   if (state) {
+      updateTxSequencing();
       // Let us not wait until the next polling slot, but prepare transmission now,
       // even though that may waste a few CPU cycles
       // through double work that will be done soon anyway:
@@ -3082,9 +3212,13 @@ void MainWindow::updateCurrentBand(){
 
     cacheActivity(m_lastBand);
 
-    // clear activity on startup if asked or on when the previous band is not empty
+    // whatever's still being decoded was heard on the band we're leaving
+    dropPendingDecodes();
+
+    // clear activity on startup if asked or on when the previous band is not empty;
+    // the heard graph keeps each band apart, so there's no need to clear it
     if(m_config.reset_activity() || !m_lastBand.isEmpty()){
-        clearActivity();
+        clearActivity(false);
     }
 
     m_wideGraph->setBand (band_name);
@@ -3199,6 +3333,91 @@ void MainWindow::createStatusBar()                           //createStatusBar
   wpm_label.setMinimumSize (QSize {120, 18});
   wpm_label.setFrameStyle (QFrame::Panel | QFrame::Sunken);
   wpm_label.setAlignment(Qt::AlignCenter);
+
+  statusBar()->addPermanentWidget(&audio_label);
+  audio_label.setMinimumSize (QSize {100, 18});
+  audio_label.setFrameStyle (QFrame::Panel | QFrame::Sunken);
+  audio_label.setAlignment(Qt::AlignCenter);
+}
+
+void MainWindow::updateAudioHealth ()
+{
+  auto const & input  = m_audioHealth.input ();
+  auto const & output = m_audioHealth.output ();
+
+  if (input.troubled () || output.troubled ())
+  {
+    audio_label.setStyleSheet ("QLabel{background-color: #ffff00}");
+    audio_label.setText ("Audio: Drops");
+  }
+  else
+  {
+    audio_label.setStyleSheet ("");
+    audio_label.setText ("Audio: OK");
+  }
+
+  audio_label.setToolTip (QString ("Input: %1\nOutput: %2").arg (input.summary (), output.summary ()));
+}
+
+void MainWindow::rollAudioHealth ()
+{
+  m_audioHealth.roll ();
+
+  // Tune from the window just rolled over, unless transmitting, when the
+  // input is likely to be muted, and so tells us nothing.
+
+  if (!m_audioAutoTune || m_transmitting) return;
+
+  // The output buffer size takes effect the next time we transmit, so we
+  // can change it as we like; if it's not been set, go from the size the
+  // device picked.
+
+  auto     & output   = m_audioHealth.output ();
+  auto const outputMS = m_msAudioOutputBuffered ? m_msAudioOutputBuffered
+                                                : static_cast<unsigned> (output.bufferMS ());
+
+  if (auto const tuned = output.tune (outputMS); tuned != outputMS)
+  {
+    qCDebug (mainwindow_js8) << "tuning audio output buffer from" << outputMS << "to" << tuned << "ms";
+    m_msAudioOutputBuffered = tuned;
+    Q_EMIT initializeAudioOutputStream (m_config.audio_output_device (),
+                                        AudioDevice::Mono == m_config.audio_output_channel () ? 1 : 2,
+                                        m_msAudioOutputBuffered);
+  }
+
+  // Changing the input buffer size means restarting the input, and losing
+  // whatever the device holds at the time. Do that just after the next
+  // period starts, once the audio it held at the boundary has come through
+  // and the end of the period just finished is in the detector; what's
+  // lost is then from the start of the next, most of it, and with a small
+  // enough buffer all of it, from the start delay, in which nothing's sent.
+  // Input is taken at whatever rate the device prefers, so scale the frames
+  // by the size the buffer came to, rather than assume a rate.
+
+  auto     & input   = m_audioHealth.input ();
+  auto const inputMS = static_cast<unsigned> (input.bufferMS ());
+
+  if (!inputMS) return;
+
+  if (auto const tuned = input.tune (inputMS); tuned != inputMS)
+  {
+    qCDebug (mainwindow_js8) << "tuning audio input buffer from" << inputMS << "to" << tuned << "ms";
+    m_framesAudioInputBuffered = m_framesAudioInputBuffered * tuned / inputMS;
+
+    auto const period = JS8::Submode::period (m_nSubMode) * 1000LL;
+
+    auto const settle = inputMS + AUDIO_RETUNE_MARGIN_MS;
+
+    m_wheel.at ("audio.retune", (TimerWheel::now () / period + 1) * period + settle, [this]()
+    {
+      if (m_config.audio_input_device ().isNull ()) return;
+
+      Q_EMIT startAudioInputStream (m_config.audio_input_device (),
+                                    m_framesAudioInputBuffered,
+                                    m_detector,
+                                    m_config.audio_input_channel ());
+    });
+  }
 }
 
 void
@@ -3212,7 +3431,7 @@ void MainWindow::closeEvent(QCloseEvent * e)
   m_valid = false;              // suppresses subprocess errors
   m_config.transceiver_offline ();
   writeSettings ();
-  m_guiTimer.stop ();
+  m_wheel.cancel ("ui.second");
   m_prefixes.reset ();
   m_shortcuts.reset ();
   m_mouseCmnds.reset ();
@@ -3827,6 +4046,8 @@ MainWindow::decodeBusy(bool b)                             //decodeBusy()
 void
 MainWindow::decodeDone()
 {
+  trimActivityCaches();
+
   // critical section
   QMutexLocker mutex(m_detector->getMutex());
 
@@ -3873,8 +4094,7 @@ QList<int> generateOffsets(int minOffset, int maxOffset){
 void
 MainWindow::processDecodeEvent(JS8::Event::Variant const & event)
 {
-  static QList<qint32> driftQueue;
-  static qint32        syncStart = -1;
+  static qint32 syncStart = -1;
 
   std::visit([this](auto && e)
   {
@@ -3919,389 +4139,447 @@ MainWindow::processDecodeEvent(JS8::Event::Variant const & event)
       }
       else if constexpr (std::is_same_v<T, JS8::Event::DecodeFinished>)
       {
-        qCDebug(decoder_js8) << "decode duration" << m_decoderBusyStartTime.msecsTo(QDateTime::currentDateTimeUtc()) << "ms";
-
-        // TODO: move this into a function
-        if(!driftQueue.isEmpty())
-        {
-          if(m_driftMsMMA_N == 0)
+        // Handle the frames of this decode run together, in the order in
+        // which they were decoded, once they've all been unpacked, and then
+        // finish up. Runs are handled in the order they finished, so each
+        // waits on the one before it; a run that's still pending when the
+        // activity is cleared, or the band changes, is dropped, since its
+        // frames were heard before that.
+
+        auto frames     = std::exchange(m_decodeBatch,     {});
+        auto syncStarts = std::exchange(m_decodeBatchSync, {});
+
+        auto unpacked = m_decodePending.isFinished()
+                      ? QtFuture::whenAll(frames.begin(), frames.end())
+                      : m_decodePending.then(this, [frames]()
+                        {
+                          return QtFuture::whenAll(frames.begin(), frames.end());
+                        }).unwrap();
+
+        m_decodePending = unpacked.then(this,
+          [this, syncStarts, decoded = e.decoded, generation = m_decodeGeneration](QList<QFuture<DecodedText>> const & results)
           {
-              m_driftMsMMA_N = 1;
-              m_driftMsMMA = DriftingDateTime::drift();
-          }
-
-          // let the widegraph know for timing control
-          m_wideGraph->notifyDriftedSignalsDecoded(driftQueue.count());
-
-          while(!driftQueue.isEmpty())
-          {
-            qint32 newDrift = driftQueue.first();
-            driftQueue.removeFirst();
-
-            m_driftMsMMA = (((m_driftMsMMA_N-1) * m_driftMsMMA) + newDrift) / m_driftMsMMA_N;
-            if(m_driftMsMMA_N < 60) m_driftMsMMA_N++; // cap it to 60 observations
-          }
-
-          // XXX The following lines do nothing; it's a completely dead store. For
-          //     now, just #ifdefing them out, but they were in the 2.2.1-devel code,
-          //     and presumably they were important; need to see what the intent was
-          //     here.
-#if 0
-          qint32 driftLimitMs = JS8::Submode::period(Varicode::JS8CallNormal) * 1000;
-          qint32 newDriftMs   = m_driftMsMMA;
-          if(newDriftMs < 0){
-              newDriftMs = -((-newDriftMs) % driftLimitMs);
-          } else {
-              newDriftMs = ((newDriftMs) % driftLimitMs);
-          }
-#endif
-
-          setDrift(m_driftMsMMA);
-          //writeNoticeTextToUI(QDateTime::currentDateTimeUtc(), QString("Automatic Drift: %1").arg(driftAvg));
-        }
+            if (generation != m_decodeGeneration)
+            {
+              qCDebug(mainwindow_js8) << "dropping" << results.size() << "decoded frames heard before the activity was cleared";
+            }
+            else
+            {
+              for (qsizetype i = 0; i < results.size(); ++i)
+              {
+                if (results.at(i).resultCount())
+                {
+                  processDecodedText(results.at(i).result(), syncStarts.at(i));
+                }
+                else
+                {
+                  qCWarning(mainwindow_js8) << "unable to unpack decoded frame" << i << "of" << results.size();
+                }
+              }
+            }
 
-        m_bDecoded = e.decoded > 0;
-        decodeDone();
+            processDecodeFinished(decoded);
+          });
       }
       else if constexpr (std::is_same_v<T, JS8::Event::Decoded>)
       {
-        // A frame is valid if we haven't seen the same frame in the past 1/2
-        // decode period.
-        //
-        // Note: Success here depends on decodes ordered such that frequencies
-        //       near `dec_data.params.nfqso` arrive here first, so it's key to
-        //       process the decode candidates in an ordered manner, likely by
-        //       sorting the raw take from the initial selection pass.
+        // Unpacking is the expensive part of handling a frame, and doesn't
+        // depend on any other frame, so it's done on the thread pool while
+        // the decoder carries on.
+
+        m_decodeBatch.append(unpackDecoded(e));
+        m_decodeBatchSync.append(syncStart);
+      }
+    }
+  }, event);
+}
 
-        DecodedText   decodedtext(e);
-        FrameCacheKey dedupeKey(decodedtext.submode(),
-                                decodedtext.frame());
+void
+MainWindow::processDecodedText(DecodedText const & decodedtext,
+                               qint32      const   syncStart)
+{
+  // A frame is valid if we haven't seen the same frame in the past 1/2
+  // decode period.
+  //
+  // Note: Success here depends on decodes ordered such that frequencies
+  //       near `dec_data.params.nfqso` arrive here first, so it's key to
+  //       process the decode candidates in an ordered manner, likely by
+  //       sorting the raw take from the initial selection pass.
 
-        if (auto const it  = m_messageDupeCache.find(dedupeKey);
-                       it != m_messageDupeCache.end())
-        {
-            if (it->second.secsTo(QDateTime::currentDateTimeUtc()) < 0.5 * JS8::Submode::period(decodedtext.submode()))
-            {
-                qCDebug(mainwindow_js8) << "duplicate frame at"
-                         << it->second
-                         << "using key"
-                         << QString("%1:%2").arg(dedupeKey.submode)
-                                            .arg(dedupeKey.frame);
-                return;
-            }
-        }
+  FrameCacheKey dedupeKey(decodedtext.submode(),
+                          decodedtext.frame());
+
+  if (auto const it  = m_messageDupeCache.find(dedupeKey);
+                 it != m_messageDupeCache.end())
+  {
+      if (it->second.secsTo(QDateTime::currentDateTimeUtc()) < 0.5 * JS8::Submode::period(decodedtext.submode()))
+      {
+          qCDebug(mainwindow_js8) << "duplicate frame at"
+                   << it->second
+                   << "using key"
+                   << QString("%1:%2").arg(dedupeKey.submode)
+                                      .arg(dedupeKey.frame);
+          return;
+      }
+  }
 #if 0
-        // frames are valid if they meet our minimum rx threshold for the submode
-        bool bValidFrame = decodedtext.snr() >= JS8::Submode::rxSNRThreshold(decodedtext.submode());
+  // frames are valid if they meet our minimum rx threshold for the submode
+  bool bValidFrame = decodedtext.snr() >= JS8::Submode::rxSNRThreshold(decodedtext.submode());
 
-        qCDebug(mainwindow_js8) << "valid" << bValidFrame << JS8::Submode::name(decodedtext.submode()) << "decoded text" << decodedtext.message();
+  qCDebug(mainwindow_js8) << "valid" << bValidFrame << JS8::Submode::name(decodedtext.submode()) << "decoded text" << decodedtext.message();
 
-        // skip if invalid
-        if(!bValidFrame) {
-            return;
-        }
+  // skip if invalid
+  if(!bValidFrame) {
+      return;
+  }
 #else
-        qCDebug(mainwindow_js8) << JS8::Submode::name(decodedtext.submode()) << "decoded text" << decodedtext.message();
+  qCDebug(mainwindow_js8) << JS8::Submode::name(decodedtext.submode()) << "decoded text" << decodedtext.message();
 #endif
-        // TODO: move this into a function
-        // compute time drift for non-dupe messages
-        if(m_wideGraph->shouldAutoSyncSubmode(decodedtext.submode())){
-            int m = decodedtext.submode();
-            float xdt = decodedtext.dt();
+  // TODO: move this into a function
+  // compute time drift for non-dupe messages
+  if(m_wideGraph->shouldAutoSyncSubmode(decodedtext.submode())){
+      int m = decodedtext.submode();
+      float xdt = decodedtext.dt();
 
-            // if we're here at this point, we _should_ be operating a decode every second
-            //
-            // so we need to figure out where:
-            //
-            //   1) this current decode started
-            //   2) when that cycle _should_ have started
-            //   3) compute the delta
-            //   4) apply the drift
+      // if we're here at this point, we _should_ be operating a decode every second
+      //
+      // so we need to figure out where:
+      //
+      //   1) this current decode started
+      //   2) when that cycle _should_ have started
+      //   3) compute the delta
+      //   4) apply the drift
 
-            qint32 periodMs = 1000 * JS8::Submode::period(m);
+      qint32 periodMs = 1000 * JS8::Submode::period(m);
 
-            //writeNoticeTextToUI(now, QString("Decode at %1 (kin: %2, lastDecoded: %3)").arg(syncStart).arg(dec_data.params.kin).arg(m_lastDecodeStartMap.value(m)));
+      //writeNoticeTextToUI(now, QString("Decode at %1 (kin: %2, lastDecoded: %3)").arg(syncStart).arg(dec_data.params.kin).arg(m_lastDecodeStartMap.value(m)));
 
-            float expectedStartDelay = JS8::Submode::startDelayMS(m) / 1000.0;
+      float expectedStartDelay = JS8::Submode::startDelayMS(m) / 1000.0;
 
-            float decodedSignalTime = (float)syncStart/(float)JS8_RX_SAMPLE_RATE;
+      float decodedSignalTime = (float)syncStart/(float)JS8_RX_SAMPLE_RATE;
 
-            //writeNoticeTextToUI(now, QString("--> started at %1 seconds into the start of my drifted minute").arg(decodedSignalTime));
+      //writeNoticeTextToUI(now, QString("--> started at %1 seconds into the start of my drifted minute").arg(decodedSignalTime));
 
-            //writeNoticeTextToUI(now, QString("--> we add a time delta of %1 seconds into the start of the cycle").arg(xdt));
+      //writeNoticeTextToUI(now, QString("--> we add a time delta of %1 seconds into the start of the cycle").arg(xdt));
 
-            // adjust for expected start delay
-            decodedSignalTime -= expectedStartDelay;
+      // adjust for expected start delay
+      decodedSignalTime -= expectedStartDelay;
 
-            // adjust for time delta
-            decodedSignalTime += xdt;
+      // adjust for time delta
+      decodedSignalTime += xdt;
 
-            // ensure that we are within a 60 second minute
-            if(decodedSignalTime < 0){
-                decodedSignalTime += 60.0f;
-            } else if(decodedSignalTime > 60){
-                decodedSignalTime -= 60.0f;
-            }
+      // ensure that we are within a 60 second minute
+      if(decodedSignalTime < 0){
+          decodedSignalTime += 60.0f;
+      } else if(decodedSignalTime > 60){
+          decodedSignalTime -= 60.0f;
+      }
 
-            //writeNoticeTextToUI(now, QString("--> so signal adjusted started at %1 seconds into the start of my drifted minute").arg(decodedSignalTime));
+      //writeNoticeTextToUI(now, QString("--> so signal adjusted started at %1 seconds into the start of my drifted minute").arg(decodedSignalTime));
 
-            qint32 decodedSignalTimeMs = 1000 * decodedSignalTime;
-            qint32 cycleStartTimeMs = (decodedSignalTimeMs / periodMs) * periodMs;
-            qint32 driftMs = cycleStartTimeMs - decodedSignalTimeMs;
+      qint32 decodedSignalTimeMs = 1000 * decodedSignalTime;
+      qint32 cycleStartTimeMs = (decodedSignalTimeMs / periodMs) * periodMs;
+      qint32 driftMs = cycleStartTimeMs - decodedSignalTimeMs;
 
-            //writeNoticeTextToUI(now, QString("--> which is a drift adjustment of %1 milliseconds").arg(driftMs));
+      //writeNoticeTextToUI(now, QString("--> which is a drift adjustment of %1 milliseconds").arg(driftMs));
 
-            // if we have a large negative offset (say -14000), use the positive inverse of +1000
-            if(driftMs + periodMs < qAbs(driftMs)){
-                driftMs += periodMs;
-            }
-            // if we have a large positive offset (say 14000, use the negative inverse of -1000)
-            else if(qAbs(driftMs - periodMs) < driftMs){
-                driftMs -= periodMs;
-            }
+      // if we have a large negative offset (say -14000), use the positive inverse of +1000
+      if(driftMs + periodMs < qAbs(driftMs)){
+          driftMs += periodMs;
+      }
+      // if we have a large positive offset (say 14000, use the negative inverse of -1000)
+      else if(qAbs(driftMs - periodMs) < driftMs){
+          driftMs -= periodMs;
+      }
 
-            //writeNoticeTextToUI(now, QString("--> which is a corrected drift adjustment of %1 milliseconds").arg(driftMs));
+      //writeNoticeTextToUI(now, QString("--> which is a corrected drift adjustment of %1 milliseconds").arg(driftMs));
 
-            qint32 newDrift = DriftingDateTime::drift() + driftMs;
-            if(newDrift < 0){
-                newDrift %= -periodMs;
-            } else {
-                newDrift %= periodMs;
-            }
+      qint32 newDrift = DriftingDateTime::drift() + driftMs;
+      if(newDrift < 0){
+          newDrift %= -periodMs;
+      } else {
+          newDrift %= periodMs;
+      }
 
-            //writeNoticeTextToUI(now, QString("--> which is rounded to a total drift of %1 milliseconds for this period").arg(newDrift));
+      //writeNoticeTextToUI(now, QString("--> which is rounded to a total drift of %1 milliseconds for this period").arg(newDrift));
 
-            driftQueue.append(newDrift);
-        }
+      m_driftQueue.append(newDrift);
+  }
 
-        // if the frame is valid, cache it!
-        m_messageDupeCache.insert_or_assign(dedupeKey, QDateTime::currentDateTimeUtc());
+  // if the frame is valid, cache it!
+  m_messageDupeCache.insert_or_assign(dedupeKey, QDateTime::currentDateTimeUtc());
 
-        // log valid frames to ALL.txt (and correct their timestamp format)
-        auto freq = dialFrequency();
+  // log valid frames to ALL.txt (and correct their timestamp format)
+  auto freq = dialFrequency();
 
-        // if we changed frequencies, use the old frequency that we started the decode with
-        if(m_decoderBusyFreq != freq){
-            freq = m_decoderBusyFreq;
-        }
+  // if we changed frequencies, use the old frequency that we started the decode with
+  if(m_decoderBusyFreq != freq){
+      freq = m_decoderBusyFreq;
+  }
 
-        auto date = DriftingDateTime::currentDateTimeUtc().toString("yyyy-MM-dd");
-        writeAllTxt(date + " " + decodedtext.string() + " " + decodedtext.message());
+  auto date = DriftingDateTime::currentDateTimeUtc().toString("yyyy-MM-dd");
+  writeAllTxt(date + " " + decodedtext.string() + " " + decodedtext.message());
 
-        ActivityDetail d = {};
-        CallDetail cd = {};
-        CommandDetail cmd = {};
-        CallDetail td = {};
+  ActivityDetail d = {};
+  CallDetail cd = {};
+  CommandDetail cmd = {};
+  CallDetail td = {};
 
-        // Parse General Activity
-      #if 1
-        bool shouldParseGeneralActivity = true;
-        if(shouldParseGeneralActivity && !decodedtext.messageWords().isEmpty()){
-          int offset = decodedtext.frequencyOffset();
+  // Parse General Activity
+#if 1
+  bool shouldParseGeneralActivity = true;
+  if(shouldParseGeneralActivity && !decodedtext.messageWords().isEmpty()){
+    int offset = decodedtext.frequencyOffset();
 
-          if(!m_bandActivity.contains(offset)){
-              int const range = JS8::Submode::rxThreshold(decodedtext.submode());
+    if(!m_bandActivity.contains(offset)){
+        int const range = JS8::Submode::rxThreshold(decodedtext.submode());
 
-              QList<int> offsets = generateOffsets(offset-range, offset+range);
+        QList<int> offsets = generateOffsets(offset-range, offset+range);
 
-              foreach(int prevOffset, offsets){
-                  if(!m_bandActivity.contains(prevOffset)){ continue; }
-                  m_bandActivity[offset] = m_bandActivity[prevOffset];
-                  m_bandActivity.remove(prevOffset);
-                  break;
-              }
-          }
+        foreach(int prevOffset, offsets){
+            if(!m_bandActivity.contains(prevOffset)){ continue; }
+            m_bandActivity[offset] = m_bandActivity[prevOffset];
+            m_bandActivity.remove(prevOffset);
+            break;
+        }
+    }
 
-          //ActivityDetail d = {};
-          d.isLowConfidence = decodedtext.isLowConfidence();
-          d.isCompound = decodedtext.isCompound();
-          d.isDirected = decodedtext.isDirectedMessage();
-          d.bits = decodedtext.bits();
-          d.dial = freq;
-          d.offset = offset;
-          d.text = decodedtext.message();
-          d.utcTimestamp = DriftingDateTime::currentDateTimeUtc();
-          d.snr = decodedtext.snr();
-          d.isBuffered = false;
-          d.submode = decodedtext.submode();
-          d.tdrift = m_wideGraph->shouldAutoSyncSubmode(d.submode) ? DriftingDateTime::drift()/1000.0 : decodedtext.dt();
-
-          // if we have any "first" frame, and a buffer is already established, clear it...
-          int prevBufferOffset = -1;
-          if(((d.bits & Varicode::JS8CallFirst) == Varicode::JS8CallFirst) && hasExistingMessageBuffer(decodedtext.submode(), d.offset, true, &prevBufferOffset)){
-              qCDebug(mainwindow_js8) << "first message encountered, clearing existing buffer" << prevBufferOffset;
-              m_messageBuffer.remove(d.offset);
-          }
+    //ActivityDetail d = {};
+    d.isLowConfidence = decodedtext.isLowConfidence();
+    d.isCompound = decodedtext.isCompound();
+    d.isDirected = decodedtext.isDirectedMessage();
+    d.bits = decodedtext.bits();
+    d.dial = freq;
+    d.offset = offset;
+    d.text = decodedtext.message();
+    d.utcTimestamp = DriftingDateTime::currentDateTimeUtc();
+    d.snr = decodedtext.snr();
+    d.isBuffered = false;
+    d.submode = decodedtext.submode();
+    d.tdrift = m_wideGraph->shouldAutoSyncSubmode(d.submode) ? DriftingDateTime::drift()/1000.0 : decodedtext.dt();
 
-          // if we have a data frame, and a message buffer has been established, buffer it...
-          if(hasExistingMessageBuffer(decodedtext.submode(), d.offset, true, &prevBufferOffset) && !decodedtext.isCompound() && !decodedtext.isDirectedMessage()){
-              qCDebug(mainwindow_js8) << "buffering data" << d.dial << d.offset << d.text;
-              d.isBuffered = true;
-              m_messageBuffer[d.offset].msgs.append(d);
-              // TODO: incremental display if it's "to" me.
-          }
+    // if we have any "first" frame, and a buffer is already established, clear it...
+    int prevBufferOffset = -1;
+    if(((d.bits & Varicode::JS8CallFirst) == Varicode::JS8CallFirst) && hasExistingMessageBuffer(decodedtext.submode(), d.offset, true, &prevBufferOffset)){
+        qCDebug(mainwindow_js8) << "first message encountered, clearing existing buffer" << prevBufferOffset;
+        m_messageBuffer.remove(d.offset);
+    }
 
-          m_rxActivityQueue.append(d);
-          m_bandActivity[offset].append(d);
-          while(m_bandActivity[offset].count() > 10){
-              m_bandActivity[offset].removeFirst();
-          }
+    // if we have a data frame, and a message buffer has been established, buffer it...
+    if(hasExistingMessageBuffer(decodedtext.submode(), d.offset, true, &prevBufferOffset) && !decodedtext.isCompound() && !decodedtext.isDirectedMessage()){
+        qCDebug(mainwindow_js8) << "buffering data" << d.dial << d.offset << d.text;
+        d.isBuffered = true;
+        m_messageBuffer[d.offset].msgs.append(d);
+        // TODO: incremental display if it's "to" me.
+    }
+
+    m_rxActivityQueue.append(d);
+    m_bandActivity[offset].append(d);
+    while(m_bandActivity[offset].count() > 10){
+        m_bandActivity[offset].removeFirst();
+    }
+  }
+#endif
+
+  // Process compound callsign commands (put them in cache)"
+#if 1
+  qCDebug(mainwindow_js8) << "decoded" << decodedtext.frameType() << decodedtext.isCompound() << decodedtext.isDirectedMessage() << decodedtext.isHeartbeat();
+  bool shouldProcessCompound = true;
+  if(shouldProcessCompound && decodedtext.isCompound() && !decodedtext.isDirectedMessage()){
+    cd.call = decodedtext.compoundCall();
+    cd.grid = decodedtext.extra(); // compound calls via pings may contain grid...
+    cd.snr = decodedtext.snr();
+    cd.dial = freq;
+    cd.offset = decodedtext.frequencyOffset();
+    cd.utcTimestamp = DriftingDateTime::currentDateTimeUtc();
+    cd.bits = decodedtext.bits();
+    cd.submode = decodedtext.submode();
+    cd.tdrift = m_wideGraph->shouldAutoSyncSubmode(d.submode) ? DriftingDateTime::drift()/1000.0 : decodedtext.dt();
+
+    // Only respond to HEARTBEATS...remember that CQ messages are "Alt" pings
+    if(decodedtext.isHeartbeat()){
+        if(decodedtext.isAlt()){
+            // this is a cq with a standard or compound call, ala "KN4CRD/P: @ALLCALL CQ CQ CQ"
+            cd.cqTimestamp = DriftingDateTime::currentDateTimeUtc();
+
+            // convert CQ to a directed command and process...
+            cmd.from = cd.call;
+            cmd.to = "@ALLCALL";
+            cmd.cmd = " CQ";
+            cmd.snr = cd.snr;
+            cmd.bits = cd.bits;
+            cmd.grid = cd.grid;
+            cmd.dial = cd.dial;
+            cmd.offset = cd.offset;
+            cmd.utcTimestamp = cd.utcTimestamp;
+            cmd.tdrift = cd.tdrift;
+            cmd.submode = cd.submode;
+            cmd.text = decodedtext.message();
+
+            // TODO: check bits so we only auto respond to "finished" cqs
+            m_rxCommandQueue.append(cmd);
+
+            // since this is no longer processed here we omit logging it here.
+            // if we change this behavior, we'd change this back to logging here.
+            // logCallActivity(cd, true);
+
+            // notification for cq
+            tryNotify("cq");
+
+        } else {
+            // convert HEARTBEAT to a directed command and process...
+            cmd.from = cd.call;
+            cmd.to = "@HB";
+            cmd.cmd = " HEARTBEAT";
+            cmd.snr = cd.snr;
+            cmd.bits = cd.bits;
+            cmd.grid = cd.grid;
+            cmd.dial = cd.dial;
+            cmd.offset = cd.offset;
+            cmd.utcTimestamp = cd.utcTimestamp;
+            cmd.tdrift = cd.tdrift;
+            cmd.submode = cd.submode;
+
+            // TODO: check bits so we only auto respond to "finished" heartbeats
+            m_rxCommandQueue.append(cmd);
+
+            // notification for hb
+            tryNotify("hb");
         }
-      #endif
-
-        // Process compound callsign commands (put them in cache)"
-      #if 1
-        qCDebug(mainwindow_js8) << "decoded" << decodedtext.frameType() << decodedtext.isCompound() << decodedtext.isDirectedMessage() << decodedtext.isHeartbeat();
-        bool shouldProcessCompound = true;
-        if(shouldProcessCompound && decodedtext.isCompound() && !decodedtext.isDirectedMessage()){
-          cd.call = decodedtext.compoundCall();
-          cd.grid = decodedtext.extra(); // compound calls via pings may contain grid...
-          cd.snr = decodedtext.snr();
-          cd.dial = freq;
-          cd.offset = decodedtext.frequencyOffset();
-          cd.utcTimestamp = DriftingDateTime::currentDateTimeUtc();
-          cd.bits = decodedtext.bits();
-          cd.submode = decodedtext.submode();
-          cd.tdrift = m_wideGraph->shouldAutoSyncSubmode(d.submode) ? DriftingDateTime::drift()/1000.0 : decodedtext.dt();
-
-          // Only respond to HEARTBEATS...remember that CQ messages are "Alt" pings
-          if(decodedtext.isHeartbeat()){
-              if(decodedtext.isAlt()){
-                  // this is a cq with a standard or compound call, ala "KN4CRD/P: @ALLCALL CQ CQ CQ"
-                  cd.cqTimestamp = DriftingDateTime::currentDateTimeUtc();
-
-                  // convert CQ to a directed command and process...
-                  cmd.from = cd.call;
-                  cmd.to = "@ALLCALL";
-                  cmd.cmd = " CQ";
-                  cmd.snr = cd.snr;
-                  cmd.bits = cd.bits;
-                  cmd.grid = cd.grid;
-                  cmd.dial = cd.dial;
-                  cmd.offset = cd.offset;
-                  cmd.utcTimestamp = cd.utcTimestamp;
-                  cmd.tdrift = cd.tdrift;
-                  cmd.submode = cd.submode;
-                  cmd.text = decodedtext.message();
-
-                  // TODO: check bits so we only auto respond to "finished" cqs
-                  m_rxCommandQueue.append(cmd);
-
-                  // since this is no longer processed here we omit logging it here.
-                  // if we change this behavior, we'd change this back to logging here.
-                  // logCallActivity(cd, true);
-
-                  // notification for cq
-                  tryNotify("cq");
 
-              } else {
-                  // convert HEARTBEAT to a directed command and process...
-                  cmd.from = cd.call;
-                  cmd.to = "@HB";
-                  cmd.cmd = " HEARTBEAT";
-                  cmd.snr = cd.snr;
-                  cmd.bits = cd.bits;
-                  cmd.grid = cd.grid;
-                  cmd.dial = cd.dial;
-                  cmd.offset = cd.offset;
-                  cmd.utcTimestamp = cd.utcTimestamp;
-                  cmd.tdrift = cd.tdrift;
-                  cmd.submode = cd.submode;
-
-                  // TODO: check bits so we only auto respond to "finished" heartbeats
-                  m_rxCommandQueue.append(cmd);
-
-                  // notification for hb
-                  tryNotify("hb");
-              }
+    } else {
+        qCDebug(mainwindow_js8) << "buffering compound call" << cd.offset << cd.call << cd.bits;
 
-          } else {
-              qCDebug(mainwindow_js8) << "buffering compound call" << cd.offset << cd.call << cd.bits;
+        hasExistingMessageBuffer(cd.submode, cd.offset, true, nullptr);
+        m_messageBuffer[cd.offset].compound.append(cd);
+    }
+  }
+#endif
+
+  // Parse commands
+  // KN4CRD K1JT ?
+#if 1
+  bool shouldProcessDirected = true;
+  if(shouldProcessDirected && decodedtext.isDirectedMessage()){
+      auto parts = decodedtext.directedMessage();
+
+      cmd.from = parts.at(0);
+      cmd.to = parts.at(1);
+      cmd.cmd = parts.at(2);
+      cmd.dial = freq;
+      cmd.offset = decodedtext.frequencyOffset();
+      cmd.snr = decodedtext.snr();
+      cmd.utcTimestamp = DriftingDateTime::currentDateTimeUtc();
+      cmd.bits = decodedtext.bits();
+      cmd.extra = parts.length() > 2 ? parts.mid(3).join(" ") : "";
+      cmd.submode = decodedtext.submode();
+      cmd.tdrift = m_wideGraph->shouldAutoSyncSubmode(cmd.submode) ? DriftingDateTime::drift()/1000.0 : decodedtext.dt();
+
+      // if the command is a buffered command and its not the last frame OR we have from or to in a separate message (compound call)
+      if((Varicode::isCommandBuffered(cmd.cmd) && (cmd.bits & Varicode::JS8CallLast) != Varicode::JS8CallLast) || cmd.from == "<....>" || cmd.to == "<....>"){
+        qCDebug(mainwindow_js8) << "buffering cmd" << cmd.dial << cmd.offset << cmd.cmd << cmd.from << cmd.to;
+
+        // log complete buffered callsigns immediately
+        if(cmd.from != "<....>" && cmd.to != "<....>"){
+            CallDetail cmdcd = {};
+            cmdcd.call = cmd.from;
+            cmdcd.bits = cmd.bits;
+            cmdcd.snr = cmd.snr;
+            cmdcd.dial = cmd.dial;
+            cmdcd.offset = cmd.offset;
+            cmdcd.utcTimestamp = cmd.utcTimestamp;
+            cmdcd.ackTimestamp = cmd.to == m_config.my_callsign() ? cmd.utcTimestamp : QDateTime{};
+            cmdcd.tdrift = cmd.tdrift;
+            cmdcd.submode = cmd.submode;
+            logCallActivity(cmdcd, false);
+            logHeardGraph(cmd.from, cmd.to);
+        }
+
+        // merge any existing buffer to this frequency
+        hasExistingMessageBuffer(cmd.submode, cmd.offset, true, nullptr);
+
+        if(cmd.to == m_config.my_callsign()){
+            d.shouldDisplay = true;
+        }
+
+        m_messageBuffer[cmd.offset].cmd = cmd;
+        m_messageBuffer[cmd.offset].msgs.clear();
+      } else {
+        m_rxCommandQueue.append(cmd);
+      }
 
-              hasExistingMessageBuffer(cd.submode, cd.offset, true, nullptr);
-              m_messageBuffer[cd.offset].compound.append(cd);
+      // check to see if this is a station we've heard 3rd party
+      bool shouldCaptureThirdPartyCallsigns = false;
+      if(shouldCaptureThirdPartyCallsigns && Symbols::call(cmd.to).base != Symbols::call(m_config.my_callsign()).base){
+          QString relayCall = QString("%1|%2").arg(Symbols::call(cmd.from).base).arg(Symbols::call(cmd.to).base);
+          int snr = -100;
+          if(parts.length() == 4){
+              snr = QString(parts.at(3)).toInt();
           }
-        }
-      #endif
-
-        // Parse commands
-        // KN4CRD K1JT ?
-      #if 1
-        bool shouldProcessDirected = true;
-        if(shouldProcessDirected && decodedtext.isDirectedMessage()){
-            auto parts = decodedtext.directedMessage();
-
-            cmd.from = parts.at(0);
-            cmd.to = parts.at(1);
-            cmd.cmd = parts.at(2);
-            cmd.dial = freq;
-            cmd.offset = decodedtext.frequencyOffset();
-            cmd.snr = decodedtext.snr();
-            cmd.utcTimestamp = DriftingDateTime::currentDateTimeUtc();
-            cmd.bits = decodedtext.bits();
-            cmd.extra = parts.length() > 2 ? parts.mid(3).join(" ") : "";
-            cmd.submode = decodedtext.submode();
-            cmd.tdrift = m_wideGraph->shouldAutoSyncSubmode(cmd.submode) ? DriftingDateTime::drift()/1000.0 : decodedtext.dt();
-
-            // if the command is a buffered command and its not the last frame OR we have from or to in a separate message (compound call)
-            if((Varicode::isCommandBuffered(cmd.cmd) && (cmd.bits & Varicode::JS8CallLast) != Varicode::JS8CallLast) || cmd.from == "<....>" || cmd.to == "<....>"){
-              qCDebug(mainwindow_js8) << "buffering cmd" << cmd.dial << cmd.offset << cmd.cmd << cmd.from << cmd.to;
-
-              // log complete buffered callsigns immediately
-              if(cmd.from != "<....>" && cmd.to != "<....>"){
-                  CallDetail cmdcd = {};
-                  cmdcd.call = cmd.from;
-                  cmdcd.bits = cmd.bits;
-                  cmdcd.snr = cmd.snr;
-                  cmdcd.dial = cmd.dial;
-                  cmdcd.offset = cmd.offset;
-                  cmdcd.utcTimestamp = cmd.utcTimestamp;
-                  cmdcd.ackTimestamp = cmd.to == m_config.my_callsign() ? cmd.utcTimestamp : QDateTime{};
-                  cmdcd.tdrift = cmd.tdrift;
-                  cmdcd.submode = cmd.submode;
-                  logCallActivity(cmdcd, false);
-                  logHeardGraph(cmd.from, cmd.to);
-              }
 
-              // merge any existing buffer to this frequency
-              hasExistingMessageBuffer(cmd.submode, cmd.offset, true, nullptr);
+          //CallDetail td = {};
+          td.through = cmd.from;
+          td.call = cmd.to;
+          td.grid = "";
+          td.snr = snr;
+          td.dial = cmd.dial;
+          td.offset = cmd.offset;
+          td.utcTimestamp = cmd.utcTimestamp;
+          td.tdrift = cmd.tdrift;
+          td.submode = cmd.submode;
+          logCallActivity(td, true);
+          logHeardGraph(cmd.from, cmd.to);
+      }
+  }
+#endif
+}
 
-              if(cmd.to == m_config.my_callsign()){
-                  d.shouldDisplay = true;
-              }
+void
+MainWindow::processDecodeFinished(std::size_t const decoded)
+{
+  qCDebug(decoder_js8) << "decode duration" << m_decoderBusyStartTime.msecsTo(QDateTime::currentDateTimeUtc()) << "ms";
 
-              m_messageBuffer[cmd.offset].cmd = cmd;
-              m_messageBuffer[cmd.offset].msgs.clear();
-            } else {
-              m_rxCommandQueue.append(cmd);
-            }
+  // TODO: move this into a function
+  if(!m_driftQueue.isEmpty())
+  {
+    if(m_driftMsMMA_N == 0)
+    {
+        m_driftMsMMA_N = 1;
+        m_driftMsMMA = DriftingDateTime::drift();
+    }
 
-            // check to see if this is a station we've heard 3rd party
-            bool shouldCaptureThirdPartyCallsigns = false;
-            if(shouldCaptureThirdPartyCallsigns && Radio::base_callsign(cmd.to) != Radio::base_callsign(m_config.my_callsign())){
-                QString relayCall = QString("%1|%2").arg(Radio::base_callsign(cmd.from)).arg(Radio::base_callsign(cmd.to));
-                int snr = -100;
-                if(parts.length() == 4){
-                    snr = QString(parts.at(3)).toInt();
-                }
+    // let the widegraph know for timing control
+    m_wideGraph->notifyDriftedSignalsDecoded(m_driftQueue.count());
 
-                //CallDetail td = {};
-                td.through = cmd.from;
-                td.call = cmd.to;
-                td.grid = "";
-                td.snr = snr;
-                td.dial = cmd.dial;
-                td.offset = cmd.offset;
-                td.utcTimestamp = cmd.utcTimestamp;
-                td.tdrift = cmd.tdrift;
-                td.submode = cmd.submode;
-                logCallActivity(td, true);
-                logHeardGraph(cmd.from, cmd.to);
-            }
-        }
-      #endif
+    while(!m_driftQueue.isEmpty())
+    {
+      qint32 newDrift = m_driftQueue.first();
+      m_driftQueue.removeFirst();
+
+      m_driftMsMMA = (((m_driftMsMMA_N-1) * m_driftMsMMA) + newDrift) / m_driftMsMMA_N;
+      if(m_driftMsMMA_N < 60) m_driftMsMMA_N++; // cap it to 60 observations
     }
-  }, event);
+
+    // XXX The following lines do nothing; it's a completely dead store. For
+    //     now, just #ifdefing them out, but they were in the 2.2.1-devel code,
+    //     and presumably they were important; need to see what the intent was
+    //     here.
+#if 0
+    qint32 driftLimitMs = JS8::Submode::period(Varicode::JS8CallNormal) * 1000;
+    qint32 newDriftMs   = m_driftMsMMA;
+    if(newDriftMs < 0){
+        newDriftMs = -((-newDriftMs) % driftLimitMs);
+    } else {
+        newDriftMs = ((newDriftMs) % driftLimitMs);
+    }
+#endif
+
+    setDrift(m_driftMsMMA);
+    //writeNoticeTextToUI(QDateTime::currentDateTimeUtc(), QString("Automatic Drift: %1").arg(driftAvg));
+  }
+
+  m_bDecoded = decoded > 0;
+  decodeDone();
 }
 
 bool
@@ -4311,7 +4589,7 @@ MainWindow::hasExistingMessageBufferToMe(int * const pOffset)
   {
     // if this is a valid buffer and it's to me...
     if (buffer.cmd.utcTimestamp.isValid() && (buffer.cmd.to == m_config.my_callsign() ||
-                                              buffer.cmd.to == Radio::base_callsign(m_config.my_callsign())))
+                                              buffer.cmd.to == Symbols::call(m_config.my_callsign()).base))
     {
       if (pOffset) *pOffset = offset;
       return true;
@@ -4401,6 +4679,8 @@ void MainWindow::logCallActivity(CallDetail d, bool spot){
         }
     }
 
+    m_callActivityLedger.touch(d.call, QDateTime::currentMSecsSinceEpoch());
+
     // enqueue for spotting to psk reporter
     if(spot){
         m_rxCallQueue.append(d);
@@ -4409,42 +4689,20 @@ void MainWindow::logCallActivity(CallDetail d, bool spot){
 
 void MainWindow::logHeardGraph(QString from, QString to){
     auto my_callsign = m_config.my_callsign();
+    auto now = QDateTime::currentMSecsSinceEpoch();
 
-    // hearing
-    if(m_heardGraphOutgoing.contains(my_callsign)){
-        m_heardGraphOutgoing[my_callsign].insert(from);
-    } else {
-        m_heardGraphOutgoing[my_callsign].insert(from);
-    }
-
-    // heard by
-    if(m_heardGraphIncoming.contains(from)){
-        m_heardGraphIncoming[from].insert(my_callsign);
-    } else {
-        m_heardGraphIncoming[from] = { my_callsign };
-    }
+    // hearing / heard by
+    m_heardGraph.add(my_callsign, from, m_lastBand, now);
 
     if(to == "@ALLCALL"){
         return;
     }
 
-    // hearing
-    if(m_heardGraphOutgoing.contains(from)){
-        m_heardGraphOutgoing[from].insert(to);
-    } else {
-        m_heardGraphOutgoing[from] = { to };
-    }
-
-    // heard by
-    if(m_heardGraphIncoming.contains(to)){
-        m_heardGraphIncoming[to].insert(from);
-    } else {
-        m_heardGraphIncoming[to] = { from };
-    }
+    m_heardGraph.add(from, to, m_lastBand, now);
 }
 
 QString MainWindow::lookupCallInCompoundCache(QString const &call){
-    QString myBaseCall = Radio::base_callsign(m_config.my_callsign());
+    QString myBaseCall = Symbols::call(m_config.my_callsign()).base;
     if(call == myBaseCall){
         return m_config.my_callsign();
     }
@@ -4461,7 +4719,7 @@ MainWindow::spotReport(int     const   submode,
 {
   if (!m_config.spot_to_reporting_networks() ||
       (m_config.spot_blacklist().contains(callsign) ||
-       m_config.spot_blacklist().contains(Radio::base_callsign(callsign)))) return;
+       m_config.spot_blacklist().contains(Symbols::call(callsign).base))) return;
 
   Q_EMIT spotClientEnqueueSpot (callsign, grid, submode, dial, offset, snr);
 }
@@ -4471,7 +4729,7 @@ MainWindow::spotCmd(CommandDetail const & cmd)
 {
   if (!m_config.spot_to_reporting_networks() ||
       (m_config.spot_blacklist().contains(cmd.from) ||
-       m_config.spot_blacklist().contains(Radio::base_callsign(cmd.from)))) return;
+       m_config.spot_blacklist().contains(Symbols::call(cmd.from).base))) return;
 
   QString cmdStr = cmd.cmd;
 
@@ -4497,14 +4755,14 @@ MainWindow::spotCmd(CommandDetail const & cmd)
 void MainWindow::spotAprsCmd(CommandDetail const & cmd){
     if(!m_config.spot_to_reporting_networks()) return;
     if(!m_config.spot_to_aprs()) return;
-    if(m_config.spot_blacklist().contains(cmd.from) || m_config.spot_blacklist().contains(Radio::base_callsign(cmd.from))) return;
+    if(m_config.spot_blacklist().contains(cmd.from) || m_config.spot_blacklist().contains(Symbols::call(cmd.from).base)) return;
 
     if(cmd.cmd != " CMD") return;
 
     qCDebug(mainwindow_js8) << "APRSISClient Enqueueing Third Party Text" << cmd.from << cmd.text;
 
-    auto by_call   = APRSISClient::replaceCallsignSuffixWithSSID(m_config.my_callsign(), Radio::base_callsign(m_config.my_callsign()));
-    auto from_call = APRSISClient::replaceCallsignSuffixWithSSID(cmd.from,               Radio::base_callsign(cmd.from));
+    auto by_call   = APRSISClient::replaceCallsignSuffixWithSSID(m_config.my_callsign(), Symbols::call(m_config.my_callsign()).base);
+    auto from_call = APRSISClient::replaceCallsignSuffixWithSSID(cmd.from,               Symbols::call(cmd.from).base);
 
     // we use a queued signal here so we can process these spots in a network thread
     // to prevent blocking the gui/decoder while waiting on TCP
@@ -4514,7 +4772,7 @@ void MainWindow::spotAprsCmd(CommandDetail const & cmd){
 void MainWindow::spotAprsGrid(int dial, int offset, int snr, QString callsign, QString grid){
     if(!m_config.spot_to_reporting_networks()) return;
     if(!m_config.spot_to_aprs()) return;
-    if(m_config.spot_blacklist().contains(callsign) || m_config.spot_blacklist().contains(Radio::base_callsign(callsign))) return;
+    if(m_config.spot_blacklist().contains(callsign) || m_config.spot_blacklist().contains(Symbols::call(callsign).base)) return;
     if(grid.length() < 4) return;
 
     Frequency frequency = dial + offset;
@@ -4524,8 +4782,8 @@ void MainWindow::spotAprsGrid(int dial, int offset, int snr, QString callsign, Q
         comment = QString("%1 %2").arg(callsign).arg(comment);
     }
 
-    auto by_call = APRSISClient::replaceCallsignSuffixWithSSID(m_config.my_callsign(), Radio::base_callsign(m_config.my_callsign()));
-    auto from_call = APRSISClient::replaceCallsignSuffixWithSSID(callsign, Radio::base_callsign(callsign));
+    auto by_call = APRSISClient::replaceCallsignSuffixWithSSID(m_config.my_callsign(), Symbols::call(m_config.my_callsign()).base);
+    auto from_call = APRSISClient::replaceCallsignSuffixWithSSID(callsign, Symbols::call(callsign).base);
 
     // we use a queued signal here so we can process these spots in a network thread
     // to prevent blocking the gui/decoder while waiting on TCP
@@ -4543,7 +4801,7 @@ MainWindow::pskLogReport(QString 	const & mode,
 {
   if (!m_config.spot_to_reporting_networks() ||
       (m_config.spot_blacklist().contains(callsign) ||
-       m_config.spot_blacklist().contains(Radio::base_callsign(callsign)))) return;
+       m_config.spot_blacklist().contains(Symbols::call(callsign).base))) return;
 
   Q_EMIT pskReporterAddRemoteStation (callsign,
                                       grid,
@@ -4670,14 +4928,14 @@ void MainWindow::prepareSending(qint64 nowMS) {
 
         if(m_tune)
         {
-            itone[0] = 0;
+            m_tones.fill(0);
         }
         else
         {
             JS8::encode(m_i3bit,
                         JS8::Costas::array(JS8::Submode::costas(m_nSubMode)),
                         message,
-                        const_cast<int *>(reinterpret_cast<volatile int *>(itone))); // XXX ick...
+                        m_tones.data());
 
             std::fill_n(std::begin(msgsent), 22, ' ');
             std::copy_n(std::begin(message), 12, std::begin(msgsent));
@@ -4687,9 +4945,9 @@ void MainWindow::prepareSending(qint64 nowMS) {
                 qCDebug(mainwindow_js8) << "-> msg:" << message;
                 qCDebug(mainwindow_js8) << "-> bit:" << m_i3bit;
                 for (int i = 0;                   i < 7;               ++i)
-                    qCDebug(mainwindow_js8) << "-> tone" << i << "=" << itone[i];
+                    qCDebug(mainwindow_js8) << "-> tone" << i << "=" << m_tones[i];
                 for (int i = JS8_NUM_SYMBOLS - 7; i < JS8_NUM_SYMBOLS; ++i)
-                    qCDebug(mainwindow_js8) << "-> tone" << i << "=" << itone[i];
+                    qCDebug(mainwindow_js8) << "-> tone" << i << "=" << m_tones[i];
             }
 
             msgibits             = m_i3bit;
@@ -4774,6 +5032,51 @@ void MainWindow::updateClockUI(const QDateTime & now) {
 }
 
 
+//------------------------------------------------------------- //txUpdate()
+// Step the TX sequence, every UI_POLL_INTERVAL_MS while there's one under
+// way, and at the moment the TX delay before a period starts; once there's
+// nothing left to send, it stops until updateTxSequencing() starts it again.
+void MainWindow::txUpdate()
+{
+    if (m_transmitting or m_auto or m_tune) {
+        refuseToSendIn30mWSPRBand();
+        prepareSending(DriftingDateTime::currentMSecsSinceEpoch());
+        displayTransmit();
+    } else {
+        m_wheel.cancel("tx.sequence");
+        m_wheel.cancel("tx.start");
+    }
+
+    m_iptt0  = m_iptt;
+    m_btxok0 = m_btxok;
+}
+
+// Start stepping the TX sequence, if there's reason to and we aren't already.
+void MainWindow::updateTxSequencing()
+{
+    if (!(m_transmitting or m_auto or m_tune)) return;
+
+    if (!m_wheel.isPending("tx.sequence")) {
+        // Nothing has looked at PTT since the sequence last stopped;
+        // start out with no edges to act on.
+        m_iptt0  = m_iptt;
+        m_btxok0 = m_btxok;
+        m_wheel.every("tx.sequence", UI_POLL_INTERVAL_MS, 0, [this](){ txUpdate(); });
+    }
+
+    if (!m_wheel.isPending("tx.start")) scheduleTxStart();
+}
+
+// Push PTT exactly at the TX delay before each period starts, rather than at
+// the first step of the sequence after it.
+void MainWindow::scheduleTxStart()
+{
+    m_wheel.every("tx.start",
+                  JS8::Submode::period(m_nSubMode) * 1000LL,
+                  -std::lround(m_TxDelay * 1000),
+                  [this](){ txUpdate(); });
+}
+
 //------------------------------------------------------------- //guiUpdate()
 void MainWindow::guiUpdate()
 {
@@ -4789,15 +5092,13 @@ void MainWindow::guiUpdate()
         qint64 tx_delay_ms = std::lround(tx_delay_now * 1000);
         m_hb_loop->onTxDelayChange(tx_delay_ms);
         m_cq_loop->onTxDelayChange(tx_delay_ms);
+        if (m_wheel.isPending("tx.start")) scheduleTxStart();
     }
 
     const QDateTime now = DriftingDateTime::currentDateTimeUtc();
     const qint64 seconds_since_epoch = now.toSecsSinceEpoch();
 
-    if (m_transmitting or m_auto or m_tune) {
-        refuseToSendIn30mWSPRBand();
-        prepareSending(now.toMSecsSinceEpoch());
-    }
+    updateTxSequencing();
 
     //Once per second:
     if(seconds_since_epoch != m_sec0) {
@@ -4883,17 +5184,6 @@ void MainWindow::guiUpdate()
     } // end of stuff we do once per second.
 
     displayTransmit();
-
-    m_iptt0  = m_iptt;
-    m_btxok0 = m_btxok;
-
-    // Set the time to hit the start of the next UI_POLL_INTERVAL_MS slot.
-    // This automatically hits close to the start of each second
-    // and hence close to the start of each transmit period.
-    qint64 now_at_end_ms = DriftingDateTime::currentMSecsSinceEpoch();
-    qint64 time_into_poll_slot = now_at_end_ms % UI_POLL_INTERVAL_MS;
-    qint64 until_start_of_next_poll_slot = UI_POLL_INTERVAL_MS - time_into_poll_slot;
-    m_guiTimer.start(until_start_of_next_poll_slot);
 } //End of guiUpdate
 
 void MainWindow::startTx()
@@ -4934,6 +5224,7 @@ void MainWindow::transmit()
     Q_EMIT sendMessage (freq() - m_XIT,
                         m_nSubMode,
                         m_TxDelay,
+                        m_tones,
                         m_soundOutput,
                         m_config.audio_output_channel());
     ui->signal_meter_widget->setValue(0, 0);
@@ -4983,7 +5274,7 @@ void MainWindow::stopTx()
       tryRestoreFreqOffset();
   }
 
-  pttReleaseTimer.start(TX_SWITCHOFF_DELAY);                       //end-of-transmission sequencer delay stopTx2
+  m_wheel.after("tx.release", TX_SWITCHOFF_DELAY, [this](){ stopTx2(); }); //end-of-transmission sequencer delay stopTx2
   monitor (true);
   statusUpdate ();
 }
@@ -5007,17 +5298,12 @@ void MainWindow::stopTx2(){
     emitPTT(false);
 }
 
-void MainWindow::TxAgain()
-{
-  auto_tx_mode(true);
-}
-
 void MainWindow::cacheActivity(QString key){
+    m_bandCacheLedger.touch(key, QDateTime::currentMSecsSinceEpoch());
+
     m_callActivityBandCache[key] = m_callActivity;
     m_bandActivityBandCache[key] = m_bandActivity;
     m_rxTextBandCache[key] = ui->textEditRX->toHtml();
-    m_heardGraphIncomingBandCache[key] = m_heardGraphIncoming;
-    m_heardGraphOutgoingBandCache[key] = m_heardGraphOutgoing;
 }
 
 void MainWindow::restoreActivity(QString key){
@@ -5033,20 +5319,17 @@ void MainWindow::restoreActivity(QString key){
         ui->textEditRX->setHtml(m_rxTextBandCache[key]);
     }
 
-    if(m_heardGraphIncomingBandCache.contains(key)){
-        m_heardGraphIncoming = m_heardGraphIncomingBandCache[key];
-    }
-
-    if(m_heardGraphOutgoingBandCache.contains(key)){
-        m_heardGraphOutgoing = m_heardGraphOutgoingBandCache[key];
-    }
+    // what we've restored is as good as new
+    m_callActivityLedger.clear();
 
     displayActivity(true);
 }
 
-void MainWindow::clearActivity(){
+void MainWindow::clearActivity(bool clearHeardGraph){
     qCDebug(mainwindow_js8) << "clear activity";
 
+    dropPendingDecodes();
+
     m_callSeenHeartbeat.clear();
     m_compoundCallCache.clear();
     m_rxCallCache.clear();
@@ -5061,11 +5344,21 @@ void MainWindow::clearActivity(){
 
     clearBandActivity();
     clearRXActivity();
-    clearCallActivity();
+    clearCallActivity(clearHeardGraph);
 
     displayActivity(true);
 }
 
+// Frames of a decode run that haven't been handled yet belong to the
+// activity as it was; forget those being unpacked, and have any run that
+// finished, but is waiting its turn, dropped when it comes up.
+
+void MainWindow::dropPendingDecodes(){
+    m_decodeBatch.clear();
+    m_decodeBatchSync.clear();
+    ++m_decodeGeneration;
+}
+
 void MainWindow::clearBandActivity(){
     qCDebug(mainwindow_js8) << "clear band activity";
     m_bandActivity.clear();
@@ -5089,13 +5382,63 @@ void MainWindow::clearRXActivity(){
     update_dynamic_property(ui->extFreeTextMsgEdit, "transmitting", false);
 }
 
-void MainWindow::clearCallActivity(){
+// Hold the activity caches to their bounds; this is cheap enough, but
+// there's no need to do it after every decode.
+
+void MainWindow::trimActivityCaches(bool force){
+    auto const now = QDateTime::currentMSecsSinceEpoch();
+
+    if(!force && now - m_lastActivityCacheTrim < Cache::TRIM_INTERVAL){
+        return;
+    }
+
+    m_lastActivityCacheTrim = now;
+
+    m_callActivityLedger.trim(m_callActivity, now, [](QString const &call, CallDetail const &cd){
+        return stringBytes(call) + sizeof(CallDetail) + stringBytes(cd.call) + stringBytes(cd.through) + stringBytes(cd.grid);
+    });
+
+    m_heardGraph.expire(now);
+
+    // Forget callsigns and grids no one's looked up since the last trim;
+    // the views look up those they show whenever they're refreshed. Not
+    // when forced, so that a generation always lasts a full interval.
+    if(!force){
+        auto const forgotten = Symbols::trim();
+        qCDebug(mainwindow_js8) << "symbols forgotten" << forgotten << "held" << Symbols::calls() << Symbols::grids();
+    }
+
+    m_rxInboxCountLedger.trim(m_rxInboxCountCache, now, [](QString const &call, int){
+        return stringBytes(call) + (qsizetype)sizeof(int);
+    });
+
+    // The band caches are all written together, so they share the keys
+    // of the first of them.
+    m_bandCacheLedger.trim(m_callActivityBandCache, now, [this](QString const &band, QMap<QString, CallDetail> const &calls){
+        auto bytes = stringBytes(band) + calls.size() * (qsizetype)sizeof(CallDetail);
+        bytes += m_bandActivityBandCache.value(band).size() * (qsizetype)sizeof(ActivityDetail);
+        bytes += stringBytes(m_rxTextBandCache.value(band));
+        return bytes;
+    });
+
+    auto const dropStaleBands = [this](auto &cache){
+        for(auto it = cache.begin(); it != cache.end();){
+            it = m_callActivityBandCache.contains(it.key()) ? std::next(it) : cache.erase(it);
+        }
+    };
+    dropStaleBands(m_bandActivityBandCache);
+    dropStaleBands(m_rxTextBandCache);
+}
+
+void MainWindow::clearCallActivity(bool clearHeardGraph){
     qCDebug(mainwindow_js8) << "clear call activity";
 
     m_callActivity.clear();
+    m_callActivityLedger.clear();
 
-    m_heardGraphIncoming.clear();
-    m_heardGraphOutgoing.clear();
+    if(clearHeardGraph){
+        m_heardGraph.clear(m_lastBand);
+    }
 
     ui->tableWidgetCalls->setRowCount(0);
 
@@ -5708,6 +6051,30 @@ bool MainWindow::prepareNextMessageFrame()
   m_nextFreeTextMsg = frame;
   m_i3bit           = bits;
 
+  // Have the frame synthesized while we wait for the period to start, and
+  // the few after it queued behind, with the bits they're likely to have
+  // when their turn comes; should typeahead change any of them, they'll be
+  // synthesized at the start of their period instead.
+
+  QList<TxFrameQueue::Request> requests = {{frame.toLocal8Bit().leftJustified(28, ' ', true), bits}};
+
+  auto const ahead = std::min(TX_FRAMES_AHEAD, m_txFrameQueue.size());
+
+  for (qsizetype i = 0; i < ahead; ++i)
+  {
+    auto const & [text, next] = m_txFrameQueue.at(i);
+    auto         predicted    = next & ~Varicode::JS8CallFirst;
+
+    if (i == m_txFrameQueue.size() - 1) predicted |= Varicode::JS8CallLast;
+
+    requests.append({text.toLocal8Bit().leftJustified(28, ' ', true), predicted});
+  }
+
+  m_txFrames.prepare(requests,
+                     m_nSubMode,
+                     freq() - m_XIT,
+                     m_modulator->symbolShaping());
+
   updateTxButtonDisplay();
 
   return true;
@@ -6218,8 +6585,7 @@ void MainWindow::on_actionErase_ALL_TXT_triggered()          //Erase ALL.TXT
   int ret = MessageBox::query_message (this, tr ("Confirm Erase"),
                                          tr ("Are you sure you want to erase file ALL.TXT?"));
   if(ret==MessageBox::Yes) {
-    QFile f {m_config.writeable_data_dir ().absoluteFilePath ("ALL.TXT")};
-    f.remove();
+    m_journal->remove (m_config.writeable_data_dir ().absoluteFilePath ("ALL.TXT"));
     m_RxLog=1;
   }
 }
@@ -7428,8 +7794,8 @@ QString MainWindow::generateCallDetail(QString selectedCall){
     }
 
     // heard detail
-    QString hearing = m_heardGraphOutgoing.value(selectedCall).values().join(", ");
-    QString heardby = m_heardGraphIncoming.value(selectedCall).values().join(", ");
+    QString hearing = m_heardGraph.hearing(selectedCall, m_lastBand).join(", ");
+    QString heardby = m_heardGraph.heardBy(selectedCall, m_lastBand).join(", ");
     QStringList detail = {
         QString("<h1>%1</h1>").arg(selectedCall.toHtmlEscaped()),
         hearing.isEmpty() ? "" : QString("<p><strong>HEARING</strong>: %1</p>").arg(hearing.toHtmlEscaped()),
@@ -7462,10 +7828,12 @@ void MainWindow::on_tableWidgetCalls_cellDoubleClicked(int row, int col){
         //
         // processAlertReplyForCommand(d, d.relayPath, d.cmd);
 
-        Inbox i(inboxPath());
-        if(i.open()){
+        m_inbox->read([call](Inbox & inbox){
+            return qMakePair(inbox.values("UNREAD", "$.params.FROM", call, 0, 1000),
+                             inbox.firstUnreadFrom(call));
+        }).then(this, [this, call](QPair<QList<QPair<int, Message>>, QPair<int, Message>> const & result){
             QList<Message> msgs;
-            foreach(auto pair, i.values("UNREAD", "$.params.FROM", call, 0, 1000)){
+            foreach(auto pair, result.first){
                 msgs.append(pair.second);
             }
 
@@ -7473,9 +7841,8 @@ void MainWindow::on_tableWidgetCalls_cellDoubleClicked(int row, int col){
             mw->populateMessages(msgs);
             mw->show();
 
-            auto pair = i.firstUnreadFrom(call);
-            auto id = pair.first;
-            auto msg = pair.second;
+            auto id = result.second.first;
+            auto msg = result.second.second;
             auto params = msg.params();
 
             CommandDetail d;
@@ -7493,12 +7860,13 @@ void MainWindow::on_tableWidgetCalls_cellDoubleClicked(int row, int col){
             d.utcTimestamp.setUtcOffset(0);
 
             msg.setType("READ");
-            i.set(id, msg);
+            m_inbox->set(id, msg);
 
             m_rxInboxCountCache[call] = max(0, m_rxInboxCountCache.value(call) - 1);
+            m_rxInboxCountLedger.touch(call, QDateTime::currentMSecsSinceEpoch());
 
             processAlertReplyForCommand(d, d.relayPath, d.cmd);
-        }
+        });
 
     } else {
         addMessageText(call);
@@ -7524,9 +7892,10 @@ void MainWindow::on_tuneButton_clicked (bool checked)
   if (m_tune) {
     tuneButtonTimer.start(250);
   } else {
-    itone[0]=0;
+    m_tones.fill(0);
     on_monitorButton_clicked (true);
     m_tune=true;
+    updateTxSequencing();
   }
   Q_EMIT tune (checked);
 }
@@ -8136,11 +8505,15 @@ void MainWindow::refreshTextDisplay(){
         text,
         forceIdentify,
         forceData,
-        m_nSubMode
+        m_nSubMode,
+        m_txFramePacker
     );
 
     connect(t, &BuildMessageFramesThread::finished, t, &QObject::deleteLater);
-    connect(t, &BuildMessageFramesThread::resultReady, this, [this, text](QString transmitText, int frames){
+    connect(t, &BuildMessageFramesThread::resultReady, this, [this, t, text](QString transmitText, int frames){
+        // keep the encoding of this text for the next edit to build on
+        m_txFramePacker = t->packer();
+
         // ugh...i hate these globals
         m_txTextDirtyLastSelectedCall = callsignSelected(true);
         m_txTextDirtyLastText         = text;
@@ -8379,7 +8752,7 @@ void MainWindow::clearOffsetDirected(int offset){
 }
 
 bool MainWindow::isMyCallIncluded(const QString &text){
-    QString myCall = Radio::base_callsign(m_config.my_callsign());
+    QString myCall = Symbols::call(m_config.my_callsign()).base;
 
     if(myCall.isEmpty()){
         return false;
@@ -8846,7 +9219,7 @@ void MainWindow::processCommandActivity() {
         }
 
         // is this to me?
-        bool toMe = d.to == m_config.my_callsign().trimmed() || d.to == Radio::base_callsign(m_config.my_callsign()).trimmed();
+        bool toMe = d.to == m_config.my_callsign().trimmed() || d.to == Symbols::call(m_config.my_callsign()).base.trimmed();
 
         // log call activity...
         CallDetail cd = {};
@@ -9049,14 +9422,14 @@ void MainWindow::processCommandActivity() {
         // we're only responding to callsigns in our whitelist if we have one defined...
         // make sure the whitelist is empty (no restrictions) or the from callsign or its base callsign is on it
         auto whitelist = m_config.auto_whitelist();
-        if(!whitelist.isEmpty() && !(whitelist.contains(d.from) || whitelist.contains(Radio::base_callsign(d.from)))){
+        if(!whitelist.isEmpty() && !(whitelist.contains(d.from) || whitelist.contains(Symbols::call(d.from).base))){
             qCDebug(mainwindow_js8) << "skipping command for whitelist" << d.from;
             continue;
         }
 
         // we'll never reply to a blacklisted callsign or base callsign
         auto blacklist = m_config.auto_blacklist();
-        if(!blacklist.isEmpty() && (blacklist.contains(d.from) || blacklist.contains(Radio::base_callsign(d.from)))){
+        if(!blacklist.isEmpty() && (blacklist.contains(d.from) || blacklist.contains(Symbols::call(d.from).base))){
             qCDebug(mainwindow_js8) << "skipping command for blacklist" << d.from;
             continue;
         }
@@ -9298,7 +9671,7 @@ void MainWindow::processCommandActivity() {
             cd.snr = d.snr;
             cd.tdrift = d.tdrift;
             cd.text = text;
-            cd.to = Radio::base_callsign(to);
+            cd.to = Symbols::call(to).base;
             cd.utcTimestamp = d.utcTimestamp;
             cd.submode = d.submode;
 
@@ -9331,35 +9704,36 @@ void MainWindow::processCommandActivity() {
             }
 
             // check to make sure this callsign isn't blacklisted
-            if(m_config.hb_blacklist().contains(d.from) || m_config.hb_blacklist().contains(Radio::base_callsign(d.from))){
+            if(m_config.hb_blacklist().contains(d.from) || m_config.hb_blacklist().contains(Symbols::call(d.from).base)){
                 qCDebug(mainwindow_js8) << "hb blacklist blocking" << d.from;
                 continue;
             }
 
             // check to see if we have a message for a station who is heartbeating
-            QString extra;
-            auto mid = getNextMessageIdForCallsign(d.from);
-            if(mid != -1){
-                extra = QString("MSG ID %1").arg(mid);
-            }
+            m_inbox->read([from = d.from, to = d.to, isGroupCall](Inbox & inbox){
+                auto mid = nextMessageIdForCallsign(inbox, from);
 
-			// group messaging - if isGroupCall, check to see if there's a message id for the group and return it if there's not an individual message
-			// TODO: include group name in response to differentiate from direct messages?
-			else if(isGroupCall)
-			{
-				mid = getNextGroupMessageIdForCallsign(d.to, d.from);
-				if(mid != -1){
-					extra = QString("MSG ID %1").arg(mid);
-				}
-			}
-
-            // TODO: require confirmation?
-            sendHeartbeatAck(d.from, d.snr, extra);
-
-            if(isAllCall){
-                // since all pings are technically @ALLCALL, let's bump the allcall cache here...
-                m_txAllcallCommandCache.insert(d.from, new QDateTime(now), 5);
-            }
+                // group messaging - if isGroupCall, check to see if there's a message id for the group and return it if there's not an individual message
+                // TODO: include group name in response to differentiate from direct messages?
+                if(mid == -1 && isGroupCall){
+                    mid = inbox.getNextGroupMessageIdForCallsign(to, from);
+                }
+
+                return mid;
+            }).then(this, [this, d, isAllCall, now](int mid){
+                QString extra;
+                if(mid != -1){
+                    extra = QString("MSG ID %1").arg(mid);
+                }
+
+                // TODO: require confirmation?
+                sendHeartbeatAck(d.from, d.snr, extra);
+
+                if(isAllCall){
+                    // since all pings are technically @ALLCALL, let's bump the allcall cache here...
+                    m_txAllcallCommandCache.insert(d.from, new QDateTime(now), 5);
+                }
+            });
 
             continue;
         }
@@ -9451,79 +9825,87 @@ void MainWindow::processCommandActivity() {
             segs.removeFirst();
 
             if(cmd == "MSG" && !segs.isEmpty()){
-                auto inbox = Inbox(inboxPath());
-                if(!inbox.open()){
-                    continue;
-                }
-
                 bool ok = false;
                 int mid = QString(segs.first()).toInt(&ok);
                 if(!ok){
                     continue;
                 }
 
-                auto msg = inbox.value(mid);
-                auto params = msg.params();
-                if(params.isEmpty()){
-                    continue;
-                }
+                // the message, and the next one after it, come from the inbox
+                // thread; we'll reply, if at all, once they're in hand.
+                m_inbox->read([mid, who, group = d.to](Inbox & inbox){
+                    auto msg = inbox.value(mid);
+                    auto lookaheadMid = lookaheadMessageIdForCallsign(inbox, who, mid);
+                    if(lookaheadMid == -1 && msg.params().value("TO").toString().trimmed().startsWith("@")){
+                        lookaheadMid = lookaheadGroupMessageIdForCallsign(inbox, group, who, mid);
+                    }
+                    return qMakePair(msg, lookaheadMid);
+                }).then(this, [this, d, mid, who, replyPath, isAllCall, now, priority, freq](QPair<Message, int> const & result){
+                    auto msg = result.first;
+                    auto lookaheadMid = result.second;
+                    auto params = msg.params();
+                    if(params.isEmpty()){
+                        return;
+                    }
 
-                auto from = params.value("FROM").toString().trimmed();
+                    auto from = params.value("FROM").toString().trimmed();
 
-                auto to = params.value("TO").toString().trimmed();
+                    auto to = params.value("TO").toString().trimmed();
 
-				// group messaging - allow any message to a @GROUP to be retrieved by anybody
-				bool isGroupMsg = to.startsWith("@");
+                    // group messaging - allow any message to a @GROUP to be retrieved by anybody
+                    bool isGroupMsg = to.startsWith("@");
 
-                if(!isGroupMsg && to != who && to != Radio::base_callsign(who)){
-                    continue;
-                }
+                    if(!isGroupMsg && to != who && to != Symbols::call(who).base){
+                        return;
+                    }
 
-                auto text = params.value("TEXT").toString().trimmed();
-                if(text.isEmpty()){
-                    continue;
-                }
+                    auto text = params.value("TEXT").toString().trimmed();
+                    if(text.isEmpty()){
+                        return;
+                    }
+
+                    /*
+                     * mark as delivered (so subsequent HBs and QUERY MSGS don't receive this message)
+                     *
+                     * Do this in callbacks so that messages are only marked read after any potential confirmations
+                     * have been made by the user, and the message has been processed in the transaction queue.
+                     */
+                    Callback callback = nullptr;
+                    if(!isGroupMsg)
+                    {
+                        callback = [this, mid, msg] (){
+                            this->markMsgDelivered(mid, msg);
+                        };
+                    }
+                    else
+                    {
+                        callback = [this, mid, who](){
+                            this->markGroupMsgDeliveredForCallsign(mid, who);
+                        };
+                    }
+
+                    // and reply
+                    QString reply;
+                    if(lookaheadMid != -1)
+                    {
+                        reply = QString("%1 MSG %2 FROM %3 NEXT MSG ID %4");
+                        reply = reply.arg(replyPath);
+                        reply = reply.arg(text);
+                        reply = reply.arg(from);
+                        reply = reply.arg(lookaheadMid);
+                    }
+                    else
+                    {
+                        reply = QString("%1 MSG %2 FROM %3");
+                        reply = reply.arg(replyPath);
+                        reply = reply.arg(text);
+                        reply = reply.arg(from);
+                    }
+
+                    enqueueCommandReply(d, isAllCall, now, priority, freq, reply, callback);
+                });
 
-				/*
-				 * mark as delivered (so subsequent HBs and QUERY MSGS don't receive this message)
-				 *
-				 * Do this in callbacks so that messages are only marked read after any potential confirmations
-				 * have been made by the user, and the message has been processed in the transaction queue.
-				 */
-				if(!isGroupMsg)
-				{
-					callback = [this, mid, msg] (){
-						this->markMsgDelivered(mid, msg);
-					};
-				}
-				else
-				{
-					callback = [this, mid, who](){
-						this->markGroupMsgDeliveredForCallsign(mid, who);
-					};
-				}
-
-				auto lookaheadMid = getLookaheadMessageIdForCallsign(who, mid);
-				if(lookaheadMid == -1 && isGroupMsg){
-					lookaheadMid = getLookaheadGroupMessageIdForCallsign(d.to, who, mid);
-				}
-
-                // and reply
-				if(lookaheadMid != -1)
-				{
-					reply = QString("%1 MSG %2 FROM %3 NEXT MSG ID %4");
-					reply = reply.arg(replyPath);
-					reply = reply.arg(text);
-					reply = reply.arg(from);
-					reply = reply.arg(lookaheadMid);
-				}
-				else
-				{
-					reply = QString("%1 MSG %2 FROM %3");
-					reply = reply.arg(replyPath);
-					reply = reply.arg(text);
-					reply = reply.arg(from);
-				}
+                continue;
             }
         }
 
@@ -9541,25 +9923,31 @@ void MainWindow::processCommandActivity() {
 
             // if this is an allcall or a directed call, check to see if we have a stored message for user.
             // we reply yes if the user would be able to retreive a stored message
-            auto mid = getNextMessageIdForCallsign(who);
-            if(mid != -1){
-                reply = QString("%1 YES MSG ID %2").arg(replyPath).arg(mid);
-            }
+            m_inbox->read([who, from = d.from, to = d.to, isGroupCall](Inbox & inbox){
+                auto mid = nextMessageIdForCallsign(inbox, who);
 
-            // Group messaging - if isGroupCall, check to see if there's a message id for the group and return it if there's not an individual message
-			// TODO: include group name in response to differentiate from direct messages?
-			else if(isGroupCall)
-			{
-				mid = getNextGroupMessageIdForCallsign(d.to, d.from);
-				if(mid != -1){
-					reply = QString("%1 YES MSG ID %2").arg(replyPath).arg(mid);
-				}
-			}
-
-            // if this is not an allcall and we have no messages, reply no.
-            if(!isAllCall && reply.isEmpty()){
-                reply = QString("%1 NO").arg(replyPath);
-            }
+                // Group messaging - if isGroupCall, check to see if there's a message id for the group and return it if there's not an individual message
+                // TODO: include group name in response to differentiate from direct messages?
+                if(mid == -1 && isGroupCall){
+                    mid = inbox.getNextGroupMessageIdForCallsign(to, from);
+                }
+
+                return mid;
+            }).then(this, [this, d, replyPath, isAllCall, now, priority, freq](int mid){
+                QString reply;
+                if(mid != -1){
+                    reply = QString("%1 YES MSG ID %2").arg(replyPath).arg(mid);
+                }
+
+                // if this is not an allcall and we have no messages, reply no.
+                if(!isAllCall && reply.isEmpty()){
+                    reply = QString("%1 NO").arg(replyPath);
+                }
+
+                enqueueCommandReply(d, isAllCall, now, priority, freq, reply, nullptr);
+            });
+
+            continue;
         }
 
         // PROCESS BUFFERED QUERY CALL
@@ -9588,7 +9976,7 @@ void MainWindow::processCommandActivity() {
                     continue;
                 }
 
-                if(baseCall == cd.call || baseCall == Radio::base_callsign(cd.call)){
+                if(baseCall == cd.call || baseCall == Symbols::call(cd.call).base){
                     auto r = QString("%1 (%2)").arg(Varicode::formatSNR(cd.snr)).arg(since(cd.utcTimestamp)).trimmed();
                     replies.append(r);
                     break;
@@ -9620,50 +10008,58 @@ void MainWindow::processCommandActivity() {
         }
 #endif
 
-        // well, if there's no reply, don't do anything...
-        if (reply.isEmpty()) {
-            continue;
-        }
+        enqueueCommandReply(d, isAllCall, now, priority, freq, reply, callback);
+    }
+}
 
-        // do not queue @ALLCALL replies if auto-reply is not checked
-        if(!ui->actionModeAutoreply->isChecked() && isAllCall){
-            continue;
-        }
+// Queue an autoreply to a command, if there is one and nothing stands in
+// its way; replies that had to wait on the inbox come here once it has
+// answered, and are held to the state of things as it is by then.
+
+void MainWindow::enqueueCommandReply(CommandDetail const & d, bool isAllCall, QDateTime const & now, int priority, int freq, QString const & reply, Callback callback){
+    // well, if there's no reply, don't do anything...
+    if (reply.isEmpty()) {
+        return;
+    }
+
+    // do not queue @ALLCALL replies if auto-reply is not checked
+    if(!ui->actionModeAutoreply->isChecked() && isAllCall){
+        return;
+    }
 
 #if 0
-        // TODO: jsherer - HB issue here
-        // do not queue a reply if it's a HB and HB is not active
-        // if((!ui->hbMacroButton->isChecked() || m_hbInterval <= 0) && d.cmd.contains("HB")){
-        //     continue;
-        // }
+    // TODO: jsherer - HB issue here
+    // do not queue a reply if it's a HB and HB is not active
+    // if((!ui->hbMacroButton->isChecked() || m_hbInterval <= 0) && d.cmd.contains("HB")){
+    //     return;
+    // }
 #endif
 
-        // do not queue for reply if there's text in the window
-        if(!ui->extFreeTextMsgEdit->toPlainText().isEmpty()){
-            continue;
-        }
+    // do not queue for reply if there's text in the window
+    if(!ui->extFreeTextMsgEdit->toPlainText().isEmpty()){
+        return;
+    }
 
-        // do not queue for reply if there's a buffer open to us
-        int bufferOffset = 0;
-        if(hasExistingMessageBufferToMe(&bufferOffset)){
-            qCDebug(mainwindow_js8) << "skipping reply due to open buffer" << bufferOffset << m_messageBuffer.count();
-            continue;
-        }
+    // do not queue for reply if there's a buffer open to us
+    int bufferOffset = 0;
+    if(hasExistingMessageBufferToMe(&bufferOffset)){
+        qCDebug(mainwindow_js8) << "skipping reply due to open buffer" << bufferOffset << m_messageBuffer.count();
+        return;
+    }
 
-        // add @ALLCALLs to the @ALLCALL cache
-        if(isAllCall){
-            m_txAllcallCommandCache.insert(d.from, new QDateTime(now), 25);
-        }
+    // add @ALLCALLs to the @ALLCALL cache
+    if(isAllCall){
+        m_txAllcallCommandCache.insert(d.from, new QDateTime(now), 25);
+    }
 
-        // queue the reply here to be sent when a free interval is available on the frequency that was sent
-        // unless, this is an allcall, to which we should be responding on a clear frequency offset
-        // we always want to make sure that the directed cache has been updated at this point so we have the
-        // most information available to make a frequency selection.
-        if(m_config.autoreply_confirmation()){
-            confirmThenEnqueueMessage(90, priority, reply, freq, callback);
-        } else {
-            enqueueMessage(priority, reply, freq, callback);
-        }
+    // queue the reply here to be sent when a free interval is available on the frequency that was sent
+    // unless, this is an allcall, to which we should be responding on a clear frequency offset
+    // we always want to make sure that the directed cache has been updated at this point so we have the
+    // most information available to make a frequency selection.
+    if(m_config.autoreply_confirmation()){
+        confirmThenEnqueueMessage(90, priority, reply, freq, callback);
+    } else {
+        enqueueMessage(priority, reply, freq, callback);
     }
 }
 
@@ -9671,18 +10067,23 @@ QString MainWindow::inboxPath(){
     return QDir::toNativeSeparators(m_config.writeable_data_dir().absoluteFilePath("inbox.db3"));
 }
 
+// Inbox counts are computed on the inbox service thread; once they're
+// in hand, we replace the cached counts and refresh the call activity.
+
 void MainWindow::refreshInboxCounts(){
-    auto inbox = Inbox(inboxPath());
-    if(inbox.open()){
+    m_inbox->read([](Inbox & inbox){
+        return qMakePair(inbox.values("UNREAD", "$", "%", 0, 10000),
+                         inbox.getGroupMessageCounts());
+    }).then(this, [this](QPair<QList<QPair<int, Message>>, QMap<QString, int>> const & result){
         // reset inbox counts
         m_rxInboxCountCache.clear();
+        m_rxInboxCountLedger.clear();
 
         // compute new counts from db
-        auto v = inbox.values("UNREAD", "$", "%", 0, 10000);
-        foreach(auto pair, v){
+        foreach(auto pair, result.first){
             auto params = pair.second.params();
             auto to = params.value("TO").toString();
-            if(to.isEmpty() || (to != m_config.my_callsign() && to != Radio::base_callsign(m_config.my_callsign()))){
+            if(to.isEmpty() || (to != m_config.my_callsign() && to != Symbols::call(m_config.my_callsign()).base)){
                 continue;
             }
             auto from = params.value("FROM").toString();
@@ -9716,41 +10117,35 @@ void MainWindow::refreshInboxCounts(){
         }
 
 		// Now handle group message counts
-		QMap<QString, int> groupMessageCounts = inbox.getGroupMessageCounts();
+		QMap<QString, int> groupMessageCounts = result.second;
 		foreach(auto key , groupMessageCounts.keys())
 		{
 			m_rxInboxCountCache[key] = groupMessageCounts[key];
 		}
-    }
-}
 
-bool MainWindow::hasMessageHistory(QString call){
-    auto inbox = Inbox(inboxPath());
-    if(!inbox.open()){
-        return false;
-    }
+        displayCallActivity();
+    });
+}
 
-    int store = inbox.count("STORE", "$.params.TO", call);
-    int unread = inbox.count("UNREAD", "$.params.FROM", call);
-    int read = inbox.count("READ", "$.params.FROM", call);
-    return (store + unread + read) > 0;
+QFuture<bool> MainWindow::hasMessageHistory(QString call){
+    return m_inbox->read([call](Inbox & inbox){
+        int store = inbox.count("STORE", "$.params.TO", call);
+        int unread = inbox.count("UNREAD", "$.params.FROM", call);
+        int read = inbox.count("READ", "$.params.FROM", call);
+        return (store + unread + read) > 0;
+    });
 }
 
-int MainWindow::addCommandToMyInbox(CommandDetail d){
+QFuture<int> MainWindow::addCommandToMyInbox(CommandDetail d){
     // local cache for inbox count
     m_rxInboxCountCache[d.from] = m_rxInboxCountCache.value(d.from, 0) + 1;
+    m_rxInboxCountLedger.touch(d.from, QDateTime::currentMSecsSinceEpoch());
 
     // add it to my unread inbox
     return addCommandToStorage("UNREAD", d);
 }
 
-int MainWindow::addCommandToStorage(QString type, CommandDetail d){
-    // inbox:
-    auto inbox = Inbox(inboxPath());
-    if(!inbox.open()){
-        return -1;
-    }
-
+QFuture<int> MainWindow::addCommandToStorage(QString type, CommandDetail d){
     QVariantMap v = {
         {"UTC", QVariant(d.utcTimestamp.toString("yyyy-MM-dd hh:mm:ss"))},
         {"TO", QVariant(d.to)},
@@ -9779,113 +10174,32 @@ int MainWindow::addCommandToStorage(QString type, CommandDetail d){
 
     auto m = Message(type, "", v);
 
-    return inbox.append(m);
-}
-
-int MainWindow::getNextMessageIdForCallsign(QString callsign){
-    auto inbox = Inbox(inboxPath());
-    if(!inbox.open()){
-        return -1;
-    }
-
-    auto v1 = inbox.values("STORE", "$.params.TO", callsign, 0, 10);
-    foreach(auto pair, v1){
-        auto params = pair.second.params();
-        auto text = params.value("TEXT").toString().trimmed();
-        if(!text.isEmpty()){
-            return pair.first;
-        }
-    }
-
-    auto v2 = inbox.values("STORE", "$.params.TO", Radio::base_callsign(callsign), 0, 10);
-    foreach(auto pair, v2){
-        auto params = pair.second.params();
-        auto text = params.value("TEXT").toString().trimmed();
-        if(!text.isEmpty()){
-            return pair.first;
-        }
-    }
-
-    return -1;
+    // inbox:
+    return m_inbox->append(m);
 }
 
-int MainWindow::getLookaheadMessageIdForCallsign(QString callsign, int msgId){
-	auto inbox = Inbox(inboxPath());
-	if(!inbox.open()){
-		return -1;
-	}
-
-	int mid = inbox.getLookaheadMessageIdForCallsign(callsign, msgId);
-
-	if(mid == -1)
-	{
-		mid = inbox.getLookaheadMessageIdForCallsign(Radio::base_callsign(callsign), msgId);
-	}
-
-	if(mid != -1)
-	{
-		return mid;
-	}
-
-	return -1;
+QFuture<int> MainWindow::getNextMessageIdForCallsign(QString callsign){
+    return m_inbox->read([callsign](Inbox & inbox){
+        return nextMessageIdForCallsign(inbox, callsign);
+    });
 }
 
 // Facade for Inbox::getNextGroupMessageIdForCallsign
-int MainWindow::getNextGroupMessageIdForCallsign(QString group_name, QString callsign)
+QFuture<int> MainWindow::getNextGroupMessageIdForCallsign(QString group_name, QString callsign)
 {
-	Inbox inbox(inboxPath());
-	if(!inbox.open())
-	{
-		return -1;
-	}
-
-	return inbox.getNextGroupMessageIdForCallsign(group_name, callsign);
-}
-
-// Facade for Inbox::getLookaheadGroupMessageIdForCallsign
-int MainWindow::getLookaheadGroupMessageIdForCallsign(QString group_name, QString callsign, int afterMsgId)
-{
-	Inbox inbox(inboxPath());
-	if(!inbox.open())
-	{
-		return -1;
-	}
-
-	int mid = inbox.getLookaheadGroupMessageIdForCallsign(group_name, callsign, afterMsgId);
-
-	if(mid == -1)
-	{
-		mid = inbox.getLookaheadGroupMessageIdForCallsign(group_name, Radio::base_callsign(callsign), afterMsgId);
-	}
-
-	if(mid != -1)
-	{
-		return mid;
-	}
-
-	return -1;
+	return m_inbox->getNextGroupMessageIdForCallsign(group_name, callsign);
 }
 
 // Facade for Inbox::markGroupMsgDeliveredForCallsign
-bool MainWindow::markGroupMsgDeliveredForCallsign(int msgId, QString callsign)
+void MainWindow::markGroupMsgDeliveredForCallsign(int msgId, QString callsign)
 {
-	Inbox inbox(inboxPath());
-	if(!inbox.open()){
-		return false;
-	}
-
-	return inbox.markGroupMsgDeliveredForCallsign(msgId, callsign);
+	m_inbox->markGroupMsgDeliveredForCallsign(msgId, callsign);
 }
 
-bool MainWindow::markMsgDelivered(int mid, Message msg)
+void MainWindow::markMsgDelivered(int mid, Message msg)
 {
-	Inbox inbox(inboxPath());
-	if(!inbox.open()){
-		return false;
-	}
-
 	msg.setType("DELIVERED");
-	return inbox.set(mid, msg);
+	m_inbox->set(mid, msg);
 }
 
 QStringList MainWindow::parseRelayPathCallsigns(QString from, QString text){
@@ -9924,7 +10238,7 @@ void MainWindow::processSpots() {
             continue;
         }
 
-        if(m_config.spot_blacklist().contains(d.call) || m_config.spot_blacklist().contains(Radio::base_callsign(d.call))){
+        if(m_config.spot_blacklist().contains(d.call) || m_config.spot_blacklist().contains(Symbols::call(d.call).base)){
             continue;
         }
 
@@ -10023,9 +10337,100 @@ void MainWindow::displayActivity(bool force) {
     // Call Activity
     displayCallActivity();
 
+    // API consumers
+    publishActivityDeltas();
+
     m_rxDisplayDirty = false;
 }
 
+// Stream changes in band and call activity to API consumers, so that
+// they needn't poll the RX.GET_BAND_ACTIVITY and RX.GET_CALL_ACTIVITY
+// snapshots. We remember the timestamp of what we last published for
+// each offset and call; anything we've not published before is added,
+// anything with a newer timestamp is updated, and anything that's gone
+// or has aged out is expired.
+
+void MainWindow::publishActivityDeltas(){
+    if(!canSendNetworkMessage()){
+        m_publishedBandActivity.clear();
+        m_publishedCallActivity.clear();
+        return;
+    }
+
+    auto const now = DriftingDateTime::currentDateTimeUtc();
+
+    auto const publish = [this](QString const &type, QVariantMap const &added, QVariantMap const &updated, QVariantList const &expired){
+        if(added.isEmpty() && updated.isEmpty() && expired.isEmpty()){
+            return;
+        }
+
+        sendNetworkMessage(type, "", {
+            {"_ID", QVariant(-1)},
+            {"ADDED", added},
+            {"UPDATED", updated},
+            {"EXPIRED", expired},
+        });
+    };
+
+    {
+        int const activityAging = m_config.activity_aging();
+        QMap<int, QDateTime> published;
+        QVariantMap added;
+        QVariantMap updated;
+        QVariantList expired;
+
+        for (auto const [offset, activity] : m_bandActivity.asKeyValueRange())
+        {
+            if (activity.isEmpty()) continue;
+
+            auto const & d = activity.last();
+
+            if (activityAging && d.utcTimestamp.secsTo(now) / 60 >= activityAging) continue;
+
+            published.insert(offset, d.utcTimestamp);
+
+            auto const it = m_publishedBandActivity.constFind(offset);
+            if (it == m_publishedBandActivity.constEnd()) added  [QString::number(offset)] = bandActivityDetail(d);
+            else if (*it != d.utcTimestamp)               updated[QString::number(offset)] = bandActivityDetail(d);
+        }
+
+        for (auto const offset : m_publishedBandActivity.keys())
+        {
+            if (!published.contains(offset)) expired.append(offset);
+        }
+
+        m_publishedBandActivity.swap(published);
+        publish("RX.BAND_ACTIVITY.DELTA", added, updated, expired);
+    }
+
+    {
+        int const callsignAging = m_config.callsign_aging();
+        QMap<QString, QDateTime> published;
+        QVariantMap added;
+        QVariantMap updated;
+        QVariantList expired;
+
+        for (auto const & cd : std::as_const(m_callActivity))
+        {
+            if (callsignAging && cd.utcTimestamp.secsTo(now) / 60 >= callsignAging) continue;
+
+            published.insert(cd.call, cd.utcTimestamp);
+
+            auto const it = m_publishedCallActivity.constFind(cd.call);
+            if (it == m_publishedCallActivity.constEnd()) added  [cd.call] = callActivityDetail(cd);
+            else if (*it != cd.utcTimestamp)              updated[cd.call] = callActivityDetail(cd);
+        }
+
+        for (auto const & call : m_publishedCallActivity.keys())
+        {
+            if (!published.contains(call)) expired.append(call);
+        }
+
+        m_publishedCallActivity.swap(published);
+        publish("RX.CALL_ACTIVITY.DELTA", added, updated, expired);
+    }
+}
+
 // updateBandActivity
 void MainWindow::displayBandActivity() {
     auto now = DriftingDateTime::currentDateTimeUtc();
@@ -10543,8 +10948,12 @@ void MainWindow::displayCallActivity() {
           return lhs < rhs;
         });
 
+        // worked before status, for all of them at once
+        auto const worked = m_logBook.worked(keys);
+
         int callsignAging = m_config.callsign_aging();
-        foreach(QString call, keys) {
+        for(qsizetype index = 0; index < keys.size(); ++index) {
+            QString const & call = keys[index];
             if(call.trimmed().isEmpty()){
                 continue;
             }
@@ -10630,8 +11039,9 @@ void MainWindow::displayCallActivity() {
                 modeItem->setTextAlignment(Qt::AlignCenter);
                 ui->tableWidgetCalls->setItem(row, col++, modeItem);
 
-                auto gridItem = new QTableWidgetItem(QString("%1").arg(d.grid.trimmed().left(4)));
-                gridItem->setToolTip(d.grid.trimmed());
+                auto const & grid = Symbols::grid(d.grid);
+                auto gridItem = new QTableWidgetItem(grid.square);
+                gridItem->setToolTip(grid.grid);
                 ui->tableWidgetCalls->setItem(row, col++, gridItem);
 
                 auto const vector = Geodesic::vector(m_config.my_grid(), d.grid);
@@ -10647,7 +11057,7 @@ void MainWindow::displayCallActivity() {
                 ui->tableWidgetCalls->setItem(row, col++, azimuthItem);
 
                 QString flag;
-                if(m_logBook.hasWorkedBefore(d.call, "")){
+                if(worked[index].call){
                     // unicode checkmark
                     flag = "\u2713";
                 }
@@ -10825,9 +11235,8 @@ void MainWindow::emitTones(){
 
     // emit tone numbers to network
     QVariantList t;
-    for(int i = 0; i < JS8_NUM_SYMBOLS; i++){
-        //qCDebug(mainwindow_js8) << "tone" << i << "=" << itone[i];
-        t.append(QVariant((int)itone[i]));
+    for(auto const tone : std::as_const(m_tones)){
+        t.append(QVariant(tone));
     }
 
     sendNetworkMessage("TX.FRAME", "", {
@@ -10886,6 +11295,7 @@ void MainWindow::networkMessage(Message const &message)
 
     // RIG.GET_FREQ - Get the current Frequency
     // RIG.SET_FREQ - Set the current Frequency
+    // RIG.GET_LATENCY - Get latency histograms of rig commands and polls
     if(type == "RIG.GET_FREQ"){
         sendNetworkMessage("RIG.FREQ", "", {
             {"_ID", id},
@@ -10896,6 +11306,13 @@ void MainWindow::networkMessage(Message const &message)
         return;
     }
 
+    if(type == "RIG.GET_LATENCY"){
+        auto params = TransceiverBase::latency();
+        params["_ID"] = id;
+        sendNetworkMessage("RIG.LATENCY", "", params);
+        return;
+    }
+
     if(type == "RIG.SET_FREQ"){
         auto params = message.params();
         if(params.contains("DIAL")){
@@ -10975,6 +11392,8 @@ void MainWindow::networkMessage(Message const &message)
     // RX.GET_CALL_ACTIVITY
     // RX.GET_CALL_SELECTED
     // RX.GET_BAND_ACTIVITY
+    // RX.GET_CACHES
+    // RX.GET_HEARD_GRAPH
     // RX.GET_TEXT
 
     if(type == "RX.GET_CALL_ACTIVITY"){
@@ -10988,11 +11407,7 @@ void MainWindow::networkMessage(Message const &message)
             if (callsignAging && cd.utcTimestamp.secsTo(now) / 60 >= callsignAging) {
                 continue;
             }
-            QVariantMap detail;
-            detail["SNR"] = QVariant(cd.snr);
-            detail["GRID"] = QVariant(cd.grid);
-            detail["UTC"] = QVariant(cd.utcTimestamp.toMSecsSinceEpoch());
-            calls[cd.call] = QVariant(detail);
+            calls[cd.call] = QVariant(callActivityDetail(cd));
         }
 
         sendNetworkMessage("RX.CALL_ACTIVITY", "", calls);
@@ -11014,22 +11429,54 @@ void MainWindow::networkMessage(Message const &message)
         {
             if (activity.isEmpty()) continue;
 
-            auto const d = activity.last();
-
-            offsets[QString("%1").arg(offset)] = QVariant(QVariantMap {
-              { "FREQ",   QVariant(d.dial + d.offset)                  },
-              { "DIAL",   QVariant(d.dial)                             },
-              { "OFFSET", QVariant(d.offset)                           },
-              { "TEXT",   QVariant(d.text)                             },
-              { "SNR",    QVariant(d.snr)                              },
-              { "UTC",    QVariant(d.utcTimestamp.toMSecsSinceEpoch()) }
-            });
+            offsets[QString("%1").arg(offset)] = QVariant(bandActivityDetail(activity.last()));
         }
 
         sendNetworkMessage("RX.BAND_ACTIVITY", "", offsets);
         return;
     }
 
+    if(type == "RX.GET_CACHES"){
+        trimActivityCaches(true);
+
+        QVariantMap caches = {
+            {"_ID", id},
+        };
+        for(auto const *ledger : {&m_callActivityLedger,
+                                  &m_rxInboxCountLedger,
+                                  &m_bandCacheLedger}){
+            caches[ledger->name()] = ledger->stats();
+        }
+        caches["HEARD_GRAPH"] = m_heardGraph.stats();
+        caches["SPOT_QUEUES"] = QVariantMap{
+            {"JS8",  m_spotClient->stats()},
+            {"PSK",  m_pskReporter->stats()},
+            {"APRS", m_aprsClient->stats()},
+        };
+
+        sendNetworkMessage("RX.CACHES", "", caches);
+        return;
+    }
+
+    if(type == "RX.GET_HEARD_GRAPH"){
+        auto call = message.params().value("CALL", m_config.my_callsign()).toString().toUpper();
+        auto to = message.params().value("TO").toString().toUpper();
+
+        QVariantMap params = {
+            {"_ID", id},
+            {"BAND", m_lastBand},
+            {"HEARING", m_heardGraph.hearing(call, m_lastBand)},
+            {"HEARD_BY", m_heardGraph.heardBy(call, m_lastBand)},
+        };
+        if(!to.isEmpty()){
+            params["TO"] = to;
+            params["RELAYS"] = m_heardGraph.relays(call, to, m_lastBand);
+        }
+
+        sendNetworkMessage("RX.HEARD_GRAPH", call, params);
+        return;
+    }
+
     if(type == "RX.GET_TEXT"){
         sendNetworkMessage("RX.TEXT", ui->textEditRX->toPlainText().right(1024), {
             {"_ID", id},
@@ -11056,6 +11503,16 @@ void MainWindow::networkMessage(Message const &message)
         return;
     }
 
+    // TX.GET_LATENCY - Get how close to the period boundary transmissions have
+    //                  started, and how many were synthesized ahead of time
+
+    if(type == "TX.GET_LATENCY"){
+        auto params = m_txFrames.stats();
+        params["_ID"] = id;
+        sendNetworkMessage("TX.LATENCY", "", params);
+        return;
+    }
+
     if(type == "TX.SEND_MESSAGE"){
         auto text = message.value();
         if(!text.isEmpty()){
@@ -11101,30 +11558,29 @@ void MainWindow::networkMessage(Message const &message)
             selectedCall = "%";
         }
 
-        Inbox inbox(inboxPath());
-        if(!inbox.open()){
-            return;
-        }
-
-        QList<QPair<int, Message> > msgs;
-        msgs.append(inbox.values("STORE", "$.params.TO", selectedCall, 0, 1000));
-        msgs.append(inbox.values("READ", "$.params.FROM", selectedCall, 0, 1000));
-        foreach(auto pair, inbox.values("UNREAD", "$.params.FROM", selectedCall, 0, 1000)){
-            msgs.append(pair);
-        }
-        std::stable_sort(msgs.begin(), msgs.end(), [](QPair<int, Message> const &a, QPair<int, Message> const &b){
-            return QVariant::compare(a.second.params().value("UTC"),
-                                     b.second.params().value("UTC")) == QPartialOrdering::Greater;
-        });
+        m_inbox->read([selectedCall](Inbox & inbox){
+            QList<QPair<int, Message> > msgs;
+            msgs.append(inbox.values("STORE", "$.params.TO", selectedCall, 0, 1000));
+            msgs.append(inbox.values("READ", "$.params.FROM", selectedCall, 0, 1000));
+            foreach(auto pair, inbox.values("UNREAD", "$.params.FROM", selectedCall, 0, 1000)){
+                msgs.append(pair);
+            }
+            return msgs;
+        }).then(this, [this, id](QList<QPair<int, Message> > msgs){
+            std::stable_sort(msgs.begin(), msgs.end(), [](QPair<int, Message> const &a, QPair<int, Message> const &b){
+                return QVariant::compare(a.second.params().value("UTC"),
+                                         b.second.params().value("UTC")) == QPartialOrdering::Greater;
+            });
 
-        QVariantList l;
-        foreach(auto pair, msgs){
-            l << pair.second.toVariantMap();
-        }
+            QVariantList l;
+            foreach(auto pair, msgs){
+                l << pair.second.toVariantMap();
+            }
 
-        sendNetworkMessage("INBOX.MESSAGES", "", {
-            {"_ID", id},
-            {"MESSAGES", l},
+            sendNetworkMessage("INBOX.MESSAGES", "", {
+                {"_ID", id},
+                {"MESSAGES", l},
+            });
         });
         return;
     }
@@ -11149,11 +11605,11 @@ void MainWindow::networkMessage(Message const &message)
         d.utcTimestamp = DriftingDateTime::currentDateTimeUtc();
         d.submode = m_nSubMode;
 
-        auto mid = addCommandToStorage("STORE", d);
-
-        sendNetworkMessage("INBOX.MESSAGE", "", {
-            {"_ID", id},
-            {"ID", mid},
+        addCommandToStorage("STORE", d).then(this, [this, id](int mid){
+            sendNetworkMessage("INBOX.MESSAGE", "", {
+                {"_ID", id},
+                {"ID", mid},
+            });
         });
         return;
     }
@@ -11167,6 +11623,25 @@ void MainWindow::networkMessage(Message const &message)
         return;
     }
 
+    // WINDOW.GET_TIMERS - Get the tasks on the timer wheel, and how late they've run
+
+    if(type == "WINDOW.GET_TIMERS"){
+        auto params = m_wheel.stats();
+        params["_ID"] = id;
+        sendNetworkMessage("WINDOW.TIMERS", "", params);
+        return;
+    }
+
+    // AUDIO.GET_HEALTH - Get how well the audio streams are keeping up
+
+    if(type == "AUDIO.GET_HEALTH"){
+        auto params = m_audioHealth.stats();
+        params["AUTO_TUNE"] = m_audioAutoTune;
+        params["_ID"] = id;
+        sendNetworkMessage("AUDIO.HEALTH", "", params);
+        return;
+    }
+
     qCDebug(mainwindow_js8) << "Unable to process networkMessage:" << type;
 }
 
@@ -11357,21 +11832,10 @@ void MainWindow::write_frequency_entry (QString const& file_name){
   }
 
   // Write freq changes to ALL.TXT only below 30 MHz.
-  QFile f2 {m_config.writeable_data_dir ().absoluteFilePath (file_name)};
-  if (f2.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Append)) {
-    QTextStream out(&f2);
-    out << DriftingDateTime::currentDateTimeUtc().toString("yyyy-MM-dd hh:mm:ss")
-        << "  " << qSetRealNumberPrecision (12) << (m_freqNominal / 1.e6) << " MHz  "
-        << "JS8" << Qt::endl;
-    f2.close();
-  } else {
-    QTimer::singleShot(0, [
-      this,
-      message = tr("Cannot open \"%1\" for append: %2").arg(f2.fileName()).arg(f2.errorString())
-    ]{
-      MessageBox::warning_message(this, tr("Log File Error"), message);
-    });
-  }
+  m_journal->append(m_config.writeable_data_dir ().absoluteFilePath (file_name),
+                    DriftingDateTime::currentDateTimeUtc().toString("yyyy-MM-dd hh:mm:ss")
+                    % "  " % QString::number (m_freqNominal / 1.e6, 'g', 12) % " MHz  "
+                    % "JS8");
 }
 
 void MainWindow::write_transmit_entry (QString const& file_name)
@@ -11380,28 +11844,14 @@ void MainWindow::write_transmit_entry (QString const& file_name)
       return;
   }
 
-  QFile f {m_config.writeable_data_dir ().absoluteFilePath (file_name)};
-  if (f.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Append))
-    {
-      QTextStream out(&f);
-      auto time = DriftingDateTime::currentDateTimeUtc ();
-      time = time.addSecs (-(time.time ().second () % m_TRperiod));
-      auto dt = DecodedText(m_currentMessage, m_currentMessageBits, m_nSubMode);
-      out << time.toString("yyyy-MM-dd hh:mm:ss")
-          << "  Transmitting " << qSetRealNumberPrecision (12) << (m_freqNominal / 1.e6)
-          << " MHz  " << "JS8"
-          << ":  " << dt.message() << Qt::endl;
-      f.close();
-    }
-  else
-    {
-      QTimer::singleShot(0, [
-        this,
-        message = tr("Cannot open \"%1\" for append: %2").arg(f.fileName()).arg(f.errorString())
-      ] {
-        MessageBox::warning_message(this, tr("Log File Error"), message);
-      });
-    }
+  auto time = DriftingDateTime::currentDateTimeUtc ();
+  time = time.addSecs (-(time.time ().second () % m_TRperiod));
+  auto dt = DecodedText(m_currentMessage, m_currentMessageBits, m_nSubMode);
+  m_journal->append(m_config.writeable_data_dir ().absoluteFilePath (file_name),
+                    time.toString("yyyy-MM-dd hh:mm:ss")
+                    % "  Transmitting " % QString::number (m_freqNominal / 1.e6, 'g', 12)
+                    % " MHz  " % "JS8"
+                    % ":  " % dt.message());
 }
 
 
@@ -11412,36 +11862,20 @@ MainWindow::writeAllTxt(QStringView message)
 
   // Write decoded text to file "ALL.TXT".
 
-  QFile f {m_config.writeable_data_dir().absoluteFilePath("ALL.TXT")};
+  auto const path = m_config.writeable_data_dir().absoluteFilePath("ALL.TXT");
 
-  if (f.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Append))
+  if (m_RxLog == 1)
   {
-    QTextStream out(&f);
-
-    if (m_RxLog == 1)
-    {
-      out << DriftingDateTime::currentDateTimeUtc().toString("yyyy-MM-dd hh:mm:ss")
-          << "  "
-          << qSetRealNumberPrecision(12)
-          << (m_freqNominal / 1.e6)
-          << " MHz  JS8"
-          << Qt::endl;
-
-      m_RxLog = 0;
-    }
-
-    out << message << Qt::endl;
+    m_journal->append(path,
+                      DriftingDateTime::currentDateTimeUtc().toString("yyyy-MM-dd hh:mm:ss")
+                      % "  "
+                      % QString::number(m_freqNominal / 1.e6, 'g', 12)
+                      % " MHz  JS8");
 
-    f.close();
-  }
-  else
-  {
-    MessageBox::warning_message(this,
-                               tr("File Open Error"),
-                               tr("Cannot open \"%1\" for append: %2")
-                               .arg(f.fileName())
-                               .arg(f.errorString()));
+    m_RxLog = 0;
   }
+
+  m_journal->append(path, message.toString());
 }
 
 void
@@ -11452,29 +11886,20 @@ MainWindow::writeMsgTxt(QStringView message,
 
   // Write decoded text to file "DIRECTED.TXT".
 
-  QFile f {m_config.writeable_data_dir().absoluteFilePath("DIRECTED.TXT")};
-
-  if (f.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Append))
-  {
-      QTextStream out(&f);
-      QString     output = DriftingDateTime::currentDateTimeUtc().toString("yyyy-MM-dd hh:mm:ss")
-                  % "\t" % Radio::frequency_MHz_string(m_freqNominal)
-                  % "\t" % QString::number(freq())
-                  % "\t" % Varicode::formatSNR(snr)
-                  % "\t" % message;
+  m_journal->append(m_config.writeable_data_dir().absoluteFilePath("DIRECTED.TXT"),
+                    DriftingDateTime::currentDateTimeUtc().toString("yyyy-MM-dd hh:mm:ss")
+                    % "\t" % Radio::frequency_MHz_string(m_freqNominal)
+                    % "\t" % QString::number(freq())
+                    % "\t" % Varicode::formatSNR(snr)
+                    % "\t" % message);
+}
 
-      out << output << Qt::endl;
+void
+MainWindow::journalError(QString const & message)
+{
+  qCWarning(mainwindow_js8) << "Log File Error:" << message;
 
-      f.close();
-    }
-    else
-    {
-      MessageBox::warning_message(this,
-                                  tr("File Open Error"),
-                                  tr("Cannot open \"%1\" for append: %2")
-                                  .arg(f.fileName())
-                                  .arg(f.errorString()));
-    }
+  showStatusMessage (message);
 }
 
 QByteArray
@@ -11,6 +11,7 @@
 #include <QMutexLocker>
 #include <QTimer>
 #include <QDateTime>
+#include <QFuture>
 #include <QList>
 #include <QAudioDevice>
 #include <QScopedPointer>
@@ -50,16 +51,20 @@
 #include "MessageClient.hpp"
 #include "MessageServer.h"
 #include "TCPClient.h"
+#include "TimerWheel.hpp"
+#include "TxFrameQueue.hpp"
 #include "TxLoop.h"
 #include "SpotClient.h"
 #include "APRSISClient.h"
+#include "AudioHealth.hpp"
 #include "NotificationAudio.h"
 #include "ProcessThread.h"
+#include "CacheLedger.hpp"
+#include "HeardGraph.hpp"
 #include "JS8.hpp"
+#include "decodedtext.h"
 #include "StationList.hpp"
 
-extern int volatile itone[JS8_NUM_SYMBOLS];   //Audio tones for all Tx symbols
-
 //--------------------------------------------------------------- MainWindow
 namespace Ui {
   class MainWindow;
@@ -80,8 +85,10 @@ class Modulator;
 class SoundInput;
 class Detector;
 class MultiSettings;
-class DecodedText;
 class JSCChecker;
+class Inbox;
+class InboxService;
+class LogJournal;
 
 using namespace std;
 typedef std::function<void()> Callback;
@@ -136,8 +143,10 @@ public slots:
    * The name `guiUpdate` suggests updating of the views from the models
    * (in MVC terms, but we don't do MVC in this project), animations and stuff.
    * While it indeed does that, this also contains controller code.
+   * It runs once a second; the TX sequence is stepped by txUpdate.
    */
   void guiUpdate();
+  void txUpdate();
   void setXIT(int n);
   void qsy(int hzDelta);
   void onDriftChanged(qint64 new_drift_ms);
@@ -153,10 +162,11 @@ public slots:
   QString lookupCallInCompoundCache(QString const &call);
   void cacheActivity(QString key);
   void restoreActivity(QString key);
-  void clearActivity();
+  void clearActivity(bool clearHeardGraph = true);
   void clearBandActivity();
   void clearRXActivity();
-  void clearCallActivity();
+  void clearCallActivity(bool clearHeardGraph = true);
+  void trimActivityCaches(bool force = false);
   void createGroupCallsignTableRows(QTableWidget *table, const QString &selectedCall, bool &showIconColumn);
   void displayTextForFreq(QString text, int freq, QDateTime date, bool isTx, bool isNewLine, bool isLast);
   void writeNoticeTextToUI(QDateTime date, QString text);
@@ -184,6 +194,9 @@ public slots:
   QPair<QString, int> popMessageFrame();
   void tryNotify(const QString &key);
   void processDecodeEvent(JS8::Event::Variant const &);
+  void processDecodedText(DecodedText const &, qint32 syncStart);
+  void processDecodeFinished(std::size_t decoded);
+  void dropPendingDecodes();
 
   void updateCQButtonDisplay();
   void updateHBButtonDisplay();
@@ -343,7 +356,6 @@ private slots:
   void sendNetworkMessage(QString const &type, QString const &message);
   void sendNetworkMessage(QString const &type, QString const &message, const QVariantMap &params);
   void pskReporterError (QString const &);
-  void TxAgain();
   void checkVersion(bool alertOnUpToDate);
   void checkStartupWarnings ();
   void clearCallsignSelected();
@@ -389,7 +401,7 @@ private:
   Q_SIGNAL void transmitFrequency (double) const;
   Q_SIGNAL void endTransmitMessage (bool quick = false) const;
   Q_SIGNAL void tune (bool = true) const;
-  Q_SIGNAL void sendMessage (double frequency, int submode, double txDelay, SoundOutput *, AudioDevice::Channel) const;
+  Q_SIGNAL void sendMessage (double frequency, int submode, double txDelay, QList<int> const & tones, SoundOutput *, AudioDevice::Channel) const;
   Q_SIGNAL void outAttenuationChanged (qreal) const;
   Q_SIGNAL void toggleShorthand () const;
   Q_SIGNAL void submodeChanged (Varicode::SubmodeType) const;
@@ -400,6 +412,7 @@ private:
 
   void writeAllTxt(QStringView message);
   void writeMsgTxt(QStringView message, int snr);
+  void journalError(QString const & message);
 
   void currentTextChanged();
   void tableSelectionChanged(QItemSelection const &,
@@ -412,6 +425,8 @@ private:
   void refuseToSendIn30mWSPRBand();
 
   void prepareSending(qint64 nowMS);
+  void updateTxSequencing();
+  void scheduleTxStart();
 
   /** Update the clock shown. */
   void updateClockUI(const QDateTime&);
@@ -451,6 +466,8 @@ private:
   unsigned m_FFTSize;
   SoundInput * m_soundInput;
   Modulator * m_modulator;
+  TxFrameQueue m_txFrames;
+  AudioHealth m_audioHealth;
   SoundOutput * m_soundOutput;
   NotificationAudio * m_notification;
 
@@ -458,6 +475,10 @@ private:
   // As long as it doesn't, we poll and compare with the previous value.
   double m_TxDelay; // in seconds.
 
+  // Runs the periodic and timed work, in DriftingDateTime's time; this needs
+  // to come before anything that schedules work on it.
+  TimerWheel m_wheel;
+
   TxLoop * m_cq_loop;
   TxLoop * m_hb_loop;
 
@@ -484,6 +505,7 @@ private:
   qint32  m_nSubMode;
   FrequencyList_v2::const_iterator m_frequency_list_fcal_iter;
   qint32  m_i3bit;
+  QList<int> m_tones = QList<int>(JS8_NUM_SYMBOLS, 0); // Audio tones for all Tx symbols
 
   bool    m_btxok;		//True if OK to transmit
   bool    m_decoderBusy;
@@ -522,17 +544,13 @@ private:
   QLabel auto_tx_label;
   QProgressBar progressBar;
   QLabel wpm_label;
+  QLabel audio_label;
 
   //QPointer<QProcess> proc_js8;
 
-  QTimer m_guiTimer;
-  // Timer to switch off PTT after end of transmission.
-  QTimer pttReleaseTimer;
   QTimer logQSOTimer;
   QTimer tuneButtonTimer;
   QTimer tuneATU_Timer;
-  QTimer TxAgainTimer;
-  QTimer minuteTimer;
   QString m_baseCall;
   QString m_hisCall;
   QString m_hisGrid;
@@ -611,6 +629,7 @@ private:
   bool m_rxDirty;
   bool m_rxDisplayDirty;
   int m_txFrameCountEstimate;
+  DataFramePacker m_txFramePacker;
   int m_txFrameCount;
   int m_txFrameCountSent;
   QTimer m_txTextDirtyDebounce;
@@ -623,6 +642,7 @@ private:
   QDateTime m_lastTxStopTime;
   qint32 m_driftMsMMA;
   qint32 m_driftMsMMA_N;
+  QList<qint32> m_driftQueue;
 
   enum Priority {
     PriorityLow    =   10,
@@ -686,6 +706,10 @@ private:
 
   QQueue<DecodeParams> m_decoderQueue;
   FrameCache  m_messageDupeCache; // submode, frame -> date seen
+  QList<QFuture<DecodedText>> m_decodeBatch; // frames of the decode run in progress, being unpacked
+  QList<qint32> m_decodeBatchSync; // sync start in effect for each of those frames
+  QFuture<void> m_decodePending; // handling of the last decode run, which the next one waits on
+  quint64 m_decodeGeneration = 0; // bumped when pending decode runs are to be dropped
   QVariantMap m_showColumnsCache; // table column:key -> show boolean
   QVariantMap m_sortCache; // table key -> sort by
   QPriorityQueue<PrioritizedMessage> m_txMessageQueue; // messages to be sent
@@ -703,21 +727,28 @@ private:
   QMap<int, MessageBuffer> m_messageBuffer; // freq -> (cmd, [frames, ...])
   int m_lastClosedMessageBufferOffset;
   QMap<QString, CallDetail> m_callActivity; // call -> (last freq, last timestamp)
+  QMap<int, QDateTime> m_publishedBandActivity; // offset -> timestamp of activity last sent to the api
+  QMap<QString, QDateTime> m_publishedCallActivity; // call -> timestamp of activity last sent to the api
 
   QMap<int, QString> m_origRxHeaderLabelMap; // colIndex, label
   QMap<int, QString> m_origCallActivityHeaderLabelMap; // colIndex, label
   QMap<QString, QString> m_columnLabelMap; // full, minimal
 
-  QMap<QString, QSet<QString>> m_heardGraphOutgoing; // callsign -> [stations who've this callsign has heard]
-  QMap<QString, QSet<QString>> m_heardGraphIncoming; // callsign -> [stations who've heard this callsign]
+  HeardGraph m_heardGraph; // who's heard whom, on which band
 
+  QScopedPointer<InboxService> m_inbox;
+  QScopedPointer<LogJournal> m_journal;
   QMap<QString, int> m_rxInboxCountCache; // call -> count
 
   QMap<QString, QMap<QString, CallDetail>> m_callActivityBandCache; // band -> call activity
   QMap<QString, QMap<int, QList<ActivityDetail>>> m_bandActivityBandCache; // band -> band activity
   QMap<QString, QString> m_rxTextBandCache; // band -> rx text
-  QMap<QString, QMap<QString, QSet<QString>>> m_heardGraphOutgoingBandCache; // band -> heard in
-  QMap<QString, QMap<QString, QSet<QString>>> m_heardGraphIncomingBandCache; // band -> heard out
+
+  // Recency of the entries in the activity caches above, bounding them.
+  CacheLedger<QString> m_callActivityLedger;
+  CacheLedger<QString> m_rxInboxCountLedger;
+  CacheLedger<QString> m_bandCacheLedger; // band -> all of the band caches
+  qint64 m_lastActivityCacheTrim;
 
   QMap<QString, QDateTime> m_callSelectedTime; // call -> timestamp when callsign was last selected
   QSet<QString> m_callSeenHeartbeat; // call
@@ -740,6 +771,7 @@ private:
   LogBook m_logBook;
   unsigned m_msAudioOutputBuffered;
   unsigned m_framesAudioInputBuffered;
+  bool m_audioAutoTune;
   QThread::Priority m_audioThreadPriority;
   QThread::Priority m_notificationAudioThreadPriority;
   QThread::Priority m_decoderThreadPriority;
@@ -809,28 +841,30 @@ private:
   void processCompoundActivity();
   void processBufferedActivity();
   void processCommandActivity();
+  void enqueueCommandReply(CommandDetail const & d, bool isAllCall, QDateTime const & now, int priority, int freq, QString const & reply, Callback callback);
   QString inboxPath();
   void refreshInboxCounts();
-  bool hasMessageHistory(QString call);
-  int addCommandToMyInbox(CommandDetail d);
-  int addCommandToStorage(QString type, CommandDetail d);
-  int getNextMessageIdForCallsign(QString callsign);
-  int getLookaheadMessageIdForCallsign(QString callsign, int afterMsgId);
-  int getNextGroupMessageIdForCallsign(QString group_name, QString callsign);
-  int getLookaheadGroupMessageIdForCallsign(QString group_name, QString callsign, int afterMsgId);
-  bool markGroupMsgDeliveredForCallsign(int msgId, QString callsign);
-  bool markMsgDelivered(int mid, Message msg);
+  QFuture<bool> hasMessageHistory(QString call);
+  QFuture<int> addCommandToMyInbox(CommandDetail d);
+  QFuture<int> addCommandToStorage(QString type, CommandDetail d);
+  QFuture<int> getNextMessageIdForCallsign(QString callsign);
+  QFuture<int> getNextGroupMessageIdForCallsign(QString group_name, QString callsign);
+  void markGroupMsgDeliveredForCallsign(int msgId, QString callsign);
+  void markMsgDelivered(int mid, Message msg);
   QStringList parseRelayPathCallsigns(QString from, QString text);
   void processSpots();
   void processTxQueue();
   void displayActivity(bool force=false);
   void displayBandActivity();
   void displayCallActivity();
+  void publishActivityDeltas();
   void enable_DXCC_entity (bool on);
   void setRig (Frequency = 0);  // zero frequency means no change
   QDateTime nextTransmitCycle();
   void statusUpdate ();
   void on_the_minute ();
+  void updateAudioHealth ();
+  void rollAudioHealth ();
   void tryBandHop();
   void add_child_to_event_filter (QObject *);
   void remove_child_from_event_filter (QObject *);
@@ -9,6 +9,13 @@
 
 Q_DECLARE_LOGGING_CATEGORY(soundin_js8)
 
+namespace
+{
+  // How often to sample how much audio is waiting in the device buffer.
+
+  constexpr int FILL_SAMPLE_MS = 250;
+}
+
 bool SoundInput::audioError () const
 {
   bool result (true);
@@ -54,7 +61,16 @@ void SoundInput::start(QAudioDevice const& device, int framesPerBuffer, AudioDev
 //  qCDebug (soundin_js8) << "Preferred audio input format:" << format;
   format.setSampleFormat (QAudioFormat::Int16);
   format.setChannelCount (AudioDevice::Mono == channel ? 1 : 2);
-  format.setSampleRate (48000);
+
+  // Take audio at the rate the device prefers, if the sink can resample
+  // from it, sparing the system from having to resample it for us; if
+  // not, ask for the rate we've always used.
+  if (!device.isFormatSupported (format) || !sink->setFrameRate (format.sampleRate ()))
+    {
+      format.setSampleRate (48000);
+      sink->setFrameRate (48000);
+    }
+  qCDebug (soundin_js8) << "Audio input sample rate:" << format.sampleRate ();
   if (!format.isValid ())
     {
       Q_EMIT error (tr ("Requested input audio format is not valid."));
@@ -77,11 +93,19 @@ void SoundInput::start(QAudioDevice const& device, int framesPerBuffer, AudioDev
 
   connect (m_stream.data(), &QAudioSource::stateChanged, this, &SoundInput::handleStateChanged);
 
-  m_stream->setBufferSize (m_stream->format ().bytesForFrames (framesPerBuffer));
+  // the buffer size we're given is in frames at 48 kHz, the rate we took
+  // audio at before we took the rate the device prefers; scale it, so
+  // that the buffer holds the same length of audio at any rate
+  auto const frames = static_cast<int> (static_cast<qint64> (framesPerBuffer) * format.sampleRate () / 48000);
+  m_stream->setBufferSize (m_stream->format ().bytesForFrames (frames));
   if (sink->initialize (QIODevice::WriteOnly, channel))
     {
       m_stream->start (sink);
-      audioError ();
+      if (!audioError () && m_health)
+        {
+          m_health->restarted (m_stream->format ().durationForBytes (m_stream->bufferSize ()) / 1000);
+          m_fill.start (FILL_SAMPLE_MS);
+        }
     }
   else
     {
@@ -109,7 +133,7 @@ void SoundInput::resume ()
   if (m_stream)
     {
       m_stream->resume ();
-      audioError ();
+      if (!audioError () && m_health) m_health->resumed ();
     }
 }
 
@@ -120,6 +144,15 @@ void SoundInput::handleStateChanged (QAudio::State newState) const
   switch (newState)
     {
     case QAudio::IdleState:
+      // the device going quiet isn't in itself a fault, e.g., it does
+      // so around a suspend or stop of our own; only count it if the
+      // device says it has failed to keep us fed
+      if (m_health
+          && (m_stream->error () == QAudio::UnderrunError
+              || m_stream->error () == QAudio::IOError))
+        {
+          m_health->underrun ();
+        }
       Q_EMIT status (tr ("Idle"));
       break;
 
@@ -144,8 +177,18 @@ void SoundInput::handleStateChanged (QAudio::State newState) const
     }
 }
 
+void SoundInput::sampleFill () const
+{
+  if (m_stream && m_health)
+    {
+      m_health->buffered (m_stream->format ().durationForBytes (m_stream->bytesAvailable ()));
+    }
+}
+
 void SoundInput::stop()
 {
+  m_fill.stop ();
+
   if (m_stream)
     {
       m_stream->stop ();
@@ -9,7 +9,9 @@
 #include <QPointer>
 #include <QAudioDevice>
 #include <QAudioSource>
+#include <QTimer>
 #include "AudioDevice.hpp"
+#include "AudioHealth.hpp"
 
 // Gets audio data from sound sample source and passes it to a sink device
 class SoundInput
@@ -21,13 +23,20 @@ public:
   SoundInput (QObject * parent = nullptr)
     : QObject {parent}
     , m_sink {nullptr}
+    , m_fill {this}
   {
+    connect (&m_fill, &QTimer::timeout, this, &SoundInput::sampleFill);
   }
 
   ~SoundInput ();
 
+  // where to record how the stream is keeping up; must be set before
+  // moving us to the audio thread
+  void setHealth (AudioHealth::Stream * health) {m_health = health;}
+
   // sink must exist from the start call until the next start call or
-  // stop call
+  // stop call; framesPerBuffer is counted at 48 kHz, whatever rate the
+  // device is run at, i.e., it's a length of time
   Q_SLOT void start(QAudioDevice const&, int framesPerBuffer, AudioDevice * sink, AudioDevice::Channel = AudioDevice::Mono);
   Q_SLOT void suspend ();
   Q_SLOT void resume ();
@@ -39,11 +48,14 @@ public:
 private:
   // used internally
   Q_SLOT void handleStateChanged (QAudio::State) const;
+  Q_SLOT void sampleFill () const;
 
   bool audioError () const;
 
   QScopedPointer<QAudioSource> m_stream;
   QPointer<AudioDevice> m_sink;
+  QTimer m_fill;
+  AudioHealth::Stream * m_health {nullptr};
 };
 
 #endif
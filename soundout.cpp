@@ -9,6 +9,13 @@
 
 Q_DECLARE_LOGGING_CATEGORY(soundout_js8)
 
+namespace
+{
+  // How often to sample how much audio is waiting in the device buffer.
+
+  constexpr int FILL_SAMPLE_MS = 250;
+}
+
 bool SoundOutput::checkStream () const
 {
   bool result {false};
@@ -106,6 +113,12 @@ void SoundOutput::restart (QIODevice * source)
   }
 
   m_stream->start (source);
+
+  if (m_health)
+  {
+    m_health->restarted (m_stream->format ().durationForBytes (m_stream->bufferSize ()) / 1000);
+    m_fill.start (FILL_SAMPLE_MS);
+  }
 }
 
 void SoundOutput::suspend ()
@@ -137,6 +150,8 @@ void SoundOutput::reset ()
 
 void SoundOutput::stop ()
 {
+  m_fill.stop ();
+
   if (m_stream)
   {
     m_stream->reset ();
@@ -145,6 +160,14 @@ void SoundOutput::stop ()
   //m_stream.reset ();  // XXX in WSJTX, seems like a bug, will assert after stop checks
 }
 
+void SoundOutput::sampleFill () const
+{
+  if (m_stream && m_health)
+    {
+      m_health->buffered (m_stream->format ().durationForBytes (m_stream->bufferSize () - m_stream->bytesFree ()));
+    }
+}
+
 qreal SoundOutput::attenuation () const
 {
   return -(20. * qLn (m_volume) / qLn (10.));
@@ -179,6 +202,9 @@ void SoundOutput::handleStateChanged (QAudio::State newState) const
   switch (newState)
     {
     case QAudio::IdleState:
+      // we pad transmissions with silence until stopped, so running out
+      // of data while sending means we've failed to keep up
+      if (m_health && m_stream->error () == QAudio::UnderrunError) m_health->underrun ();
       Q_EMIT status (tr ("Idle"));
       break;
 
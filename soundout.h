@@ -7,6 +7,8 @@
 #include <QAudioDevice>
 #include <QAudioFormat>
 #include <QAudioSink>
+#include <QTimer>
+#include "AudioHealth.hpp"
 
 // An instance of this sends audio data to a specified soundcard.
 
@@ -16,11 +18,19 @@ class SoundOutput
   Q_OBJECT;
 
 public:
-  SoundOutput() = default;
+  SoundOutput()
+    : m_fill {this}
+  {
+    connect (&m_fill, &QTimer::timeout, this, &SoundOutput::sampleFill);
+  }
 
   qreal attenuation () const;
   QAudioFormat format() const;
 
+  // where to record how the stream is keeping up; must be set before
+  // moving us to the audio thread
+  void setHealth (AudioHealth::Stream * health) {m_health = health;}
+
 public Q_SLOTS:
   void setFormat (QAudioDevice const& device, unsigned channels, unsigned msBuffered = 0u);
   void setDeviceFormat (QAudioDevice const& device, QAudioFormat const&format, unsigned msBuffered = 0u);
@@ -41,11 +51,14 @@ private:
 
 private Q_SLOTS:
   void handleStateChanged (QAudio::State) const;
+  void sampleFill () const;
 
 private:
   QAudioDevice               m_device;
   QScopedPointer<QAudioSink> m_stream;
   QAudioFormat               m_format;
+  QTimer                     m_fill;
+  AudioHealth::Stream      * m_health     = nullptr;
   unsigned                   m_msBuffered = 0u;
   qreal                      m_volume     = 1.0;
   bool                       m_error      = false;
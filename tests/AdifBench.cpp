@@ -0,0 +1,463 @@
+#include "logbook/adif.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QMultiHash>
+#include <QSet>
+#include <QString>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimeZone>
+
+// Loading of ADIF logs of 10k to 1M QSOs, a line at a time into a buffer
+// searched for each field, as ADIF used to, in a single mapped pass, as it
+// does now, and from the index cache that pass leaves beside the log. Fails
+// if what's loaded doesn't answer every worked-before and details question
+// as it did; the throughput is only reported, since it depends on the
+// machine, and on the disk.
+
+/******************************************************************************/
+// Constants
+/******************************************************************************/
+
+namespace
+{
+  // QSOs in each log, and the QSOs per distinct callsign in it; a busy
+  // station works the same calls again and again.
+
+  constexpr int SIZES[] = {10000, 100000, 1000000};
+  constexpr int REPEATS = 10;
+
+  // Fixed, so that any failure can be reproduced.
+
+  constexpr std::mt19937::result_type SEED = 20130701;
+
+  // Bands logged, in the case they're logged in; an empty one counts as
+  // worked on any band. Those asked about include one never logged.
+
+  constexpr char const * BANDS[]  = {"160m", "80m", "40m", "30m", "20m", "20M", "17m", "15m", "10m", "6m", ""};
+  constexpr char const * ASKED[]  = {"160m", "80m", "40m", "30m", "20m", "17m", "15m", "10m", "6m", "2190m", ""};
+  constexpr char const * GRIDS[]  = {"EM73", "KP25", "FM18", "FN31", "KM71", "QF56", ""};
+  constexpr char const * NAMES[]  = {"JORDAN", "ALEX", "SAM", "CHRIS", ""};
+  constexpr char const * MODES[]  = {"MFSK", "FT8", "JS8"};
+}
+
+/******************************************************************************/
+// Previous Implementation
+/******************************************************************************/
+
+namespace Old
+{
+  class ADIF
+  {
+  public:
+
+    void init(QString const& filename);
+    void load();
+    void add(QString const& call, QString const& band, QString const& mode, const QString &submode, QString const& grid, QString const& date, const QString &name, const QString &comment);
+    bool match(QString const& call, QString const& band) const;
+    QList<::ADIF::QSO> find(QString const& call) const;
+    qsizetype getCount() const;
+    QSet<QString> getCalls() const;
+
+  private:
+
+    QMultiHash<QString, ::ADIF::QSO> _data;
+    QString _filename;
+
+    QString extractField(QString const& line, QString const& fieldName) const;
+  };
+
+  void ADIF::init(QString const& filename)
+  {
+      _filename = filename;
+      _data.clear();
+  }
+
+
+  QString ADIF::extractField(QString const& record, QString const& fieldName) const
+  {
+      qsizetype fieldNameIndex = record.indexOf ('<' + fieldName + ':', 0, Qt::CaseInsensitive);
+      if (fieldNameIndex >=0)
+      {
+          qsizetype closingBracketIndex = record.indexOf('>',fieldNameIndex);
+          qsizetype fieldLengthIndex    = record.indexOf(':',fieldNameIndex);  // find the size delimiter
+          qsizetype dataTypeIndex       = -1;
+          if (fieldLengthIndex >= 0)
+          {
+            dataTypeIndex = record.indexOf(':',fieldLengthIndex+1);  // check for a second : indicating there is a data type
+            if (dataTypeIndex > closingBracketIndex)
+              dataTypeIndex = -1; // second : was found but it was beyond the closing >
+          }
+
+          if ((closingBracketIndex > fieldNameIndex) && (fieldLengthIndex > fieldNameIndex) && (fieldLengthIndex< closingBracketIndex))
+          {
+              qsizetype fieldLengthCharCount = closingBracketIndex - fieldLengthIndex -1;
+              if (dataTypeIndex >= 0)
+                fieldLengthCharCount -= 2; // data type indicator is always a colon followed by a single character
+              QString fieldLengthString = record.mid(fieldLengthIndex+1,fieldLengthCharCount);
+              int fieldLength = fieldLengthString.toInt();
+              if (fieldLength > 0)
+              {
+                QString field = record.mid(closingBracketIndex+1,fieldLength);
+                return field;
+              }
+         }
+      }
+      return "";
+  }
+
+
+
+  void ADIF::load()
+  {
+      _data.clear();
+      QFile inputFile(_filename);
+      if (inputFile.open(QIODevice::ReadOnly))
+      {
+        QTextStream in(&inputFile);
+        QString buffer;
+        bool pre_read {false};
+        qsizetype end_position {-1};
+
+        // skip optional header record
+        do
+          {
+            buffer += in.readLine () + '\n';
+            if (buffer.startsWith (QChar {'<'})) // denotes no header
+              {
+                pre_read = true;
+              }
+            else
+              {
+                end_position = buffer.indexOf ("<EOH>", 0, Qt::CaseInsensitive);
+              }
+          }
+        while (!in.atEnd () && !pre_read && end_position < 0);
+        if (!pre_read)            // found header
+          {
+            buffer.remove (0, end_position + 5);
+          }
+        while (buffer.size () || !in.atEnd ())
+          {
+            do
+              {
+                end_position = buffer.indexOf ("<EOR>", 0, Qt::CaseInsensitive);
+                if (!in.atEnd () && end_position < 0)
+                  {
+                    buffer += in.readLine () + '\n';
+                  }
+              }
+            while (!in.atEnd () && end_position < 0);
+            qsizetype record_length {end_position >= 0 ? end_position + 5 : -1};
+            auto record = buffer.left (record_length).trimmed ();
+            auto next_record = buffer.indexOf (QChar {'<'}, record_length);
+            buffer.remove (0, next_record >=0 ? next_record : buffer.size ());
+            record = record.mid (record.indexOf (QChar {'<'}));
+            add (extractField (record, "CALL")
+                 , extractField (record, "BAND")
+                 , extractField (record, "MODE")
+                 , extractField (record, "SUBMODE")
+                 , extractField (record, "GRIDSQUARE")
+                 , extractField (record, "QSO_DATE")
+                 , extractField (record, "NAME")
+                 , extractField (record, "COMMENT")
+                 );
+          }
+          inputFile.close ();
+      }
+  }
+
+
+  void ADIF::add(QString const& call, QString const& band, QString const& mode, QString const& submode, QString const &grid, QString const& date, QString const& name, QString const& comment)
+  {
+      ::ADIF::QSO q;
+      q.call = call;
+      q.band = band;
+      q.mode = mode;
+      q.submode = submode;
+      q.grid = grid;
+      q.date = date;
+      q.name = name;
+      q.comment = comment;
+
+      if (q.call.size ())
+        {
+          _data.insert(q.call,q);
+          // qCDebug(adif_js8) << "Added as worked:" << call << band << mode << date;
+        }
+  }
+
+  // return true if in the log same band
+  bool ADIF::match(QString const& call, QString const& band) const
+  {
+      QList<::ADIF::QSO> qsos = _data.values(call);
+      if (qsos.size()>0)
+      {
+          ::ADIF::QSO q;
+          foreach(q,qsos)
+          {
+              if (     (band.compare(q.band,Qt::CaseInsensitive) == 0)
+                    || (band=="")
+                    || (q.band==""))
+              {
+                  return true;
+              }
+          }
+      }
+      return false;
+  }
+
+  QList<::ADIF::QSO> ADIF::find(QString const& call) const
+  {
+      return _data.values(call);
+  }
+
+  qsizetype ADIF::getCount() const
+  {
+      return _data.size();
+  }
+
+  // Not as it was; getCallList() listed a call once for each QSO.
+
+  QSet<QString>
+  ADIF::getCalls() const
+  {
+    auto const keys = _data.uniqueKeys();
+
+    return QSet<QString>(keys.begin(), keys.end());
+  }
+
+  // As LogBook::findCallDetails() made them of what find() returned; the
+  // first of each detail found, most recent QSO first.
+
+  ::ADIF::QSO
+  details(ADIF const & log, QString const & call)
+  {
+    ::ADIF::QSO details;
+
+    foreach(auto qso, log.find(call)){
+        if(details.grid.isEmpty() && !qso.grid.isEmpty()) details.grid = qso.grid;
+        if(details.date.isEmpty() && !qso.date.isEmpty()) details.date = qso.date;
+        if(details.name.isEmpty() && !qso.name.isEmpty()) details.name = qso.name;
+        if(details.comment.isEmpty() && !qso.comment.isEmpty()) details.comment = qso.comment;
+    }
+
+    return details;
+  }
+}
+
+/******************************************************************************/
+// Local Routines
+/******************************************************************************/
+
+namespace
+{
+  std::mt19937 rng(SEED);
+
+  int
+  uniform(int const lo,
+          int const hi)
+  {
+    return std::uniform_int_distribution<int>(lo, hi)(rng);
+  }
+
+  template <typename T, std::size_t N>
+  T
+  pick(T const (& array)[N])
+  {
+    return array[uniform(0, N - 1)];
+  }
+
+  QString
+  callsign(int const i)
+  {
+    return QString("K%1%2").arg(i % 10).arg(QString::number(i, 36).toUpper());
+  }
+
+  // Write a log of the size provided, as addQSOToFile() would have, one
+  // QSO a minute, and return its size in megabytes.
+
+  double
+  write(QString const & path,
+        int     const   size)
+  {
+    QFile file(path);
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return 0;
+
+    ADIF       adif;
+    QByteArray chunk = "JS8Call ADIF Export<eoh>\n";
+    auto       on    = QDateTime(QDate(2015, 1, 1), QTime(0, 0), QTimeZone::UTC);
+
+    for (int i = 0; i < size; ++i, on = on.addSecs(60))
+    {
+      auto const mode    = QString(pick(MODES));
+      auto const comment = uniform(0, 3) ? QString() : QString("QSO NUMBER %1").arg(i);
+
+      chunk += adif.QSOToADIF(callsign(uniform(0, size / REPEATS)), pick(GRIDS),
+                              mode, mode == "MFSK" ? "JS8" : "",
+                              QString::number(uniform(-24, 10)), QString::number(uniform(-24, 10)),
+                              on, on.addSecs(45), pick(BANDS), comment, pick(NAMES),
+                              "14.078000", "KN4CRD", "EM73", "", {});
+      chunk += " <eor>\n";
+
+      if (chunk.size() > 1024 * 1024)
+      {
+        file.write(chunk);
+        chunk.clear();
+      }
+    }
+
+    file.write(chunk);
+
+    return file.size() / (1024.0 * 1024.0);
+  }
+
+  // Whether the log loaded answers every question about every call as
+  // the previous implementation does.
+
+  bool
+  same(Old::ADIF const & old,
+       ADIF      const & adif)
+  {
+    auto const calls = old.getCalls();
+
+    if (old.getCount() != adif.getCount())
+    {
+      std::printf("FAIL %lld QSOs loaded, not %lld\n",
+                  static_cast<long long>(adif.getCount()),
+                  static_cast<long long>(old.getCount()));
+      return false;
+    }
+
+    if (auto const list = adif.getCallList(); QSet<QString>(list.begin(), list.end()) != calls)
+    {
+      std::printf("FAIL calls loaded differ\n");
+      return false;
+    }
+
+    for (auto const & call : calls)
+    {
+      for (auto const band : ASKED)
+      {
+        if (old.match(call, band) != adif.match(call, band))
+        {
+          std::printf("FAIL %s on \"%s\" worked before differs\n", qPrintable(call), band);
+          return false;
+        }
+      }
+
+      auto const expected = Old::details(old, call);
+      ADIF::QSO  details;
+
+      if (!adif.find(call, details)         ||
+          details.grid    != expected.grid  ||
+          details.date    != expected.date  ||
+          details.name    != expected.name  ||
+          details.comment != expected.comment)
+      {
+        std::printf("FAIL %s details differ\n", qPrintable(call));
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // Milliseconds taken by the function provided.
+
+  template <typename Function>
+  double
+  elapsed(Function function)
+  {
+    auto const start = std::chrono::steady_clock::now();
+
+    function();
+
+    std::chrono::duration<double, std::milli> const taken = std::chrono::steady_clock::now() - start;
+
+    return taken.count();
+  }
+}
+
+/******************************************************************************/
+// Main
+/******************************************************************************/
+
+int
+main(int    argc,
+     char * argv[])
+{
+  QCoreApplication app(argc, argv);
+  QTemporaryDir    dir;
+
+  if (!dir.isValid())
+  {
+    std::printf("FAIL unable to create a temporary directory\n");
+    return 1;
+  }
+
+  bool failed = false;
+
+  std::printf("%8s %8s %11s %8s %11s %8s %11s %8s %9s\n",
+              "QSOs", "MB",
+              "before ms", "MB/s",
+              "parsed ms", "MB/s",
+              "cached ms", "MB/s",
+              "speedup");
+
+  for (auto const size : SIZES)
+  {
+    auto const path = dir.filePath(QString("log%1.adi").arg(size));
+    auto const mb   = write(path, size);
+
+    if (mb == 0)
+    {
+      std::printf("FAIL unable to write a log of %d QSOs\n", size);
+      failed = true;
+      continue;
+    }
+
+    Old::ADIF old;
+    ADIF      parsed;
+    ADIF      cached;
+
+    old.init(path);
+    parsed.init(path);
+    cached.init(path);
+
+    // The first load finds no index, so parses the log, and leaves one;
+    // the second finds it, and parses nothing.
+
+    auto const timeOld    = elapsed([&]{ old.load();    });
+    auto const timeParsed = elapsed([&]{ parsed.load(); });
+    auto const timeCached = elapsed([&]{ cached.load(); });
+
+    if (!QFileInfo::exists(path + ".idx"))
+    {
+      std::printf("FAIL no index left beside the log of %d QSOs\n", size);
+      failed = true;
+    }
+
+    failed |= !same(old, parsed);
+    failed |= !same(old, cached);
+
+    std::printf("%8d %8.1f %11.0f %8.1f %11.0f %8.1f %11.0f %8.1f %8.1fx\n",
+                size, mb,
+                timeOld,    1000 * mb / timeOld,
+                timeParsed, 1000 * mb / timeParsed,
+                timeCached, 1000 * mb / timeCached,
+                timeOld / timeParsed);
+
+    QFile::remove(path);
+    QFile::remove(path + ".idx");
+  }
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,998 @@
+#include "jsc.h"
+#include "varicode.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Round trips through the message codecs, and cross-checks of each of
+// them against the implementation it replaced, copied here as it was,
+// since what they produce goes over the air, and has to stay the same
+// for as long as anyone's listening. Fails if anything doesn't match.
+
+/******************************************************************************/
+// Constants
+/******************************************************************************/
+
+namespace
+{
+  // Random inputs are drawn from a fixed seed, so that any failure can
+  // be reproduced.
+
+  constexpr std::mt19937::result_type SEED = 20180715;
+
+  // Dictionary words looked up, and texts of up to MAX_WORDS words each
+  // encoded, by each of the checks.
+
+  constexpr int WORDS     = 5000;
+  constexpr int TEXTS     = 2000;
+  constexpr int MAX_WORDS = 12;
+
+  // Characters a word might continue with, beyond the dictionary's.
+
+  constexpr char SUFFIXES[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 ./?-+";
+
+  // Failures reported in full before we just count them.
+
+  constexpr int MAX_REPORTED = 20;
+}
+
+/******************************************************************************/
+// Local Routines
+/******************************************************************************/
+
+namespace
+{
+  std::mt19937 rng(SEED);
+  int          failures = 0;
+
+  int
+  uniform(int const lo,
+          int const hi)
+  {
+    return std::uniform_int_distribution<int>(lo, hi)(rng);
+  }
+
+  quint64
+  uniform64()
+  {
+    return std::uniform_int_distribution<quint64>()(rng);
+  }
+
+  // Note that the check named failed for the input provided.
+
+  void
+  fail(char    const * check,
+       QString const & input)
+  {
+    if (failures++ < MAX_REPORTED) std::printf("FAIL %s: \"%s\"\n", check, qPrintable(input));
+  }
+
+  // Words of the dictionary that look up, whole, to themselves, and that
+  // are upper case, as the Huffman table is; any text made of them can
+  // be encoded by either codec without anything being skipped over.
+
+  QStringList const &
+  words()
+  {
+    static QStringList const words = []
+    {
+      QStringList words;
+
+      for (quint32 i = 0; i < JSC::size; ++i)
+      {
+        if (!JSC::map[i].str) continue;
+
+        auto const word  = QString::fromLatin1(JSC::map[i].str);
+        bool       ok    = false;
+        auto const index = JSC::lookup(word, &ok);
+
+        if (ok                     &&
+            !word.isEmpty()        &&
+            !word.contains(' ')    &&
+            word == word.toUpper() &&
+            word == QString::fromLatin1(JSC::map[index].str)) words.append(word);
+      }
+
+      return words;
+    }();
+
+    return words;
+  }
+
+  // A text of between one and MAX_WORDS of the words above.
+
+  QString
+  text()
+  {
+    QStringList parts;
+
+    for (int i = uniform(1, MAX_WORDS); i > 0; --i)
+    {
+      parts.append(words().at(uniform(0, words().size() - 1)));
+    }
+
+    return parts.join(' ');
+  }
+
+  // A text as above, with a few of its characters replaced by ones that
+  // the dictionary or the Huffman table might not have, in lower case,
+  // or outside of Latin-1, so that there's something to skip over.
+
+  QString
+  noisy()
+  {
+    auto input = text();
+
+    for (int i = uniform(1, 4); i > 0; --i)
+    {
+      auto const at = uniform(0, input.size() - 1);
+
+      switch (uniform(0, 2))
+      {
+        case 0:  input[at] = QLatin1Char(SUFFIXES[uniform(0, sizeof(SUFFIXES) - 2)]); break;
+        case 1:  input[at] = input.at(at).toLower();                                  break;
+        default: input[at] = QChar(0x20ac);                                           break;
+      }
+    }
+
+    return input;
+  }
+
+  // Whether the text provided ought to come back out of a frame just as
+  // it went in; it has to be in upper case, as the Huffman table is, in
+  // Latin-1, as the dictionary is, and all of it in the dictionary.
+
+  bool
+  lossless(QString const & input)
+  {
+    if (input != input.toUpper()) return false;
+
+    for (auto const ch : input)
+    {
+      if (ch.unicode() > 0xff) return false;
+    }
+
+    QList<int> starts;
+    auto const codes = JSC::compress(input, &starts);
+    int        at    = 0;
+
+    for (int i = 0; i < codes.size(); ++i)
+    {
+      if (starts.at(i) != at) return false;
+
+      at += codes.at(i).second;
+    }
+
+    return at == input.size();
+  }
+
+  template <std::size_t N>
+  QVector<bool>
+  toBits(BitBuffer<N> const & buffer)
+  {
+    QVector<bool> bits;
+
+    for (int i = 0; i < buffer.size(); ++i) bits.append(buffer.at(i));
+
+    return bits;
+  }
+
+  QString
+  toString(QVector<bool> const & bits)
+  {
+    QString string;
+
+    for (auto const bit : bits) string.append(bit ? '1' : '0');
+
+    return string;
+  }
+}
+
+/******************************************************************************/
+// Previous Implementations
+/******************************************************************************/
+
+namespace Old
+{
+  // JSC::lookup(), as it was before the trie; a linear scan of the list
+  // from the start of the first letter's group.
+
+  quint32 lookup(char const* b, bool *ok){
+      quint32 index = 0;
+      quint32 count = 0;
+      bool found = false;
+
+      // first find prefix match to jump into the list faster
+      for(quint32 i = 0; i < JSC::prefixSize; i++){
+          // skip obvious non-prefixes...
+          if(b[0] != JSC::prefix[i].str[0]){
+              continue;
+          }
+
+          // ok, we found one... let's end early for single char strings.
+          if(JSC::prefix[i].size == 1){
+              if(ok) *ok = true;
+              return JSC::list[JSC::prefix[i].index].index;
+          }
+
+          // otherwise, keep track of the first index in the list and the number of elements
+          index = JSC::prefix[i].index;
+          count = JSC::prefix[i].size;
+          found = true;
+          break;
+      }
+
+      // no prefix found... no lookup
+      if(!found){
+          if(ok) *ok = false;
+          return 0;
+      }
+
+      // now that we have the first index in the list, let's just iterate through the list, comparing words along the way
+      for(quint32 i = index; i < index + count; i++){
+          quint32 len = JSC::list[i].size;
+          if(strncmp(b, JSC::list[i].str, len) == 0){
+              if(ok) *ok = true;
+              return JSC::list[i].index;
+          }
+      }
+
+      if(ok) *ok = false;
+      return 0;
+  }
+
+  // The QVector<bool> routines that BitBuffer replaced.
+
+  QVector<bool> strToBits(QString const& bitvec){
+      QVector<bool> bits;
+      foreach(auto ch, bitvec){
+          bits.append(ch == '1');
+      }
+      return bits;
+  }
+
+  QVector<bool> intToBits(quint64 value, int expected){
+      QVector<bool> bits;
+
+      while(value){
+          bits.prepend((bool)(value & 1));
+          value = value >> 1;
+      }
+
+      if(expected){
+          while(bits.count() < expected){
+              bits.prepend((bool) 0);
+          }
+      }
+
+      return bits;
+  }
+
+  quint64 bitsToInt(QVector<bool> const value){
+      quint64 v = 0;
+      foreach(bool bit, value){
+          v = (v << 1) + (int)(bit);
+      }
+      return v;
+  }
+
+  quint64 bitsToInt(QVector<bool>::ConstIterator start, int n){
+      quint64 v = 0;
+      for(int i = 0; i < n; i++){
+          int bit = (int)(*start);
+          v = (v << 1) + (int)(bit);
+          start++;
+      }
+      return v;
+  }
+
+  // JSC codewords, compression, and decompression, as they were with
+  // codewords in a QVector<bool>.
+
+  QVector<bool> codeword(quint32 index, bool separate, quint32 bytesize, quint32 s, quint32 c){
+      QList<QVector<bool>> out;
+
+      quint32 v = ((index % s) << 1) + (quint32)separate;
+      out.prepend(intToBits(v, bytesize + 1));
+
+      quint32 x = index / s;
+      while(x > 0){
+          x -= 1;
+          out.prepend(intToBits((x % c) + s, bytesize));
+          x /= c;
+      }
+
+      QVector<bool> word;
+      foreach(auto w, out){
+          word.append(w);
+      }
+
+      return word;
+  }
+
+  QList<QPair<QVector<bool>, quint32>> compress(QString text){
+      QList<QPair<QVector<bool>, quint32>> out;
+
+      const quint32 b = 4;
+      const quint32 s = 7;
+      const quint32 c = pow(2, 4) - s;
+
+      QString space(" ");
+
+      QStringList words = text.split(" ", Qt::KeepEmptyParts);
+
+      for(int i = 0, len = words.length(); i < len; i++){
+          QString w = words[i];
+
+          bool isLastWord = (i == len - 1);
+          bool ok = false;
+          bool isSpaceCharacter = false;
+
+          // if this is an empty part, it should be a space, unless its the last word.
+          if(w.isEmpty() && !isLastWord){
+              w = space;
+              isSpaceCharacter = true;
+          }
+
+          while(!w.isEmpty()){
+              // this does both prefix and full match lookup
+              auto index = lookup(w.toLatin1().data(), &ok);
+              if(!ok){
+                  break;
+              }
+
+              auto t = JSC::map[index];
+
+              w = QString(w).mid(t.size);
+
+              bool isLast = w.isEmpty();
+              bool shouldAppendSpace = isLast && !isSpaceCharacter && !isLastWord;
+
+              out.append({ codeword(index, shouldAppendSpace, b, s, c), (quint32)t.size + (shouldAppendSpace ? 1 : 0) /* for the space that follows */});
+          }
+      }
+
+      return out;
+  }
+
+  QString decompress(QVector<bool> const& bitvec){
+      const quint32 b = 4;
+      const quint32 s = 7;
+      const quint32 c = pow(2, b) - s;
+
+      QStringList out;
+
+      quint32 base[8];
+      base[0] = 0;
+      base[1] = s;
+      base[2] = base[1] + s*c;
+      base[3] = base[2] + s*c*c;
+      base[4] = base[3] + s*c*c*c;
+      base[5] = base[4] + s*c*c*c*c;
+      base[6] = base[5] + s*c*c*c*c*c;
+      base[7] = base[6] + s*c*c*c*c*c*c;
+
+      QList<quint64> bytes;
+      QList<quint32> separators;
+
+      int i = 0;
+      int count = bitvec.count();
+      while(i < count){
+          auto b = bitvec.mid(i, 4);
+          if(b.length() != 4){
+              break;
+          }
+          quint64 byte = bitsToInt(b);
+          bytes.append(byte);
+          i += 4;
+
+          if(byte < s){
+              if(count - i > 0 && bitvec.at(i)){
+                  separators.append(bytes.length()-1);
+              }
+              i += 1;
+          }
+      }
+
+      quint32 start = 0;
+      while(start < (quint32)bytes.length()){
+          quint32 k = 0;
+          quint32 j = 0;
+
+          while(start + k < (quint32)bytes.length() && bytes[start + k] >= s){
+              j = j*c + (bytes[start + k] - s);
+              k++;
+          }
+          if(j >= JSC::size){
+              break;
+          }
+
+          if(start + k >= (quint32)bytes.length()){
+              break;
+          }
+          j = j*s + bytes[start + k] + base[k];
+
+          if(j >= JSC::size){
+              break;
+          }
+
+          // map is in latin1 format, not utf-8
+          auto word = QLatin1String(JSC::map[j].str);
+
+          out.append(word);
+          if(!separators.isEmpty() && separators.first() == start + k){
+              out.append(" ");
+              separators.removeFirst();
+          }
+
+          start = start + (k + 1);
+      }
+
+      return out.join("");
+  }
+
+  // Huffman coding, as it was before the table was compiled.
+
+  QList<QPair<int, QVector<bool>>> huffEncode(const QMap<QString, QString> &huff, QString const& text){
+      QList<QPair<int, QVector<bool>>> out;
+
+      int i = 0;
+
+      auto keys = huff.keys();
+      std::sort(keys.begin(), keys.end(), [](QString const &a, QString const &b){
+          auto alen = a.length();
+          auto blen = b.length();
+          if(blen < alen){
+              return true;
+          }
+          if(alen < blen){
+              return false;
+          }
+
+          return b < a;
+      });
+
+      while(i < text.length()){
+          bool found = false;
+          foreach(auto ch, keys){
+              if (QStringView(text.begin() + i, text.end()).startsWith(ch)) {
+                  out.append({ ch.length(), strToBits(huff[ch])});
+                  i += ch.length();
+                  found = true;
+                  break;
+              }
+          }
+
+          if(!found){
+              i++;
+          }
+      }
+
+      return out;
+  }
+
+  QString bitsToStr(QVector<bool> const& bitvec){
+      QString bits;
+      foreach(auto bit, bitvec){
+          bits.append(bit ? "1" : "0");
+      }
+      return bits;
+  }
+
+  QChar EOT = '\x04'; // EOT char
+
+  QString huffDecode(QMap<QString, QString> const &huff, QVector<bool> const& bitvec){
+      QString text;
+
+      QString bits = bitsToStr(bitvec);
+
+      // TODO: jsherer - this is naive...
+      while(bits.length() > 0){
+          bool found = false;
+          foreach(auto key, huff.keys()){
+              if(bits.startsWith(huff[key])){
+                  if(key == EOT){
+                      text.append(" ");
+                      found = false;
+                      break;
+                  }
+                  text.append(key);
+                  bits = bits.mid(huff[key].length());
+                  found = true;
+              }
+          }
+          if(!found){
+              break;
+          }
+      }
+
+      return text;
+  }
+
+  QSet<QString> huffValidChars(const QMap<QString, QString> &huff){
+      auto const keys = huff.keys();
+      return QSet<QString>(keys.begin(),
+                           keys.end());
+  }
+
+  // Data frame packing, as it was with frames in a QVector<bool>, and
+  // before DataFramePacker; less its logging.
+
+  QString packHuffMessage(const QString &input, const QVector<bool> prefix, int *n){
+      static const int frameSize = 72;
+
+      QString frame;
+
+      // [1][1][70] = 72
+      // The first bit is a flag that indicates this is a data frame, technically encoded as [100]
+      // but, since none of the other frame types start with a 0, we can drop the two zeros and use
+      // them for encoding the first two bits of the actuall data sent. boom!
+      // The second bit is a flag that indicates this is not compressed frame (huffman coding)
+      QVector<bool> frameBits;
+      if(!prefix.isEmpty()){
+          frameBits << prefix;
+      }
+
+      int i = 0;
+
+      // only pack huff messages that only contain valid chars
+      QString::const_iterator it;
+      QSet<QString> validChars = huffValidChars(Varicode::defaultHuffTable());
+      for(it = input.constBegin(); it != input.constEnd(); it++){
+          auto ch = (*it).toUpper();
+          if(!validChars.contains(ch)){
+              if(n) *n = 0;
+              return frame;
+          }
+      }
+
+      // pack using the default huff table
+      foreach(auto pair, huffEncode(Varicode::defaultHuffTable(), input)){
+          auto charN = pair.first;
+          auto charBits = pair.second;
+          if(frameBits.length() + charBits.length() < frameSize){
+              frameBits += charBits;
+              i += charN;
+              continue;
+          }
+          break;
+      }
+
+      int pad = frameSize - frameBits.length();
+      if(pad){
+          // the way we will pad is this...
+          // set the bit after the frame to 0 and every bit after that a 1
+          // to unpad, seek from the end of the bits until you hit a zero... the rest is the actual frame.
+          for(int i = 0; i < pad; i++){
+              frameBits.append(i == 0 ? (bool)0 : (bool)1);
+          }
+      }
+
+      quint64 value = bitsToInt(frameBits.constBegin(), 64);
+      quint8 rem = (quint8)bitsToInt(frameBits.constBegin() + 64, 8);
+      frame = Varicode::pack72bits(value, rem);
+
+      if(n) *n = i;
+
+      return frame;
+  }
+
+  QString packCompressedMessage(const QString &input, QVector<bool> prefix, int *n){
+      static const int frameSize = 72;
+
+      QString frame;
+
+      // [1][1][70] = 72
+      // The first bit is a flag that indicates this is a data frame, technically encoded as [100]
+      // but, since none of the other frame types start with a 1, we can drop the two zeros and use
+      // them for encoding the first two bits of the actuall data sent. boom!
+      // The second bit is a flag that indicates this is a compressed frame (dense coding)
+      // For fast modes, we don't use the prefix since it is indicated by the JS8CallData flag.
+      QVector<bool> frameBits;
+      if(!prefix.isEmpty()){
+          frameBits << prefix;
+      }
+
+      int i = 0;
+      foreach(auto pair, compress(input)){
+          auto bits = pair.first;
+          auto chars = pair.second;
+
+          if(frameBits.length() + bits.length() < frameSize){
+              frameBits.append(bits);
+              i += chars;
+              continue;
+          }
+
+          break;
+      }
+
+      int pad = frameSize - frameBits.length();
+      if(pad){
+          // the way we will pad is this...
+          // set the bit after the frame to 0 and every bit after that a 1
+          // to unpad, seek from the end of the bits until you hit a zero... the rest is the actual frame.
+          for(int i = 0; i < pad; i++){
+              frameBits.append(i == 0 ? (bool)0 : (bool)1);
+          }
+      }
+
+      quint64 value = bitsToInt(frameBits.constBegin(), 64);
+      quint8 rem = (quint8)bitsToInt(frameBits.constBegin() + 64, 8);
+      frame = Varicode::pack72bits(value, rem);
+
+      if(n) *n = i;
+
+      return frame;
+  }
+
+  QString packDataMessage(const QString &input, int *n){
+     QString huffFrame;
+     int huffChars = 0;
+     huffFrame = packHuffMessage(input, {true, false}, &huffChars);
+
+     QString compressedFrame;
+     int compressedChars = 0;
+     compressedFrame = packCompressedMessage(input, {true, true}, &compressedChars);
+
+     if(huffChars > compressedChars){
+         if(n) *n = huffChars;
+         return huffFrame;
+     } else {
+         if(n) *n = compressedChars;
+         return compressedFrame;
+     }
+  }
+
+  QString packFastDataMessage(const QString &input, int *n){
+     QString compressedFrame;
+     int compressedChars = 0;
+     compressedFrame = packCompressedMessage(input, {}, &compressedChars);
+
+     if(n) *n = compressedChars;
+     return compressedFrame;
+  }
+}
+
+/******************************************************************************/
+// Checks
+/******************************************************************************/
+
+namespace
+{
+  // Dictionary lookups, through either overload, against the linear scan;
+  // of words in the dictionary, of prefixes of them, and of them followed
+  // by something that might or might not make a longer word.
+
+  void
+  checkLookup()
+  {
+    auto const check = [](QByteArray const & word)
+    {
+      bool oldOk = false;
+      bool newOk = false;
+      bool strOk = false;
+
+      auto const oldIndex = Old::lookup(word.constData(), &oldOk);
+      auto const newIndex = JSC::lookup(word.constData(), &newOk);
+      auto const strIndex = JSC::lookup(QString::fromLatin1(word), &strOk);
+
+      if (newOk != oldOk || (newOk && newIndex != oldIndex)) fail("JSC::lookup",          QString::fromLatin1(word));
+      if (strOk != newOk || (strOk && strIndex != newIndex)) fail("JSC::lookup(QString)", QString::fromLatin1(word));
+    };
+
+    for (int i = 0; i < WORDS; ++i)
+    {
+      QByteArray const word(JSC::list[uniform(0, JSC::size - 1)].str);
+
+      if (word.isEmpty()) continue;
+
+      check(word);
+      check(word.left(uniform(1, word.size())));
+      check(word + QByteArray(uniform(1, 3), SUFFIXES[uniform(0, sizeof(SUFFIXES) - 2)]));
+    }
+  }
+
+  // A BitBuffer, through a random run of appends, truncations, and
+  // slices, against a QVector<bool> put through the same, with any bits
+  // past the capacity dropped, as BitBuffer drops them.
+
+  void
+  checkBitBuffer()
+  {
+    for (int t = 0; t < TEXTS; ++t)
+    {
+      BitBuffer<72> bits;
+      QVector<bool> reference;
+
+      for (int op = 0; op < 16; ++op)
+      {
+        switch (uniform(0, 3))
+        {
+          case 0:
+          {
+            bool const bit = uniform(0, 1);
+
+            bits     .append(bit);
+            reference.append(bit);
+            break;
+          }
+          case 1:
+          {
+            auto const n     = uniform(1, 64);
+            auto const value = n == 64 ? uniform64() : uniform64() & ((1ULL << n) - 1);
+
+            bits.append(value, n);
+            reference += Old::intToBits(value, n);
+            break;
+          }
+          case 2:
+          {
+            auto const n = uniform(0, 80);
+
+            bits.truncate(n);
+            if (n < reference.size()) reference.resize(n);
+            break;
+          }
+          default:
+          {
+            auto const pos = uniform(0, 80);
+            auto const n   = uniform(-1, 80);
+
+            bits      = bits.mid(pos, n);
+            reference = reference.mid(pos, n);
+            break;
+          }
+        }
+
+        if (reference.size() > 72) reference.resize(72);
+
+        if (toBits(bits) != reference) fail("BitBuffer", toString(reference));
+
+        auto const pos = uniform(0, reference.size());
+        auto const n   = uniform(0, std::min<int>(64, reference.size() - pos));
+
+        if (bits.extract(pos, n)     != Old::bitsToInt(reference.mid(pos, n))) fail("BitBuffer::extract",     toString(reference));
+        if (bits.lastIndexOf(false)  != reference.lastIndexOf(false))          fail("BitBuffer::lastIndexOf", toString(reference));
+      }
+    }
+  }
+
+  // Codewords for every index in the dictionary, with and without a
+  // separator, against those built in a QVector<bool>.
+
+  void
+  checkCodeword()
+  {
+    for (quint32 index = 0; index < JSC::size; ++index)
+    {
+      for (auto const separate : {false, true})
+      {
+        auto const bits = toBits(JSC::codeword(index, separate, 4, 7, 9));
+
+        if (bits != Old::codeword(index, separate, 4, 7, 9)) fail("JSC::codeword", QString::number(index));
+      }
+    }
+  }
+
+  // Texts through JSC::compress(), a frame's worth of codewords at a
+  // time, and back through JSC::decompress(); each frame has to give
+  // back just the text its codewords cover.
+
+  void
+  checkCompress()
+  {
+    for (int t = 0; t < TEXTS; ++t)
+    {
+      auto const input = text();
+      QList<int> starts;
+      auto const codes = JSC::compress(input, &starts);
+
+      for (int i = 0; i < codes.size();)
+      {
+        BitBuffer<72> bits;
+        QString       expected;
+
+        for (; i < codes.size() && bits.size() + codes.at(i).first.size() < 72; ++i)
+        {
+          bits     += codes.at(i).first;
+          expected += input.mid(starts.at(i), codes.at(i).second);
+        }
+
+        if (bits.isEmpty())
+        {
+          fail("JSC::compress() codeword longer than a frame", input);
+          break;
+        }
+
+        if (JSC::decompress(bits) != expected) fail("JSC::decompress(JSC::compress())", input);
+      }
+    }
+  }
+
+  // Compression of texts, clean and noisy, against compression as it was
+  // with codewords in a QVector<bool>; and decompression of random bits.
+
+  void
+  checkCompressOld()
+  {
+    for (int t = 0; t < TEXTS; ++t)
+    {
+      auto const input = t % 2 ? noisy() : text();
+      auto const codes = JSC::compress(input);
+      auto const old   = Old::compress(input);
+      auto       same  = codes.size() == old.size();
+
+      for (int i = 0; same && i < codes.size(); ++i)
+      {
+        same = toBits(codes.at(i).first) == old.at(i).first &&
+               codes.at(i).second        == old.at(i).second;
+      }
+
+      if (!same) fail("JSC::compress", input);
+
+      BitBuffer<72> bits;
+
+      for (int i = uniform(0, 72); i > 0; --i) bits.append(static_cast<bool>(uniform(0, 1)));
+
+      if (JSC::decompress(bits) != Old::decompress(toBits(bits))) fail("JSC::decompress", toString(toBits(bits)));
+    }
+  }
+
+  // Huffman coding, against the encoder and decoder as they were before
+  // the table was compiled; encoding of strings of the table's keys and
+  // characters it doesn't have, decoding of random bits and of codes run
+  // together, and the trip back from the one to the other.
+
+  void
+  checkHuffman()
+  {
+    auto const table = Varicode::defaultHuffTable();
+    auto const keys  = table.keys();
+
+    if (Varicode::huffValidChars() != Old::huffValidChars(table)) fail("Varicode::huffValidChars", QString());
+
+    for (int t = 0; t < TEXTS; ++t)
+    {
+      QString input;
+
+      for (int i = uniform(1, 40); i > 0; --i)
+      {
+        input += uniform(0, 7) ? keys.at(uniform(0, keys.size() - 1))
+                               : QString(QLatin1Char(SUFFIXES[uniform(0, sizeof(SUFFIXES) - 2)])).toLower();
+      }
+
+      // Anything not in the table is skipped over, so each code has to
+      // start where the key it's the code for does.
+
+      QList<int> starts;
+      auto const codes = Varicode::huffEncode(input, &starts);
+      auto const old   = Old::huffEncode(table, input);
+      auto       same  = codes.size() == old.size() && starts.size() == codes.size();
+
+      for (int i = 0; same && i < codes.size(); ++i)
+      {
+        auto const key = input.mid(starts.at(i), codes.at(i).first);
+
+        same = codes.at(i).first                == old.at(i).first  &&
+               toBits(codes.at(i).second)       == old.at(i).second &&
+               Old::strToBits(table.value(key)) == old.at(i).second;
+      }
+
+      if (!same) fail("Varicode::huffEncode", input);
+
+      BitBuffer<72> bits;
+
+      for (int i = uniform(0, 72); i > 0; --i) bits.append(static_cast<bool>(uniform(0, 1)));
+
+      if (Varicode::huffDecode(bits) != Old::huffDecode(table, toBits(bits))) fail("Varicode::huffDecode", toString(toBits(bits)));
+
+      // A frame's worth of the codes, which has to decode to the keys
+      // they're for, unless there's an EOT among them, which ends the
+      // text early.
+
+      BitBuffer<72> run;
+      QString       expected;
+
+      for (int i = 0; i < codes.size() && run.size() + codes.at(i).second.size() <= 72; ++i)
+      {
+        run      += codes.at(i).second;
+        expected += input.mid(starts.at(i), codes.at(i).first);
+      }
+
+      auto const decoded = Varicode::huffDecode(run);
+
+      if (decoded != Old::huffDecode(table, toBits(run)))     fail("Varicode::huffDecode", toString(toBits(run)));
+      if (!expected.contains(Old::EOT) && decoded != expected) fail("Varicode::huffDecode(Varicode::huffEncode())", input);
+    }
+  }
+
+  // Texts packed a frame at a time, as buildMessageFrames() does, by
+  // Varicode::packDataMessage() or packFastDataMessage(), and by a
+  // DataFramePacker kept across texts that share a beginning, as they do
+  // while a message is typed, against the packing as it was; and frames
+  // of texts that should survive the trip back through unpacking.
+
+  void
+  checkPacking()
+  {
+    for (auto const submode : {Varicode::JS8CallNormal, Varicode::JS8CallFast})
+    {
+      auto const      normal = submode == Varicode::JS8CallNormal;
+      DataFramePacker packer(submode);
+      QString         input;
+
+      for (int t = 0; t < TEXTS; ++t)
+      {
+        auto const next = t % 2 ? noisy() : text();
+
+        input = uniform(0, 1) ? input.left(uniform(0, input.size())) + next : next;
+
+        packer.setText(input);
+
+        for (int offset = 0; offset < input.size();)
+        {
+          auto const tail = input.mid(offset);
+
+          int oldN    = 0;
+          int newN    = 0;
+          int packerN = 0;
+
+          auto const oldFrame    = normal ? Old::packDataMessage(tail, &oldN)      : Old::packFastDataMessage(tail, &oldN);
+          auto const newFrame    = normal ? Varicode::packDataMessage(tail, &newN) : Varicode::packFastDataMessage(tail, &newN);
+          auto const packerFrame = packer.pack(offset, &packerN);
+
+          if (newFrame    != oldFrame || newN    != oldN) fail(normal ? "Varicode::packDataMessage" : "Varicode::packFastDataMessage", tail);
+          if (packerFrame != oldFrame || packerN != oldN) fail("DataFramePacker::pack", tail);
+
+          if (oldN <= 0) break;
+
+          if (lossless(tail))
+          {
+            auto const unpacked = normal ? Varicode::unpackDataMessage(oldFrame) : Varicode::unpackFastDataMessage(oldFrame);
+
+            if (unpacked != tail.left(oldN)) fail(normal ? "Varicode::unpackDataMessage" : "Varicode::unpackFastDataMessage", tail);
+          }
+
+          offset += oldN;
+        }
+      }
+    }
+  }
+}
+
+/******************************************************************************/
+// Main
+/******************************************************************************/
+
+int
+main()
+{
+  if (words().isEmpty())
+  {
+    std::printf("FAIL no dictionary words to make texts of\n");
+    return 1;
+  }
+
+  checkBitBuffer();
+  checkLookup();
+  checkCodeword();
+  checkCompress();
+  checkCompressOld();
+  checkHuffman();
+  checkPacking();
+
+  std::printf("%d failures\n", failures);
+
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,334 @@
+#include "decodedtext.h"
+#include "varicode.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QStringView>
+
+// A period's worth of decoded frames, unpacked, and then searched for the
+// callsigns and grids in them, as MainWindow does with each, with the
+// expressions compiled on every call, as Varicode used to, and compiled
+// once, as it does now. Fails if the two disagree on what's in a frame;
+// the timings are only reported, since they depend on the machine.
+
+/******************************************************************************/
+// Constants
+/******************************************************************************/
+
+namespace
+{
+  // Frames decoded in a busy period, and the periods timed.
+
+  constexpr int FRAMES  = 50;
+  constexpr int PERIODS = 200;
+
+  // Fixed, so that any failure can be reproduced.
+
+  constexpr std::mt19937::result_type SEED = 20180715;
+
+  constexpr char const * CALLS[] = {"KN4CRD", "OH8STN", "K4RWR", "W1AW", "JY1", "VK2/G4ABC", "@GROUP42"};
+  constexpr char const * GRIDS[] = {"EM73", "KP25", "FM18", "FN31", "KM71", "QF56"};
+
+  // Texts sent, with the callsign they're sent to and the grid sent in
+  // them filled in; enough of each kind of frame that we decode.
+
+  constexpr char const * TEXTS[] = {"@HB HEARTBEAT %2",
+                                    "CQ CQ %2",
+                                    "%1 SNR?",
+                                    "%1 GRID %2",
+                                    "%1 HEARING?",
+                                    "%1: HELLO BRAVE NEW WORLD",
+                                    "%1 MSG THE QUICK BROWN FOX, GRID %2, 73",
+                                    "TNX FOR THE QSO %1 FROM %2, 73"};
+}
+
+/******************************************************************************/
+// Previous Implementation
+/******************************************************************************/
+
+// The callsign and grid patterns, and the table of base callsigns, are
+// those Varicode uses; only how the expressions are made differs.
+
+extern QString                grid_pattern;
+extern QString                base_callsign_pattern;
+extern QString                compound_callsign_pattern;
+extern QMap<QString, quint32> basecalls;
+
+namespace Old
+{
+  bool isValidCallsign(const QString &callsign, bool *pIsCompound);
+
+  QStringList parseCallsigns(QString const &input){
+      QStringList callsigns;
+      QRegularExpression re(compound_callsign_pattern);
+      QRegularExpressionMatchIterator iter = re.globalMatch(input);
+      while(iter.hasNext()){
+          QRegularExpressionMatch match = iter.next();
+          if(!match.hasMatch()){
+              continue;
+          }
+          QString callsign = match.captured("callsign").trimmed();
+          if(!Old::isValidCallsign(callsign, nullptr)){
+              continue;
+          }
+          QRegularExpression m(grid_pattern);
+          if(m.match(callsign).hasMatch()){
+              continue;
+          }
+          callsigns.append(callsign);
+      }
+      return callsigns;
+  }
+
+  QStringList parseGrids(const QString &input){
+      QStringList grids;
+      QRegularExpression re(grid_pattern);
+      QRegularExpressionMatchIterator iter = re.globalMatch(input);
+      while(iter.hasNext()){
+          QRegularExpressionMatch match = iter.next();
+          if(!match.hasMatch()){
+              continue;
+          }
+          auto grid = match.captured("grid");
+          if(grid == "RR73"){
+              continue;
+          }
+          grids.append(grid);
+      }
+      return grids;
+  }
+
+  bool isValidCompoundCallsign(QStringView callsign){
+      // compound calls cannot be > 9 characters after removing the /
+      if (callsign.length() - callsign.count('/') > 9) {
+          return false;
+      }
+
+      if (const auto index = callsign.indexOf('/'); index != -1) {
+          return !basecalls.contains(callsign.first(index).toString());
+      }
+
+      if (callsign.startsWith('@')){
+          return true;
+      }
+
+      if (callsign.length() > 2 && QRegularExpression("[0-9][A-Z]|[A-Z][0-9]")
+#if (QT_VERSION < QT_VERSION_CHECK(6, 5, 0))
+      .match(callsign)
+#else
+      .matchView(callsign)
+#endif
+      .hasMatch())
+      {
+          return true;
+      }
+
+      return false;
+  }
+
+  bool isValidCallsign(const QString &callsign, bool *pIsCompound){
+      if(basecalls.contains(callsign)){
+          if(pIsCompound) *pIsCompound = false;
+          return true;
+      }
+
+      auto match = QRegularExpression(base_callsign_pattern).match(callsign);
+      if(match.hasMatch() && (match.capturedLength() == callsign.length())){
+          if(pIsCompound) *pIsCompound = false;
+          return callsign.length() > 2 && QRegularExpression("[0-9][A-Z]|[A-Z][0-9]").match(callsign).hasMatch();
+      }
+
+      match = QRegularExpression("^" + compound_callsign_pattern).match(callsign);
+
+      if(match.hasMatch() && (match.capturedLength() == callsign.length())){
+          bool isValid = isValidCompoundCallsign(match.capturedView(0));
+
+          if(pIsCompound) *pIsCompound = isValid;
+          return isValid;
+      }
+
+      if(pIsCompound) *pIsCompound = false;
+      return false;
+  }
+
+  // Less its debug logging.
+
+  bool isCompoundCallsign(const QString &callsign){
+      if(basecalls.contains(callsign) && !callsign.startsWith("@")){
+          return false;
+      }
+
+      auto match = QRegularExpression(base_callsign_pattern).match(callsign);
+      if(match.hasMatch() && (match.capturedLength() == callsign.length())){
+          return false;
+      }
+
+      match = QRegularExpression("^" + compound_callsign_pattern).match(callsign);
+      if(!match.hasMatch() || (match.capturedLength() != callsign.length())){
+          return false;
+      }
+
+      return isValidCompoundCallsign(match.capturedView(0));
+  }
+}
+
+/******************************************************************************/
+// Local Routines
+/******************************************************************************/
+
+namespace
+{
+  std::mt19937 rng(SEED);
+
+  int
+  uniform(int const lo,
+          int const hi)
+  {
+    return std::uniform_int_distribution<int>(lo, hi)(rng);
+  }
+
+  template <typename T, std::size_t N>
+  T
+  pick(T const (& array)[N])
+  {
+    return array[uniform(0, N - 1)];
+  }
+
+  struct Frame
+  {
+    QString frame;
+    int     bits;
+  };
+
+  // What we find in a frame; its text, the callsigns and grids in it,
+  // and which of those callsigns are compound.
+
+  struct Found
+  {
+    QString     text;
+    QStringList calls;
+    QStringList grids;
+    QStringList compound;
+
+    bool operator==(Found const &) const = default;
+  };
+
+  // A period's worth of frames, from stations sending the texts above;
+  // multi-frame messages contribute each of their frames.
+
+  QList<Frame>
+  period(int const submode)
+  {
+    QList<Frame> frames;
+
+    while (frames.size() < FRAMES)
+    {
+      auto const from = QString(pick(CALLS)).remove('@');
+      auto const text = QString(pick(TEXTS)).replace("%1", pick(CALLS)).replace("%2", pick(GRIDS));
+
+      for (auto const & [frame, bits] : Varicode::buildMessageFrames(from, pick(GRIDS), "", text, false, false, submode))
+      {
+        frames.append(Frame{frame, bits});
+      }
+    }
+
+    return frames.mid(0, FRAMES);
+  }
+
+  // Unpack each of the frames provided, and find what's in it, using the
+  // parsers provided.
+
+  template <typename Calls, typename Grids, typename IsCompound>
+  QList<Found>
+  decode(QList<Frame> const & frames,
+         int          const   submode,
+         Calls                calls,
+         Grids                grids,
+         IsCompound           isCompound)
+  {
+    QList<Found> found;
+
+    for (auto const & [frame, bits] : frames)
+    {
+      DecodedText const decoded(frame, bits, submode);
+      auto        const text = decoded.message();
+      Found             f    = {text, calls(text), grids(text), {}};
+
+      for (auto const & call : f.calls)
+      {
+        if (isCompound(call)) f.compound.append(call);
+      }
+
+      found.append(f);
+    }
+
+    return found;
+  }
+
+  // Microseconds taken by the function provided.
+
+  template <typename Function>
+  double
+  elapsed(Function function)
+  {
+    auto const start = std::chrono::steady_clock::now();
+
+    function();
+
+    std::chrono::duration<double, std::micro> const taken = std::chrono::steady_clock::now() - start;
+
+    return taken.count();
+  }
+}
+
+/******************************************************************************/
+// Main
+/******************************************************************************/
+
+int
+main()
+{
+  bool failed = false;
+
+  std::printf("%-8s %7s %14s %14s %9s\n", "submode", "frames", "before us", "after us", "speedup");
+
+  for (auto const submode : {Varicode::JS8CallNormal, Varicode::JS8CallFast})
+  {
+    auto const frames = period(submode);
+
+    QList<Found> before;
+    QList<Found> after;
+
+    auto const timeOld = elapsed([&]
+    {
+      for (int i = 0; i < PERIODS; ++i) before = decode(frames, submode, Old::parseCallsigns, Old::parseGrids, Old::isCompoundCallsign);
+    }) / PERIODS;
+
+    auto const timeNew = elapsed([&]
+    {
+      for (int i = 0; i < PERIODS; ++i) after = decode(frames, submode, Varicode::parseCallsigns, Varicode::parseGrids, Varicode::isCompoundCallsign);
+    }) / PERIODS;
+
+    for (int i = 0; i < frames.size(); ++i)
+    {
+      if (before.at(i) != after.at(i))
+      {
+        std::printf("FAIL frame \"%s\" decoded differently\n", qPrintable(frames.at(i).frame));
+        failed = true;
+      }
+    }
+
+    std::printf("%-8s %7lld %14.0f %14.0f %8.1fx\n",
+                submode == Varicode::JS8CallNormal ? "normal" : "fast",
+                static_cast<long long>(frames.size()),
+                timeOld, timeNew, timeOld / timeNew);
+  }
+
+  return failed ? 1 : 0;
+}
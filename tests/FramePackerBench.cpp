@@ -0,0 +1,245 @@
+#include "jsc.h"
+#include "varicode.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <QString>
+#include <QStringList>
+
+// Packing of long messages into data frames, one frame at a time, as
+// buildMessageFrames used to, encoding all of what's left of the text
+// for each frame, and with a DataFramePacker, which encodes it once;
+// then both again as the text is edited, the way the operator edits a
+// message before sending it. Fails if the two produce different frames;
+// the timings are only reported, since they depend on the machine.
+
+/******************************************************************************/
+// Constants
+/******************************************************************************/
+
+namespace
+{
+  // Message sizes, in characters, and the edits made to each; an edit
+  // drops a few words from the end, or adds a few, and then the whole
+  // message is packed again.
+
+  constexpr int SIZES[] = {1000, 2000, 5000, 10000};
+  constexpr int EDITS   = 5;
+
+  // Fixed, so that any failure can be reproduced.
+
+  constexpr std::mt19937::result_type SEED = 20180715;
+}
+
+/******************************************************************************/
+// Local Routines
+/******************************************************************************/
+
+namespace
+{
+  std::mt19937 rng(SEED);
+
+  int
+  uniform(int const lo,
+          int const hi)
+  {
+    return std::uniform_int_distribution<int>(lo, hi)(rng);
+  }
+
+  // Words of the dictionary that look up, whole, to themselves, and that
+  // are upper case, as the Huffman table is; a message made of them is
+  // what the compressor is built for.
+
+  QStringList const &
+  words()
+  {
+    static QStringList const words = []
+    {
+      QStringList words;
+
+      for (quint32 i = 0; i < JSC::size; ++i)
+      {
+        if (!JSC::map[i].str) continue;
+
+        auto const word  = QString::fromLatin1(JSC::map[i].str);
+        bool       ok    = false;
+        auto const index = JSC::lookup(word, &ok);
+
+        if (ok                     &&
+            !word.isEmpty()        &&
+            !word.contains(' ')    &&
+            word == word.toUpper() &&
+            word == QString::fromLatin1(JSC::map[index].str)) words.append(word);
+      }
+
+      return words;
+    }();
+
+    return words;
+  }
+
+  // Append words to the text provided until it's at least size long.
+
+  QString
+  grow(QString    text,
+       int const  size)
+  {
+    while (text.size() < size)
+    {
+      if (!text.isEmpty()) text += ' ';
+      text += words().at(uniform(0, words().size() - 1));
+    }
+
+    return text;
+  }
+
+  // An edit of the text provided; a few words dropped from the end, or a
+  // few added to it.
+
+  QString
+  edit(QString const & text)
+  {
+    if (uniform(0, 1))
+    {
+      auto const words = text.split(' ');
+      return words.mid(0, words.size() - uniform(1, 4)).join(' ');
+    }
+
+    return grow(text, text.size() + uniform(5, 30));
+  }
+
+  // Frames for the text provided, packed one at a time from whatever's
+  // left of it, as buildMessageFrames used to.
+
+  QStringList
+  perFrame(QString const & text,
+           int     const   submode)
+  {
+    QStringList frames;
+
+    for (int offset = 0; offset < text.size();)
+    {
+      int        n     = 0;
+      auto const tail  = text.mid(offset);
+      auto const frame = submode == Varicode::JS8CallNormal ? Varicode::packDataMessage(tail, &n)
+                                                            : Varicode::packFastDataMessage(tail, &n);
+      if (n <= 0) break;
+
+      frames.append(frame);
+      offset += n;
+    }
+
+    return frames;
+  }
+
+  // Frames for the text provided, packed by the packer provided.
+
+  QStringList
+  packed(DataFramePacker & packer,
+         QString   const & text)
+  {
+    QStringList frames;
+
+    packer.setText(text);
+
+    for (int offset = 0; offset < text.size();)
+    {
+      int        n     = 0;
+      auto const frame = packer.pack(offset, &n);
+
+      if (n <= 0) break;
+
+      frames.append(frame);
+      offset += n;
+    }
+
+    return frames;
+  }
+
+  // Milliseconds taken by the function provided.
+
+  template <typename Function>
+  double
+  elapsed(Function function)
+  {
+    auto const start = std::chrono::steady_clock::now();
+
+    function();
+
+    std::chrono::duration<double, std::milli> const taken = std::chrono::steady_clock::now() - start;
+
+    return taken.count();
+  }
+}
+
+/******************************************************************************/
+// Main
+/******************************************************************************/
+
+int
+main()
+{
+  if (words().isEmpty())
+  {
+    std::printf("FAIL no dictionary words to make messages of\n");
+    return 1;
+  }
+
+  bool failed = false;
+
+  std::printf("%-8s %6s %7s %12s %12s %9s %12s %12s %9s\n",
+              "submode", "chars", "frames",
+              "frame ms", "packer ms", "speedup",
+              "edit ms", "packer ms", "speedup");
+
+  for (auto const submode : {Varicode::JS8CallNormal, Varicode::JS8CallFast})
+  {
+    for (auto const size : SIZES)
+    {
+      auto const text = grow({}, size);
+
+      // The whole message, packed once, each way.
+
+      QStringList     oldFrames;
+      QStringList     newFrames;
+      DataFramePacker packer(submode);
+
+      auto const packOld = elapsed([&]{ oldFrames = perFrame(text, submode); });
+      auto const packNew = elapsed([&]{ newFrames = packed(packer, text);    });
+
+      if (oldFrames != newFrames)
+      {
+        std::printf("FAIL %d character message packed differently\n", size);
+        failed = true;
+      }
+
+      // Then edited, and packed again after each edit; the packer keeps
+      // what it encoded of the text before.
+
+      QStringList edits;
+      auto        edited = text;
+
+      for (int i = 0; i < EDITS; ++i) edits.append(edited = edit(edited));
+
+      QList<QStringList> oldEdits;
+      QList<QStringList> newEdits;
+
+      auto const editOld = elapsed([&]{ for (auto const & e : edits) oldEdits.append(perFrame(e, submode)); }) / EDITS;
+      auto const editNew = elapsed([&]{ for (auto const & e : edits) newEdits.append(packed(packer, e));    }) / EDITS;
+
+      if (oldEdits != newEdits)
+      {
+        std::printf("FAIL edits of %d character message packed differently\n", size);
+        failed = true;
+      }
+
+      std::printf("%-8s %6d %7lld %12.1f %12.1f %8.1fx %12.1f %12.1f %8.1fx\n",
+                  submode == Varicode::JS8CallNormal ? "normal" : "fast",
+                  size, static_cast<long long>(oldFrames.size()),
+                  packOld, packNew, packOld / packNew,
+                  editOld, editNew, editOld / editNew);
+    }
+  }
+
+  return failed ? 1 : 0;
+}
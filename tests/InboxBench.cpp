@@ -0,0 +1,345 @@
+#include "Inbox.h"
+#include "Message.hpp"
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QVariantMap>
+
+// Inbox counts and per-callsign lookups at MESSAGES stored messages, as
+// MainWindow used to make them, opening the database afresh for each,
+// and querying through json_extract(), against a long-lived Inbox with
+// cached statements and typed columns. Fails if the two disagree on any
+// answer; the timings are only reported, since they depend on the
+// machine, and on the disk.
+
+/******************************************************************************/
+// Constants
+/******************************************************************************/
+
+namespace
+{
+  constexpr int MESSAGES  = 100000;
+  constexpr int CALLSIGNS = 2000;
+  constexpr int QUERIES   = 200;
+
+  // Fixed, so that any failure can be reproduced.
+
+  constexpr std::mt19937::result_type SEED = 20180626;
+
+  // The types a message is stored as, in the proportions we'd expect,
+  // more or less, of a busy station.
+
+  constexpr char const * TYPES[] = {"READ", "READ", "READ", "UNREAD", "STORE"};
+}
+
+/******************************************************************************/
+// Previous Implementation
+/******************************************************************************/
+
+namespace Old
+{
+  // The schema, with its json_extract() expression indexes, and the two
+  // queries, as they were before the typed columns; each query opened
+  // its own connection, and ran the schema, as a fresh Inbox did.
+
+  constexpr char SCHEMA[] = "CREATE TABLE IF NOT EXISTS inbox_v1 ("
+                            "  id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                            "  blob TEXT"
+                            ");"
+                            "CREATE INDEX IF NOT EXISTS idx_inbox_v1__type ON"
+                            "  inbox_v1(json_extract(blob, '$.type'));"
+                            "CREATE INDEX IF NOT EXISTS idx_inbox_v1__params_from ON"
+                            "  inbox_v1(json_extract(blob, '$.params.FROM'));"
+                            "CREATE INDEX IF NOT EXISTS idx_inbox_v1__params_to ON"
+                            "  inbox_v1(json_extract(blob, '$.params.TO'));"
+                            "CREATE TABLE IF NOT EXISTS inbox_group_recip_v1 ("
+                            "  id INTEGER PRIMARY KEY AUTOINCREMENT, "
+                            "  msg_id INTEGER, "
+                            "  callsign VARCHAR(255), "
+                            "  FOREIGN KEY(msg_id) REFERENCES inbox_v1(id) ON DELETE CASCADE"
+                            ");"
+                            "CREATE INDEX IF NOT EXISTS idx_inbox_group_recip_v1__callsign ON"
+                            "  inbox_group_recip_v1(callsign);";
+
+  sqlite3 *
+  open(QString const & path)
+  {
+    sqlite3 * db = nullptr;
+
+    if (sqlite3_open(path.toLocal8Bit().data(), &db) != SQLITE_OK ||
+        sqlite3_exec(db, SCHEMA, nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+      sqlite3_close(db);
+      return nullptr;
+    }
+
+    return db;
+  }
+
+  int
+  count(QString const & path,
+        QString const & type,
+        QString const & query,
+        QString const & match)
+  {
+    auto const db = open(path);
+
+    if (!db) return -1;
+
+    const char* sql = "SELECT COUNT(*) FROM inbox_v1 "
+                      "WHERE json_extract(blob, '$.type') = ? "
+                      "AND json_extract(blob, ?) LIKE ?;";
+
+    sqlite3_stmt *stmt;
+    int count = -1;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK)
+    {
+      auto t8 = type.toLocal8Bit();
+      auto q8 = query.toLocal8Bit();
+      auto m8 = match.toLocal8Bit();
+      sqlite3_bind_text(stmt, 1, t8.data(), -1, nullptr);
+      sqlite3_bind_text(stmt, 2, q8.data(), -1, nullptr);
+      sqlite3_bind_text(stmt, 3, m8.data(), -1, nullptr);
+
+      if (sqlite3_step(stmt) == SQLITE_ROW) count = sqlite3_column_int(stmt, 0);
+
+      sqlite3_finalize(stmt);
+    }
+
+    sqlite3_close(db);
+    return count;
+  }
+
+  QList<int>
+  values(QString const & path,
+         QString const & type,
+         QString const & query,
+         QString const & match,
+         int     const   offset,
+         int     const   limit)
+  {
+    auto const db = open(path);
+
+    if (!db) return {};
+
+    const char* sql = "SELECT id, blob FROM inbox_v1 "
+                      "WHERE json_extract(blob, '$.type') = ? "
+                      "AND json_extract(blob, ?) LIKE ? "
+                      "ORDER BY id ASC "
+                      "LIMIT ? OFFSET ?;";
+
+    sqlite3_stmt *stmt;
+    QList<int>    v;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) == SQLITE_OK)
+    {
+      auto t8 = type.toLocal8Bit();
+      auto q8 = query.toLocal8Bit();
+      auto m8 = match.toLocal8Bit();
+      sqlite3_bind_text(stmt, 1, t8.data(), -1, nullptr);
+      sqlite3_bind_text(stmt, 2, q8.data(), -1, nullptr);
+      sqlite3_bind_text(stmt, 3, m8.data(), -1, nullptr);
+      sqlite3_bind_int(stmt, 4, limit);
+      sqlite3_bind_int(stmt, 5, offset);
+
+      // The blob was deserialized for every row, so we do the same.
+
+      while (sqlite3_step(stmt) == SQLITE_ROW)
+      {
+        try
+        {
+          Message::fromJson(QByteArray((const char *)sqlite3_column_text (stmt, 1),
+                                                     sqlite3_column_bytes(stmt, 1)));
+          v.append(sqlite3_column_int(stmt, 0));
+        }
+        catch (...)
+        {
+          continue;
+        }
+      }
+
+      sqlite3_finalize(stmt);
+    }
+
+    sqlite3_close(db);
+    return v;
+  }
+}
+
+/******************************************************************************/
+// Local Routines
+/******************************************************************************/
+
+namespace
+{
+  std::mt19937 rng(SEED);
+
+  int
+  uniform(int const lo,
+          int const hi)
+  {
+    return std::uniform_int_distribution<int>(lo, hi)(rng);
+  }
+
+  QString
+  callsign(int const i)
+  {
+    return QString("K%1%2").arg(i % 10).arg(QString::number(i, 36).toUpper());
+  }
+
+  // Microseconds per call of the function provided, over the callsigns
+  // provided.
+
+  template <typename Function>
+  double
+  perCall(QStringList const & calls,
+          Function            function)
+  {
+    auto const start = std::chrono::steady_clock::now();
+
+    for (auto const & call : calls) function(call);
+
+    std::chrono::duration<double, std::micro> const elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / calls.size();
+  }
+}
+
+/******************************************************************************/
+// Main
+/******************************************************************************/
+
+int
+main(int    argc,
+     char * argv[])
+{
+  QCoreApplication app(argc, argv);
+  QTemporaryDir    dir;
+
+  if (!dir.isValid())
+  {
+    std::printf("FAIL unable to create a temporary directory\n");
+    return 1;
+  }
+
+  auto const oldPath = dir.filePath("old.db3");
+  auto const newPath = dir.filePath("new.db3");
+
+  // Store the same messages in both, the old way in the one, and through
+  // the Inbox in the other.
+
+  Inbox inbox(newPath);
+  auto  old = Old::open(oldPath);
+
+  if (!inbox.open() || !old)
+  {
+    std::printf("FAIL unable to open the inboxes: %s\n", qPrintable(inbox.error()));
+    return 1;
+  }
+
+  sqlite3_stmt * insert = nullptr;
+
+  sqlite3_prepare_v2(old, "INSERT INTO inbox_v1 (blob) VALUES (?);", -1, &insert, nullptr);
+  sqlite3_exec(old, "BEGIN;", nullptr, nullptr, nullptr);
+  inbox.begin();
+
+  for (int i = 0; i < MESSAGES; ++i)
+  {
+    QVariantMap params;
+
+    params["FROM"] = callsign(uniform(0, CALLSIGNS - 1));
+    params["TO"]   = callsign(uniform(0, CALLSIGNS - 1));
+    params["UTC"]  = QString("2024-01-01 00:00:%1").arg(i % 60, 2, 10, QChar('0'));
+    params["TEXT"] = QString("MESSAGE NUMBER %1").arg(i);
+
+    Message const message(TYPES[uniform(0, std::size(TYPES) - 1)], "", params);
+    auto    const json = message.toJson();
+
+    sqlite3_bind_text(insert, 1, json.constData(), json.size(), SQLITE_TRANSIENT);
+    sqlite3_step(insert);
+    sqlite3_reset(insert);
+
+    inbox.append(message);
+  }
+
+  inbox.commit();
+  sqlite3_exec(old, "COMMIT;", nullptr, nullptr, nullptr);
+  sqlite3_finalize(insert);
+  sqlite3_close(old);
+
+  QStringList calls;
+
+  for (int i = 0; i < QUERIES; ++i) calls.append(callsign(uniform(0, CALLSIGNS - 1)));
+
+  // What refreshInboxCounts() asks for each callsign; then, the unread
+  // messages from it, as when the operator selects it.
+
+  bool failed = false;
+
+  auto const countsOld = perCall(calls, [&](QString const & call)
+  {
+    Old::count(oldPath, "STORE",  "$.params.TO",   call);
+    Old::count(oldPath, "UNREAD", "$.params.FROM", call);
+    Old::count(oldPath, "READ",   "$.params.FROM", call);
+  });
+
+  auto const countsNew = perCall(calls, [&](QString const & call)
+  {
+    inbox.count("STORE",  "$.params.TO",   call);
+    inbox.count("UNREAD", "$.params.FROM", call);
+    inbox.count("READ",   "$.params.FROM", call);
+  });
+
+  auto const valuesOld = perCall(calls, [&](QString const & call)
+  {
+    Old::values(oldPath, "UNREAD", "$.params.FROM", call, 0, 1000);
+  });
+
+  auto const valuesNew = perCall(calls, [&](QString const & call)
+  {
+    inbox.values("UNREAD", "$.params.FROM", call, 0, 1000);
+  });
+
+  // Both have to give the same answers; ids match, since both were
+  // filled in the same order.
+
+  for (auto const & call : calls)
+  {
+    for (auto const & [type, query] : {QPair<QString, QString>{"STORE",  "$.params.TO"},
+                                       QPair<QString, QString>{"UNREAD", "$.params.FROM"},
+                                       QPair<QString, QString>{"READ",   "$.params.FROM"}})
+    {
+      if (Old::count(oldPath, type, query, call) != inbox.count(type, query, call))
+      {
+        std::printf("FAIL count of %s %s %s\n", qPrintable(type), qPrintable(query), qPrintable(call));
+        failed = true;
+      }
+    }
+
+    QList<int> ids;
+
+    for (auto const & [id, message] : inbox.values("UNREAD", "$.params.FROM", call, 0, 1000)) ids.append(id);
+
+    if (ids != Old::values(oldPath, "UNREAD", "$.params.FROM", call, 0, 1000))
+    {
+      std::printf("FAIL unread messages from %s\n", qPrintable(call));
+      failed = true;
+    }
+  }
+
+  std::printf("%d messages, %d callsigns\n", MESSAGES, CALLSIGNS);
+  std::printf("%-10s %12s %12s %10s\n", "query", "before us", "after us", "speedup");
+  std::printf("%-10s %12.0f %12.0f %9.1fx\n", "counts",  countsOld, countsNew, countsOld / countsNew);
+  std::printf("%-10s %12.0f %12.0f %9.1fx\n", "unread",  valuesOld, valuesNew, valuesOld / valuesNew);
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,223 @@
+#include "Message.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QList>
+#include <QString>
+#include <QVariantList>
+#include <QVariantMap>
+
+// Encoding and decoding cost, and bytes on the wire, of the API messages
+// we send most of, RX.ACTIVITY, and the largest, INBOX.MESSAGES, as JSON
+// and as CBOR. Fails if a message doesn't survive the round trip through
+// either encoding, or if the two disagree on what it decodes to; the
+// timings and sizes are only reported, since the timings depend on the
+// machine, and the sizes on the messages.
+
+/******************************************************************************/
+// Constants
+/******************************************************************************/
+
+namespace
+{
+  // Activity messages, and inbox replies, encoded and decoded for each
+  // timing, and the number of messages in each inbox reply; the service
+  // hands back at most 1000 of each type, but a few dozen is typical.
+
+  constexpr int ACTIVITY = 20000;
+  constexpr int REPLIES  = 200;
+  constexpr int MESSAGES = 50;
+
+  // Bytes each frame adds to the message; JSON is newline-delimited, and
+  // CBOR is prefixed with a 32-bit length.
+
+  constexpr int JSON_FRAMING = 1;
+  constexpr int CBOR_FRAMING = 4;
+
+  // Fixed, so that any failure can be reproduced.
+
+  constexpr std::mt19937::result_type SEED = 20180626;
+
+  constexpr char const * TYPES[] = {"READ", "UNREAD", "STORE"};
+  constexpr char const * CALLS[] = {"KN4CRD", "OH8STN", "K4RWR", "W1AW", "JY1", "VK2/G4ABC"};
+  constexpr char const * TEXTS[] = {"@ALLCALL CQ CQ EM73",
+                                    "@HB HEARTBEAT EM73",
+                                    "SNR -12",
+                                    "HELLO BRAVE NEW WORLD",
+                                    "MSG TO: W1AW THIS IS A TEST OF THE INBOX"};
+}
+
+/******************************************************************************/
+// Local Routines
+/******************************************************************************/
+
+namespace
+{
+  std::mt19937 rng(SEED);
+
+  int
+  uniform(int const lo,
+          int const hi)
+  {
+    return std::uniform_int_distribution<int>(lo, hi)(rng);
+  }
+
+  template <typename T, std::size_t N>
+  T
+  pick(T const (& array)[N])
+  {
+    return array[uniform(0, N - 1)];
+  }
+
+  // An activity message, as processRxActivity() sends for each frame.
+
+  Message
+  activity()
+  {
+    auto const dial   = 14078000;
+    auto const offset = uniform(500, 2500);
+
+    return Message("RX.ACTIVITY",
+                   QString("%1: %2 ").arg(pick(CALLS), pick(TEXTS)),
+                   {
+                     {"_ID",    QVariant(-1)},
+                     {"FREQ",   QVariant(dial + offset)},
+                     {"DIAL",   QVariant(dial)},
+                     {"OFFSET", QVariant(offset)},
+                     {"SNR",    QVariant(uniform(-24, 10))},
+                     {"SPEED",  QVariant(uniform(0, 4))},
+                     {"TDRIFT", QVariant(uniform(-500, 500) / 1000.0f)},
+                     {"UTC",    QVariant(QDateTime::currentMSecsSinceEpoch() - uniform(0, 3600000))}
+                   });
+  }
+
+  // An inbox reply, as the INBOX.GET_MESSAGES handler sends, with the
+  // stored messages it found, each as the variant map of its Message.
+
+  Message
+  inbox()
+  {
+    QVariantList messages;
+
+    for (int i = 0; i < MESSAGES; ++i)
+    {
+      Message const message(pick(TYPES), "",
+                            {
+                              {"UTC",     QVariant(QString("2024-01-01 00:%1:%2").arg(uniform(0, 59), 2, 10, QChar('0'))
+                                                                                  .arg(uniform(0, 59), 2, 10, QChar('0')))},
+                              {"TO",      QVariant(pick(CALLS))},
+                              {"FROM",    QVariant(pick(CALLS))},
+                              {"PATH",    QVariant(pick(CALLS))},
+                              {"TDRIFT",  QVariant(uniform(-500, 500) / 1000.0f)},
+                              {"FREQ",    QVariant(14078000 + uniform(500, 2500))},
+                              {"DIAL",    QVariant(14078000)},
+                              {"OFFSET",  QVariant(uniform(500, 2500))},
+                              {"CMD",     QVariant(" MSG ")},
+                              {"SNR",     QVariant(uniform(-24, 10))},
+                              {"SUBMODE", QVariant(uniform(0, 4))},
+                              {"TEXT",    QVariant(pick(TEXTS))}
+                            });
+
+      messages << message.toVariantMap();
+    }
+
+    return Message("INBOX.MESSAGES", "",
+                   {
+                     {"_ID",      QVariant(uniform(1, 1 << 30))},
+                     {"MESSAGES", messages}
+                   });
+  }
+
+  // Microseconds per message to apply the function provided to each of
+  // the messages provided.
+
+  template <typename T, typename Function>
+  double
+  perMessage(QList<T> const & messages,
+             Function         function)
+  {
+    auto const start = std::chrono::steady_clock::now();
+
+    for (auto const & message : messages) function(message);
+
+    std::chrono::duration<double, std::micro> const elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / messages.size();
+  }
+
+  // Round trip the messages provided through both encodings, checking
+  // that neither loses anything, and reporting what each costs.
+
+  bool
+  bench(char            const * const name,
+        QList<Message>  const &       messages)
+  {
+    bool failed = false;
+
+    QList<QByteArray> json;
+    QList<QByteArray> cbor;
+
+    auto const jsonEncode = perMessage(messages, [&](Message const & message){ json << message.toJson(); });
+    auto const cborEncode = perMessage(messages, [&](Message const & message){ cbor << message.toCbor(); });
+    auto const jsonDecode = perMessage(json,     [ ](QByteArray const & bytes){ Message::fromJson(bytes); });
+    auto const cborDecode = perMessage(cbor,     [ ](QByteArray const & bytes){ Message::fromCbor(bytes); });
+
+    double jsonBytes = 0;
+    double cborBytes = 0;
+
+    // What each decodes to has to match what we started with; we compare
+    // them as JSON, which is what a client would have seen before.
+
+    for (int i = 0; i < messages.size(); ++i)
+    {
+      auto const expected = messages.at(i).toJson();
+
+      if (Message::fromJson(json.at(i)).toJson() != expected ||
+          Message::fromCbor(cbor.at(i)).toJson() != expected)
+      {
+        std::printf("FAIL %s message %d doesn't survive the round trip\n", name, i);
+        failed = true;
+      }
+
+      jsonBytes += json.at(i).size() + JSON_FRAMING;
+      cborBytes += cbor.at(i).size() + CBOR_FRAMING;
+    }
+
+    jsonBytes /= messages.size();
+    cborBytes /= messages.size();
+
+    std::printf("%-15s %-6s %10.2f %10.2f %10.0f\n", name, "JSON", jsonEncode, jsonDecode, jsonBytes);
+    std::printf("%-15s %-6s %10.2f %10.2f %10.0f %8.0f%%\n", name, "CBOR", cborEncode, cborDecode, cborBytes, 100.0 * cborBytes / jsonBytes);
+
+    return !failed;
+  }
+}
+
+/******************************************************************************/
+// Main
+/******************************************************************************/
+
+int
+main(int    argc,
+     char * argv[])
+{
+  QCoreApplication app(argc, argv);
+
+  QList<Message> activities;
+  QList<Message> replies;
+
+  for (int i = 0; i < ACTIVITY; ++i) activities << activity();
+  for (int i = 0; i < REPLIES;  ++i) replies    << inbox();
+
+  std::printf("%-15s %-6s %10s %10s %10s %9s\n", "message", "as", "encode us", "decode us", "bytes", "of JSON");
+
+  bool failed = false;
+
+  failed |= !bench("RX.ACTIVITY",    activities);
+  failed |= !bench("INBOX.MESSAGES", replies);
+
+  return failed ? 1 : 0;
+}
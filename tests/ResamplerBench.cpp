@@ -0,0 +1,235 @@
+#include "Resampler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <numbers>
+#include <vector>
+
+// Passband ripple, stopband attenuation, and throughput of the Resampler,
+// at each of the rates a sound card is likely to offer us. Fails if the
+// ripple or attenuation is out of spec at any of them; throughput is only
+// reported, since it depends on the machine, and on the build.
+
+/******************************************************************************/
+// Constants
+/******************************************************************************/
+
+namespace
+{
+  constexpr int RATES[] =
+  {
+     12000,  16000,  22050,  24000,  32000,  44100,  48000,
+     88200,  96000, 176400, 192000, 352800, 384000
+  };
+
+  // Edges of the passband and stopband, as the filter is designed to;
+  // most ripple allowed in the passband, and least attenuation in the
+  // stopband, in dB. The filter's designed for 60dB; we allow for the
+  // rounding of the output to 16 bits, and for the transition band's
+  // edge.
+
+  constexpr double PASSBAND_HZ    = 4500.0;
+  constexpr double STOPBAND_HZ    = 6000.0;
+  constexpr double MAX_RIPPLE_DB  = 0.1;
+  constexpr double MIN_ATTEN_DB   = 55.0;
+
+  // Tones are at half of full scale, a second long, and measured after
+  // the first tenth of a second, once the filter's full.
+
+  constexpr double AMPLITUDE      = 16384.0;
+  constexpr double TONE_SECONDS   = 1.0;
+  constexpr double SETTLE_SECONDS = 0.1;
+
+  // Audio resampled to measure throughput, in seconds.
+
+  constexpr double BENCH_SECONDS  = 60.0;
+}
+
+/******************************************************************************/
+// Local Routines
+/******************************************************************************/
+
+namespace
+{
+  // Resample the input provided, as the Detector does, a chunk at a time.
+
+  std::vector<short>
+  resample(Resampler                & resampler,
+           std::vector<short> const & input)
+  {
+    std::vector<short> output;
+
+    output.reserve(input.size() * Resampler::OUTPUT_RATE / resampler.inputRate() + 1);
+
+    for (std::size_t done = 0; done < input.size(); done += Resampler::CHUNK)
+    {
+      resampler.process(input.data() + done,
+                        std::min(Resampler::CHUNK, input.size() - done),
+                        [&output](short const sample) { output.push_back(sample); });
+    }
+
+    return output;
+  }
+
+  std::vector<short>
+  tone(int    const rate,
+       double const frequency,
+       double const seconds)
+  {
+    std::vector<short> samples(static_cast<std::size_t>(rate * seconds));
+
+    for (std::size_t i = 0; i < samples.size(); ++i)
+    {
+      samples[i] = static_cast<short>(std::lround(AMPLITUDE * std::sin(2 * std::numbers::pi * frequency * i / rate)));
+    }
+
+    return samples;
+  }
+
+  // Amplitude of a tone at the frequency provided in the output, by least
+  // squares fit of a sine and cosine at that frequency; and the RMS of the
+  // output, as an amplitude, for tones that alias to who knows where.
+
+  double
+  amplitude(std::vector<short> const & output,
+            double             const   frequency)
+  {
+    double ss = 0, cc = 0, sc = 0, ys = 0, yc = 0;
+
+    for (auto i = static_cast<std::size_t>(SETTLE_SECONDS * Resampler::OUTPUT_RATE); i < output.size(); ++i)
+    {
+      auto const w = 2 * std::numbers::pi * frequency * i / Resampler::OUTPUT_RATE;
+      auto const s = std::sin(w);
+      auto const c = std::cos(w);
+
+      ss += s * s;
+      cc += c * c;
+      sc += s * c;
+      ys += output[i] * s;
+      yc += output[i] * c;
+    }
+
+    auto const det = ss * cc - sc * sc;
+    auto const a   = (ys * cc - yc * sc) / det;
+    auto const b   = (yc * ss - ys * sc) / det;
+
+    return std::hypot(a, b);
+  }
+
+  double
+  rms(std::vector<short> const & output)
+  {
+    double      sum   = 0;
+    std::size_t count = 0;
+
+    for (auto i = static_cast<std::size_t>(SETTLE_SECONDS * Resampler::OUTPUT_RATE); i < output.size(); ++i, ++count)
+    {
+      sum += static_cast<double>(output[i]) * output[i];
+    }
+
+    return std::sqrt(2 * sum / std::max<std::size_t>(count, 1));
+  }
+
+  double
+  dB(double const ratio)
+  {
+    return 20 * std::log10(std::max(ratio, 1e-12));
+  }
+}
+
+/******************************************************************************/
+// Main
+/******************************************************************************/
+
+int
+main()
+{
+  bool failed = false;
+
+  std::printf("%8s %12s %12s %14s\n", "rate", "ripple dB", "atten dB", "x realtime");
+
+  for (auto const rate : RATES)
+  {
+    if (!Resampler::supports(rate))
+    {
+      std::printf("%8d unsupported\n", rate);
+      failed = true;
+      continue;
+    }
+
+    // Passband; the gain of tones across it, highest less lowest.
+
+    double lowest  = 0;
+    double highest = 0;
+    bool   first   = true;
+
+    for (double f = 250; f <= PASSBAND_HZ; f += 250)
+    {
+      Resampler  resampler(rate);
+      auto const gain = dB(amplitude(resample(resampler, tone(rate, f, TONE_SECONDS)), f) / AMPLITUDE);
+
+      lowest  = first ? gain : std::min(lowest,  gain);
+      highest = first ? gain : std::max(highest, gain);
+      first   = false;
+    }
+
+    // Stopband, if there's any of it below the input's Nyquist; the
+    // least attenuation of tones across it, aliased or not.
+
+    double attenuation = std::numeric_limits<double>::infinity();
+
+    for (double f = STOPBAND_HZ; f < rate / 2.0; f += std::max(250.0, (rate / 2.0 - STOPBAND_HZ) / 32))
+    {
+      Resampler resampler(rate);
+
+      attenuation = std::min(attenuation, -dB(rms(resample(resampler, tone(rate, f, TONE_SECONDS))) / AMPLITUDE));
+    }
+
+    // Throughput, over a mix of tones, in seconds of audio resampled per
+    // second taken.
+
+    std::vector<short> bench(static_cast<std::size_t>(rate * BENCH_SECONDS));
+
+    for (std::size_t i = 0; i < bench.size(); ++i)
+    {
+      auto const t = static_cast<double>(i) / rate;
+
+      bench[i] = static_cast<short>(std::lround(AMPLITUDE / 3 * (std::sin(2 * std::numbers::pi *  700 * t) +
+                                                                 std::sin(2 * std::numbers::pi * 1500 * t) +
+                                                                 std::sin(2 * std::numbers::pi * 9000 * t))));
+    }
+
+    Resampler   resampler(rate);
+    long long   checksum = 0;
+    auto const  start    = std::chrono::steady_clock::now();
+
+    for (std::size_t done = 0; done < bench.size(); done += Resampler::CHUNK)
+    {
+      resampler.process(bench.data() + done,
+                        std::min(Resampler::CHUNK, bench.size() - done),
+                        [&checksum](short const sample) { checksum += sample; });
+    }
+
+    std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+
+    auto const ripple = highest - lowest;
+    auto const pass   = ripple <= MAX_RIPPLE_DB && attenuation >= MIN_ATTEN_DB;
+
+    std::printf("%8d %12.3f %12.1f %14.0f%s\n",
+                rate,
+                ripple,
+                attenuation,
+                BENCH_SECONDS / elapsed.count(),
+                pass ? "" : "  FAIL");
+
+    failed |= !pass;
+
+    // Keep the benchmark's output live, so it's not optimized away.
+
+    if (checksum == 1) std::printf("\n");
+  }
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,429 @@
+#include "LatencyHistogram.hpp"
+#include "PollingTransceiver.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include <QCoreApplication>
+#include <QList>
+#include <QMetaObject>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVariantList>
+#include <QVariantMap>
+
+// The latency histograms kept of rig operations, recorded into at the
+// edges of each bucket, and read back as the API reports them; and the
+// schedule a polling transceiver keeps, driven poll by poll with a rig
+// that reports whatever it's told to, through settling after start and
+// after commands, backing off while nothing changes, and tightening up
+// again on change, on QSY, and while transmitting. Fails if anything
+// doesn't match.
+
+/******************************************************************************/
+// Constants
+/******************************************************************************/
+
+namespace
+{
+  // Seconds between polls, as configured, and in milliseconds, what the
+  // schedule starts at, settles at, and backs off to.
+
+  constexpr int POLL_INTERVAL = 1;
+  constexpr int INTERVAL      = POLL_INTERVAL * 1000;
+  constexpr int SETTLING      = 500;
+  constexpr int BACKED_OFF    = 4 * INTERVAL;
+
+  // Polls without change before the interval doubles.
+
+  constexpr int STABLE_POLLS = 5;
+
+  // Frequencies the rig is tuned to.
+
+  constexpr Transceiver::Frequency DIAL = 14078000;
+  constexpr Transceiver::Frequency QSY  = 7078000;
+  constexpr Transceiver::Frequency KNOB = 10136000;
+
+  // Threads recording latencies at once, and the latencies each records.
+
+  constexpr int THREADS = 4;
+  constexpr int RECORDS = 100000;
+}
+
+/******************************************************************************/
+// Local Routines
+/******************************************************************************/
+
+namespace
+{
+  int failures = 0;
+
+  // Note that the check named failed, and why.
+
+  void
+  fail(char    const * check,
+       QString const & why)
+  {
+    ++failures;
+    std::printf("FAIL %s: %s\n", check, qPrintable(why));
+  }
+
+  // Check a histogram's counters against those expected.
+
+  void
+  counted(char                          const * check,
+          LatencyHistogram              const & histogram,
+          QList<QPair<QString, double>> const & expected)
+  {
+    auto const stats = histogram.stats();
+
+    for (auto const & [name, value] : expected)
+    {
+      if (auto const actual = stats.value(name).toDouble(); std::abs(actual - value) > 1e-9)
+      {
+        fail(check, QString("%1 is %2, not %3").arg(name).arg(actual).arg(value));
+      }
+    }
+  }
+
+  // The bucket a latency, in microseconds, lands in, on its own.
+
+  int
+  bucket(qint64 const microseconds)
+  {
+    LatencyHistogram histogram;
+
+    histogram.record(microseconds);
+
+    auto const buckets = histogram.stats().value("BUCKETS").toList();
+
+    for (int i = 0; i < buckets.size(); ++i)
+    {
+      if (buckets.at(i).toULongLong()) return i;
+    }
+
+    return -1;
+  }
+
+  // Under a millisecond lands in the first bucket, anything from 2^(n-1)
+  // up to 2^n milliseconds in bucket n, and anything beyond the last but
+  // one in the last; negative latencies, which a clock stepping back can
+  // give us, count as none.
+
+  void
+  checkBuckets()
+  {
+    auto const landed = [](qint64 const microseconds, int const expected)
+    {
+      if (auto const actual = bucket(microseconds); actual != expected)
+      {
+        fail("buckets", QString("%1 us landed in bucket %2, not %3").arg(microseconds).arg(actual).arg(expected));
+      }
+    };
+
+    landed(-5,  0);
+    landed(0,   0);
+    landed(999, 0);
+
+    for (int n = 1; n < LatencyHistogram::BUCKETS - 1; ++n)
+    {
+      landed((qint64{1} << (n - 1)) * 1000,    n);
+      landed((qint64{1} << n)       * 1000 - 1, n);
+    }
+
+    landed((qint64{1} << (LatencyHistogram::BUCKETS - 2)) * 1000, LatencyHistogram::BUCKETS - 1);
+    landed(qint64{1} << 40,                                        LatencyHistogram::BUCKETS - 1);
+  }
+
+  // Percentiles are the upper bounds of the buckets they fall in, other
+  // than in the last, which has none, and where it's the maximum; the
+  // mean and maximum are exact.
+
+  void
+  checkStats()
+  {
+    LatencyHistogram histogram;
+
+    counted("empty", histogram, {{"COUNT", 0}, {"MEAN", 0}, {"MAX", 0}, {"P50", 0}, {"P90", 0}, {"P99", 0}});
+
+    for (int i = 0; i < 50; ++i) histogram.record(500);
+    for (int i = 0; i < 40; ++i) histogram.record(1500);
+    for (int i = 0; i <  9; ++i) histogram.record(3000);
+
+    histogram.record(100000);
+
+    counted("stats", histogram, {{"COUNT", 100}, {"MEAN", 2.12}, {"MAX", 100}, {"P50", 1}, {"P90", 2}, {"P99", 4}});
+
+    histogram.clear();
+
+    counted("clear", histogram, {{"COUNT", 0}, {"MEAN", 0}, {"MAX", 0}, {"P50", 0}, {"P90", 0}, {"P99", 0}});
+
+    histogram.record(20000000);
+
+    counted("last bucket", histogram, {{"COUNT", 1}, {"MAX", 20000}, {"P50", 20000}, {"P99", 20000}});
+  }
+
+  // Recording from several threads at once loses nothing.
+
+  void
+  checkThreads()
+  {
+    LatencyHistogram         histogram;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < THREADS; ++t)
+    {
+      threads.emplace_back([&histogram, t]
+      {
+        for (int i = 0; i < RECORDS; ++i) histogram.record(t * 1000 + i % 1000);
+      });
+    }
+
+    for (auto & thread : threads) thread.join();
+
+    quint64 total = 0;
+
+    for (auto const & count : histogram.stats().value("BUCKETS").toList()) total += count.toULongLong();
+
+    counted("threads", histogram, {{"COUNT", THREADS * RECORDS}, {"MAX", THREADS - 0.001}});
+
+    if (total != static_cast<quint64>(THREADS * RECORDS))
+    {
+      fail("threads", QString("buckets hold %1 latencies, not %2").arg(total).arg(THREADS * RECORDS));
+    }
+  }
+
+  // A rig that reports whatever it's been told to, by us or by the tests,
+  // as if by the operator at its front panel.
+
+  class Rig final
+    : public PollingTransceiver
+  {
+  public:
+
+    explicit Rig(int const poll_interval)
+      : PollingTransceiver {poll_interval, nullptr}
+    {}
+
+    Frequency frequency = DIAL;
+    bool      ptt       = false;
+    qint64    polls     = 0;
+
+    // The interval the next poll is scheduled for, or zero if there's
+    // none scheduled.
+
+    int
+    interval() const
+    {
+      auto const timer = findChild<QTimer *>();
+      return timer && timer->isActive() ? timer->interval() : 0;
+    }
+
+    // Poll, as the timer going off would.
+
+    void
+    fire()
+    {
+      QMetaObject::invokeMethod(this, "handle_timeout");
+    }
+
+    // Ask for the state provided, as the client does.
+
+    void
+    request(Frequency const dial,
+            bool      const transmit)
+    {
+      TransceiverState state;
+
+      state.online(true);
+      state.frequency(dial);
+      state.mode(USB);
+      state.ptt(transmit);
+
+      set(state, 0);
+    }
+
+  private:
+
+    int  do_start()                                  override { return 0; }
+    void do_stop()                                   override {}
+    void do_frequency(Frequency f, MODE, bool)       override { update_rx_frequency(frequency = f); }
+    void do_tx_frequency(Frequency, MODE, bool)      override {}
+    void do_mode(MODE)                               override {}
+    void do_ptt(bool on)                             override { update_PTT(ptt = on); }
+
+    void
+    poll() override
+    {
+      ++polls;
+      update_rx_frequency(frequency);
+      update_other_frequency(0);
+      update_split(false);
+      update_mode(USB);
+      update_PTT(ptt);
+    }
+  };
+
+  // Poll once for each of the intervals expected, checking that each is
+  // what the next poll is then scheduled for.
+
+  void
+  scheduled(char       const * check,
+            Rig              & rig,
+            QList<int> const & expected)
+  {
+    QStringList actual;
+
+    for (int i = 0; i < expected.size(); ++i)
+    {
+      rig.fire();
+      actual.append(QString::number(rig.interval()));
+
+      if (rig.interval() != expected.at(i))
+      {
+        fail(check, QString("after poll %1, scheduled %2").arg(i + 1).arg(actual.join(", ")));
+        return;
+      }
+    }
+  }
+
+  // Intervals expected while nothing changes, starting from the full
+  // rate; doubling after each run of stable polls, up to the most we'll
+  // back off to.
+
+  QList<int>
+  backingOff()
+  {
+    QList<int> intervals;
+
+    for (int interval = INTERVAL; interval <= BACKED_OFF; interval *= 2)
+    {
+      for (int i = 1; i < STABLE_POLLS; ++i) intervals.append(interval);
+      intervals.append(std::min(interval * 2, BACKED_OFF));
+    }
+
+    return intervals;
+  }
+
+  // The schedule from start to finish; settling after start, and after
+  // each command, at the shorter interval, backing off while stable, and
+  // back to the full rate on any change, and for as long as we transmit.
+
+  void
+  checkSchedule()
+  {
+    auto const before = TransceiverBase::latency();
+
+    Rig rig(POLL_INTERVAL);
+
+    rig.start(0);
+
+    if (rig.interval() != INTERVAL)
+    {
+      fail("start", QString("first poll scheduled after %1 ms, not %2").arg(rig.interval()).arg(INTERVAL));
+    }
+
+    scheduled("settling after start", rig, {SETTLING, SETTLING, INTERVAL});
+    scheduled("backing off",          rig, backingOff());
+    scheduled("backed off",           rig, {BACKED_OFF, BACKED_OFF, BACKED_OFF});
+
+    // Turning the knob; seen at the next poll, which is back at the full
+    // rate, and backing off starts over from there.
+
+    rig.frequency = KNOB;
+
+    scheduled("change at the rig", rig, {INTERVAL});
+    scheduled("backing off again", rig, backingOff());
+
+    // QSY, which tightens up at once, rather than waiting out the poll
+    // that's backed off.
+
+    rig.request(QSY, false);
+
+    if (rig.interval() != SETTLING)
+    {
+      fail("QSY", QString("next poll scheduled after %1 ms, not %2").arg(rig.interval()).arg(SETTLING));
+    }
+
+    scheduled("settling after QSY", rig, {INTERVAL});
+    scheduled("backing off after QSY", rig, backingOff());
+
+    // Transmitting; polled at the full rate throughout, and backing off
+    // afresh once we're done.
+
+    rig.request(QSY, true);
+
+    if (rig.interval() != SETTLING)
+    {
+      fail("PTT", QString("next poll scheduled after %1 ms, not %2").arg(rig.interval()).arg(SETTLING));
+    }
+
+    scheduled("transmitting", rig, QList<int>(3 * STABLE_POLLS, INTERVAL));
+
+    rig.request(QSY, false);
+
+    scheduled("after transmitting", rig, {INTERVAL});
+    scheduled("backing off after transmitting", rig, backingOff());
+
+    // Each poll, and each command, has been timed.
+
+    auto const after = TransceiverBase::latency();
+    auto const count = [&](char const * operation)
+    {
+      return after.value(operation).toMap().value("COUNT").toLongLong()
+           - before.value(operation).toMap().value("COUNT").toLongLong();
+    };
+
+    if (count("POLL") != rig.polls || count("PTT") != 2 || count("FREQUENCY") != 2)
+    {
+      fail("latency", QString("timed %1 polls, %2 PTT and %3 frequency changes")
+                      .arg(count("POLL")).arg(count("PTT")).arg(count("FREQUENCY")));
+    }
+
+    rig.stop();
+
+    if (rig.interval())
+    {
+      fail("stop", QString("poll still scheduled after %1 ms").arg(rig.interval()));
+    }
+  }
+
+  // With no poll interval, there's no polling at all.
+
+  void
+  checkNoPolling()
+  {
+    Rig rig(0);
+
+    rig.start(0);
+
+    if (rig.interval())
+    {
+      fail("no polling", QString("poll scheduled after %1 ms").arg(rig.interval()));
+    }
+  }
+}
+
+/******************************************************************************/
+// Main
+/******************************************************************************/
+
+int
+main(int    argc,
+     char * argv[])
+{
+  QCoreApplication app(argc, argv);
+
+  checkBuckets();
+  checkStats();
+  checkThreads();
+  checkSchedule();
+  checkNoPolling();
+
+  std::printf("%d failures\n", failures);
+
+  return failures ? 1 : 0;
+}
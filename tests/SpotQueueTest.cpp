@@ -0,0 +1,485 @@
+#include "SpotQueue.hpp"
+#include <cstdio>
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QHostAddress>
+#include <QList>
+#include <QNetworkDatagram>
+#include <QPair>
+#include <QStandardPaths>
+#include <QString>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QUdpSocket>
+
+// The spot queue, driven as the uploaders drive it, sending what it hands
+// out over loopback sockets; a datagram a record, as SpotClient does, and
+// as many records to a write of a stream as will fit, as APRSISClient and
+// PSK Reporter do. Checks what arrives, and what the queue counts, through
+// replacement and duplicates within the time to live, coalescing, dropping
+// the oldest, going stale, and spilling to disk and coming back. Fails if
+// anything doesn't match.
+
+/******************************************************************************/
+// Constants
+/******************************************************************************/
+
+namespace
+{
+  // Milliseconds we'll wait on a socket before giving up on it.
+
+  constexpr int TIMEOUT = 5000;
+
+  // Bytes to a write of a stream.
+
+  constexpr qsizetype MAX_WRITE = 256;
+}
+
+/******************************************************************************/
+// Local Routines
+/******************************************************************************/
+
+namespace
+{
+  int failures = 0;
+
+  // Note that the check named failed, and why.
+
+  void
+  fail(char    const * check,
+       QString const & why)
+  {
+    ++failures;
+    std::printf("FAIL %s: %s\n", check, qPrintable(why));
+  }
+
+  // A record, as each of the uploaders' are; a line of text.
+
+  QByteArray
+  record(int const i)
+  {
+    return QString("SPOT %1 KN4CRD EM73\n").arg(i, 3, 10, QChar('0')).toLatin1();
+  }
+
+  QList<QByteArray>
+  records(int const from,
+          int const to)
+  {
+    QList<QByteArray> records;
+
+    for (int i = from; i < to; ++i) records.append(record(i));
+
+    return records;
+  }
+
+  QString
+  key(int const i)
+  {
+    return QString("K%1_20m").arg(i);
+  }
+
+  // Check that what arrived is what was expected.
+
+  void
+  arrived(char              const * check,
+          QList<QByteArray> const & received,
+          QList<QByteArray> const & expected)
+  {
+    if (received != expected)
+    {
+      fail(check, QString("%1 records arrived, not the %2 expected, or not as expected")
+                  .arg(received.size()).arg(expected.size()));
+    }
+  }
+
+  // Check the queue's counters against those expected.
+
+  void
+  counted(char                          const * check,
+          SpotQueue                     const & queue,
+          QList<QPair<QString, qint64>> const & expected)
+  {
+    auto const stats = queue.stats();
+
+    for (auto const & [name, value] : expected)
+    {
+      if (auto const actual = stats.value(name).toLongLong(); actual != value)
+      {
+        fail(check, QString("%1 is %2, not %3").arg(name).arg(actual).arg(value));
+      }
+    }
+  }
+
+  // A loopback destination for datagrams, one record to each.
+
+  struct Datagrams
+  {
+    QUdpSocket receiver;
+    QUdpSocket sender;
+
+    bool
+    open()
+    {
+      return receiver.bind(QHostAddress::LocalHost, 0);
+    }
+
+    // Send all that's queued, and return what arrived.
+
+    QList<QByteArray>
+    send(SpotQueue    & queue,
+         qint64 const   now)
+    {
+      qsizetype count = 0;
+
+      for (auto records = queue.take(0, now); !records.isEmpty(); records = queue.take(0, now))
+      {
+        if (sender.writeDatagram(records.first().data, QHostAddress::LocalHost, receiver.localPort()) == -1)
+        {
+          queue.failed(records);
+          break;
+        }
+
+        queue.sent(records.size());
+        count += records.size();
+      }
+
+      QList<QByteArray> received;
+
+      while (received.size() < count && (receiver.hasPendingDatagrams() || receiver.waitForReadyRead(TIMEOUT)))
+      {
+        while (receiver.hasPendingDatagrams()) received.append(receiver.receiveDatagram().data());
+      }
+
+      return received;
+    }
+  };
+
+  // A loopback destination for a stream, to which records are written as
+  // many at a time as will fit.
+
+  struct Stream
+  {
+    QTcpServer   server;
+    QTcpSocket   client;
+    QTcpSocket * peer = nullptr;
+
+    bool
+    open()
+    {
+      if (!server.listen(QHostAddress::LocalHost)) return false;
+
+      client.connectToHost(QHostAddress::LocalHost, server.serverPort());
+
+      if (!client.waitForConnected(TIMEOUT) || !server.waitForNewConnection(TIMEOUT)) return false;
+
+      peer = server.nextPendingConnection();
+
+      return peer != nullptr;
+    }
+
+    // Send all that's queued, returning the records of each write, and
+    // the lines that arrived.
+
+    QList<SpotQueue::Records>
+    send(SpotQueue         &       queue,
+         qint64            const   now,
+         qsizetype         const   overhead,
+         QList<QByteArray>       & received)
+    {
+      QList<SpotQueue::Records> writes;
+      QByteArray                expected;
+
+      for (auto records = queue.take(MAX_WRITE, now, overhead); !records.isEmpty(); records = queue.take(MAX_WRITE, now, overhead))
+      {
+        QByteArray data;
+
+        for (auto const & record : records) data.append(record.data);
+
+        if (client.write(data) == -1)
+        {
+          queue.failed(records);
+          break;
+        }
+
+        queue.sent(records.size());
+        writes.append(records);
+        expected.append(data);
+      }
+
+      client.waitForBytesWritten(TIMEOUT);
+
+      QByteArray data;
+
+      while (data.size() < expected.size() && (peer->bytesAvailable() || peer->waitForReadyRead(TIMEOUT)))
+      {
+        data.append(peer->readAll());
+      }
+
+      for (auto const & line : data.split('\n'))
+      {
+        if (!line.isEmpty()) received.append(line + '\n');
+      }
+
+      return writes;
+    }
+  };
+
+  // Where a queue of the name provided spills to, as SpotQueue has it.
+
+  QString
+  spillPath(QString const & name)
+  {
+    return QDir{QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)}
+             .absoluteFilePath(QString("spots-%1.dat").arg(name.toLower()));
+  }
+
+  // A record pushed while another with its key is queued replaces it; one
+  // pushed once that's been sent is a duplicate, until the time to live
+  // is up. Records without a key are never duplicates.
+
+  void
+  checkDedupe(Datagrams & udp)
+  {
+    SpotQueue queue("dedupe", {100, 60});
+
+    queue.push("A", 0, "K1");
+    queue.push("B", 1, "K1");
+    queue.push("C", 1);
+    queue.push("D", 2, "K2");
+
+    arrived("replacement", udp.send(queue, 2), {"B", "C", "D"});
+
+    if ( queue.push("E", 30, "K1")) fail("duplicate", "sent key within its time to live was queued");
+    if (!queue.push("F", 30))       fail("duplicate", "record without a key was refused");
+    if ( queue.push("G", 62, "K2")) fail("duplicate", "sent key at its time to live was queued");
+    if (!queue.push("H", 63, "K2")) fail("duplicate", "sent key past its time to live was refused");
+
+    arrived("time to live", udp.send(queue, 63), {"F", "H"});
+
+    counted("dedupe", queue, {{"QUEUED",     5},
+                              {"REPLACED",   1},
+                              {"DUPLICATES", 2},
+                              {"SENT",       5},
+                              {"PENDING",    0}});
+  }
+
+  // As many records to a write as will fit, each counted with the overhead
+  // provided, and no fewer; one that won't fit on its own goes alone.
+  // Records that fail to go go back to the head of the queue.
+
+  void
+  checkCoalescing(Stream & tcp)
+  {
+    for (auto const overhead : {qsizetype{0}, qsizetype{11}})
+    {
+      SpotQueue queue("coalesce", {1000});
+
+      for (int i = 0; i < 100; ++i) queue.push(record(i), i);
+
+      queue.push(QByteArray(300, 'X') + '\n', 100);
+
+      auto const failed = queue.take(MAX_WRITE, 100, overhead);
+
+      if (failed.size() < 2) fail("coalescing", "one record taken where many would fit");
+
+      queue.failed(failed);
+
+      QList<QByteArray> received;
+      auto const        writes = tcp.send(queue, 100, overhead, received);
+
+      for (int i = 0; i < writes.size(); ++i)
+      {
+        auto const bytes = [overhead](SpotQueue::Records const & records)
+        {
+          qsizetype bytes = 0;
+          for (auto const & record : records) bytes += record.data.size() + overhead;
+          return bytes;
+        };
+
+        auto const & write = writes.at(i);
+
+        if (write.size() > 1 && bytes(write) > MAX_WRITE)
+        {
+          fail("coalescing", QString("write %1 of %2 bytes").arg(i).arg(bytes(write)));
+        }
+
+        if (i + 1 < writes.size() && bytes(write) + bytes(writes.at(i + 1).mid(0, 1)) <= MAX_WRITE)
+        {
+          fail("coalescing", QString("write %1 had room for another record").arg(i));
+        }
+      }
+
+      if (writes.isEmpty() || writes.last().size() != 1)
+      {
+        fail("coalescing", "oversized record not sent on its own");
+      }
+
+      arrived("coalescing", received, records(0, 100) << QByteArray(300, 'X') + '\n');
+
+      counted("coalescing", queue, {{"QUEUED",  101},
+                                    {"SENT",    101},
+                                    {"FAILED",  failed.size()},
+                                    {"PENDING", 0}});
+    }
+  }
+
+  // Past capacity, the oldest records go, unsent; their keys aren't then
+  // duplicates, while those of the records that went are.
+
+  void
+  checkDropOldest(Datagrams & udp)
+  {
+    SpotQueue queue("drop", {10, 600});
+
+    for (int i = 0; i < 15; ++i) queue.push(record(i), i, key(i));
+
+    counted("drop oldest", queue, {{"DROPPED", 5}, {"PENDING", 10}});
+
+    arrived("drop oldest", udp.send(queue, 15), records(5, 15));
+
+    for (int i = 0; i < 15; ++i)
+    {
+      if (queue.push(record(i), 20, key(i)) != (i < 5))
+      {
+        fail("drop oldest", QString("%1 %2").arg(key(i), i < 5 ? "refused, though dropped" : "queued, though sent"));
+      }
+    }
+
+    counted("drop oldest", queue, {{"QUEUED", 20}, {"DUPLICATES", 10}, {"SENT", 10}});
+  }
+
+  // Records past the age limit go, unsent, when records are next taken;
+  // their keys aren't then duplicates.
+
+  void
+  checkStale(Datagrams & udp)
+  {
+    SpotQueue queue("stale", {100, 600, 10});
+
+    queue.push("A", 0, "K1");
+    queue.push("B", 5, "K2");
+
+    arrived("stale", udp.send(queue, 12), {"B"});
+
+    if (!queue.push("C", 13, "K1")) fail("stale", "key of a stale record was refused");
+    if ( queue.push("D", 13, "K2")) fail("stale", "key of a sent record was queued");
+
+    arrived("stale", udp.send(queue, 13), {"C"});
+
+    counted("stale", queue, {{"STALE", 1}, {"DUPLICATES", 1}, {"SENT", 2}});
+  }
+
+  // Offline, records past capacity spill to disk, and come back, oldest
+  // first, as there's room for them once online; so too does whatever's
+  // left in a queue when it goes, in the next queue of its name. What
+  // won't fit in the spill file is dropped, and its key forgotten.
+
+  void
+  checkSpill(Stream & tcp)
+  {
+    QFile::remove(spillPath("spill"));
+
+    {
+      SpotQueue queue("spill", {5, 0, 0, 64 * 1024});
+
+      queue.setOnline(false, 0);
+
+      for (int i = 0; i < 12; ++i) queue.push(record(i), i);
+
+      if (!queue.spilled() || queue.isEmpty() || queue.bytes() != 0)
+      {
+        fail("spill", "records past capacity weren't spilled");
+      }
+
+      counted("spill", queue, {{"SPILLED", 12}, {"PENDING", 0}, {"ONLINE", 0}});
+
+      queue.setOnline(true, 12);
+
+      counted("unspill", queue, {{"RESTORED", 5}, {"PENDING", 5}, {"ONLINE", 1}});
+
+      QList<QByteArray> received;
+      tcp.send(queue, 12, 0, received);
+
+      arrived("unspill", received, records(0, 12));
+
+      counted("unspill", queue, {{"RESTORED", 12}, {"DROPPED", 0}, {"SENT", 12}, {"PENDING", 0}});
+
+      if (queue.spilled() || !queue.isEmpty()) fail("unspill", "records left spilled");
+
+      for (int i = 12; i < 15; ++i) queue.push(record(i), i);
+    }
+
+    {
+      SpotQueue queue("spill", {5, 0, 0, 64 * 1024});
+
+      if (queue.isEmpty()) fail("carry over", "records left at exit were lost");
+
+      queue.setOnline(true, 20);
+
+      QList<QByteArray> received;
+      tcp.send(queue, 20, 0, received);
+
+      arrived("carry over", received, records(12, 15));
+
+      counted("carry over", queue, {{"RESTORED", 3}, {"SENT", 3}});
+    }
+
+    QFile::remove(spillPath("full"));
+
+    {
+      // Room for the header, and five records of these, each with a time,
+      // a key of 2 characters, and the lengths of the two.
+
+      SpotQueue queue("full", {5, 600, 0, 8 + 5 * (8 + 4 + 4 + 4 + record(0).size())});
+
+      queue.setOnline(false, 0);
+
+      for (int i = 0; i < 6; ++i) queue.push(record(i), i, QString("K%1").arg(i));
+
+      counted("spill full", queue, {{"SPILLED", 5}, {"DROPPED", 1}, {"PENDING", 0}});
+
+      if (!queue.push(record(5), 10, "K5")) fail("spill full", "key of a record that couldn't be spilled was refused");
+      if ( queue.push(record(0), 10, "K0")) fail("spill full", "key of a spilled record was queued");
+    }
+
+    QFile::remove(spillPath("full"));
+  }
+}
+
+/******************************************************************************/
+// Main
+/******************************************************************************/
+
+int
+main(int    argc,
+     char * argv[])
+{
+  QCoreApplication app(argc, argv);
+
+  // Spill files go where they would for the application, were it under
+  // test; keep them out of the way of any real ones.
+
+  QStandardPaths::setTestModeEnabled(true);
+  QDir().mkpath(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation));
+
+  Datagrams udp;
+  Stream    tcp;
+
+  if (!udp.open() || !tcp.open())
+  {
+    std::printf("FAIL unable to open loopback sockets\n");
+    return 1;
+  }
+
+  checkDedupe(udp);
+  checkCoalescing(tcp);
+  checkDropOldest(udp);
+  checkStale(udp);
+  checkSpill(tcp);
+
+  std::printf("%d failures\n", failures);
+
+  return failures ? 1 : 0;
+}
@@ -18,13 +18,16 @@
  *
  **/
 
+#include <algorithm>
 #include <stdexcept>
 
 #include <boost/format.hpp>
 
+#include <QHash>
 #include <QLoggingCategory>
 #include <QMap>
 #include <QSet>
+#include <QStringList>
 
 #define CRCPP_INCLUDE_ESOTERIC_CRC_DEFINITIONS
 #define CRCPP_USE_CPP11
@@ -161,6 +164,42 @@ QRegularExpression compound_re("^\\s*[`]"              +
                                  optional_num_pattern  +
                                ")");
 
+namespace {
+    // Expressions used while packing and unpacking each frame, compiled
+    // once up front rather than on every call; matching against a const
+    // expression is safe from any thread once it has been compiled.
+    QRegularExpression compiled(QString const &pattern){
+        QRegularExpression re(pattern);
+        re.optimize();
+        return re;
+    }
+
+    QRegularExpression const grid_re                    = compiled(grid_pattern);
+    QRegularExpression const base_callsign_re           = compiled(base_callsign_pattern);
+    QRegularExpression const compound_callsign_re       = compiled(compound_callsign_pattern);
+    QRegularExpression const compound_callsign_whole_re = compiled("^" + compound_callsign_pattern);
+    QRegularExpression const pack_callsign_re           = compiled(pack_callsign_pattern);
+    QRegularExpression const callsign_alnum_re          = compiled("[0-9][A-Z]|[A-Z][0-9]");
+#if JS8_USE_ESCAPE_SUB_CHAR
+    QRegularExpression const unescape_re                = compiled("([\\x1A][0-9a-fA-F]{4})");
+#else
+    QRegularExpression const unescape_re                = compiled("(([uU][+]|\\\\[uU])[0-9a-fA-F]{4})");
+#endif
+
+    // Remove all but the characters of the callsign and grid alphabet,
+    // less any it doesn't allow, as replacing [^A-Z0-9 /@] would.
+    QString alphanumericOnly(QString const &value, bool allowAt){
+        QString word;
+        word.reserve(value.size());
+        for(auto ch : value){
+            if((ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == ' ' || ch == '/' || (allowAt && ch == '@')){
+                word.append(ch);
+            }
+        }
+        return word;
+    }
+}
+
 QMap<QString, QString> hufftable = {
     // char   code                 weight
     { " " , "01" }, // 1.0
@@ -353,7 +392,7 @@ int mwattsToDbm(int mwatts){
 
 int dbmTomwatts(int dbm){
     if(dbm2mw.contains(dbm)){
-        return dbm2mw[dbm];
+        return dbm2mw.value(dbm);
     }
     auto iter = dbm2mw.lowerBound(dbm);
     if(iter == dbm2mw.end()){
@@ -399,14 +438,12 @@ QString Varicode::unescape(const QString &text){
     QString unescaped(text);
 #if JS8_USE_ESCAPE_SUB_CHAR
     static const int size = 5;
-    QRegularExpression r("([\\x1A][0-9a-fA-F]{4})");
 #else
     static const int size = 6;
-    QRegularExpression r("(([uU][+]|\\\\[uU])[0-9a-fA-F]{4})");
 #endif
     qsizetype pos = 0;
     QRegularExpressionMatch match;
-    while ((pos = unescaped.indexOf(r, pos, &match)) != -1) {
+    while ((pos = unescaped.indexOf(unescape_re, pos, &match)) != -1) {
         unescaped.replace(pos++, size, QChar(match.captured(1).right(4).toUShort(0, 16)));
     }
 
@@ -446,14 +483,14 @@ QString Varicode::cqString(int number){
     if(!cqs.contains(number)){
         return QString{};
     }
-    return cqs[number];
+    return cqs.value(number);
 }
 
 QString Varicode::hbString(int number){
     if(!hbs.contains(number)){
         return QString{};
     }
-    return hbs[number];
+    return hbs.value(number);
 }
 
 bool Varicode::startsWithCQ(QString text){
@@ -516,8 +553,7 @@ bool Varicode::checksum32Valid(QString const &checksum, QString const &input){
 
 QStringList Varicode::parseCallsigns(QString const &input){
     QStringList callsigns;
-    QRegularExpression re(compound_callsign_pattern);
-    QRegularExpressionMatchIterator iter = re.globalMatch(input);
+    QRegularExpressionMatchIterator iter = compound_callsign_re.globalMatch(input);
     while(iter.hasNext()){
         QRegularExpressionMatch match = iter.next();
         if(!match.hasMatch()){
@@ -527,8 +563,7 @@ QStringList Varicode::parseCallsigns(QString const &input){
         if(!Varicode::isValidCallsign(callsign, nullptr)){
             continue;
         }
-        QRegularExpression m(grid_pattern);
-        if(m.match(callsign).hasMatch()){
+        if(grid_re.match(callsign).hasMatch()){
             continue;
         }
         callsigns.append(callsign);
@@ -538,8 +573,7 @@ QStringList Varicode::parseCallsigns(QString const &input){
 
 QStringList Varicode::parseGrids(const QString &input){
     QStringList grids;
-    QRegularExpression re(grid_pattern);
-    QRegularExpressionMatchIterator iter = re.globalMatch(input);
+    QRegularExpressionMatchIterator iter = grid_re.globalMatch(input);
     while(iter.hasNext()){
         QRegularExpressionMatch match = iter.next();
         if(!match.hasMatch()){
@@ -554,145 +588,181 @@ QStringList Varicode::parseGrids(const QString &input){
     return grids;
 }
 
-QList<QPair<int, QVector<bool>>> Varicode::huffEncode(const QMap<QString, QString> &huff, QString const& text){
-    QList<QPair<int, QVector<bool>>> out;
+namespace {
+    // The Huffman table, compiled once into the forms that encoding and
+    // decoding need, rather than searching the table for each character
+    // or each bit. The codes themselves are fixed by the protocol.
+    class HuffCodec {
+    public:
+        static HuffCodec const & instance(){
+            static HuffCodec const codec(hufftable);
+            return codec;
+        }
 
-    int i = 0;
+        QSet<QString> const & validChars() const {
+            return valid_;
+        }
 
-    auto keys = huff.keys();
-    std::sort(keys.begin(), keys.end(), [](QString const &a, QString const &b){
-        auto alen = a.length();
-        auto blen = b.length();
-        if(blen < alen){
-            return true;
+        // Keys that could start at a character, longest first, as the
+        // encoder has always preferred them.
+        QList<QPair<QString, Codeword>> const * candidates(QChar ch) const {
+            auto const it = encode_.constFind(ch);
+            return it == encode_.cend() ? nullptr : &it.value();
         }
-        if(alen < blen){
-            return false;
+
+        // The number of bits in each decoder lookup.
+        int width() const {
+            return width_;
         }
 
-        return b < a;
-    });
+        // Symbol whose code is a prefix of the width() bits given, or -1,
+        // and the length of that code.
+        qint16 symbol(quint64 bits) const {
+            return decode_[bits].symbol;
+        }
 
-    while(i < text.length()){
-        bool found = false;
-        foreach(auto ch, keys){
-            if (QStringView(text.begin() + i, text.end()).startsWith(ch)) {
-                out.append({ ch.length(), Varicode::strToBits(huff[ch])});
-                i += ch.length();
-                found = true;
-                break;
-            }
+        int length(quint64 bits) const {
+            return decode_[bits].length;
         }
 
-        if(!found){
-            i++;
+        QString const & key(qint16 symbol) const {
+            return keys_[symbol];
         }
-    }
 
-    return out;
-}
+    private:
+        struct Entry {
+            qint16 symbol = -1;
+            quint8 length = 0;
+        };
+
+        explicit HuffCodec(QMap<QString, QString> const &huff){
+            auto keys = huff.keys();
+            std::sort(keys.begin(), keys.end(), [](QString const &a, QString const &b){
+                auto alen = a.length();
+                auto blen = b.length();
+                if(blen < alen){
+                    return true;
+                }
+                if(alen < blen){
+                    return false;
+                }
 
-QString Varicode::huffDecode(QMap<QString, QString> const &huff, QVector<bool> const& bitvec){
-    QString text;
+                return b < a;
+            });
 
-    QString bits = Varicode::bitsToStr(bitvec);
+            foreach(auto const &key, keys){
+                if(key.isEmpty()){
+                    continue;
+                }
 
-    // TODO: jsherer - this is naive...
-    while(bits.length() > 0){
-        bool found = false;
-        foreach(auto key, huff.keys()){
-            if(bits.startsWith(huff[key])){
-                if(key == EOT){
-                    text.append(" ");
-                    found = false;
-                    break;
+                auto const &str = huff[key];
+
+                Codeword code;
+                foreach(auto bit, str){
+                    code.append(bit == '1');
                 }
-                text.append(key);
-                bits = bits.mid(huff[key].length());
-                found = true;
+
+                encode_[key.at(0)].append({ key, code });
+                valid_.insert(key);
+                width_ = qMax(width_, (int)str.length());
+            }
+
+            // Every entry whose leading bits are a code decodes to it; the
+            // codes are prefix free, so no entry is claimed twice.
+            decode_.resize(1 << width_);
+
+            foreach(auto const &key, keys){
+                auto const &str = huff[key];
+                if(key.isEmpty() || str.isEmpty()){
+                    continue;
+                }
+
+                quint64 prefix = 0;
+                foreach(auto bit, str){
+                    prefix = (prefix << 1) | (bit == '1');
+                }
+
+                auto const span = 1 << (width_ - str.length());
+                for(int i = 0; i < span; i++){
+                    auto &entry = decode_[(prefix << (width_ - str.length())) | i];
+                    if(entry.symbol < 0){
+                        entry = { (qint16)keys_.size(), (quint8)str.length() };
+                    }
+                }
+
+                keys_.append(key);
             }
         }
-        if(!found){
-            break;
-        }
-    }
 
-    return text;
+        QHash<QChar, QList<QPair<QString, Codeword>>> encode_;
+        QVector<Entry> decode_;
+        QStringList keys_;
+        QSet<QString> valid_;
+        int width_ = 0;
+    };
 }
 
-QSet<QString> Varicode::huffValidChars(const QMap<QString, QString> &huff){
-    auto const keys = huff.keys();
-    return QSet<QString>(keys.begin(),
-                         keys.end());
-}
+// If pStarts is provided, it receives the position in the text at which
+// each code begins; characters not in the table are skipped over.
+QList<QPair<int, Codeword>> Varicode::huffEncode(QString const& text, QList<int> *pStarts){
+    auto const &codec = HuffCodec::instance();
 
-// convert char* array of 0 bytes and 1 bytes to bool vector
-QVector<bool> Varicode::bytesToBits(char *bitvec, int n){
-    QVector<bool> bits;
-    for(int i = 0; i < n; i++){
-        bits.append(bitvec[i] == 0x01);
-    }
-    return bits;
-}
+    QList<QPair<int, Codeword>> out;
 
-// convert string of 0s and 1s to bool vector
-QVector<bool> Varicode::strToBits(QString const& bitvec){
-    QVector<bool> bits;
-    foreach(auto ch, bitvec){
-        bits.append(ch == '1');
-    }
-    return bits;
-}
+    int i = 0;
 
-QString Varicode::bitsToStr(QVector<bool> const& bitvec){
-    QString bits;
-    foreach(auto bit, bitvec){
-        bits.append(bit ? "1" : "0");
+    while(i < text.length()){
+        bool found = false;
+        if(auto const *candidates = codec.candidates(text.at(i))){
+            foreach(auto const &candidate, *candidates){
+                auto const &key = candidate.first;
+                if (QStringView(text.begin() + i, text.end()).startsWith(key)) {
+                    out.append({ key.length(), candidate.second });
+                    if(pStarts) pStarts->append(i);
+                    i += key.length();
+                    found = true;
+                    break;
+                }
+            }
+        }
+
+        if(!found){
+            i++;
+        }
     }
-    return bits;
+
+    return out;
 }
 
-QVector<bool> Varicode::intToBits(quint64 value, int expected){
-    QVector<bool> bits;
+QString Varicode::huffDecode(BitBuffer<72> const& bitvec){
+    auto const &codec = HuffCodec::instance();
 
-    while(value){
-        bits.prepend((bool)(value & 1));
-        value = value >> 1;
-    }
+    QString text;
 
-    if(expected){
-        while(bits.count() < expected){
-            bits.prepend((bool) 0);
+    // Look up a table width of bits at a time, reading zeros past the
+    // end, and stop at the first code that's absent or runs past it.
+    for(int i = 0; i < bitvec.size();){
+        auto const bits = bitvec.extract(i, codec.width());
+        auto const symbol = codec.symbol(bits);
+        if(symbol < 0 || i + codec.length(bits) > bitvec.size()){
+            break;
         }
-    }
 
-    return bits;
-}
+        auto const &key = codec.key(symbol);
+        if(key == EOT){
+            text.append(" ");
+            break;
+        }
 
-quint64 Varicode::bitsToInt(QVector<bool> const value){
-    quint64 v = 0;
-    foreach(bool bit, value){
-        v = (v << 1) + (int)(bit);
+        text.append(key);
+        i += codec.length(bits);
     }
-    return v;
-}
 
-quint64 Varicode::bitsToInt(QVector<bool>::ConstIterator start, int n){
-    quint64 v = 0;
-    for(int i = 0; i < n; i++){
-        int bit = (int)(*start);
-        v = (v << 1) + (int)(bit);
-        start++;
-    }
-    return v;
+    return text;
 }
 
-QVector<bool> Varicode::bitsListToBits(QList<QVector<bool>> &list){
-    QVector<bool> out;
-    foreach(auto vec, list){
-        out += vec;
-    }
-    return out;
+QSet<QString> const & Varicode::huffValidChars(){
+    return HuffCodec::instance().validChars();
 }
 
 quint8 Varicode::unpack5bits(QString const& value){
@@ -816,7 +886,7 @@ QString Varicode::pack72bits(quint64 value, quint8 rem){
 // 21 bits for the data + 1 bit for a flag indicator
 // giving us a total of 5.5 bits per character
 quint32 Varicode::packAlphaNumeric22(QString const& value, bool isFlag){
-    QString word = QString(value).replace(QRegularExpression("[^A-Z0-9/ ]"), "");
+    QString word = alphanumericOnly(value, false);
     if(word.length() < 4){
         word = word + QString(" ").repeated(4-word.length());
     }
@@ -867,7 +937,7 @@ QString Varicode::unpackAlphaNumeric22(quint32 packed, bool *isFlag){
 //
 // giving us a total of 4.5-5.55 bits per character
 quint64 Varicode::packAlphaNumeric50(QString const& value){
-    QString word = QString(value).replace(QRegularExpression("[^A-Z0-9 /@]"), "");
+    QString word = alphanumericOnly(value, true);
     if(word.length() > 3 && word.at(3) != '/'){
         word.insert(3, ' ');
     }
@@ -955,7 +1025,7 @@ quint32 Varicode::packCallsign(QString const& value, bool *pPortable){
     QString callsign = value.toUpper().trimmed();
 
     if(basecalls.contains(callsign)){
-        return basecalls[callsign];
+        return basecalls.value(callsign);
     }
 
     // strip /P
@@ -1002,9 +1072,8 @@ quint32 Varicode::packCallsign(QString const& value, bool *pPortable){
     }
 
     QString matched;
-    QRegularExpression m(pack_callsign_pattern);
     foreach(auto permutation, permutations){
-        auto match = m.match(permutation);
+        auto match = pack_callsign_re.match(permutation);
         if(match.hasMatch()){
             matched = match.captured(0);
         }
@@ -1028,7 +1097,7 @@ quint32 Varicode::packCallsign(QString const& value, bool *pPortable){
 
 QString Varicode::unpackCallsign(quint32 value, bool portable){
     foreach(auto key, basecalls.keys()){
-        if(basecalls[key] == value){
+        if(basecalls.value(key) == value){
             return key;
         }
     }
@@ -1196,13 +1265,13 @@ quint8 Varicode::unpackCmd(quint8 value, quint8 *pNum){
     if(value & (1<<7)){
         if(pNum) *pNum = value & ((1<<6)-1);
 
-        auto cmd = directed_cmds[" SNR"];
+        auto cmd = directed_cmds.value(" SNR");
 
         // sending digits with ACKS this way was deprecated in 2.2 (for reasons)
         // so we zero them out when unpacking so we don't display them even if
         // they were encoded that way.
         if(value & (1<<6)){
-            cmd = directed_cmds[" HEARTBEAT SNR"];
+            cmd = directed_cmds.value(" HEARTBEAT SNR");
         }
         return cmd;
     } else {
@@ -1212,27 +1281,27 @@ quint8 Varicode::unpackCmd(quint8 value, quint8 *pNum){
 }
 
 bool Varicode::isSNRCommand(const QString &cmd){
-    return directed_cmds.contains(cmd) && snr_cmds.contains(directed_cmds[cmd]);
+    return directed_cmds.contains(cmd) && snr_cmds.contains(directed_cmds.value(cmd));
 }
 
 bool Varicode::isCommandAllowed(const QString &cmd){
-    return directed_cmds.contains(cmd) && allowed_cmds.contains(directed_cmds[cmd]);
+    return directed_cmds.contains(cmd) && allowed_cmds.contains(directed_cmds.value(cmd));
 }
 
 bool Varicode::isCommandBuffered(const QString &cmd){
-    return directed_cmds.contains(cmd) && (cmd.contains(" ") || buffered_cmds.contains(directed_cmds[cmd]));
+    return directed_cmds.contains(cmd) && (cmd.contains(" ") || buffered_cmds.contains(directed_cmds.value(cmd)));
 }
 
 int Varicode::isCommandChecksumed(const QString &cmd){
-    if(!directed_cmds.contains(cmd) || !checksum_cmds.contains(directed_cmds[cmd])){
+    if(!directed_cmds.contains(cmd) || !checksum_cmds.contains(directed_cmds.value(cmd))){
         return 0;
     }
 
-    return checksum_cmds[directed_cmds[cmd]];
+    return checksum_cmds.value(directed_cmds.value(cmd));
 }
 
 bool Varicode::isCommandAutoreply(const QString &cmd){
-    return directed_cmds.contains(cmd) && (autoreply_cmds.contains(directed_cmds[cmd]));
+    return directed_cmds.contains(cmd) && (autoreply_cmds.contains(directed_cmds.value(cmd)));
 }
 
 bool isValidCompoundCallsign(QStringView callsign){
@@ -1256,7 +1325,7 @@ bool isValidCompoundCallsign(QStringView callsign){
         return true;
     }
 
-    if (callsign.length() > 2 && QRegularExpression("[0-9][A-Z]|[A-Z][0-9]")
+    if (callsign.length() > 2 && callsign_alnum_re
 #if (QT_VERSION < QT_VERSION_CHECK(6, 5, 0))
     .match(callsign)
 #else
@@ -1276,13 +1345,13 @@ bool Varicode::isValidCallsign(const QString &callsign, bool *pIsCompound){
         return true;
     }
 
-    auto match = QRegularExpression(base_callsign_pattern).match(callsign);
+    auto match = base_callsign_re.match(callsign);
     if(match.hasMatch() && (match.capturedLength() == callsign.length())){
         if(pIsCompound) *pIsCompound = false;
-        return callsign.length() > 2 && QRegularExpression("[0-9][A-Z]|[A-Z][0-9]").match(callsign).hasMatch();
+        return callsign.length() > 2 && callsign_alnum_re.match(callsign).hasMatch();
     }
 
-    match = QRegularExpression("^" + compound_callsign_pattern).match(callsign);
+    match = compound_callsign_whole_re.match(callsign);
 
     if(match.hasMatch() && (match.capturedLength() == callsign.length())){
         bool isValid = isValidCompoundCallsign(match.capturedView(0));
@@ -1300,12 +1369,12 @@ bool Varicode::isCompoundCallsign(const QString &callsign){
         return false;
     }
 
-    auto match = QRegularExpression(base_callsign_pattern).match(callsign);
+    auto match = base_callsign_re.match(callsign);
     if(match.hasMatch() && (match.capturedLength() == callsign.length())){
         return false;
     }
 
-    match = QRegularExpression("^" + compound_callsign_pattern).match(callsign);
+    match = compound_callsign_whole_re.match(callsign);
     if(!match.hasMatch() || (match.capturedLength() != callsign.length())){
         return false;
     }
@@ -1354,7 +1423,7 @@ QString Varicode::packHeartbeatMessage(QString const &text, const QString &calls
     }
 
     quint16 packed_extra = nmaxgrid; // which will display an empty string
-    if(extra.length() == 4 && QRegularExpression(grid_pattern).match(extra).hasMatch()){
+    if(extra.length() == 4 && grid_re.match(extra).hasMatch()){
         packed_extra = Varicode::packGrid(extra);
     }
 
@@ -1428,7 +1497,7 @@ QString Varicode::packCompoundMessage(QString const &text, int *n){
     if (!cmd.isEmpty() && directed_cmds.contains(cmd) && Varicode::isCommandAllowed(cmd)){
         bool packedNum = false;
         quint8 inum = Varicode::packNum(num, nullptr);
-        extra = nusergrid + Varicode::packCmd(directed_cmds[cmd], inum, &packedNum);
+        extra = nusergrid + Varicode::packCmd(directed_cmds.value(cmd), inum, &packedNum);
 
         type = Varicode::FrameCompoundDirected;
     } else if(!grid.isEmpty()){
@@ -1494,13 +1563,12 @@ QString Varicode::packCompoundFrame(const QString &callsign, quint8 type, quint1
     quint8 packed_8 = (packed_5 << 3) | bits3;
 
     // [3][50][11],[5][3] = 72
-    auto bits = (
-        Varicode::intToBits(packed_flag,  3) +
-        Varicode::intToBits(packed_callsign, 50) +
-        Varicode::intToBits(packed_11,   11)
-    );
+    BitBuffer<64> bits;
+    bits.append(packed_flag,      3);
+    bits.append(packed_callsign, 50);
+    bits.append(packed_11,       11);
 
-    return Varicode::pack72bits(Varicode::bitsToInt(bits), packed_8);
+    return Varicode::pack72bits(bits.extract(0, 64), packed_8);
 }
 
 QStringList Varicode::unpackCompoundFrame(const QString &text, quint8 *pType, quint16 *pNum, quint8 *pBits3){
@@ -1512,20 +1580,21 @@ QStringList Varicode::unpackCompoundFrame(const QString &text, quint8 *pType, qu
 
     // [3][50][11],[5][3] = 72
     quint8 packed_8 = 0;
-    auto bits = Varicode::intToBits(Varicode::unpack72bits(text, &packed_8), 64);
+    BitBuffer<64> bits;
+    bits.append(Varicode::unpack72bits(text, &packed_8), 64);
 
     quint8 packed_5 = packed_8 >> 3;
     quint8 packed_3 = packed_8 & ((1<<3)-1);
 
-    quint8 packed_flag = Varicode::bitsToInt(bits.mid(0, 3));
+    quint8 packed_flag = bits.extract(0, 3);
 
     // needs to be a ping type...
     if(packed_flag == Varicode::FrameData || packed_flag == Varicode::FrameDirected){
         return unpacked;
     }
 
-    quint64 packed_callsign = Varicode::bitsToInt(bits.mid(3, 50));
-    quint16 packed_11 = Varicode::bitsToInt(bits.mid(53, 11));
+    quint64 packed_callsign = bits.extract(3, 50);
+    quint16 packed_11 = bits.extract(53, 11);
 
     QString callsign = Varicode::unpackAlphaNumeric50(packed_callsign);
 
@@ -1618,11 +1687,11 @@ QString Varicode::packDirectedMessage(const QString &text, const QString &mycall
     quint8 packed_cmd = 0;
     if(directed_cmds.contains(cmd)){
         cmdOut = cmd;
-        packed_cmd = directed_cmds[cmdOut];
+        packed_cmd = directed_cmds.value(cmdOut);
     }
     if(directed_cmds.contains(cmd.trimmed())){
         cmdOut = cmd.trimmed();
-        packed_cmd = directed_cmds[cmdOut];
+        packed_cmd = directed_cmds.value(cmdOut);
     }
     quint8 packed_flag = Varicode::FrameDirected;
     quint8 packed_extra = (
@@ -1632,16 +1701,15 @@ QString Varicode::packDirectedMessage(const QString &text, const QString &mycall
     );
 
     // [3][28][28][5],[2][6] = 72
-    auto bits = (
-        Varicode::intToBits(packed_flag,      3) +
-        Varicode::intToBits(packed_from,     28) +
-        Varicode::intToBits(packed_to,       28) +
-        Varicode::intToBits(packed_cmd % 32,  5)
-    );
+    BitBuffer<64> bits;
+    bits.append(packed_flag,      3);
+    bits.append(packed_from,     28);
+    bits.append(packed_to,       28);
+    bits.append(packed_cmd % 32,  5);
 
     if(pCmd) *pCmd = cmdOut;
     if(n) *n = match.captured(0).length();
-    return Varicode::pack72bits(Varicode::bitsToInt(bits), packed_extra);
+    return Varicode::pack72bits(bits.extract(0, 64), packed_extra);
 }
 
 QStringList Varicode::unpackDirectedMessage(const QString &text, quint8 *pType){
@@ -1653,16 +1721,17 @@ QStringList Varicode::unpackDirectedMessage(const QString &text, quint8 *pType){
 
     // [3][28][22][11],[2][6] = 72
     quint8 extra = 0;
-    auto bits = Varicode::intToBits(Varicode::unpack72bits(text, &extra), 64);
+    BitBuffer<64> bits;
+    bits.append(Varicode::unpack72bits(text, &extra), 64);
 
-    quint8 packed_flag = Varicode::bitsToInt(bits.mid(0, 3));
+    quint8 packed_flag = bits.extract(0, 3);
     if(packed_flag != Varicode::FrameDirected){
         return unpacked;
     }
 
-    quint32 packed_from = Varicode::bitsToInt(bits.mid(3, 28));
-    quint32 packed_to = Varicode::bitsToInt(bits.mid(31, 28));
-    quint8 packed_cmd = Varicode::bitsToInt(bits.mid(59, 5));
+    quint32 packed_from = bits.extract(3, 28);
+    quint32 packed_to = bits.extract(31, 28);
+    quint8 packed_cmd = bits.extract(59, 5);
 
     bool portable_from = ((extra >> 7) & 1) == 1;
     bool portable_to = ((extra >> 6) & 1) == 1;
@@ -1688,7 +1757,26 @@ QStringList Varicode::unpackDirectedMessage(const QString &text, quint8 *pType){
     return unpacked;
 }
 
-QString packHuffMessage(const QString &input, const QVector<bool> prefix, int *n){
+// Pad a data frame out to 72 bits and pack it.
+QString packDataFrameBits(BitBuffer<72> frameBits){
+    static const int frameSize = 72;
+
+    int pad = frameSize - frameBits.length();
+    if(pad){
+        // the way we will pad is this...
+        // set the bit after the frame to 0 and every bit after that a 1
+        // to unpad, seek from the end of the bits until you hit a zero... the rest is the actual frame.
+        for(int i = 0; i < pad; i++){
+            frameBits.append(i == 0 ? (bool)0 : (bool)1);
+        }
+    }
+
+    quint64 value = frameBits.extract(0, 64);
+    quint8 rem = (quint8)frameBits.extract(64, 8);
+    return Varicode::pack72bits(value, rem);
+}
+
+QString packHuffMessage(const QString &input, BitBuffer<72> const &prefix, int *n){
     static const int frameSize = 72;
 
     QString frame;
@@ -1698,16 +1786,13 @@ QString packHuffMessage(const QString &input, const QVector<bool> prefix, int *n
     // but, since none of the other frame types start with a 0, we can drop the two zeros and use
     // them for encoding the first two bits of the actuall data sent. boom!
     // The second bit is a flag that indicates this is not compressed frame (huffman coding)
-    QVector<bool> frameBits;
-    if(!prefix.isEmpty()){
-        frameBits << prefix;
-    }
+    BitBuffer<72> frameBits = prefix;
 
     int i = 0;
 
     // only pack huff messages that only contain valid chars
     QString::const_iterator it;
-    QSet<QString> validChars = Varicode::huffValidChars(Varicode::defaultHuffTable());
+    auto const &validChars = Varicode::huffValidChars();
     for(it = input.constBegin(); it != input.constEnd(); it++){
         auto ch = (*it).toUpper();
         if(!validChars.contains(ch)){
@@ -1717,7 +1802,7 @@ QString packHuffMessage(const QString &input, const QVector<bool> prefix, int *n
     }
 
     // pack using the default huff table
-    foreach(auto pair, Varicode::huffEncode(Varicode::defaultHuffTable(), input)){
+    foreach(auto pair, Varicode::huffEncode(input)){
         auto charN = pair.first;
         auto charBits = pair.second;
         if(frameBits.length() + charBits.length() < frameSize){
@@ -1730,26 +1815,14 @@ QString packHuffMessage(const QString &input, const QVector<bool> prefix, int *n
 
     qCDebug(varicode_js8) << "Huff bits" << frameBits.length() << "chars" << i;
 
-    int pad = frameSize - frameBits.length();
-    if(pad){
-        // the way we will pad is this...
-        // set the bit after the frame to 0 and every bit after that a 1
-        // to unpad, seek from the end of the bits until you hit a zero... the rest is the actual frame.
-        for(int i = 0; i < pad; i++){
-            frameBits.append(i == 0 ? (bool)0 : (bool)1);
-        }
-    }
-
-    quint64 value = Varicode::bitsToInt(frameBits.constBegin(), 64);
-    quint8 rem = (quint8)Varicode::bitsToInt(frameBits.constBegin() + 64, 8);
-    frame = Varicode::pack72bits(value, rem);
+    frame = packDataFrameBits(frameBits);
 
     if(n) *n = i;
 
     return frame;
 }
 
-QString packCompressedMessage(const QString &input, QVector<bool> prefix, int *n){
+QString packCompressedMessage(const QString &input, BitBuffer<72> const &prefix, int *n){
     static const int frameSize = 72;
 
     QString frame;
@@ -1760,10 +1833,7 @@ QString packCompressedMessage(const QString &input, QVector<bool> prefix, int *n
     // them for encoding the first two bits of the actuall data sent. boom!
     // The second bit is a flag that indicates this is a compressed frame (dense coding)
     // For fast modes, we don't use the prefix since it is indicated by the JS8CallData flag.
-    QVector<bool> frameBits;
-    if(!prefix.isEmpty()){
-        frameBits << prefix;
-    }
+    BitBuffer<72> frameBits = prefix;
 
     int i = 0;
     foreach(auto pair, JSC::compress(input)){
@@ -1781,19 +1851,7 @@ QString packCompressedMessage(const QString &input, QVector<bool> prefix, int *n
 
     qCDebug(varicode_js8) << "Compressed bits" << frameBits.length() << "chars" << i;
 
-    int pad = frameSize - frameBits.length();
-    if(pad){
-        // the way we will pad is this...
-        // set the bit after the frame to 0 and every bit after that a 1
-        // to unpad, seek from the end of the bits until you hit a zero... the rest is the actual frame.
-        for(int i = 0; i < pad; i++){
-            frameBits.append(i == 0 ? (bool)0 : (bool)1);
-        }
-    }
-
-    quint64 value = Varicode::bitsToInt(frameBits.constBegin(), 64);
-    quint8 rem = (quint8)Varicode::bitsToInt(frameBits.constBegin() + 64, 8);
-    frame = Varicode::pack72bits(value, rem);
+    frame = packDataFrameBits(frameBits);
 
     if(n) *n = i;
 
@@ -1831,7 +1889,9 @@ QString Varicode::unpackDataMessage(const QString &text){
 
     quint8 rem = 0;
     quint64 value = Varicode::unpack72bits(text, &rem);
-    auto bits = Varicode::intToBits(value, 64) + Varicode::intToBits(rem, 8);
+    BitBuffer<72> bits;
+    bits.append(value, 64);
+    bits.append(rem, 8);
 
     bool isData = bits.at(0);
     if(!isData){
@@ -1841,7 +1901,7 @@ QString Varicode::unpackDataMessage(const QString &text){
     bits = bits.mid(1);
 
     bool compressed = bits.at(0);
-    int n = bits.lastIndexOf(0);
+    int n = bits.lastIndexOf(false);
 
     // trim off the pad bits
     bits = bits.mid(1, n-1);
@@ -1851,7 +1911,7 @@ QString Varicode::unpackDataMessage(const QString &text){
         unpacked = JSC::decompress(bits);
     } else {
         // huff decode the bits (without escapes)
-        unpacked = Varicode::huffDecode(Varicode::defaultHuffTable(), bits);
+        unpacked = Varicode::huffDecode(bits);
     }
 
     return unpacked;
@@ -1897,11 +1957,13 @@ QString Varicode::unpackFastDataMessage(const QString &text){
 
     quint8 rem = 0;
     quint64 value = Varicode::unpack72bits(text, &rem);
-    auto bits = Varicode::intToBits(value, 64) + Varicode::intToBits(rem, 8);
+    BitBuffer<72> bits;
+    bits.append(value, 64);
+    bits.append(rem, 8);
 
 #if JS8_FAST_DATA_CAN_USE_HUFF
     bool compressed = bits.at(0);
-    int n = bits.lastIndexOf(0);
+    int n = bits.lastIndexOf(false);
 
     // trim off the pad bits
     bits = bits.mid(1, n-1);
@@ -1911,10 +1973,10 @@ QString Varicode::unpackFastDataMessage(const QString &text){
         unpacked = JSC::decompress(bits);
     } else {
         // huff decode the bits (without escapes)
-        unpacked = Varicode::huffDecode(Varicode::defaultHuffTable(), bits);
+        unpacked = Varicode::huffDecode(bits);
     }
 #else
-    int n = bits.lastIndexOf(0);
+    int n = bits.lastIndexOf(false);
 
     // trim off the pad bits
     bits = bits.mid(0, n);
@@ -1926,6 +1988,183 @@ QString Varicode::unpackFastDataMessage(const QString &text){
     return unpacked;
 }
 
+DataFramePacker::DataFramePacker(int submode):
+    m_submode{submode},
+    m_lastInvalidHuff{-1}
+{
+}
+
+bool DataFramePacker::usesHuff() const {
+#if JS8_FAST_DATA_CAN_USE_HUFF
+    return true;
+#else
+    return m_submode == Varicode::JS8CallNormal;
+#endif
+}
+
+void DataFramePacker::setText(QString const &text){
+    if(text == m_text){
+        return;
+    }
+
+    int common = 0;
+    for(int max = qMin(text.size(), m_text.size()); common < max && text.at(common) == m_text.at(common); common++){}
+
+    m_text = text;
+    m_compressedResumed.clear();
+    m_huffResumed.clear();
+
+    // Dictionary codewords depend on the whole of their word, and on
+    // whether it's the last, so keep only those for words ending, with
+    // the space after them, before the first change.
+    encode(m_compressed, false, common ? m_text.lastIndexOf(' ', common - 1) + 1 : 0);
+
+    if(!usesHuff()){
+        return;
+    }
+
+    // Huffman codes are chosen by looking only at the next few characters,
+    // so we can keep any that were chosen before reaching the change.
+    static const int maxKeyLength = [](){
+        int max = 0;
+        foreach(auto key, Varicode::defaultHuffTable().keys()){
+            max = qMax(max, (int)key.length());
+        }
+        return max;
+    }();
+
+    int resume = 0;
+    foreach(auto const &t, m_huff){
+        if(t.start + maxKeyLength > common){
+            break;
+        }
+        resume = t.start + t.chars;
+    }
+    encode(m_huff, true, resume);
+
+    auto const &validChars = Varicode::huffValidChars();
+
+    m_lastInvalidHuff = -1;
+    for(int i = m_text.size() - 1; i >= 0; i--){
+        if(!validChars.contains(m_text.at(i).toUpper())){
+            m_lastInvalidHuff = i;
+            break;
+        }
+    }
+}
+
+// Replace the tokens from offset on with a fresh encoding of the text
+// from there.
+void DataFramePacker::encode(QList<Token> &tokens, bool huff, int offset){
+    auto const first = std::lower_bound(tokens.begin(), tokens.end(), offset, [](Token const &t, int o){
+        return t.start < o;
+    });
+    tokens.erase(first, tokens.end());
+
+    QList<int> starts;
+    auto const tail = m_text.mid(offset);
+
+    if(huff){
+        auto const codes = Varicode::huffEncode(tail, &starts);
+        for(int i = 0; i < codes.size(); i++){
+            tokens.append({ offset + starts.at(i), codes.at(i).first, codes.at(i).second });
+        }
+    } else {
+        auto const codes = JSC::compress(tail, &starts);
+        for(int i = 0; i < codes.size(); i++){
+            tokens.append({ offset + starts.at(i), (int)codes.at(i).second, codes.at(i).first });
+        }
+    }
+}
+
+// The same frame as packHuffMessage() or packCompressedMessage() would
+// give for the text from offset on. Encoding is deterministic from any
+// point, so a frame can start wherever a token does. Frames can also
+// start in the middle of characters that were skipped over because they
+// couldn't be encoded, which the character counts don't include, so we
+// may have to encode the rest of the text again from there.
+QString DataFramePacker::packFrame(QList<Token> const &tokens, QList<Token> &resumed, bool huff, int offset, BitBuffer<72> const &prefix, int *n){
+    static const int frameSize = 72;
+
+    // only pack huff messages that only contain valid chars
+    if(huff && offset <= m_lastInvalidHuff){
+        if(n) *n = 0;
+        return {};
+    }
+
+    auto find = [offset](QList<Token> const &list){
+        auto const it = std::lower_bound(list.cbegin(), list.cend(), offset, [](Token const &t, int o){
+            return t.start < o;
+        });
+        return it - list.cbegin();
+    };
+
+    auto const *list = &tokens;
+    auto i = find(*list);
+
+    if(offset < m_text.size() && (i == list->size() || list->at(i).start != offset)){
+        list = &resumed;
+        i = find(*list);
+
+        if(i == list->size() || list->at(i).start != offset){
+            resumed.clear();
+            encode(resumed, huff, offset);
+            i = find(*list);
+        }
+    }
+
+    BitBuffer<72> frameBits = prefix;
+    int chars = 0;
+
+    for(; i < list->size(); i++){
+        auto const &t = list->at(i);
+        if(frameBits.length() + t.bits.length() >= frameSize){
+            break;
+        }
+        frameBits += t.bits;
+        chars += t.chars;
+    }
+
+    if(n) *n = chars;
+    return packDataFrameBits(frameBits);
+}
+
+QString DataFramePacker::pack(int offset, int *n){
+    if(m_submode == Varicode::JS8CallNormal){
+        int huffChars = 0;
+        auto huffFrame = packFrame(m_huff, m_huffResumed, true, offset, {true, false}, &huffChars);
+
+        int compressedChars = 0;
+        auto compressedFrame = packFrame(m_compressed, m_compressedResumed, false, offset, {true, true}, &compressedChars);
+
+        if(huffChars > compressedChars){
+            if(n) *n = huffChars;
+            return huffFrame;
+        } else {
+            if(n) *n = compressedChars;
+            return compressedFrame;
+        }
+    }
+
+#if JS8_FAST_DATA_CAN_USE_HUFF
+    int huffChars = 0;
+    auto huffFrame = packFrame(m_huff, m_huffResumed, true, offset, {false}, &huffChars);
+
+    int compressedChars = 0;
+    auto compressedFrame = packFrame(m_compressed, m_compressedResumed, false, offset, {true}, &compressedChars);
+
+    if(huffChars > compressedChars){
+        if(n) *n = huffChars;
+        return huffFrame;
+    } else {
+        if(n) *n = compressedChars;
+        return compressedFrame;
+    }
+#else
+    return packFrame(m_compressed, m_compressedResumed, false, offset, {}, n);
+#endif
+}
+
 // TODO: remove the dependence on providing all this data?
 QList<QPair<QString, int>> Varicode::buildMessageFrames(QString const& mycall,
     QString const& mygrid,
@@ -1934,7 +2173,8 @@ QList<QPair<QString, int>> Varicode::buildMessageFrames(QString const& mycall,
     bool forceIdentify,
     bool forceData,
     int submode,
-    MessageInfo *pInfo){
+    MessageInfo *pInfo,
+    DataFramePacker *pPacker){
 
     #define ALLOW_SEND_COMPOUND 1
     #define ALLOW_SEND_COMPOUND_DIRECTED 1
@@ -1945,6 +2185,15 @@ QList<QPair<QString, int>> Varicode::buildMessageFrames(QString const& mycall,
 
     bool mycallCompound = Varicode::isCompoundCallsign(mycall);
 
+    // data frames are packed out of a single encoding of the line; use
+    // the caller's packer if we have one, as it may have encoded most of
+    // this line already, on the last call.
+    DataFramePacker localPacker(submode);
+    DataFramePacker &packer = pPacker ? *pPacker : localPacker;
+    if(packer.submode() != submode){
+        packer = DataFramePacker(submode);
+    }
+
     QList<QPair<QString, int>> allFrames;
 
 #if JS8_NO_MULTILINE
@@ -2015,6 +2264,33 @@ QList<QPair<QString, int>> Varicode::buildMessageFrames(QString const& mycall,
 #endif
 
         while(line.size() > 0){
+          // once we're only sending data, the rest of the line goes out in
+          // data frames, one after the other, with no need to look at it
+          // any further. the packer already has the line if it's only lost
+          // data frames from the front since it was last given it.
+          if((hasDirected || hasData) && !(forceIdentify && lineFrames.isEmpty())){
+              int offset = packer.text().size() - line.size();
+              if(offset < 0 || QStringView(packer.text()).mid(offset) != line){
+                  packer.setText(line);
+                  offset = 0;
+              }
+
+              auto const frameType = submode == Varicode::JS8CallNormal ? Varicode::JS8Call : Varicode::JS8CallData;
+
+              while(offset < packer.text().size()){
+                  int m = 0;
+                  auto const datFrame = packer.pack(offset, &m);
+                  if(m <= 0){
+                      // nothing left that we can encode
+                      break;
+                  }
+                  lineFrames.append({ datFrame, frameType });
+                  offset += m;
+              }
+
+              break;
+          }
+
           QString frame;
 
           bool useBcn = false;
@@ -2051,15 +2327,6 @@ QList<QPair<QString, int>> Varicode::buildMessageFrames(QString const& mycall,
 #endif
           int m = 0;
           bool fastDataFrame = false;
-          QString datFrame;
-          // TODO: DEPRECATED in 2.2 (the following release will remove transmission of these frames)
-          if(submode == Varicode::JS8CallNormal){
-              datFrame = Varicode::packDataMessage(line, &m);
-              fastDataFrame = false;
-          } else {
-              datFrame = Varicode::packFastDataMessage(line, &m);
-              fastDataFrame = true;
-          }
 
           // if this parses to a standard FT8 free text message
           // but it can be parsed as a directed message, then we
@@ -2084,10 +2351,31 @@ QList<QPair<QString, int>> Varicode::buildMessageFrames(QString const& mycall,
               hasDirected = true;
               frame = dirFrame;
           }
-          else if (m > 0) {
-              useDat = true;
-              hasData = true;
-              frame = datFrame;
+          else {
+              // the data frame is only needed if nothing else fits, and we
+              // pack it just as packDataMessage() or packFastDataMessage()
+              // would have; the former is DEPRECATED in 2.2 (the following
+              // release will remove transmission of these frames)
+              packer.setText(line);
+              QString datFrame = packer.pack(0, &m);
+              fastDataFrame = submode != Varicode::JS8CallNormal;
+
+              if (m > 0) {
+                  useDat = true;
+                  hasData = true;
+                  frame = datFrame;
+              }
+          }
+
+          // if nothing at all could be encoded from what's left of the
+          // line, give up on it, rather than go round again forever.
+          bool useAny = useBcn || useDir || useDat;
+#if ALLOW_SEND_COMPOUND
+          useAny = useAny || useCmp;
+#endif
+          if(!useAny){
+              qCDebug(varicode_js8) << "unable to encode rest of line" << line;
+              break;
           }
 
           if(useBcn){
@@ -2209,6 +2497,7 @@ BuildMessageFramesThread::BuildMessageFramesThread(const QString &mycall,
     bool forceIdentify,
     bool forceData,
     int submode,
+    DataFramePacker const &packer,
     QObject *parent):
     QThread(parent),
     m_mycall{mycall},
@@ -2217,7 +2506,8 @@ BuildMessageFramesThread::BuildMessageFramesThread(const QString &mycall,
     m_text{text},
     m_forceIdentify{forceIdentify},
     m_forceData{forceData},
-    m_submode{submode}
+    m_submode{submode},
+    m_packer{packer}
 {
 }
 
@@ -2229,7 +2519,9 @@ void BuildMessageFramesThread::run(){
         m_text,
         m_forceIdentify,
         m_forceData,
-        m_submode
+        m_submode,
+        nullptr,
+        &m_packer
     );
 
     // TODO: jsherer - we wouldn't normally use decodedtext.h here... but it's useful for computing the actual frames transmitted.
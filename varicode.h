@@ -7,10 +7,15 @@
 
 #include <QBitArray>
 #include <QRegularExpression>
+#include <QList>
 #include <QString>
 #include <QVector>
 #include <QThread>
 
+#include "BitBuffer.hpp"
+#include "jsc.h"
+
+class DataFramePacker;
 
 class Varicode
 {
@@ -105,18 +110,9 @@ public:
     static QStringList parseCallsigns(QString const &input);
     static QStringList parseGrids(QString const &input);
 
-    static QList<QPair<int, QVector<bool>>> huffEncode(const QMap<QString, QString> &huff, QString const& text);
-    static QString huffDecode(const QMap<QString, QString> &huff, QVector<bool> const& bitvec);
-    static QSet<QString> huffValidChars(const QMap<QString, QString> &huff);
-
-    static QVector<bool> bytesToBits(char * bitvec, int n);
-    static QVector<bool> strToBits(QString const& bitvec);
-    static QString bitsToStr(QVector<bool> const& bitvec);
-
-    static QVector<bool> intToBits(quint64 value, int expected=0);
-    static quint64 bitsToInt(QVector<bool> const value);
-    static quint64 bitsToInt(QVector<bool>::ConstIterator start, int n);
-    static QVector<bool> bitsListToBits(QList<QVector<bool>> &list);
+    static QList<QPair<int, Codeword>> huffEncode(QString const& text, QList<int> *pStarts=nullptr);
+    static QString huffDecode(BitBuffer<72> const& bitvec);
+    static QSet<QString> const & huffValidChars();
 
     static quint8 unpack5bits(QString const& value);
     static QString pack5bits(quint8 packed);
@@ -189,7 +185,51 @@ public:
         bool forceIdentify,
         bool forceData,
         int submode,
-        MessageInfo *pInfo=nullptr);
+        MessageInfo *pInfo=nullptr,
+        DataFramePacker *pPacker=nullptr);
+};
+
+
+// Packs the data frames for a line of text out of a single encoding of
+// it, rather than re-encoding whatever is left for each frame; frames
+// are the same as those from packDataMessage() in the normal submode,
+// or packFastDataMessage() in the others. When the text is replaced,
+// the encoding of what the old and new text have in common is kept, so
+// a packer held across edits only has to encode the edited tail.
+class DataFramePacker
+{
+public:
+    explicit DataFramePacker(int submode = Varicode::JS8CallNormal);
+
+    int submode() const { return m_submode; }
+    QString const & text() const { return m_text; }
+    void setText(QString const &text);
+
+    // Pack a frame from the text starting at offset, returning the
+    // number of characters it holds in n.
+    QString pack(int offset, int *n);
+
+private:
+    struct Token {
+        int start;           // position in the text
+        int chars;           // characters covered
+        Codeword bits;
+    };
+
+    bool usesHuff() const;
+    void encode(QList<Token> &tokens, bool huff, int offset);
+    QString packFrame(QList<Token> const &tokens, QList<Token> &resumed, bool huff, int offset, BitBuffer<72> const &prefix, int *n);
+
+    int m_submode;
+    QString m_text;
+
+    // Encodings of the text from the start, and from wherever we last
+    // had to resume after characters that couldn't be encoded.
+    QList<Token> m_compressed;
+    QList<Token> m_compressedResumed;
+    QList<Token> m_huff;
+    QList<Token> m_huffResumed;
+    int m_lastInvalidHuff;   // last character that can't be huff coded, or -1
 };
 
 
@@ -204,8 +244,13 @@ public:
                              bool forceIdentify,
                              bool forceData,
                              int submode,
+                             DataFramePacker const &packer,
                              QObject *parent=nullptr);
     void run() override;
+
+    // The packer, as left by the last run; hand it to the next thread
+    // to spare it from encoding the text the two have in common.
+    DataFramePacker packer() const { return m_packer; }
 signals:
     void resultReady(QString, int);
 
@@ -217,6 +262,7 @@ private:
     bool m_forceIdentify;
     bool m_forceData;
     int m_submode;
+    DataFramePacker m_packer;
 };
 
 #endif // VARICODE_H